@@ -18,6 +18,15 @@
 
 #define FILETIME_TO_UNIX(ft)        (time_t)((ft) / 10000000ULL - 11644473600ULL)
 #define VER_OSARCH                  "Linux"
+#define VFS_FUSE_FAST_MAXIO         0x00100000      // 1MB
+
+typedef struct tdVFS_FUSE_CONFIG {
+    BOOL fFast;         // high-throughput mode (-fuse-fast)
+    BOOL fDirectIo;     // direct i/o for volatile files (-fuse-direct-io)
+    BOOL fRefresh;      // underlying memory is volatile and refreshed
+} VFS_FUSE_CONFIG;
+
+static VFS_FUSE_CONFIG g_VfsFuseCfg = { 0 };
 
 static int vfs_getattr(const char *uszPathFull, struct stat *st)
 {
@@ -77,21 +86,108 @@ static int vfs_readdir(const char *uszPath, void *buffer, fuse_fill_dir_t filler
     return 0;
 }
 
-static int vfs_read(const char *uszPath, char *buffer, size_t size, off_t offset, struct fuse_file_info *fi)
+/*
+* Copy a FUSE path and replace forward slashes with backward slashes.
+*/
+static void vfs_path_fuse2vmm(const char *uszPath, _Out_writes_(3 * MAX_PATH) LPSTR uszPathCopy)
 {
-    NTSTATUS nt;
-    DWORD i = 0, readlength = 0;
-    CHAR c = 0, uszPathCopy[3 * MAX_PATH] = { 0 };
-    // 1: replace forward slash with backward slash
-    strncpy_s(uszPathCopy, sizeof(uszPathCopy), uszPath, _TRUNCATE);
+    DWORD i = 0;
+    CHAR c = 0;
+    ZeroMemory(uszPathCopy, 3 * MAX_PATH);
+    strncpy_s(uszPathCopy, 3 * MAX_PATH, uszPath, _TRUNCATE);
     while((c = uszPathCopy[i++])) {
         if(c == '/') { uszPathCopy[i - 1] = '\\'; }
     }
-    // 2: read
-    nt = VMMDLL_VfsReadU((LPSTR)uszPathCopy, (PBYTE)buffer, size, &readlength, offset);
+}
+
+/*
+* Check whether a file opened read-only won't change for the lifetime of the
+* mount and may be kept in the page cache between opens. This is the case for
+* generated minidumps and for the forensic output in the sub-directories of
+* \forensic\ once forensic processing has completed - but not for the status
+* files in \forensic\ itself (progress, forensic_enable.txt) - and only if the
+* underlying memory is static (no refresh).
+* -- uszPath
+* -- fi
+* -- return
+*/
+static BOOL vfs_open_immutable(_In_ LPSTR uszPath, _In_ struct fuse_file_info *fi)
+{
+    DWORD cbRead = 0;
+    CHAR szProgress[4] = { 0 };
+    if(g_VfsFuseCfg.fRefresh || ((fi->flags & O_ACCMODE) != O_RDONLY)) { return FALSE; }
+    if(strstr(uszPath, "\\minidump\\")) { return TRUE; }
+    if(_strnicmp(uszPath, "\\forensic\\", 10) || !strchr(uszPath + 10, '\\')) { return FALSE; }
+    VMMDLL_VfsReadU("\\forensic\\progress_percent.txt", (PBYTE)szProgress, 3, &cbRead, 0);
+    return !strcmp(szProgress, "100");
+}
+
+/*
+* Resolve the file once on open and keep the resolved handle in fi->fh. Reads
+* and writes on the handle won't have to re-resolve the path. If the path can't
+* be resolved (fh == 0) reads and writes fall back to path-based access.
+* In high-throughput mode immutable files are kept in the page cache. Other
+* files bypass the page cache (direct i/o) only if -fuse-direct-io is given
+* since direct i/o files, such as memory.pmem, can't be memory mapped.
+*/
+static int vfs_open(const char *uszPath, struct fuse_file_info *fi)
+{
+    BOOL fImmutable;
+    CHAR uszPathCopy[3 * MAX_PATH];
+    vfs_path_fuse2vmm(uszPath, uszPathCopy);
+    fi->fh = (uint64_t)(SIZE_T)VMMDLL_VfsOpenU(uszPathCopy);
+    if(g_VfsFuseCfg.fFast) {
+        fImmutable = vfs_open_immutable(uszPathCopy, fi);
+        fi->keep_cache = fImmutable ? 1 : 0;
+        fi->direct_io = (!fImmutable && g_VfsFuseCfg.fDirectIo) ? 1 : 0;
+    }
+    return 0;
+}
+
+static int vfs_release(const char *uszPath, struct fuse_file_info *fi)
+{
+    if(fi->fh) {
+        VMMDLL_VfsCloseHandle((VMMDLL_VFS_HANDLE)(SIZE_T)fi->fh);
+        fi->fh = 0;
+    }
+    return 0;
+}
+
+static int vfs_read(const char *uszPath, char *buffer, size_t size, off_t offset, struct fuse_file_info *fi)
+{
+    NTSTATUS nt;
+    DWORD readlength = 0;
+    CHAR uszPathCopy[3 * MAX_PATH];
+    if(fi && fi->fh) {
+        nt = VMMDLL_VfsReadHandle((VMMDLL_VFS_HANDLE)(SIZE_T)fi->fh, (PBYTE)buffer, size, &readlength, offset);
+    } else {
+        vfs_path_fuse2vmm(uszPath, uszPathCopy);
+        nt = VMMDLL_VfsReadU((LPSTR)uszPathCopy, (PBYTE)buffer, size, &readlength, offset);
+    }
     return ((nt == VMMDLL_STATUS_SUCCESS) || (nt == VMMDLL_STATUS_END_OF_FILE)) ? (int)readlength : 0;
 }
 
+/*
+* High-throughput mode read: the data is read into a memory buffer which is
+* handed over to FUSE which replies with it using splice (if enabled) to avoid
+* an additional copy. The buffer and buffer vector is free'd by FUSE.
+*/
+static int vfs_read_buf(const char *uszPath, struct fuse_bufvec **pbufp, size_t size, off_t offset, struct fuse_file_info *fi)
+{
+    int cbRead;
+    struct fuse_bufvec *pbufv;
+    if(!(pbufv = malloc(sizeof(struct fuse_bufvec)))) { return -ENOMEM; }
+    *pbufv = (struct fuse_bufvec)FUSE_BUFVEC_INIT(size);
+    if(!(pbufv->buf[0].mem = malloc(size ? size : 1))) {
+        free(pbufv);
+        return -ENOMEM;
+    }
+    cbRead = vfs_read(uszPath, pbufv->buf[0].mem, size, offset, fi);
+    pbufv->buf[0].size = (cbRead > 0) ? cbRead : 0;
+    *pbufp = pbufv;
+    return 0;
+}
+
 static int vfs_truncate(const char *path, off_t size)
 {
     // dummy function - required and called before vfs_write().
@@ -101,29 +197,50 @@ static int vfs_truncate(const char *path, off_t size)
 static int vfs_write(const char *uszPath, const char *buffer, size_t size, off_t offset, struct fuse_file_info *fi)
 {
     NTSTATUS nt;
-    DWORD i = 0, writelength = 0;
-    CHAR c = 0, uszPathCopy[3 * MAX_PATH] = { 0 };
-    // 1: replace forward slash with backward slash
-    strncpy_s(uszPathCopy, sizeof(uszPathCopy), uszPath, _TRUNCATE);
-    while((c = uszPathCopy[i++])) {
-        if(c == '/') { uszPathCopy[i - 1] = '\\'; }
+    DWORD writelength = 0;
+    CHAR uszPathCopy[3 * MAX_PATH];
+    if(fi && fi->fh) {
+        nt = VMMDLL_VfsWriteHandle((VMMDLL_VFS_HANDLE)(SIZE_T)fi->fh, (PBYTE)buffer, size, &writelength, offset);
+    } else {
+        vfs_path_fuse2vmm(uszPath, uszPathCopy);
+        nt = VMMDLL_VfsWriteU((LPSTR)uszPathCopy, (PBYTE)buffer, size, &writelength, offset);
     }
-    // 2: write
-    nt = VMMDLL_VfsWriteU((LPSTR)uszPathCopy, (PBYTE)buffer, size, &writelength, offset);
     return ((nt == VMMDLL_STATUS_SUCCESS) || (nt == VMMDLL_STATUS_END_OF_FILE)) ? (int)size : 0;
 }
 
 static struct fuse_operations vfs_operations = {
     .readdir = vfs_readdir,
     .getattr = vfs_getattr,
+    .open = vfs_open,
+    .release = vfs_release,
     .read = vfs_read,
     .write = vfs_write,
     .truncate = vfs_truncate,
 };
 
-int vfs_initialize_and_mount_displayinfo(int argc, char *argv[])
+/*
+* Start FUSE. FUSE runs its multi-threaded session loop since "-s" is never
+* given. In high-throughput mode large read/write requests, splice and
+* read_buf replies are additionally enabled.
+* -- uszArgv0
+* -- uszMountPoint
+* -- return
+*/
+int vfs_initialize_and_mount_displayinfo(_In_ LPSTR uszArgv0, _In_ LPSTR uszMountPoint)
 {
-    return fuse_main(argc, argv, &vfs_operations, NULL);
+    ULONG64 qwRefresh = 0;
+    CHAR szFuseOpt[MAX_PATH];
+    LPSTR szArgListFuse[] = { uszArgv0, uszMountPoint, "-f", "-o", szFuseOpt };
+    if(!g_VfsFuseCfg.fFast) {
+        return fuse_main(3, szArgListFuse, &vfs_operations, NULL);
+    }
+    VMMDLL_ConfigGet(VMMDLL_OPT_CONFIG_IS_REFRESH_ENABLED, &qwRefresh);
+    g_VfsFuseCfg.fRefresh = qwRefresh ? TRUE : FALSE;
+    vfs_operations.read_buf = vfs_read_buf;
+    _snprintf_s(szFuseOpt, sizeof(szFuseOpt), _TRUNCATE,
+        "max_read=%i,max_write=%i,max_readahead=%i,big_writes,splice_read,splice_write,splice_move",
+        VFS_FUSE_FAST_MAXIO, VFS_FUSE_FAST_MAXIO, VFS_FUSE_FAST_MAXIO);
+    return fuse_main(5, szArgListFuse, &vfs_operations, NULL);
 }
 
 
@@ -134,6 +251,8 @@ int vfs_initialize_and_mount_displayinfo(int argc, char *argv[])
 
 /*
 * Retrieve the mount point of the FUSE file system given in the -mount parameter.
+* The FUSE high-throughput mode is also enabled if the -fuse-fast parameter is
+* set and direct i/o for volatile files if the -fuse-direct-io parameter is set.
 * -- argc
 * -- argv
 * -- pszMountPoint
@@ -144,7 +263,15 @@ VOID GetMountPoint(_In_ DWORD argc, _In_ char *argv[], _Out_ LPSTR *pszMountPoin
     DWORD i = 0;
     *pszMountPoint = NULL;
     while(i < argc) {
-        if(0 == _stricmp(argv[i], "-mount")) {
+        if(0 == _stricmp(argv[i], "-fuse-fast")) {
+            g_VfsFuseCfg.fFast = TRUE;
+            i++;
+            continue;
+        } else if(0 == _stricmp(argv[i], "-fuse-direct-io")) {
+            g_VfsFuseCfg.fDirectIo = TRUE;
+            i++;
+            continue;
+        } else if(0 == _stricmp(argv[i], "-mount")) {
             *pszMountPoint = argv[i + 1];
             i += 2;
             continue;
@@ -237,8 +364,7 @@ int main(_In_ int argc, _In_ char* argv[])
     VfsList_Initialize(VMMDLL_VfsListU, 500, 128, FALSE);
     Vfs_InitializeAndMount_DisplayInfo(szMountPoint);
     // hand over control to FUSE.
-    LPSTR szArgListFuse[] = { argv[0], szMountPoint, "-f" };
-    return vfs_initialize_and_mount_displayinfo(3, szArgListFuse);
+    return vfs_initialize_and_mount_displayinfo(argv[0], szMountPoint);
 }
 
 #endif /* LINUX */
@@ -74,9 +74,22 @@ _Success_(return != NULL)
 sqlite3* Fc_SqlReserveReturn(_In_opt_ sqlite3 *hSql)
 {
     DWORD i;
+    sqlite3_stmt *hStmt;
+    PFCSQL_CONNECTION pc;
     if(!hSql) { return NULL; }
     for(i = 0; i < FC_SQL_POOL_CONNECTION_NUM; i++) {
         if(ctxFc->db.hSql[i] == hSql) {
+            pc = &ctxFc->db.Conn[i];
+            if(pc->fTransaction) {
+                // bulk transaction not committed by caller - commit pending rows.
+                Fc_SqlTransactionCommit(hSql);
+            }
+            // end of reservation: cached statements may be evicted again and
+            // statements which did not fit in the cache are finalized.
+            pc->qwReserve++;
+            while((hStmt = (sqlite3_stmt*)ObSet_Pop(pc->psObStmtOverflow))) {
+                sqlite3_finalize(hStmt);
+            }
             SetEvent(ctxFc->db.hEvent[i]);
             break;
         }
@@ -121,8 +134,7 @@ int Fc_SqlQueryN(_In_ LPSTR szSql, _In_ DWORD cQueryValues, _In_reads_(cQueryVal
     sqlite3 *hSql = Fc_SqlReserve();
     sqlite3_stmt *hStmt = NULL;
     if(hSql) {
-        rc = sqlite3_prepare_v2(hSql, szSql, -1, &hStmt, 0);
-        if(rc != SQLITE_OK) { goto fail; }
+        if(!(hStmt = Fc_SqlPrepareCached(hSql, szSql))) { goto fail; }
         for(i = 0; i < cQueryValues; i++) {
             sqlite3_bind_int64(hStmt, i + 1, pqwQueryValues[i]);
         }
@@ -142,26 +154,253 @@ int Fc_SqlQueryN(_In_ LPSTR szSql, _In_ DWORD cQueryValues, _In_reads_(cQueryVal
         rc = SQLITE_OK;
     }
 fail:
-    sqlite3_finalize(hStmt);
+    if(hStmt) { sqlite3_reset(hStmt); }
     Fc_SqlReserveReturn(hSql);
     if(pcResultValues) { *pcResultValues = 0; }
     return rc;
 }
 
+/*
+* Retrieve the per-connection bulk/cache context of a database handle.
+* -- hSql
+* -- return = the connection context, or NULL if not a pool connection.
+*/
+PFCSQL_CONNECTION Fc_SqlConnection(_In_ sqlite3 *hSql)
+{
+    DWORD i;
+    for(i = 0; i < FC_SQL_POOL_CONNECTION_NUM; i++) {
+        if(ctxFc->db.hSql[i] == hSql) {
+            return &ctxFc->db.Conn[i];
+        }
+    }
+    return NULL;
+}
+
+_Success_(return != NULL)
+sqlite3_stmt* Fc_SqlPrepareCached(_In_ sqlite3 *hSql, _In_ LPCSTR szSql)
+{
+    DWORD i, iLRU = (DWORD)-1;
+    sqlite3_stmt *hStmt = NULL;
+    PFCSQL_STMT_CACHE_ENTRY pe;
+    PFCSQL_CONNECTION pc = Fc_SqlConnection(hSql);
+    if(!pc) { return NULL; }
+    for(i = 0; i < FC_SQL_STMT_CACHE_NUM; i++) {
+        pe = &pc->Stmt[i];
+        if(pe->hStmt && ((pe->szSql == szSql) || !strcmp(pe->szSql, szSql))) {
+            pe->qwTickLastUse = ++pc->qwTick;
+            pe->qwReserve = pc->qwReserve;
+            sqlite3_reset(pe->hStmt);
+            sqlite3_clear_bindings(pe->hStmt);
+            return pe->hStmt;
+        }
+        // statements retrieved in the current reservation may still be held
+        // by the caller and are not eligible for eviction.
+        if(pe->hStmt && (pe->qwReserve == pc->qwReserve)) { continue; }
+        if((iLRU == (DWORD)-1) || (pe->qwTickLastUse < pc->Stmt[iLRU].qwTickLastUse)) {
+            iLRU = i;
+        }
+    }
+    if(iLRU == (DWORD)-1) {
+        // cache full of statements in use - prepare an uncached statement which
+        // is finalized when the connection is returned.
+        if(!pc->psObStmtOverflow && !(pc->psObStmtOverflow = ObSet_New())) { return NULL; }
+        if(SQLITE_OK != sqlite3_prepare_v2(hSql, szSql, -1, &hStmt, NULL)) {
+            VmmLog(MID_FORENSIC, LOGLEVEL_DEBUG, "BAD SQL CODE=0x%x SQL=%s\n", sqlite3_errcode(hSql), szSql);
+            return NULL;
+        }
+        ObSet_Push(pc->psObStmtOverflow, (QWORD)hStmt);
+        return hStmt;
+    }
+    // not found - prepare statement into least recently used cache slot.
+    pe = &pc->Stmt[iLRU];
+    if(pe->hStmt) {
+        sqlite3_finalize(pe->hStmt);
+        LocalFree((LPSTR)pe->szSql);
+        ZeroMemory(pe, sizeof(FCSQL_STMT_CACHE_ENTRY));
+    }
+    if(!(pe->szSql = Util_StrDupA((LPSTR)szSql))) { return NULL; }
+    if(SQLITE_OK != sqlite3_prepare_v3(hSql, szSql, -1, SQLITE_PREPARE_PERSISTENT, &pe->hStmt, NULL)) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_DEBUG, "BAD SQL CODE=0x%x SQL=%s\n", sqlite3_errcode(hSql), szSql);
+        LocalFree((LPSTR)pe->szSql);
+        ZeroMemory(pe, sizeof(FCSQL_STMT_CACHE_ENTRY));
+        return NULL;
+    }
+    pe->qwTickLastUse = ++pc->qwTick;
+    pe->qwReserve = pc->qwReserve;
+    return pe->hStmt;
+}
+
+/*
+* Finalize all cached statements of a connection. Must be called before the
+* connection is closed.
+* -- pc
+*/
+VOID Fc_SqlPrepareCached_Close(_In_ PFCSQL_CONNECTION pc)
+{
+    DWORD i;
+    sqlite3_stmt *hStmt;
+    for(i = 0; i < FC_SQL_STMT_CACHE_NUM; i++) {
+        if(pc->Stmt[i].hStmt) {
+            sqlite3_finalize(pc->Stmt[i].hStmt);
+            LocalFree((LPSTR)pc->Stmt[i].szSql);
+        }
+    }
+    ZeroMemory(pc->Stmt, sizeof(pc->Stmt));
+    while((hStmt = (sqlite3_stmt*)ObSet_Pop(pc->psObStmtOverflow))) {
+        sqlite3_finalize(hStmt);
+    }
+    Ob_DECREF_NULL(&pc->psObStmtOverflow);
+    LocalFree(pc->pbStr);
+    pc->pbStr = NULL;
+}
+
+#define FC_SQL_STR_ROW          "(?,?,?,?)"
+#define FC_SQL_STR_ROW4         FC_SQL_STR_ROW "," FC_SQL_STR_ROW "," FC_SQL_STR_ROW "," FC_SQL_STR_ROW
+#define FC_SQL_STR_ROW16        FC_SQL_STR_ROW4 "," FC_SQL_STR_ROW4 "," FC_SQL_STR_ROW4 "," FC_SQL_STR_ROW4
+#define FC_SQL_STR_INSERT1      "INSERT INTO str (id, cbu, cbj, sz) VALUES " FC_SQL_STR_ROW ";"
+#define FC_SQL_STR_INSERTN      "INSERT INTO str (id, cbu, cbj, sz) VALUES " FC_SQL_STR_ROW16 "," FC_SQL_STR_ROW16 ";"
+
+#if FC_SQL_STR_BULK_ROWS != 32
+#error "FC_SQL_STR_INSERTN must match FC_SQL_STR_BULK_ROWS"
+#endif
+
+/*
+* Insert pending 'str' table rows of a connection. A full batch is inserted by
+* a single multi-row insert statement, a partial batch row-by-row.
+* -- hSql
+* -- pc
+*/
+VOID Fc_SqlStrFlush(_In_ sqlite3 *hSql, _In_ PFCSQL_CONNECTION pc)
+{
+    DWORD i, iBind = 1;
+    sqlite3_stmt *hStmt;
+    PFCSQL_STR_BULK_ENTRY pe;
+    if(!pc->cStr) { return; }
+    if((pc->cStr == FC_SQL_STR_BULK_ROWS) && (hStmt = Fc_SqlPrepareCached(hSql, FC_SQL_STR_INSERTN))) {
+        for(i = 0; i < pc->cStr; i++) {
+            pe = &pc->Str[i];
+            sqlite3_bind_int64(hStmt, iBind++, pe->id);
+            sqlite3_bind_int(hStmt, iBind++, pe->cbu);
+            sqlite3_bind_int(hStmt, iBind++, pe->cbj);
+            sqlite3_bind_text(hStmt, iBind++, (LPSTR)pc->pbStr + pe->oText, pe->cbu, NULL);
+        }
+        sqlite3_step(hStmt);
+        sqlite3_reset(hStmt);
+    } else if((hStmt = Fc_SqlPrepareCached(hSql, FC_SQL_STR_INSERT1))) {
+        for(i = 0; i < pc->cStr; i++) {
+            pe = &pc->Str[i];
+            sqlite3_reset(hStmt);
+            sqlite3_bind_int64(hStmt, 1, pe->id);
+            sqlite3_bind_int(hStmt, 2, pe->cbu);
+            sqlite3_bind_int(hStmt, 3, pe->cbj);
+            sqlite3_bind_text(hStmt, 4, (LPSTR)pc->pbStr + pe->oText, pe->cbu, NULL);
+            sqlite3_step(hStmt);
+        }
+        sqlite3_reset(hStmt);
+    }
+    InterlockedAdd64(&ctxFc->db.cInsertRow, pc->cStr);
+    pc->cStr = 0;
+    pc->cbStr = 0;
+}
+
+/*
+* Commit the current bulk transaction and start a new one if the transaction
+* row or byte budget is exceeded.
+* -- hSql
+* -- pc
+*/
+VOID Fc_SqlTransactionBudget(_In_ sqlite3 *hSql, _In_ PFCSQL_CONNECTION pc)
+{
+    sqlite3_stmt *hStmt = NULL;
+    if((pc->cTransactionRow < FC_SQL_TRANSACTION_ROWS_MAX) && (pc->cbTransaction < FC_SQL_TRANSACTION_BYTES_MAX)) { return; }
+    Fc_SqlStrFlush(hSql, pc);
+    // COMMIT fails with pending write statements - reset unfinished writes only;
+    // pending reads (e.g. a SELECT being iterated by the caller) do not block
+    // COMMIT and are left untouched.
+    while((hStmt = sqlite3_next_stmt(hSql, hStmt))) {
+        if(sqlite3_stmt_busy(hStmt) && !sqlite3_stmt_readonly(hStmt)) { sqlite3_reset(hStmt); }
+    }
+    sqlite3_exec(hSql, "COMMIT TRANSACTION; BEGIN TRANSACTION;", NULL, NULL, NULL);
+    pc->cTransactionRow = 0;
+    pc->cbTransaction = 0;
+}
+
+VOID Fc_SqlTransactionBegin(_In_ sqlite3 *hSql)
+{
+    PFCSQL_CONNECTION pc = Fc_SqlConnection(hSql);
+    sqlite3_exec(hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
+    if(!pc) { return; }
+    if(!pc->pbStr) {
+        pc->pbStr = LocalAlloc(0, FC_SQL_STR_BULK_BUFFER);
+    }
+    pc->fTransaction = (pc->pbStr != NULL);
+    pc->cTransactionRow = 0;
+    pc->cbTransaction = 0;
+}
+
+VOID Fc_SqlTransactionCommit(_In_ sqlite3 *hSql)
+{
+    PFCSQL_CONNECTION pc = Fc_SqlConnection(hSql);
+    if(pc) {
+        Fc_SqlStrFlush(hSql, pc);
+        pc->fTransaction = FALSE;
+    }
+    sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+}
+
+int Fc_SqlInsertStep(_In_ sqlite3 *hSql, _In_ sqlite3_stmt *hStmt)
+{
+    int rc = sqlite3_step(hStmt);
+    PFCSQL_CONNECTION pc = Fc_SqlConnection(hSql);
+    if(pc && pc->fTransaction) {
+        InterlockedIncrement64(&ctxFc->db.cInsertRow);
+        pc->cTransactionRow++;
+        pc->cbTransaction += 0x40;
+        Fc_SqlTransactionBudget(hSql, pc);
+    }
+    return rc;
+}
+
 _Success_(return)
-BOOL Fc_SqlInsertStr(_In_ sqlite3_stmt *hStmt, _In_ LPSTR usz, _Out_ PFCSQL_INSERTSTRTABLE pThis)
+BOOL Fc_SqlInsertStr(_In_ sqlite3 *hSql, _In_ LPSTR usz, _Out_ PFCSQL_INSERTSTRTABLE pThis)
 {
+    sqlite3_stmt *hStmt;
+    PFCSQL_STR_BULK_ENTRY pe;
+    PFCSQL_CONNECTION pc = Fc_SqlConnection(hSql);
+    if(!pc) { return FALSE; }
     if(!CharUtil_UtoU(usz, -1, NULL, 0, NULL, &pThis->cbu, 0)) { return FALSE; }
     pThis->cbu--;               // don't count null terminator.
     CharUtil_UtoJ(usz, -1, NULL, 0, NULL, &pThis->cbj, 0);   // # of bytes to represent JSON string (incl. null-terminator)
     if(pThis->cbj) { pThis->cbj--; }
     pThis->id = InterlockedIncrement64(&ctxFc->db.qwIdStr);
-    sqlite3_reset(hStmt);
+    // bulk transaction: buffer row for multi-row insert.
+    if(pc->fTransaction && (pThis->cbu < FC_SQL_STR_BULK_BUFFER / FC_SQL_STR_BULK_ROWS)) {
+        if(pc->cbStr + pThis->cbu > FC_SQL_STR_BULK_BUFFER) {
+            Fc_SqlStrFlush(hSql, pc);
+        }
+        pe = &pc->Str[pc->cStr++];
+        pe->id = pThis->id;
+        pe->cbu = pThis->cbu;
+        pe->cbj = pThis->cbj;
+        pe->oText = pc->cbStr;
+        memcpy(pc->pbStr + pc->cbStr, usz, pThis->cbu);
+        pc->cbStr += pThis->cbu;
+        pc->cTransactionRow++;
+        pc->cbTransaction += 0x20ULL + pThis->cbu;
+        if(pc->cStr == FC_SQL_STR_BULK_ROWS) {
+            Fc_SqlStrFlush(hSql, pc);
+            Fc_SqlTransactionBudget(hSql, pc);
+        }
+        return TRUE;
+    }
+    // single row insert:
+    if(!(hStmt = Fc_SqlPrepareCached(hSql, FC_SQL_STR_INSERT1))) { return FALSE; }
     sqlite3_bind_int64(hStmt, 1, pThis->id);
     sqlite3_bind_int(hStmt, 2, pThis->cbu);
     sqlite3_bind_int(hStmt, 3, pThis->cbj);
     sqlite3_bind_text(hStmt, 4, usz, -1, NULL);
     sqlite3_step(hStmt);
+    sqlite3_reset(hStmt);
     return TRUE;
 }
 
@@ -202,7 +441,6 @@ typedef struct tdFCTIMELINE_PLUGIN_CONTEXT {
     DWORD dwId;
     sqlite3 *hSql;
     sqlite3_stmt *hStmt;
-    sqlite3_stmt *hStmtStr;
 } FCTIMELINE_PLUGIN_CONTEXT, *PFCTIMELINE_PLUGIN_CONTEXT;
 
 /*
@@ -219,7 +457,7 @@ VOID FcTimeline_Callback_PluginEntryAdd(_In_ HANDLE hTimeline, _In_ QWORD ft, _I
     PFCTIMELINE_PLUGIN_CONTEXT ctx = (PFCTIMELINE_PLUGIN_CONTEXT)hTimeline;
     FCSQL_INSERTSTRTABLE SqlStrInsert;
     // build and insert string data into 'str' table.
-    if(!Fc_SqlInsertStr(ctx->hStmtStr, uszText, &SqlStrInsert)) { return; }
+    if(!Fc_SqlInsertStr(ctx->hSql, uszText, &SqlStrInsert)) { return; }
     // insert into 'timeline_data' table.
     sqlite3_reset(ctx->hStmt);
     Fc_SqlBindMultiInt64(ctx->hStmt, 1, 7,
@@ -231,7 +469,7 @@ VOID FcTimeline_Callback_PluginEntryAdd(_In_ HANDLE hTimeline, _In_ QWORD ft, _I
         (QWORD)dwData32,
         qwData64
     );
-    sqlite3_step(ctx->hStmt);
+    Fc_SqlInsertStep(ctx->hSql, ctx->hStmt);
 }
 
 /*
@@ -246,6 +484,7 @@ VOID FcTimeline_Callback_PluginEntryAddBySQL(_In_ HANDLE hTimeline, _In_ DWORD c
     DWORD i;
     CHAR szSql[2048];
     PFCTIMELINE_PLUGIN_CONTEXT ctx = (PFCTIMELINE_PLUGIN_CONTEXT)hTimeline;
+    sqlite3_reset(ctx->hStmt);
     for(i = 0; i < cEntrySql; i++) {
         ZeroMemory(szSql, sizeof(szSql));
         snprintf(szSql, sizeof(szSql), "INSERT INTO timeline_data(tp, id_str, ft, ac, pid, data32, data64) SELECT %i, %s;", ctx->dwId, pszEntrySql[i]);
@@ -263,9 +502,7 @@ VOID FcTimeline_Callback_PluginEntryAddBySQL(_In_ HANDLE hTimeline, _In_ DWORD c
 VOID FcTimeline_Callback_PluginClose(_In_ HANDLE hTimeline)
 {
     PFCTIMELINE_PLUGIN_CONTEXT ctxPlugin = (PFCTIMELINE_PLUGIN_CONTEXT)hTimeline;
-    sqlite3_exec(ctxPlugin->hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
-    sqlite3_finalize(ctxPlugin->hStmtStr);
-    sqlite3_finalize(ctxPlugin->hStmt);
+    Fc_SqlTransactionCommit(ctxPlugin->hSql);
     Fc_SqlReserveReturn(ctxPlugin->hSql);
 }
 
@@ -282,20 +519,20 @@ HANDLE FcTimeline_Callback_PluginRegister(_In_reads_(6) LPSTR sNameShort, _In_re
     sqlite3_stmt *hStmt = NULL;
     PFCTIMELINE_PLUGIN_CONTEXT ctxPlugin = NULL;
     if(!(hSql = Fc_SqlReserve())) { goto fail; }
-    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO timeline_info (short_name, file_name_u, file_name_j) VALUES (?, ?, '');", -1, &hStmt, 0)) { goto fail; }
+    if(!(hStmt = Fc_SqlPrepareCached(hSql, "INSERT INTO timeline_info (short_name, file_name_u, file_name_j) VALUES (?, ?, '');"))) { goto fail; }
     if(SQLITE_OK != sqlite3_bind_text(hStmt, 1, sNameShort, 6, NULL)) { goto fail; }
     if(SQLITE_OK != sqlite3_bind_text(hStmt, 2, szFileUTF8, -1, NULL)) { goto fail; }
     if(SQLITE_DONE != sqlite3_step(hStmt)) { goto fail; }
+    sqlite3_reset(hStmt);
     hSql = Fc_SqlReserveReturn(hSql);
     Fc_SqlQueryN("SELECT MAX(id) FROM timeline_info;", 0, NULL, 1, &v, NULL);
     if(!(ctxPlugin = LocalAlloc(LMEM_ZEROINIT, sizeof(FCTIMELINE_PLUGIN_CONTEXT)))) { goto fail; }
     ctxPlugin->dwId = (DWORD)v;
     ctxPlugin->hSql = Fc_SqlReserve();
-    sqlite3_prepare_v2(ctxPlugin->hSql, "INSERT INTO timeline_data (id_str, tp, ft, ac, pid, data32, data64) VALUES (?, ?, ?, ?, ?, ?, ?);", -1, &ctxPlugin->hStmt, NULL);
-    sqlite3_prepare_v2(ctxPlugin->hSql, "INSERT INTO str (id, cbu, cbj, sz) VALUES (?, ?, ?, ?);", -1, &ctxPlugin->hStmtStr, NULL);
-    sqlite3_exec(ctxPlugin->hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
+    ctxPlugin->hStmt = Fc_SqlPrepareCached(ctxPlugin->hSql, "INSERT INTO timeline_data (id_str, tp, ft, ac, pid, data32, data64) VALUES (?, ?, ?, ?, ?, ?, ?);");
+    Fc_SqlTransactionBegin(ctxPlugin->hSql);
 fail:
-    sqlite3_finalize(hStmt);
+    if(hSql && hStmt) { sqlite3_reset(hStmt); }
     if(ctxPlugin) {
         return (HANDLE)ctxPlugin;
     }
@@ -303,6 +540,608 @@ fail:
     return NULL;
 }
 
+#define FCTIMELINE_SORT_RUN_ENTRIES         0x00100000  // max entries per in-memory sort run (~64MB)
+#define FCTIMELINE_SORT_MERGE_ENTRIES       0x00001000  // entries buffered per run during merge
+
+typedef struct tdFCTIMELINE_SORT_ENTRY {
+    QWORD ft;
+    QWORD id;                   // timeline_data id (tie-break sort key)
+    QWORD id_str;
+    QWORD data64;
+    QWORD oStr;                 // offset of text in timeline index string pool
+    DWORD tp;
+    DWORD ac;
+    DWORD pid;
+    DWORD data32;
+    DWORD cbu;
+    DWORD cbj;
+} FCTIMELINE_SORT_ENTRY, *PFCTIMELINE_SORT_ENTRY;
+
+typedef struct tdFCTIMELINE_SORT_RUN {
+    FILE *hFile;
+    QWORD cRemaining;           // entries remaining in file
+    BOOL fError;                // read of file failed - run is incomplete
+    DWORD cBuffer;
+    DWORD iBuffer;
+    FCTIMELINE_SORT_ENTRY Buffer[FCTIMELINE_SORT_MERGE_ENTRIES];
+} FCTIMELINE_SORT_RUN, *PFCTIMELINE_SORT_RUN;
+
+typedef struct tdFCTIMELINE_SORT_CONTEXT {
+    sqlite3 *hSql;
+    sqlite3_stmt *hStmt;
+    DWORD cTp;
+    PQWORD pcTpId;              // per-type running count (tp_id)
+    PQWORD pcbTpU;              // per-type running utf-8 offset (oln_utp)
+    QWORD cId;
+    QWORD cbU;                  // running utf-8 offset (oln_u)
+    QWORD cbJ;                  // running json offset (oln_j)
+    struct {
+        BOOL fFail;             // index build failed - timeline works from database only
+        FILE *hFile;            // index file (header + records written in merge pass)
+        FILE *hFileStr;         // temporary string pool
+        QWORD cbStr;
+        FILE **phFileTp;        // temporary per-type record index arrays
+    } Index;
+    DWORD cRun;
+    PFCTIMELINE_SORT_RUN pRuns[0x1000];
+} FCTIMELINE_SORT_CONTEXT, *PFCTIMELINE_SORT_CONTEXT;
+
+/*
+* Timeline sort order: time descending, timeline_data id ascending.
+*/
+int FcTimeline_Sort_CmpSort(_In_ PFCTIMELINE_SORT_ENTRY a, _In_ PFCTIMELINE_SORT_ENTRY b)
+{
+    if(a->ft != b->ft) { return ((LONGLONG)a->ft < (LONGLONG)b->ft) ? 1 : -1; }
+    if(a->id != b->id) { return (a->id < b->id) ? -1 : 1; }
+    return 0;
+}
+
+/*
+* Create a temporary file for a spilled sort run. The file is deleted when closed.
+* -- return
+*/
+FILE* FcTimeline_Sort_TempFile()
+{
+#ifdef _WIN32
+    FILE *hFile = NULL;
+    CHAR szPath[MAX_PATH], szFile[MAX_PATH];
+    if(!GetTempPathA(MAX_PATH, szPath) || !GetTempFileNameA(szPath, "vmm", 0, szFile)) { return NULL; }
+    if(fopen_s(&hFile, szFile, "w+bD")) { return NULL; }
+    return hFile;
+#endif /* _WIN32 */
+#ifdef LINUX
+    return tmpfile();
+#endif /* LINUX */
+}
+
+/*
+* Sort an in-memory run and spill it to a temporary file.
+* -- ctx
+* -- pe
+* -- cEntry
+* -- return
+*/
+_Success_(return)
+BOOL FcTimeline_Sort_RunSpill(_In_ PFCTIMELINE_SORT_CONTEXT ctx, _In_reads_(cEntry) PFCTIMELINE_SORT_ENTRY pe, _In_ DWORD cEntry)
+{
+    PFCTIMELINE_SORT_RUN pRun;
+    if(ctx->cRun >= _countof(ctx->pRuns)) { return FALSE; }
+    if(!(pRun = LocalAlloc(LMEM_ZEROINIT, sizeof(FCTIMELINE_SORT_RUN)))) { return FALSE; }
+    ctx->pRuns[ctx->cRun++] = pRun;
+    if(!(pRun->hFile = FcTimeline_Sort_TempFile())) { return FALSE; }
+    qsort(pe, cEntry, sizeof(FCTIMELINE_SORT_ENTRY), (_CoreCrtNonSecureSearchSortCompareFunction)FcTimeline_Sort_CmpSort);
+    if(cEntry != fwrite(pe, sizeof(FCTIMELINE_SORT_ENTRY), cEntry, pRun->hFile)) { return FALSE; }
+    if(fflush(pRun->hFile)) { return FALSE; }
+    rewind(pRun->hFile);
+    pRun->cRemaining = cEntry;
+    return TRUE;
+}
+
+/*
+* Retrieve the current entry of a spilled sort run - refilling the run buffer
+* from file if required.
+* -- pRun
+* -- return = the current entry or NULL if the run is exhausted (or on read
+*    error in which case pRun->fError is set).
+*/
+PFCTIMELINE_SORT_ENTRY FcTimeline_Sort_RunPeek(_In_ PFCTIMELINE_SORT_RUN pRun)
+{
+    DWORD cRead;
+    if(pRun->iBuffer < pRun->cBuffer) {
+        return &pRun->Buffer[pRun->iBuffer];
+    }
+    if(!pRun->cRemaining) { return NULL; }
+    cRead = (DWORD)min(FCTIMELINE_SORT_MERGE_ENTRIES, pRun->cRemaining);
+    if(cRead != fread(pRun->Buffer, sizeof(FCTIMELINE_SORT_ENTRY), cRead, pRun->hFile)) {
+        pRun->cRemaining = 0;
+        pRun->fError = TRUE;
+        return NULL;
+    }
+    pRun->cRemaining -= cRead;
+    pRun->cBuffer = cRead;
+    pRun->iBuffer = 0;
+    return &pRun->Buffer[0];
+}
+
+/*
+* Create the file that will hold the memory-mapped timeline index.
+* -- szPath = buffer to receive the file path.
+* -- return
+*/
+FILE* FcTimeline_Index_CreateFile(_Out_writes_(MAX_PATH) LPSTR szPath)
+{
+    FILE *hFile = NULL;
+    if(ctxFc->Cache.fEnabled) {
+        // persisted forensic database cache -> index is kept alongside the database.
+        _snprintf_s(szPath, MAX_PATH, _TRUNCATE, "%s.timeline", ctxFc->Cache.uszPathBase);
+        ctxFc->Timeline.Index.fKeep = TRUE;
+        return fopen_s(&hFile, szPath, "w+b") ? NULL : hFile;
+    }
+#ifdef _WIN32
+    CHAR szTempPath[MAX_PATH];
+    if(!GetTempPathA(MAX_PATH, szTempPath) || !GetTempFileNameA(szTempPath, "vmm", 0, szPath)) { return NULL; }
+    if(fopen_s(&hFile, szPath, "w+b")) {
+        DeleteFileA(szPath);
+        return NULL;
+    }
+#endif /* _WIN32 */
+#ifdef LINUX
+    int fd;
+    LPSTR szTempDir = getenv("TMPDIR");
+    if(!szTempDir || !szTempDir[0]) { szTempDir = "/tmp"; }
+    if(MAX_PATH <= snprintf(szPath, MAX_PATH, "%s/vmm-timeline-XXXXXX", szTempDir)) { return NULL; }
+    if(-1 == (fd = mkstemp(szPath))) { return NULL; }
+    if(!(hFile = fdopen(fd, "w+b"))) {
+        close(fd);
+        unlink(szPath);
+        return NULL;
+    }
+#endif /* LINUX */
+    return hFile;
+}
+
+/*
+* Start building the timeline index: create the string pool, the per-type
+* record index arrays and the index file with space reserved for its header.
+* -- ctx
+* -- return
+*/
+_Success_(return)
+BOOL FcTimeline_Index_Begin(_In_ PFCTIMELINE_SORT_CONTEXT ctx)
+{
+    DWORD i;
+    BYTE pbZero[0x100] = { 0 };
+    QWORD cbHdr = sizeof(FC_TIMELINE_INDEX_HEADER) + ctx->cTp * sizeof(((PFC_TIMELINE_INDEX_HEADER)0)->Tp[0]);
+    if(!(ctx->Index.hFileStr = FcTimeline_Sort_TempFile())) { return FALSE; }
+    if(!(ctx->Index.phFileTp = LocalAlloc(LMEM_ZEROINIT, ctx->cTp * sizeof(FILE*)))) { return FALSE; }
+    for(i = 1; i < ctx->cTp; i++) {
+        if(!(ctx->Index.phFileTp[i] = FcTimeline_Sort_TempFile())) { return FALSE; }
+    }
+    if(!(ctx->Index.hFile = FcTimeline_Index_CreateFile(ctxFc->Timeline.Index.szPath))) { return FALSE; }
+    while(cbHdr) {
+        if(1 != fwrite(pbZero, (SIZE_T)min(cbHdr, sizeof(pbZero)), 1, ctx->Index.hFile)) { return FALSE; }
+        cbHdr -= min(cbHdr, sizeof(pbZero));
+    }
+    return TRUE;
+}
+
+/*
+* Append the text of a source timeline row to the index string pool.
+* -- ctx
+* -- pe
+* -- usz
+*/
+VOID FcTimeline_Index_AddStr(_In_ PFCTIMELINE_SORT_CONTEXT ctx, _Inout_ PFCTIMELINE_SORT_ENTRY pe, _In_opt_ LPCSTR usz)
+{
+    pe->oStr = ctx->Index.cbStr;
+    if(!usz || (pe->cbu != strlen(usz)) || (1 != fwrite(usz, pe->cbu + 1ULL, 1, ctx->Index.hFileStr))) {
+        ctx->Index.fFail = TRUE;
+        return;
+    }
+    ctx->Index.cbStr += pe->cbu + 1ULL;
+}
+
+/*
+* Write an index record of an entry in final timeline order.
+* -- ctx
+* -- pe
+*/
+VOID FcTimeline_Index_Emit(_In_ PFCTIMELINE_SORT_CONTEXT ctx, _In_ PFCTIMELINE_SORT_ENTRY pe)
+{
+    DWORD iRecord = (DWORD)(ctx->cId - 1);
+    FC_TIMELINE_INDEX_RECORD r = { 0 };
+    r.ft = pe->ft;
+    r.data64 = pe->data64;
+    r.oStr = pe->oStr;
+    r.oLnU = ctx->cbU;
+    r.oLnUtp = ctx->pcbTpU[pe->tp];
+    r.tp = pe->tp;
+    r.ac = pe->ac;
+    r.pid = pe->pid;
+    r.data32 = pe->data32;
+    r.cbu = pe->cbu;
+    if((ctx->cId > 0xffffffff) || !pe->tp ||
+        (1 != fwrite(&r, sizeof(FC_TIMELINE_INDEX_RECORD), 1, ctx->Index.hFile)) ||
+        (1 != fwrite(&iRecord, sizeof(DWORD), 1, ctx->Index.phFileTp[pe->tp]))
+    ) {
+        ctx->Index.fFail = TRUE;
+    }
+}
+
+/*
+* Append a temporary file to the index file.
+* -- hFileDst
+* -- hFileSrc
+* -- pbBuffer = 0x00100000 bytes buffer.
+* -- return
+*/
+_Success_(return)
+BOOL FcTimeline_Index_AppendFile(_In_ FILE *hFileDst, _In_ FILE *hFileSrc, _Inout_ PBYTE pbBuffer)
+{
+    SIZE_T cb;
+    if(fflush(hFileSrc)) { return FALSE; }
+    rewind(hFileSrc);
+    while((cb = fread(pbBuffer, 1, 0x00100000, hFileSrc))) {
+        if(cb != fwrite(pbBuffer, 1, cb, hFileDst)) { return FALSE; }
+    }
+    return !ferror(hFileSrc);
+}
+
+/*
+* Unmap and delete the memory-mapped timeline index.
+*/
+VOID FcTimeline_Index_Close()
+{
+#ifdef _WIN32
+    if(ctxFc->Timeline.Index.pHdr) { UnmapViewOfFile(ctxFc->Timeline.Index.pHdr); }
+    if(ctxFc->Timeline.Index.hMap) { CloseHandle(ctxFc->Timeline.Index.hMap); }
+    if(ctxFc->Timeline.Index.hFile) { CloseHandle(ctxFc->Timeline.Index.hFile); }
+    ctxFc->Timeline.Index.hMap = NULL;
+    ctxFc->Timeline.Index.hFile = NULL;
+    if(ctxFc->Timeline.Index.szPath[0] && !ctxFc->Timeline.Index.fKeep) { DeleteFileA(ctxFc->Timeline.Index.szPath); }
+#endif /* _WIN32 */
+#ifdef LINUX
+    if(ctxFc->Timeline.Index.pHdr) { munmap(ctxFc->Timeline.Index.pHdr, ctxFc->Timeline.Index.cb); }
+    if(ctxFc->Timeline.Index.szPath[0] && !ctxFc->Timeline.Index.fKeep) { unlink(ctxFc->Timeline.Index.szPath); }
+#endif /* LINUX */
+    ctxFc->Timeline.Index.pHdr = NULL;
+    ctxFc->Timeline.Index.cb = 0;
+    ctxFc->Timeline.Index.szPath[0] = 0;
+}
+
+/*
+* Memory-map the finished timeline index file.
+* -- return
+*/
+_Success_(return)
+BOOL FcTimeline_Index_Map()
+{
+    PFC_TIMELINE_INDEX_HEADER pHdr = NULL;
+    QWORD cb = 0;
+#ifdef _WIN32
+    LARGE_INTEGER li;
+    ctxFc->Timeline.Index.hFile = CreateFileA(ctxFc->Timeline.Index.szPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(ctxFc->Timeline.Index.hFile == INVALID_HANDLE_VALUE) {
+        ctxFc->Timeline.Index.hFile = NULL;
+        goto fail;
+    }
+    if(!GetFileSizeEx(ctxFc->Timeline.Index.hFile, &li) || ((QWORD)li.QuadPart > (SIZE_T)-1)) { goto fail; }
+    cb = li.QuadPart;
+    if(!(ctxFc->Timeline.Index.hMap = CreateFileMappingA(ctxFc->Timeline.Index.hFile, NULL, PAGE_READONLY, 0, 0, NULL))) { goto fail; }
+    if(!(pHdr = MapViewOfFile(ctxFc->Timeline.Index.hMap, FILE_MAP_READ, 0, 0, 0))) { goto fail; }
+#endif /* _WIN32 */
+#ifdef LINUX
+    int fd;
+    PVOID pv;
+    if(-1 == (fd = open(ctxFc->Timeline.Index.szPath, O_RDONLY))) { goto fail; }
+    cb = lseek(fd, 0, SEEK_END);
+    pv = ((cb > 0) && (cb != (QWORD)-1)) ? mmap(NULL, cb, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if(!ctxFc->Timeline.Index.fKeep) {
+        unlink(ctxFc->Timeline.Index.szPath);   // file is kept alive by the mapping.
+        ctxFc->Timeline.Index.szPath[0] = 0;
+    }
+    if(pv == MAP_FAILED) { goto fail; }
+    pHdr = (PFC_TIMELINE_INDEX_HEADER)pv;
+#endif /* LINUX */
+    ctxFc->Timeline.Index.cb = cb;
+    ctxFc->Timeline.Index.pHdr = pHdr;
+    if((cb < sizeof(FC_TIMELINE_INDEX_HEADER)) || (pHdr->qwMagic != FC_TIMELINE_INDEX_MAGIC) || (pHdr->cbFile != cb)) { goto fail; }
+    if((pHdr->oRecord + pHdr->cRecord * sizeof(FC_TIMELINE_INDEX_RECORD) > cb) || (pHdr->oStr + pHdr->cbStr > cb)) { goto fail; }
+    return TRUE;
+fail:
+    FcTimeline_Index_Close();
+    return FALSE;
+}
+
+/*
+* Finish the timeline index: append the per-type record indexes and the
+* string pool, write the header and memory-map the index file.
+* -- ctx
+* -- return
+*/
+_Success_(return)
+BOOL FcTimeline_Index_Finish(_In_ PFCTIMELINE_SORT_CONTEXT ctx)
+{
+    BOOL fResult = FALSE;
+    DWORD i;
+    PBYTE pbBuffer = NULL;
+    QWORD cbHdr = sizeof(FC_TIMELINE_INDEX_HEADER) + ctx->cTp * sizeof(((PFC_TIMELINE_INDEX_HEADER)0)->Tp[0]);
+    PFC_TIMELINE_INDEX_HEADER pHdr = NULL;
+    if(ctx->Index.fFail || !ctx->Index.hFile) { goto fail; }
+    if(!(pHdr = LocalAlloc(LMEM_ZEROINIT, (SIZE_T)cbHdr))) { goto fail; }
+    if(!(pbBuffer = LocalAlloc(0, 0x00100000))) { goto fail; }
+    pHdr->qwMagic = FC_TIMELINE_INDEX_MAGIC;
+    pHdr->dwVersion = FC_TIMELINE_INDEX_VERSION;
+    pHdr->cTp = ctx->cTp;
+    pHdr->cRecord = ctx->cId;
+    pHdr->oRecord = cbHdr;
+    pHdr->cbFile = cbHdr + ctx->cId * sizeof(FC_TIMELINE_INDEX_RECORD);
+    for(i = 1; i < ctx->cTp; i++) {
+        pHdr->Tp[i].o = pHdr->cbFile;
+        pHdr->Tp[i].c = ctx->pcTpId[i];
+        pHdr->cbFile += ctx->pcTpId[i] * sizeof(DWORD);
+        if(!FcTimeline_Index_AppendFile(ctx->Index.hFile, ctx->Index.phFileTp[i], pbBuffer)) { goto fail; }
+    }
+    for(; pHdr->cbFile % 8; pHdr->cbFile++) {
+        if(EOF == fputc(0, ctx->Index.hFile)) { goto fail; }
+    }
+    pHdr->oStr = pHdr->cbFile;
+    pHdr->cbStr = ctx->Index.cbStr;
+    pHdr->cbFile += ctx->Index.cbStr;
+    if(!FcTimeline_Index_AppendFile(ctx->Index.hFile, ctx->Index.hFileStr, pbBuffer)) { goto fail; }
+    rewind(ctx->Index.hFile);
+    if(1 != fwrite(pHdr, (SIZE_T)cbHdr, 1, ctx->Index.hFile)) { goto fail; }
+    if(fclose(ctx->Index.hFile)) {
+        ctx->Index.hFile = NULL;
+        goto fail;
+    }
+    ctx->Index.hFile = NULL;
+    fResult = FcTimeline_Index_Map();
+fail:
+    LocalFree(pbBuffer);
+    LocalFree(pHdr);
+    return fResult;
+}
+
+/*
+* Write a single entry in final timeline order to the 'timeline' table.
+* File offsets, per-type ids and per-type offsets are computed in-pass.
+* -- ctx
+* -- pe
+*/
+VOID FcTimeline_Sort_Emit(_In_ PFCTIMELINE_SORT_CONTEXT ctx, _In_ PFCTIMELINE_SORT_ENTRY pe)
+{
+    QWORD cbU = pe->cbu + FC_LINELENGTH_TIMELINE_UTF8;
+    QWORD cbJ = pe->cbj + FC_LINELENGTH_TIMELINE_JSON;
+    if(pe->tp >= ctx->cTp) { return; }
+    ctx->pcTpId[pe->tp]++;
+    ctx->cId++;
+    sqlite3_reset(ctx->hStmt);
+    Fc_SqlBindMultiInt64(ctx->hStmt, 1, 12,
+        ctx->cId,
+        (QWORD)pe->tp,
+        ctx->pcTpId[pe->tp],
+        pe->id_str,
+        pe->ft,
+        (QWORD)pe->ac,
+        (QWORD)pe->pid,
+        (QWORD)pe->data32,
+        pe->data64,
+        ctx->cbU,
+        ctx->cbJ,
+        ctx->pcbTpU[pe->tp]
+    );
+    Fc_SqlInsertStep(ctx->hSql, ctx->hStmt);
+    if(!ctx->Index.fFail) {
+        FcTimeline_Index_Emit(ctx, pe);
+    }
+    ctx->cbU += cbU;
+    ctx->cbJ += cbJ;
+    ctx->pcbTpU[pe->tp] += cbU;
+}
+
+/*
+* Sift down a heap of sort runs ordered by their current entry.
+*/
+VOID FcTimeline_Sort_HeapDown(_Inout_ PFCTIMELINE_SORT_RUN *pHeap, _In_ DWORD cHeap, _In_ DWORD i)
+{
+    DWORD iMin, iChild;
+    PFCTIMELINE_SORT_RUN pTmp;
+    while(TRUE) {
+        iMin = i;
+        for(iChild = 2 * i + 1; (iChild <= 2 * i + 2) && (iChild < cHeap); iChild++) {
+            if(FcTimeline_Sort_CmpSort(FcTimeline_Sort_RunPeek(pHeap[iChild]), FcTimeline_Sort_RunPeek(pHeap[iMin])) < 0) {
+                iMin = iChild;
+            }
+        }
+        if(iMin == i) { return; }
+        pTmp = pHeap[i]; pHeap[i] = pHeap[iMin]; pHeap[iMin] = pTmp;
+        i = iMin;
+    }
+}
+
+/*
+* Build the unified 'timeline' table from the 'timeline_data' table natively.
+* Rows are streamed from the database into bounded memory sort runs, which are
+* spilled to temporary files if the timeline does not fit into a single run,
+* and k-way merged by time. The final timeline rows are bulk-inserted in sorted
+* order with tp_id and utf-8/json line offsets computed in the same pass. This
+* replaces a much slower INSERT .. SELECT with SUM() OVER window functions and
+* produces identical table contents. The in-memory run is sized by the number
+* of timeline_data rows - only large timelines use the full run size.
+* -- return
+*/
+_Success_(return)
+BOOL FcTimeline_Sort_Build()
+{
+    BOOL fResult = FALSE, fReadError = FALSE;
+    DWORD i, cEntry = 0, cEntryMax, cHeap = 0;
+    QWORD v = 0;
+    PFCTIMELINE_SORT_ENTRY pe, pEntries = NULL;
+    PFCTIMELINE_SORT_CONTEXT ctx = NULL;
+    PFCTIMELINE_SORT_RUN pRun;
+    sqlite3_stmt *hStmt;
+    CHAR szSql[0x100];
+    if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(FCTIMELINE_SORT_CONTEXT)))) { goto fail; }
+    if(SQLITE_OK != Fc_SqlQueryN("SELECT COUNT(*) FROM timeline_data;", 0, NULL, 1, &v, NULL)) { goto fail; }
+    cEntryMax = (DWORD)max(1, min(FCTIMELINE_SORT_RUN_ENTRIES, v));
+    if(!(pEntries = LocalAlloc(0, cEntryMax * sizeof(FCTIMELINE_SORT_ENTRY)))) { goto fail; }
+    if(SQLITE_OK != Fc_SqlQueryN("SELECT MAX(id) FROM timeline_info;", 0, NULL, 1, &v, NULL)) { goto fail; }
+    ctx->cTp = (DWORD)v + 1;
+    if(!(ctx->pcTpId = LocalAlloc(LMEM_ZEROINIT, ctx->cTp * sizeof(QWORD)))) { goto fail; }
+    if(!(ctx->pcbTpU = LocalAlloc(LMEM_ZEROINIT, ctx->cTp * sizeof(QWORD)))) { goto fail; }
+    ctx->Index.fFail = !FcTimeline_Index_Begin(ctx);
+    if(!(ctx->hSql = Fc_SqlReserve())) { goto fail; }
+    // 1: stream source rows into sort runs - spill full runs to temp files.
+    hStmt = Fc_SqlPrepareCached(ctx->hSql, "SELECT td.id, td.tp, td.id_str, td.ft, td.ac, td.pid, td.data32, td.data64, str.cbu, str.cbj, str.sz FROM timeline_data td, str WHERE str.id = td.id_str;");
+    if(!hStmt) { goto fail; }
+    while(SQLITE_ROW == sqlite3_step(hStmt)) {
+        if(cEntry == cEntryMax) {
+            if(!FcTimeline_Sort_RunSpill(ctx, pEntries, cEntry)) {
+                sqlite3_reset(hStmt);
+                goto fail;
+            }
+            cEntry = 0;
+        }
+        pe = pEntries + cEntry++;
+        pe->id = sqlite3_column_int64(hStmt, 0);
+        pe->tp = sqlite3_column_int(hStmt, 1);
+        pe->id_str = sqlite3_column_int64(hStmt, 2);
+        pe->ft = sqlite3_column_int64(hStmt, 3);
+        pe->ac = sqlite3_column_int(hStmt, 4);
+        pe->pid = sqlite3_column_int(hStmt, 5);
+        pe->data32 = sqlite3_column_int(hStmt, 6);
+        pe->data64 = sqlite3_column_int64(hStmt, 7);
+        pe->cbu = sqlite3_column_int(hStmt, 8);
+        pe->cbj = sqlite3_column_int(hStmt, 9);
+        if(!ctx->Index.fFail) {
+            FcTimeline_Index_AddStr(ctx, pe, (LPCSTR)sqlite3_column_text(hStmt, 10));
+        }
+    }
+    sqlite3_reset(hStmt);
+    if(ctx->cRun && cEntry) {
+        if(!FcTimeline_Sort_RunSpill(ctx, pEntries, cEntry)) { goto fail; }
+        cEntry = 0;
+    }
+    // 2: merge sorted runs (or the single in-memory run) into the timeline table.
+    if(!(ctx->hStmt = Fc_SqlPrepareCached(ctx->hSql, "INSERT INTO timeline (id, tp, tp_id, id_str, ft, ac, pid, data32, data64, oln_u, oln_j, oln_utp) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);"))) { goto fail; }
+    Fc_SqlTransactionBegin(ctx->hSql);
+    if(!ctx->cRun) {
+        qsort(pEntries, cEntry, sizeof(FCTIMELINE_SORT_ENTRY), (_CoreCrtNonSecureSearchSortCompareFunction)FcTimeline_Sort_CmpSort);
+        for(i = 0; i < cEntry; i++) {
+            FcTimeline_Sort_Emit(ctx, pEntries + i);
+        }
+    } else {
+        VmmLog(MID_FORENSIC, LOGLEVEL_DEBUG, "TIMELINE: k-way merge of %i sorted runs\n", ctx->cRun);
+        for(i = 0; i < ctx->cRun; i++) {
+            if(FcTimeline_Sort_RunPeek(ctx->pRuns[i])) {
+                ctx->pRuns[cHeap++] = ctx->pRuns[i];
+            } else {
+                fReadError = fReadError || ctx->pRuns[i]->fError;
+                fclose(ctx->pRuns[i]->hFile);
+                LocalFree(ctx->pRuns[i]);
+            }
+        }
+        ctx->cRun = cHeap;
+        for(i = cHeap / 2; i > 0; i--) {
+            FcTimeline_Sort_HeapDown(ctx->pRuns, cHeap, i - 1);
+        }
+        while(cHeap && !fReadError) {
+            pRun = ctx->pRuns[0];
+            FcTimeline_Sort_Emit(ctx, &pRun->Buffer[pRun->iBuffer++]);
+            if(!FcTimeline_Sort_RunPeek(pRun)) {
+                fReadError = pRun->fError;
+                ctx->pRuns[0] = ctx->pRuns[--cHeap];
+                ctx->pRuns[cHeap] = pRun;
+            }
+            FcTimeline_Sort_HeapDown(ctx->pRuns, cHeap, 0);
+        }
+    }
+    Fc_SqlTransactionCommit(ctx->hSql);
+    if(fReadError) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "TIMELINE: read of sorted run failed - timeline incomplete\n");
+        goto fail;
+    }
+    if(!FcTimeline_Index_Finish(ctx)) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_VERBOSE, "TIMELINE: index unavailable - timeline files read from database\n");
+    }
+    // 3: update timeline_info with file sizes computed in the merge pass.
+    _snprintf_s(szSql, sizeof(szSql), _TRUNCATE, "UPDATE timeline_info SET file_size_u = %llu, file_size_j = %llu WHERE id = 0;", ctx->cbU, ctx->cbJ);
+    sqlite3_exec(ctx->hSql, szSql, NULL, NULL, NULL);
+    if((hStmt = Fc_SqlPrepareCached(ctx->hSql, "UPDATE timeline_info SET file_size_u = ? WHERE id = ?;"))) {
+        Fc_SqlTransactionBegin(ctx->hSql);
+        for(i = 1; i < ctx->cTp; i++) {
+            sqlite3_reset(hStmt);
+            Fc_SqlBindMultiInt64(hStmt, 1, 2, ctx->pcbTpU[i], (QWORD)i);
+            sqlite3_step(hStmt);
+        }
+        sqlite3_reset(hStmt);
+        Fc_SqlTransactionCommit(ctx->hSql);
+    }
+    fResult = TRUE;
+fail:
+    Fc_SqlReserveReturn(ctx ? ctx->hSql : NULL);
+    if(ctx) {
+        for(i = 0; i < ctx->cRun; i++) {
+            if(ctx->pRuns[i]->hFile) { fclose(ctx->pRuns[i]->hFile); }
+            LocalFree(ctx->pRuns[i]);
+        }
+        if(ctx->Index.hFile) {
+            fclose(ctx->Index.hFile);
+            FcTimeline_Index_Close();
+        }
+        if(ctx->Index.hFileStr) { fclose(ctx->Index.hFileStr); }
+        for(i = 0; ctx->Index.phFileTp && (i < ctx->cTp); i++) {
+            if(ctx->Index.phFileTp[i]) { fclose(ctx->Index.phFileTp[i]); }
+        }
+        LocalFree(ctx->Index.phFileTp);
+        LocalFree(ctx->pcTpId);
+        LocalFree(ctx->pcbTpU);
+        LocalFree(ctx);
+    }
+    LocalFree(pEntries);
+    return fResult;
+}
+
+/*
+* Populate the timeline info struct array (ctxFc->Timeline) from the already
+* existing timeline_info database table.
+* -- return
+*/
+_Success_(return)
+BOOL FcTimeline_InitializeInfo()
+{
+    BOOL fResult = FALSE;
+    DWORD i;
+    QWORD v = 0;
+    sqlite3 *hSql = NULL;
+    sqlite3_stmt *hStmt = NULL;
+    PFC_TIMELINE_INFO pi;
+    if(SQLITE_OK != Fc_SqlQueryN("SELECT MAX(id) FROM timeline_info;", 0, NULL, 1, &v, NULL)) { goto fail; }
+    ctxFc->Timeline.cTp = (DWORD)v + 1;
+    // populate timeline info struct
+    if(!(ctxFc->Timeline.pInfo = LocalAlloc(LMEM_ZEROINIT, (ctxFc->Timeline.cTp) * sizeof(FC_TIMELINE_INFO)))) { goto fail; }
+    if(!(hSql = Fc_SqlReserve())) { goto fail; }
+    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "SELECT * FROM timeline_info", -1, &hStmt, 0)) { goto fail; }
+    for(i = 0; i < ctxFc->Timeline.cTp; i++) {
+        pi = ctxFc->Timeline.pInfo + i;
+        if(SQLITE_ROW != sqlite3_step(hStmt)) { goto fail; }
+        pi->dwId = sqlite3_column_int(hStmt, 0);
+        pi->szNameShort[0] = 0;
+        strncpy_s(pi->szNameShort, _countof(pi->szNameShort), sqlite3_column_text(hStmt, 1), _TRUNCATE);
+        pi->szNameShort[_countof(pi->szNameShort) - 1] = 0;
+        strncpy_s(pi->uszNameFile, _countof(pi->uszNameFile), sqlite3_column_text(hStmt, 2), _TRUNCATE);
+        pi->dwFileSizeUTF8 = sqlite3_column_int(hStmt, 4);
+        pi->dwFileSizeJSON = sqlite3_column_int(hStmt, 5);
+    }
+    fResult = TRUE;
+fail:
+    sqlite3_finalize(hStmt);
+    Fc_SqlReserveReturn(hSql);
+    return fResult;
+}
+
 /*
 * Initialize the timelining functionality. Before the timelining functionality
 * is initialized processes, threads, registry and ntfs must be initialized.
@@ -315,10 +1154,6 @@ BOOL FcTimeline_Initialize()
     BOOL fResult = FALSE;
     int rc;
     DWORD i;
-    QWORD k, v = 0;
-    sqlite3 *hSql = NULL;
-    sqlite3_stmt *hStmt = NULL;
-    PFC_TIMELINE_INFO pi;
     LPSTR szTIMELINE_SQL1[] = {
         // populate timeline_info with basic information:
         "DROP TABLE IF EXISTS timeline_info;",
@@ -337,20 +1172,19 @@ BOOL FcTimeline_Initialize()
     // populate timeline_data temporary table - with plugins.
     PluginManager_FcTimeline(FcTimeline_Callback_PluginRegister, FcTimeline_Callback_PluginClose, FcTimeline_Callback_PluginEntryAdd, FcTimeline_Callback_PluginEntryAddBySQL);
     LPSTR szTIMELINE_SQL2[] = {
-        // populate main timeline table:
+        // create main timeline table:
         "DROP TABLE IF EXISTS timeline;",
         "DROP VIEW IF EXISTS v_timeline;",
         "CREATE TABLE timeline ( id INTEGER PRIMARY KEY AUTOINCREMENT, tp INT, tp_id INTEGER, id_str INTEGER, ft INTEGER, ac INT, pid INT, data32 INT, data64 INTEGER, oln_u INTEGER, oln_j INTEGER, oln_utp INTEGER );"
         "CREATE VIEW v_timeline AS SELECT * FROM timeline, str WHERE timeline.id_str = str.id;",
+    };
+    LPSTR szTIMELINE_SQL3[] = {
+        // index main timeline table (after bulk insert) and drop temporary table:
         "CREATE UNIQUE INDEX idx_timeline_tpid     ON timeline(tp, tp_id);",
         "CREATE UNIQUE INDEX idx_timeline_oln_u    ON timeline(oln_u);",
         "CREATE UNIQUE INDEX idx_timeline_oln_j    ON timeline(oln_j);"
         "CREATE UNIQUE INDEX idx_timeline_oln_utp  ON timeline(tp, oln_utp);",
-        "INSERT INTO timeline (tp, tp_id, id_str, ft, ac, pid, data32, data64, oln_u, oln_j, oln_utp) SELECT td.tp, (SUM(1) OVER (PARTITION BY td.tp ORDER BY td.ft DESC, td.id)), td.id_str, td.ft, td.ac, td.pid, td.data32, td.data64, (SUM(str.cbu+"STRINGIZE(FC_LINELENGTH_TIMELINE_UTF8)")  OVER (ORDER BY td.ft DESC, td.id) - str.cbu-"STRINGIZE(FC_LINELENGTH_TIMELINE_UTF8)"), (SUM(str.cbj+"STRINGIZE(FC_LINELENGTH_TIMELINE_JSON)") OVER (ORDER BY td.ft DESC, td.id) - str.cbj-"STRINGIZE(FC_LINELENGTH_TIMELINE_JSON)"), (SUM(str.cbu+"STRINGIZE(FC_LINELENGTH_TIMELINE_UTF8)")  OVER (PARTITION BY td.tp ORDER BY td.ft DESC, td.id) - str.cbu-"STRINGIZE(FC_LINELENGTH_TIMELINE_UTF8)") FROM timeline_data td, str WHERE str.id = td.id_str ORDER BY td.ft DESC, td.id;",
         "DROP TABLE timeline_data;"
-        // update timeline_info with sizes for 'all' file (utf8 and json).
-        "UPDATE timeline_info SET file_size_u = (SELECT oln_u+cbu+"STRINGIZE(FC_LINELENGTH_TIMELINE_UTF8)" AS cbu_tot FROM v_timeline WHERE id = (SELECT MAX(id) FROM v_timeline)) WHERE id = 0;",
-        "UPDATE timeline_info SET file_size_j = (SELECT oln_j+cbj+"STRINGIZE(FC_LINELENGTH_TIMELINE_JSON)" AS cbj_tot FROM v_timeline WHERE id = (SELECT MAX(id) FROM v_timeline)) WHERE id = 0;",
     };
     for(i = 0; i < sizeof(szTIMELINE_SQL2) / sizeof(LPCSTR); i++) {
         if(SQLITE_OK != (rc = Fc_SqlExec(szTIMELINE_SQL2[i]))) {
@@ -358,41 +1192,25 @@ BOOL FcTimeline_Initialize()
             goto fail;
         }
     }
-    // update progress percent counter.
-    ctxFc->cProgressPercent = 80;
-    // update timeline_info with sizes for individual types for utf-8 only.
-    LPSTR szTIMELINE_SQL_TIMELINE_UPD_UTF8 =
-        "UPDATE timeline_info SET file_size_u = IFNULL((SELECT oln_utp+cbu+"STRINGIZE(FC_LINELENGTH_TIMELINE_UTF8)" FROM v_timeline WHERE tp = ? AND tp_id = (SELECT MAX(tp_id) FROM v_timeline WHERE tp = ?)), 0) WHERE id = ?;";
-    Fc_SqlQueryN("SELECT MAX(id) FROM timeline_info;", 0, NULL, 1, &v, NULL);
-    ctxFc->Timeline.cTp = (DWORD)v + 1;
-    for(k = 1; k < ctxFc->Timeline.cTp; k++) {
-        if(SQLITE_DONE != (rc = Fc_SqlQueryN(szTIMELINE_SQL_TIMELINE_UPD_UTF8, 3, (QWORD[]) { k, k, k }, 0, NULL, NULL))) {
-            VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "FAIL INITIALIZE TIMELINE WITH SQLITE ERROR CODE %i, QUERY: %s\n", rc, szTIMELINE_SQL_TIMELINE_UPD_UTF8);
-            goto fail;
-        }
-    }
-    // populate timeline info struct
-    if(!(ctxFc->Timeline.pInfo = LocalAlloc(LMEM_ZEROINIT, (ctxFc->Timeline.cTp) * sizeof(FC_TIMELINE_INFO)))) { goto fail; }
-    if(!(hSql = Fc_SqlReserve())) { goto fail; }
-    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "SELECT * FROM timeline_info", -1, &hStmt, 0)) { goto fail; }
-    for(i = 0; i < ctxFc->Timeline.cTp; i++) {
-        pi = ctxFc->Timeline.pInfo + i;
-        if(SQLITE_ROW != sqlite3_step(hStmt)) { goto fail; }
-        pi->dwId = sqlite3_column_int(hStmt, 0);
-        pi->szNameShort[0] = 0;
-        strncpy_s(pi->szNameShort, _countof(pi->szNameShort), sqlite3_column_text(hStmt, 1), _TRUNCATE);
-        pi->szNameShort[_countof(pi->szNameShort) - 1] = 0;
-        strncpy_s(pi->uszNameFile, _countof(pi->uszNameFile), sqlite3_column_text(hStmt, 2), _TRUNCATE);
-        pi->dwFileSizeUTF8 = sqlite3_column_int(hStmt, 4);
-        pi->dwFileSizeJSON = sqlite3_column_int(hStmt, 5);
+    // populate main timeline table (sorted by time) and timeline_info file sizes:
+    if(!FcTimeline_Sort_Build()) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "FAIL INITIALIZE TIMELINE: SORT\n");
+        goto fail;
     }
-    fResult = TRUE;
+    // update progress percent counter.
+    ctxFc->cProgressPercent = 80;
+    for(i = 0; i < sizeof(szTIMELINE_SQL3) / sizeof(LPCSTR); i++) {
+        if(SQLITE_OK != (rc = Fc_SqlExec(szTIMELINE_SQL3[i]))) {
+            VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "FAIL INITIALIZE TIMELINE WITH SQLITE ERROR CODE %i, QUERY: %s\n", rc, szTIMELINE_SQL3[i]);
+            goto fail;
+        }
+    }
+    fResult = FcTimeline_InitializeInfo();
 fail:
-    sqlite3_finalize(hStmt);
-    Fc_SqlReserveReturn(hSql);
     return fResult;
 }
 
+
 #define FCTIMELINE_SQL_SELECT_FIELDS_ALL " cbu, sz,    id, ft, tp, ac, pid, data32, data64, oln_u,   oln_j   "
 #define FCTIMELINE_SQL_SELECT_FIELDS_TP  " cbu, sz, tp_id, ft, tp, ac, pid, data32, data64, oln_utp, 0 "
 
@@ -485,6 +1303,72 @@ BOOL FcTimelineMap_GetFromIdRange(_In_ DWORD dwTimelineType, _In_ QWORD qwId, _I
     return FcTimelineMap_CreateInternal(szSQL[iSQL], szSQL[iSQL + 1], (dwTimelineType ? 3 : 2), v, ppObTimelineMap);
 }
 
+/*
+* Retrieve a record from the memory-mapped timeline index.
+* -- pHdr
+* -- dwTimelineType = the timeline type, 0 for all.
+* -- iEntry = the 0-based entry index within the timeline file.
+* -- return = the record, or NULL on error.
+*/
+PFC_TIMELINE_INDEX_RECORD FcTimelineIndex_GetRecord(_In_ PFC_TIMELINE_INDEX_HEADER pHdr, _In_ DWORD dwTimelineType, _In_ QWORD iEntry)
+{
+    DWORD iRecord;
+    if(dwTimelineType) {
+        if(iEntry >= pHdr->Tp[dwTimelineType].c) { return NULL; }
+        iRecord = ((PDWORD)((PBYTE)pHdr + pHdr->Tp[dwTimelineType].o))[iEntry];
+    } else {
+        iRecord = (DWORD)iEntry;
+    }
+    if(iRecord >= pHdr->cRecord) { return NULL; }
+    return (PFC_TIMELINE_INDEX_RECORD)((PBYTE)pHdr + pHdr->oRecord) + iRecord;
+}
+
+_Success_(return)
+BOOL FcTimelineIndex_GetFromPosition(_In_ DWORD dwTimelineType, _In_ QWORD qwFilePos, _Out_ PQWORD piEntry)
+{
+    QWORD c, iLo = 0, iHi, iMid;
+    PFC_TIMELINE_INDEX_RECORD pr;
+    PFC_TIMELINE_INDEX_HEADER pHdr = ctxFc->Timeline.Index.pHdr;
+    if(!pHdr || (dwTimelineType >= pHdr->cTp)) { return FALSE; }
+    c = dwTimelineType ? pHdr->Tp[dwTimelineType].c : pHdr->cRecord;
+    if(!c) { return FALSE; }
+    // binary search for the last entry starting at or before qwFilePos:
+    iHi = c - 1;
+    while(iLo < iHi) {
+        iMid = iLo + (iHi - iLo + 1) / 2;
+        if(!(pr = FcTimelineIndex_GetRecord(pHdr, dwTimelineType, iMid))) { return FALSE; }
+        if((dwTimelineType ? pr->oLnUtp : pr->oLnU) <= qwFilePos) {
+            iLo = iMid;
+        } else {
+            iHi = iMid - 1;
+        }
+    }
+    *piEntry = iLo;
+    return TRUE;
+}
+
+_Success_(return)
+BOOL FcTimelineIndex_GetEntry(_In_ DWORD dwTimelineType, _In_ QWORD iEntry, _Out_ PFC_MAP_TIMELINEENTRY pe)
+{
+    PFC_TIMELINE_INDEX_RECORD pr;
+    PFC_TIMELINE_INDEX_HEADER pHdr = ctxFc->Timeline.Index.pHdr;
+    if(!pHdr || (dwTimelineType >= pHdr->cTp)) { return FALSE; }
+    if(!(pr = FcTimelineIndex_GetRecord(pHdr, dwTimelineType, iEntry))) { return FALSE; }
+    if(pr->oStr + pr->cbu >= pHdr->cbStr) { return FALSE; }
+    pe->id = iEntry + 1;
+    pe->ft = pr->ft;
+    pe->tp = pr->tp;
+    pe->ac = pr->ac;
+    pe->pid = pr->pid;
+    pe->data32 = pr->data32;
+    pe->data64 = pr->data64;
+    pe->cuszOffset = dwTimelineType ? pr->oLnUtp : pr->oLnU;
+    pe->cjszOffset = 0;
+    pe->cuszText = pr->cbu;
+    pe->uszText = (LPSTR)pHdr + pHdr->oStr + pr->oStr;
+    return TRUE;
+}
+
 /*
 * Retrieve the minimum timeline id that exists within a byte range inside a
 * timeline file of a specific type.
@@ -517,21 +1401,39 @@ BOOL FcTimeline_GetIdFromPosition(_In_ DWORD dwTimelineType, _In_ BOOL fJSON, _I
 
 typedef struct tdFC_SCANPHYSMEM_CONTEXT {
     HANDLE hEvent;
+    BOOL fSkip;                 // no valid (non-free/non-zero) pages in chunk.
     VMMDLL_PLUGIN_FORENSIC_INGEST_PHYSMEM e;
 } FC_SCANPHYSMEM_CONTEXT, *PFC_SCANPHYSMEM_CONTEXT;
 
+/*
+* Retrieve a performance counter time stamp.
+*/
+QWORD FcScanPhysmem_TimeNow()
+{
+    QWORD tm;
+    QueryPerformanceCounter((PLARGE_INTEGER)&tm);
+    return tm;
+}
 
-VOID FcScanPhysmem_ThreadProc(_Inout_ PVMMDLL_PLUGIN_FORENSIC_INGEST_PHYSMEM ctx)
+/*
+* Physical memory scan pipeline stages 1-2: PFN lookup and memory read of a
+* chunk. Runs in a worker thread - several chunks may be in flight at once.
+* -- ctx
+*/
+VOID FcScanPhysmem_ThreadProc(_Inout_ PFC_SCANPHYSMEM_CONTEXT ctxS)
 {
     DWORD dwPfnBase, cbPfnMap;
-    QWORD i, pa;
+    QWORD i, pa, tmStart;
     BOOL fValidMEMs, fValidAddr;
     PDWORD pPfns = NULL;
     PVMMDLL_MAP_PFNENTRY pePfn;
+    PVMMDLL_PLUGIN_FORENSIC_INGEST_PHYSMEM ctx = &ctxS->e;
     ctx->fValid = FALSE;
+    ctxS->fSkip = FALSE;
     // 1: fetch and setup PFN map by calling VMMDLL API
     //    (somewhat ugly to call external api, but it provides required data).
     if(!ctxVmm->Work.fEnabled) { goto fail; }
+    tmStart = FcScanPhysmem_TimeNow();
     dwPfnBase = (DWORD)(ctx->paBase >> 12);
     if(!(pPfns = LocalAlloc(0, FC_PHYSMEM_NUM_CHUNKS * sizeof(DWORD)))) { goto fail; }
     for(i = 0; i < FC_PHYSMEM_NUM_CHUNKS; i++) {
@@ -559,73 +1461,140 @@ VOID FcScanPhysmem_ThreadProc(_Inout_ PVMMDLL_PLUGIN_FORENSIC_INGEST_PHYSMEM ctx
         ctx->ppMEMs[i]->f = FALSE;
         fValidMEMs = fValidMEMs || fValidAddr;
     }
-    // 3: read physical memory
+    InterlockedAdd64(&ctxFc->PhysmemScan.tmPfn, FcScanPhysmem_TimeNow() - tmStart);
+    // 3: read physical memory - chunks with only free/zero pages are skipped.
     if(fValidMEMs) {
+        tmStart = FcScanPhysmem_TimeNow();
         VmmReadScatterPhysical(ctx->ppMEMs, FC_PHYSMEM_NUM_CHUNKS, VMM_FLAG_NOCACHEPUT);
+        InterlockedAdd64(&ctxFc->PhysmemScan.tmRead, FcScanPhysmem_TimeNow() - tmStart);
+        InterlockedAdd64(&ctxFc->PhysmemScan.cbRead, 0x1000 * FC_PHYSMEM_NUM_CHUNKS);
+    } else {
+        ctxS->fSkip = TRUE;
+        InterlockedAdd64(&ctxFc->PhysmemScan.cbSkip, 0x1000 * FC_PHYSMEM_NUM_CHUNKS);
     }
     ctx->fValid = TRUE;
 fail:
     LocalFree(pPfns);
 }
 
+/*
+* Retrieve the physical memory scan pipeline statistics as a string.
+* -- sz = buffer to receive the statistics (or NULL to retrieve size only).
+* -- cch
+* -- return = number of characters (excl. NULL).
+*/
+DWORD FcScanPhysmem_StatisticsToString(_Out_writes_opt_(cch) LPSTR sz, _In_ DWORD cch)
+{
+    QWORD qwFreq, cbPfn, cbRead, cbSkip, tmPfn, tmRead, tmIngest, tmTotal, tmDb;
+    CHAR szBuffer[0x400];
+    if(sz && cch) { sz[0] = 0; }
+    if(!ctxFc) { return 0; }
+    QueryPerformanceFrequency((PLARGE_INTEGER)&qwFreq);
+    cbRead = ctxFc->PhysmemScan.cbRead;
+    cbSkip = ctxFc->PhysmemScan.cbSkip;
+    cbPfn = cbRead + cbSkip;
+    tmPfn = max(1, ctxFc->PhysmemScan.tmPfn);
+    tmRead = max(1, ctxFc->PhysmemScan.tmRead);
+    tmIngest = max(1, ctxFc->PhysmemScan.tmIngest);
+    tmTotal = max(1, (ctxFc->PhysmemScan.tmEnd ? ctxFc->PhysmemScan.tmEnd : FcScanPhysmem_TimeNow()) - ctxFc->PhysmemScan.tmStart);
+    tmDb = max(1, (ctxFc->db.tmIngestEnd ? ctxFc->db.tmIngestEnd : FcScanPhysmem_TimeNow()) - ctxFc->db.tmIngestStart);
+    snprintf(
+        szBuffer,
+        sizeof(szBuffer),
+        "Pipeline depth:     %i\n" \
+        "Scanned:            %llu MB\n" \
+        "Skipped (free/zero):%llu MB\n" \
+        "Total:              %llu MB/s\n" \
+        "Stage PFN lookup:   %llu MB/s\n" \
+        "Stage memory read:  %llu MB/s\n" \
+        "Stage plugin ingest:%llu MB/s\n" \
+        "Database rows:      %llu\n" \
+        "Database ingest:    %llu rows/s\n",
+        ctxFc->PhysmemScan.cDepth,
+        cbPfn >> 20,
+        cbSkip >> 20,
+        ctxFc->PhysmemScan.tmStart ? (((cbPfn * qwFreq) / tmTotal) >> 20) : 0,
+        ((cbPfn * qwFreq) / tmPfn) >> 20,
+        ((cbRead * qwFreq) / tmRead) >> 20,
+        ((cbRead * qwFreq) / tmIngest) >> 20,
+        ctxFc->db.cInsertRow,
+        ctxFc->db.tmIngestStart ? ((ctxFc->db.cInsertRow * qwFreq) / tmDb) : 0
+    );
+    if(sz && cch) {
+        strncpy_s(sz, cch, szBuffer, _TRUNCATE);
+    }
+    return (DWORD)strlen(szBuffer);
+}
+
 /*
 * Physical Memory Scan Loop - function is meant to be running in asynchronously
-* with one thread calling only. The function allocates two 16MB chunks and will
-* begin to loop-read physical memory into chunks (in separate thread) and call
-* the plugin manager for processing by forensic consumer plugins.
+* with one thread calling only. The function allocates a number (pipeline depth)
+* of 16MB chunks. PFN lookup and read of physical memory into chunks takes
+* place in worker threads - overlapping with each other and with the plugin
+* manager ingest (processing by forensic consumer plugins) which takes place in
+* address order on the calling thread.
 */
 VOID FcScanPhysmem()
 {
-    QWORD i, iChunk = 0, paBase;
-    FC_SCANPHYSMEM_CONTEXT ctx2[2] = { 0 };
-    PFC_SCANPHYSMEM_CONTEXT ctx;
-    // 1: initialize two 16MB physical memory scan chunks
-    for(i = 0; i < 2; i++) {
-        ctx = ctx2 + i;
+    DWORD i, cDepth;
+    QWORD paIssue = 0, tmStart;
+    QWORD iChunkIssue = 0, iChunkIngest = 0;
+    PFC_SCANPHYSMEM_CONTEXT ctx, pCtxs = NULL;
+    // 1: initialize pipeline depth number of 16MB physical memory scan chunks
+    cDepth = ctxMain->cfg.cForensicScanDepth ? ctxMain->cfg.cForensicScanDepth : FC_PHYSMEM_PIPELINE_DEPTH_DEFAULT;
+    cDepth = min(FC_PHYSMEM_PIPELINE_DEPTH_MAX, max(2, cDepth));
+    ctxFc->PhysmemScan.cDepth = cDepth;
+    ctxFc->PhysmemScan.tmStart = FcScanPhysmem_TimeNow();
+    if(!(pCtxs = LocalAlloc(LMEM_ZEROINIT, cDepth * sizeof(FC_SCANPHYSMEM_CONTEXT)))) { goto fail; }
+    for(i = 0; i < cDepth; i++) {
+        ctx = pCtxs + i;
         if(!(ctx->hEvent = CreateEvent(NULL, TRUE, TRUE, NULL))) { goto fail; }
         if(!LcAllocScatter1(FC_PHYSMEM_NUM_CHUNKS, &ctx->e.ppMEMs)) { goto fail; }
         if(!(ctx->e.pPfnMap = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMDLL_MAP_PFN) + FC_PHYSMEM_NUM_CHUNKS * sizeof(VMMDLL_MAP_PFNENTRY)))) { goto fail; }
         ctx->e.cMEMs = FC_PHYSMEM_NUM_CHUNKS;
     }
     // 2: main physical memory scan loop
-    for(paBase = 0; paBase < ctxMain->dev.paMax; paBase += 0x1000 * FC_PHYSMEM_NUM_CHUNKS) {
-        iChunk++;
-        if(!ctxVmm->Work.fEnabled) { goto fail; }
-        VmmLog(MID_FORENSIC, LOGLEVEL_DEBUG, "PhysicalAddress=%016llx\n", paBase);
-        // 2.1: fetch new physical data in separate thread:
-        ctx = ctx2 + (iChunk % 2);
-        ctx->e.paBase = paBase;
-        ResetEvent(ctx->hEvent);
-        VmmWork((LPTHREAD_START_ROUTINE)FcScanPhysmem_ThreadProc, &ctx->e, ctx->hEvent);
-        // 2.2: process previously scheduled work item (unless first):
-        if(paBase == 0) { continue; }
-        ctx = ctx2 + ((iChunk - 1) % 2);
-        WaitForSingleObject(ctx->hEvent, INFINITE);
-        if(!ctxVmm->Work.fEnabled) { goto fail; }
-        if(ctx->e.fValid) {
-            PluginManager_FcIngestPhysmem(&ctx->e);
+    while(TRUE) {
+        // 2.1: keep the pipeline filled - fetch new physical data in worker threads:
+        while((iChunkIssue - iChunkIngest < cDepth) && (paIssue < ctxMain->dev.paMax)) {
+            if(!ctxVmm->Work.fEnabled) { goto fail; }
+            VmmLog(MID_FORENSIC, LOGLEVEL_DEBUG, "PhysicalAddress=%016llx\n", paIssue);
+            ctx = pCtxs + (iChunkIssue % cDepth);
+            ctx->e.paBase = paIssue;
+            ResetEvent(ctx->hEvent);
+            VmmWork((LPTHREAD_START_ROUTINE)FcScanPhysmem_ThreadProc, ctx, ctx->hEvent);
+            paIssue += 0x1000 * FC_PHYSMEM_NUM_CHUNKS;
+            iChunkIssue++;
         }
-        ctxFc->cProgressPercent = 10 + (BYTE)((50 * paBase) / ctxMain->dev.paMax);
-    }
-    // 2.3: process last read chunk
-    if(iChunk) {
-        ctx = ctx2 + ((iChunk - 1) % 2);
+        if(iChunkIngest == iChunkIssue) { break; }
+        // 2.2: ingest the oldest scheduled chunk (in address order):
+        ctx = pCtxs + (iChunkIngest % cDepth);
         WaitForSingleObject(ctx->hEvent, INFINITE);
         if(!ctxVmm->Work.fEnabled) { goto fail; }
-        if(ctx->e.fValid) {
+        if(ctx->e.fValid && !ctx->fSkip) {
+            tmStart = FcScanPhysmem_TimeNow();
             PluginManager_FcIngestPhysmem(&ctx->e);
+            ctxFc->PhysmemScan.tmIngest += FcScanPhysmem_TimeNow() - tmStart;
         }
+        iChunkIngest++;
+        ctxFc->cProgressPercent = 10 + (BYTE)((50 * ctx->e.paBase) / ctxMain->dev.paMax);
     }
 fail:
-    for(i = 0; i < 2; i++) {
-        ctx = ctx2 + i;
-        if(ctx->hEvent) {
-            WaitForSingleObject(ctx->hEvent, INFINITE);
+    ctxFc->PhysmemScan.tmEnd = FcScanPhysmem_TimeNow();
+    if(pCtxs) {
+        for(i = 0; i < cDepth; i++) {
+            ctx = pCtxs + i;
+            if(ctx->hEvent) {
+                WaitForSingleObject(ctx->hEvent, INFINITE);
+                CloseHandle(ctx->hEvent);
+            }
+            LcMemFree(ctx->e.ppMEMs);
+            LocalFree(ctx->e.pPfnMap);
         }
-        if(ctx->hEvent) { CloseHandle(ctx->hEvent); }
-        LcMemFree(ctx->e.ppMEMs);
-        LocalFree(ctx->e.pPfnMap);
+        LocalFree(pCtxs);
     }
+    VmmLog(MID_FORENSIC, LOGLEVEL_VERBOSE, "PHYSMEM SCAN: depth=%i scanned=%lluMB skipped=%lluMB\n",
+        cDepth, (ctxFc->PhysmemScan.cbRead + ctxFc->PhysmemScan.cbSkip) >> 20, ctxFc->PhysmemScan.cbSkip >> 20);
 }
 
 
@@ -634,15 +1603,204 @@ fail:
 // GENERAL JSON DATA LOG BELOW:
 // ----------------------------------------------------------------------------
 
+#define FCJSON_THREAD_BUFFER_SIZE           0x00040000
+
+typedef struct tdFCJSON_THREAD_BUFFER {
+    struct tdFCJSON_THREAD_BUFFER *FLink;
+    DWORD cbGen;
+    DWORD cbGenVerbose;
+    BYTE pbGen[FCJSON_THREAD_BUFFER_SIZE];
+    BYTE pbGenVerbose[FCJSON_THREAD_BUFFER_SIZE];
+} FCJSON_THREAD_BUFFER, *PFCJSON_THREAD_BUFFER;
+
+static DWORD g_dwFcJsonGeneration = 0;
+#ifdef _WIN32
+static __declspec(thread) DWORD g_dwFcJsonThreadGeneration = 0;
+static __declspec(thread) PFCJSON_THREAD_BUFFER g_pFcJsonThreadBuffer = NULL;
+#endif /* _WIN32 */
+#ifdef LINUX
+static __thread DWORD g_dwFcJsonThreadGeneration = 0;
+static __thread PFCJSON_THREAD_BUFFER g_pFcJsonThreadBuffer = NULL;
+#endif /* LINUX */
+
+/*
+* Retrieve the json line buffer of the current thread. Buffers are registered
+* with the forensic context and are flushed and freed by FcJson_Flush() when
+* the json log phase ends (or when the forensic context is closed).
+* -- return = the buffer, or NULL if lines should be appended directly.
+*/
+PFCJSON_THREAD_BUFFER FcJson_ThreadBuffer()
+{
+    PFCJSON_THREAD_BUFFER pb;
+    if(ctxFc->FileJSON.fThreadBufferDisable) { return NULL; }
+    if(g_pFcJsonThreadBuffer && (g_dwFcJsonThreadGeneration == g_dwFcJsonGeneration)) {
+        return g_pFcJsonThreadBuffer;
+    }
+    g_pFcJsonThreadBuffer = NULL;
+    if(!(pb = LocalAlloc(0, sizeof(FCJSON_THREAD_BUFFER)))) { return NULL; }
+    pb->cbGen = 0;
+    pb->cbGenVerbose = 0;
+    AcquireSRWLockExclusive(&ctxFc->FileJSON.LockSRW);
+    pb->FLink = ctxFc->FileJSON.pThreadBufferFirst;
+    ctxFc->FileJSON.pThreadBufferFirst = pb;
+    ReleaseSRWLockExclusive(&ctxFc->FileJSON.LockSRW);
+    g_dwFcJsonThreadGeneration = g_dwFcJsonGeneration;
+    g_pFcJsonThreadBuffer = pb;
+    return pb;
+}
+
+/*
+* Flush the json line buffers of all threads to the json memory files and free
+* them. Called when the json log phase has ended - any json line added after
+* this is appended directly to the json memory files. Must not be called while
+* json entries are being added.
+*/
+VOID FcJson_Flush()
+{
+    PFCJSON_THREAD_BUFFER pb;
+    AcquireSRWLockExclusive(&ctxFc->FileJSON.LockSRW);
+    ctxFc->FileJSON.fThreadBufferDisable = TRUE;
+    InterlockedIncrement(&g_dwFcJsonGeneration);
+    while((pb = ctxFc->FileJSON.pThreadBufferFirst)) {
+        ctxFc->FileJSON.pThreadBufferFirst = pb->FLink;
+        if(pb->cbGen) { ObMemFile_Append(ctxFc->FileJSON.pGen, pb->pbGen, pb->cbGen); }
+        if(pb->cbGenVerbose) { ObMemFile_Append(ctxFc->FileJSON.pGenVerbose, pb->pbGenVerbose, pb->cbGenVerbose); }
+        LocalFree(pb);
+    }
+    ReleaseSRWLockExclusive(&ctxFc->FileJSON.LockSRW);
+}
+
+/*
+* Free all json line buffers. Called when the forensic context is closed.
+*/
+VOID FcJson_Close()
+{
+    PFCJSON_THREAD_BUFFER pb;
+    InterlockedIncrement(&g_dwFcJsonGeneration);
+    while((pb = ctxFc->FileJSON.pThreadBufferFirst)) {
+        ctxFc->FileJSON.pThreadBufferFirst = pb->FLink;
+        LocalFree(pb);
+    }
+}
+
+/*
+* Append a json line to the json memory file - buffered per thread and written
+* in large blocks to the memory file.
+* -- fVerbose
+* -- pbLine
+* -- cbLine
+*/
+VOID FcJson_AppendLine(_In_ BOOL fVerbose, _In_reads_(cbLine) PBYTE pbLine, _In_ DWORD cbLine)
+{
+    PDWORD pcb;
+    PBYTE pbBuffer;
+    POB_MEMFILE pmf = fVerbose ? ctxFc->FileJSON.pGenVerbose : ctxFc->FileJSON.pGen;
+    PFCJSON_THREAD_BUFFER pb = FcJson_ThreadBuffer();
+    if(!pb) {
+        ObMemFile_Append(pmf, pbLine, cbLine);
+        return;
+    }
+    pcb = fVerbose ? &pb->cbGenVerbose : &pb->cbGen;
+    pbBuffer = fVerbose ? pb->pbGenVerbose : pb->pbGen;
+    if(*pcb + cbLine > FCJSON_THREAD_BUFFER_SIZE) {
+        ObMemFile_Append(pmf, pbBuffer, *pcb);
+        *pcb = 0;
+    }
+    memcpy(pbBuffer + *pcb, pbLine, cbLine);
+    *pcb += cbLine;
+}
+
+#define FCJSON_APPEND_LIT(psz, sz)          { memcpy(psz, sz, sizeof(sz) - 1); psz += sizeof(sz) - 1; }
+#define FCJSON_SWAR_ONES                    0x0101010101010101ULL
+#define FCJSON_SWAR_HIGH                    0x8080808080808080ULL
+#define FCJSON_SWAR_HASZERO(v)              (((v) - FCJSON_SWAR_ONES) & ~(v) & FCJSON_SWAR_HIGH)
+#define FCJSON_SWAR_HASLESS(v, n)           (((v) - FCJSON_SWAR_ONES * (n)) & ~(v) & FCJSON_SWAR_HIGH)
+
+/*
+* Append a signed decimal number.
+* -- psz
+* -- v
+* -- return = pointer to the end of the appended number.
+*/
+LPSTR FcJson_AppendDec(_Out_writes_(20) LPSTR psz, _In_ LONGLONG v)
+{
+    CHAR sz[20];
+    DWORD i = 0;
+    QWORD qw = (v < 0) ? (0 - (QWORD)v) : (QWORD)v;
+    if(v < 0) { *psz++ = '-'; }
+    do {
+        sz[i++] = '0' + (CHAR)(qw % 10);
+        qw /= 10;
+    } while(qw);
+    while(i) { *psz++ = sz[--i]; }
+    return psz;
+}
+
+/*
+* Append a quoted lower-case hexadecimal number (without leading zeroes).
+* -- psz
+* -- v
+* -- return = pointer to the end of the appended number.
+*/
+LPSTR FcJson_AppendHexQuoted(_Out_writes_(18) LPSTR psz, _In_ QWORD v)
+{
+    DWORD i = 64;
+    *psz++ = '"';
+    while((i > 4) && !(v >> (i - 4))) { i -= 4; }
+    while(i) {
+        i -= 4;
+        *psz++ = "0123456789abcdef"[(v >> i) & 0xf];
+    }
+    *psz++ = '"';
+    return psz;
+}
+
+/*
+* Find the length of a utf-8 string if it requires no json escaping and is
+* shorter than cchMax. The string is scanned 8 bytes at a time (SWAR) for null
+* terminators, control characters, quotes and backslashes.
+* -- usz
+* -- cchMax
+* -- return = string length, or (DWORD)-1 if escaping is required / too long.
+*/
+DWORD FcJson_StrLenNoEscape(_In_ LPCSTR usz, _In_ DWORD cchMax)
+{
+    UCHAR c;
+    QWORD v;
+    DWORD i = 0;
+    // unaligned head:
+    while(((SIZE_T)(usz + i) & 7) && (i < cchMax)) {
+        c = usz[i];
+        if(!c) { return i; }
+        if((c < 0x20) || (c == '"') || (c == '\\')) { return (DWORD)-1; }
+        i++;
+    }
+    // aligned 8-byte words (never cross a page boundary):
+    while(i + 8 <= cchMax) {
+        v = *(PQWORD)(usz + i);
+        if(FCJSON_SWAR_HASLESS(v, 0x20) || FCJSON_SWAR_HASZERO(v ^ (FCJSON_SWAR_ONES * '"')) || FCJSON_SWAR_HASZERO(v ^ (FCJSON_SWAR_ONES * '\\'))) {
+            break;
+        }
+        i += 8;
+    }
+    // tail / word with special byte:
+    while(i < cchMax) {
+        c = usz[i];
+        if(!c) { return i; }
+        if((c < 0x20) || (c == '"') || (c == '\\')) { return (DWORD)-1; }
+        i++;
+    }
+    return (DWORD)-1;
+}
+
 /*
 * Callback function to add a json log line to 'general.json'
 * -- pDataJSON
 */
 VOID FcJson_Callback_EntryAdd(_In_ PVMMDLL_PLUGIN_FORENSIC_JSONDATA pDataJSON)
 {
-    LPSTR szj;
-    DWORD i;
-    SIZE_T o = 0;
+    LPSTR szj, psz;
+    DWORD i, cch;
     PVMM_PROCESS pObProcess = NULL;
     typedef struct tdBUFFER {
         CHAR szj[0x1000];
@@ -659,6 +1817,7 @@ VOID FcJson_Callback_EntryAdd(_In_ PVMMDLL_PLUGIN_FORENSIC_JSONDATA pDataJSON)
     } *PBUFFER;
     PBUFFER buf = (PBUFFER)pDataJSON->_Reserved;
     if(pDataJSON->dwVersion != VMMDLL_PLUGIN_FORENSIC_JSONDATA_VERSION) { return; }
+    psz = buf->szln;
     // general/base:
     {
         if(buf->dwHdrType != *(PDWORD)pDataJSON->szjType) {
@@ -670,7 +1829,7 @@ VOID FcJson_Callback_EntryAdd(_In_ PVMMDLL_PLUGIN_FORENSIC_JSONDATA pDataJSON)
                 pDataJSON->szjType
             );
         }
-        memcpy(buf->szln + o, buf->szjHdrType, buf->cchHdrType + 1ULL); o += buf->cchHdrType;
+        memcpy(psz, buf->szjHdrType, buf->cchHdrType); psz += buf->cchHdrType;
     }
     // pid & process:
     if(pDataJSON->dwPID) {
@@ -684,54 +1843,376 @@ VOID FcJson_Callback_EntryAdd(_In_ PVMMDLL_PLUGIN_FORENSIC_JSONDATA pDataJSON)
                 buf->cchPidProcName = snprintf(buf->szjPidProcName, sizeof(buf->szjPidProcName), ",\"pid\":%i", pDataJSON->dwPID);
             }
         }
-        memcpy(buf->szln + o, buf->szjPidProcName, buf->cchPidProcName + 1ULL); o += buf->cchPidProcName;
+        memcpy(psz, buf->szjPidProcName, buf->cchPidProcName); psz += buf->cchPidProcName;
     }
     // index:
-    o += snprintf(buf->szln + o, sizeof(buf->szln) - o, ",\"i\":%i", pDataJSON->i);
+    FCJSON_APPEND_LIT(psz, ",\"i\":");
+    psz = FcJson_AppendDec(psz, (int)pDataJSON->i);
     // obj:
     if(pDataJSON->vaObj) {
-        o += snprintf(buf->szln + o, sizeof(buf->szln) - o, ",\"obj\":\"%llx\"", pDataJSON->vaObj);
+        FCJSON_APPEND_LIT(psz, ",\"obj\":");
+        psz = FcJson_AppendHexQuoted(psz, pDataJSON->vaObj);
     }
     // addr:
-    for(i = 0; i < 2; i++) {
-        if(pDataJSON->fva[i] || pDataJSON->va[i]) {
-            o += snprintf(buf->szln + o, sizeof(buf->szln) - o, ",\"addr%s\":\"%llx\"", (i ? "2" : ""), pDataJSON->va[i]);
-        }
+    if(pDataJSON->fva[0] || pDataJSON->va[0]) {
+        FCJSON_APPEND_LIT(psz, ",\"addr\":");
+        psz = FcJson_AppendHexQuoted(psz, pDataJSON->va[0]);
+    }
+    if(pDataJSON->fva[1] || pDataJSON->va[1]) {
+        FCJSON_APPEND_LIT(psz, ",\"addr2\":");
+        psz = FcJson_AppendHexQuoted(psz, pDataJSON->va[1]);
     }
     // size/num:
     if(pDataJSON->fNum[0] || pDataJSON->qwNum[0]) {
-        o += snprintf(buf->szln + o, sizeof(buf->szln) - o, ",\"size\":%lli", pDataJSON->qwNum[0]);
+        FCJSON_APPEND_LIT(psz, ",\"size\":");
+        psz = FcJson_AppendDec(psz, (LONGLONG)pDataJSON->qwNum[0]);
     }
     if(pDataJSON->fNum[1] || pDataJSON->qwNum[1]) {
-        o += snprintf(buf->szln + o, sizeof(buf->szln) - o, ",\"num\":%lli", pDataJSON->qwNum[1]);
+        FCJSON_APPEND_LIT(psz, ",\"num\":");
+        psz = FcJson_AppendDec(psz, (LONGLONG)pDataJSON->qwNum[1]);
     }
     // hex:
-    for(i = 0; i < 2; i++) {
-        if(pDataJSON->fHex[i] || pDataJSON->qwHex[i]) {
-            o += snprintf(buf->szln + o, sizeof(buf->szln) - o, ",\"hex%s\":\"%llx\"", (i ? "2" : ""), pDataJSON->qwHex[i]);
-        }
+    if(pDataJSON->fHex[0] || pDataJSON->qwHex[0]) {
+        FCJSON_APPEND_LIT(psz, ",\"hex\":");
+        psz = FcJson_AppendHexQuoted(psz, pDataJSON->qwHex[0]);
+    }
+    if(pDataJSON->fHex[1] || pDataJSON->qwHex[1]) {
+        FCJSON_APPEND_LIT(psz, ",\"hex2\":");
+        psz = FcJson_AppendHexQuoted(psz, pDataJSON->qwHex[1]);
     }
     // desc:
     for(i = 0; i < 2; i++) {
         szj = NULL;
+        cch = 0;
         if(pDataJSON->usz[i]) {
-            CharUtil_UtoJ((LPSTR)pDataJSON->usz[i], -1, buf->szj, sizeof(buf->szj), &szj, NULL, CHARUTIL_FLAG_TRUNCATE_ONFAIL_NULLSTR);
+            // fast path: short string without characters requiring escaping.
+            if((DWORD)-1 != (cch = FcJson_StrLenNoEscape(pDataJSON->usz[i], sizeof(buf->szj) - 1))) {
+                szj = (LPSTR)pDataJSON->usz[i];
+            } else {
+                CharUtil_UtoJ((LPSTR)pDataJSON->usz[i], -1, buf->szj, sizeof(buf->szj), &szj, NULL, CHARUTIL_FLAG_TRUNCATE_ONFAIL_NULLSTR);
+                cch = szj ? (DWORD)strlen(szj) : 0;
+            }
         } else if(pDataJSON->wsz[i]) {
             CharUtil_WtoJ((LPWSTR)pDataJSON->wsz[i], -1, buf->szj, sizeof(buf->szj), &szj, NULL, CHARUTIL_FLAG_TRUNCATE_ONFAIL_NULLSTR);
+            cch = szj ? (DWORD)strlen(szj) : 0;
         }
         if(szj) {
-            o += snprintf(buf->szln + o, sizeof(buf->szln) - o, ",\"desc%s\":\"%s\"", (i ? "2" : ""), szj);
+            if(i) {
+                FCJSON_APPEND_LIT(psz, ",\"desc2\":\"");
+            } else {
+                FCJSON_APPEND_LIT(psz, ",\"desc\":\"");
+            }
+            memcpy(psz, szj, cch); psz += cch;
+            *psz++ = '"';
         }
     }
     // commit to json file:
-    if(sizeof(buf->szln) - o > 3) {
-        memcpy(buf->szln + o, "}\n", 3);
-        if(pDataJSON->fVerbose) {
-            ObMemFile_AppendString(ctxFc->FileJSON.pGenVerbose, buf->szln);
-        } else {
-            ObMemFile_AppendString(ctxFc->FileJSON.pGen, buf->szln);
+    FCJSON_APPEND_LIT(psz, "}\n");
+    FcJson_AppendLine(pDataJSON->fVerbose, (PBYTE)buf->szln, (DWORD)(psz - buf->szln));
+}
+
+
+
+// ----------------------------------------------------------------------------
+// FORENSIC DATABASE CACHE FUNCTIONALITY BELOW:
+// The forensic database and the outputs generated during forensic init may be
+// persisted in a cache directory (-forensic-cache). The cache is keyed on a
+// fingerprint of the memory image (size, file header and sampled physical
+// page hashes), the configured pagefiles and the MemProcFS build. If a complete
+// cache exists it's used read-only instead of re-running the forensic scan; in
+// that case the plugin forensic finalize pass is still run (with a NULL plugin
+// forensic context) so that plugins complete their post-init work. A cache is
+// complete only once its '.done' marker file exists - the marker is written
+// last and is removed first whenever a cache is invalidated (mismatch or
+// -forensic-cache-refresh).
+// ----------------------------------------------------------------------------
+
+typedef struct tdFC_CACHE_FINGERPRINT_DATA {
+    DWORD dwVersion[4];                 // MemProcFS build
+    DWORD dwCacheVersion;
+    DWORD _Filler;
+    QWORD paMax;
+    QWORD cbImageFile;
+    QWORD cbImageHeader;
+    QWORD cbPageFile[10];               // size of configured pagefiles (-pagefile0..9)
+    BYTE pbImageHeader[0x1000];
+    BYTE pbPageHash[FC_CACHE_FINGERPRINT_SAMPLES][32];
+} FC_CACHE_FINGERPRINT_DATA, *PFC_CACHE_FINGERPRINT_DATA;
+
+static LPCSTR FC_CACHE_FILE_EXT[] = { ".done", ".sqlite3", ".timeline", ".general.json", ".general-v.json", ".registry.json" };
+
+/*
+* Retrieve the path of a forensic database cache file.
+* -- szExt
+* -- uszPath
+*/
+VOID FcCache_Path(_In_ LPCSTR szExt, _Out_writes_(MAX_PATH) LPSTR uszPath)
+{
+    _snprintf_s(uszPath, MAX_PATH, _TRUNCATE, "%s%s", ctxFc->Cache.uszPathBase, szExt);
+}
+
+/*
+* Check whether a forensic database cache file exists.
+* -- szExt
+* -- return
+*/
+BOOL FcCache_Exists(_In_ LPCSTR szExt)
+{
+    FILE *hFile = NULL;
+    CHAR uszPath[MAX_PATH];
+    FcCache_Path(szExt, uszPath);
+    if(fopen_s(&hFile, uszPath, "rb") || !hFile) { return FALSE; }
+    fclose(hFile);
+    return TRUE;
+}
+
+/*
+* Retrieve the size of a file.
+* -- szFile
+* -- return = the file size, or (QWORD)-1 if the file could not be opened.
+*/
+QWORD FcCache_FileSize(_In_ LPCSTR szFile)
+{
+    QWORD cb = (QWORD)-1;
+    FILE *hFile = NULL;
+    if(fopen_s(&hFile, szFile, "rb") || !hFile) { return cb; }
+    if(!_fseeki64(hFile, 0, SEEK_END)) {
+        cb = _ftelli64(hFile);
+    }
+    fclose(hFile);
+    return cb;
+}
+
+/*
+* Calculate the fingerprint of the memory image, the configured pagefiles and
+* the MemProcFS build. The image file size and header are only included if the
+* memory is acquired from a local memory dump file.
+* -- szFingerprint
+* -- return
+*/
+_Success_(return)
+BOOL FcCache_Fingerprint(_Out_writes_(2 * FC_CACHE_FINGERPRINT_HASH_SIZE + 1) LPSTR szFingerprint)
+{
+    DWORD i;
+    FILE *hFile = NULL;
+    LPCSTR szFile;
+    BYTE pbHash[32], pbPage[0x1000];
+    PFC_CACHE_FINGERPRINT_DATA pd;
+    if(!(pd = LocalAlloc(LMEM_ZEROINIT, sizeof(FC_CACHE_FINGERPRINT_DATA)))) { return FALSE; }
+    pd->dwVersion[0] = VERSION_MAJOR;
+    pd->dwVersion[1] = VERSION_MINOR;
+    pd->dwVersion[2] = VERSION_REVISION;
+    pd->dwVersion[3] = VERSION_BUILD;
+    pd->dwCacheVersion = FC_CACHE_VERSION;
+    pd->paMax = ctxMain->dev.paMax;
+    // image file size and header (if device is a local file):
+    if(!ctxMain->dev.fRemote && !_stricmp(ctxMain->dev.szDeviceName, "file")) {
+        szFile = ctxMain->dev.szDevice;
+        if(!_strnicmp(szFile, "file://", 7)) { szFile += 7; }
+        if(!fopen_s(&hFile, szFile, "rb") && hFile) {
+            pd->cbImageHeader = fread(pd->pbImageHeader, 1, sizeof(pd->pbImageHeader), hFile);
+            if(!_fseeki64(hFile, 0, SEEK_END)) {
+                pd->cbImageFile = _ftelli64(hFile);
+            }
+            fclose(hFile);
+        }
+    }
+    // pagefile sizes (pagefile contents affect the forensic scan results):
+    for(i = 0; i < _countof(pd->cbPageFile); i++) {
+        if(ctxMain->cfg.szPageFile[i][0]) {
+            pd->cbPageFile[i] = FcCache_FileSize(ctxMain->cfg.szPageFile[i]);
         }
     }
+    // sampled physical memory pages:
+    for(i = 0; i < FC_CACHE_FINGERPRINT_SAMPLES; i++) {
+        VmmReadEx(NULL, ((ctxMain->dev.paMax / FC_CACHE_FINGERPRINT_SAMPLES) * i) & ~0xfff, pbPage, sizeof(pbPage), NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
+        Util_HashSHA256(pbPage, sizeof(pbPage), pd->pbPageHash[i]);
+    }
+    if(!Util_HashSHA256((PBYTE)pd, sizeof(FC_CACHE_FINGERPRINT_DATA), pbHash)) {
+        LocalFree(pd);
+        return FALSE;
+    }
+    for(i = 0; i < FC_CACHE_FINGERPRINT_HASH_SIZE; i++) {
+        _snprintf_s(szFingerprint + 2ULL * i, 3, _TRUNCATE, "%02x", pbHash[i]);
+    }
+    LocalFree(pd);
+    return TRUE;
+}
+
+/*
+* Delete the forensic database cache files of the current fingerprint.
+*/
+VOID FcCache_Invalidate()
+{
+    DWORD i;
+    CHAR uszPath[MAX_PATH];
+    for(i = 0; i < sizeof(FC_CACHE_FILE_EXT) / sizeof(LPCSTR); i++) {
+        FcCache_Path(FC_CACHE_FILE_EXT[i], uszPath);
+        Util_DeleteFileU(uszPath);
+    }
+}
+
+/*
+* Initialize the forensic database cache (if enabled by -forensic-cache). If a
+* complete cache matching the fingerprint exists it's set to be reused, any
+* other cache of the fingerprint is invalidated.
+* -- return = FALSE on fatal error, TRUE otherwise (also if cache is disabled).
+*/
+_Success_(return)
+BOOL FcCache_Initialize()
+{
+    DWORD i;
+    SIZE_T cch;
+    CHAR szDir[MAX_PATH];
+    if(!ctxMain->cfg.szForensicCacheDir[0]) { return TRUE; }
+    if(ctxMain->dev.fVolatile) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "FORENSIC CACHE: not available on volatile memory - disabled.\n");
+        return TRUE;
+    }
+    // resolve the cache directory to an absolute path (required by the sqlite uri):
+#ifdef _WIN32
+    cch = GetFullPathNameA(ctxMain->cfg.szForensicCacheDir, _countof(szDir), szDir, NULL);
+    if(!cch || (cch >= _countof(szDir))) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "FORENSIC CACHE: invalid directory '%s'\n", ctxMain->cfg.szForensicCacheDir);
+        return FALSE;
+    }
+#endif /* _WIN32 */
+#ifdef LINUX
+    LPSTR szDirFull = realpath(ctxMain->cfg.szForensicCacheDir, NULL);
+    if(!szDirFull || (strlen(szDirFull) >= _countof(szDir))) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "FORENSIC CACHE: invalid directory '%s'\n", ctxMain->cfg.szForensicCacheDir);
+        free(szDirFull);
+        return FALSE;
+    }
+    strncpy_s(szDir, _countof(szDir), szDirFull, _TRUNCATE);
+    free(szDirFull);
+#endif /* LINUX */
+    cch = strlen(szDir);
+    if(cch && (szDir[cch - 1] != '\\') && (szDir[cch - 1] != '/')) {
+#ifdef _WIN32
+        strcat_s(szDir, _countof(szDir), "\\");
+#endif /* _WIN32 */
+#ifdef LINUX
+        strcat_s(szDir, _countof(szDir), "/");
+#endif /* LINUX */
+    }
+    if(!FcCache_Fingerprint(ctxFc->Cache.szFingerprint)) { return FALSE; }
+    _snprintf_s(ctxFc->Cache.uszPathBase, _countof(ctxFc->Cache.uszPathBase), _TRUNCATE, "%svmm-%s", szDir, ctxFc->Cache.szFingerprint);
+    if(strlen(ctxFc->Cache.uszPathBase) > MAX_PATH - 32) { return FALSE; }
+    ctxFc->Cache.fEnabled = TRUE;
+    ctxFc->Cache.fReuse = !ctxMain->cfg.fForensicCacheRefresh;
+    for(i = 0; ctxFc->Cache.fReuse && (i < sizeof(FC_CACHE_FILE_EXT) / sizeof(LPCSTR)); i++) {
+        ctxFc->Cache.fReuse = FcCache_Exists(FC_CACHE_FILE_EXT[i]);
+    }
+    if(ctxFc->Cache.fReuse) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_INFO, "FORENSIC CACHE: reuse '%s'\n", ctxFc->Cache.uszPathBase);
+    } else {
+        VmmLog(MID_FORENSIC, LOGLEVEL_INFO, "FORENSIC CACHE: create '%s'\n", ctxFc->Cache.uszPathBase);
+        FcCache_Invalidate();
+    }
+    return TRUE;
+}
+
+/*
+* Write an ObMemFile to a forensic database cache file.
+* -- pmf
+* -- szExt
+* -- return
+*/
+_Success_(return)
+BOOL FcCache_SaveMemFile(_In_ POB_MEMFILE pmf, _In_ LPCSTR szExt)
+{
+    BOOL fResult = FALSE;
+    DWORD cbRead;
+    QWORD o = 0, cbTotal = ObMemFile_Size(pmf);
+    FILE *hFile = NULL;
+    PBYTE pb = NULL;
+    CHAR uszPath[MAX_PATH];
+    FcCache_Path(szExt, uszPath);
+    if(!(pb = LocalAlloc(0, 0x00100000))) { goto fail; }
+    if(fopen_s(&hFile, uszPath, "wb") || !hFile) { goto fail; }
+    while(o < cbTotal) {
+        if(VMMDLL_STATUS_SUCCESS != ObMemFile_ReadFile(pmf, pb, 0x00100000, &cbRead, o) || !cbRead) { goto fail; }
+        if(cbRead != fwrite(pb, 1, cbRead, hFile)) { goto fail; }
+        o += cbRead;
+    }
+    fResult = TRUE;
+fail:
+    if(hFile) { fclose(hFile); }
+    LocalFree(pb);
+    return fResult;
+}
+
+/*
+* Read a forensic database cache file into an ObMemFile.
+* -- pmf
+* -- szExt
+* -- return
+*/
+_Success_(return)
+BOOL FcCache_LoadMemFile(_In_ POB_MEMFILE pmf, _In_ LPCSTR szExt)
+{
+    BOOL fResult = FALSE;
+    SIZE_T cb;
+    FILE *hFile = NULL;
+    PBYTE pb = NULL;
+    CHAR uszPath[MAX_PATH];
+    FcCache_Path(szExt, uszPath);
+    if(!(pb = LocalAlloc(0, 0x00100000))) { goto fail; }
+    if(fopen_s(&hFile, uszPath, "rb") || !hFile) { goto fail; }
+    while((cb = fread(pb, 1, 0x00100000, hFile))) {
+        if(!ObMemFile_Append(pmf, pb, cb)) { goto fail; }
+    }
+    fResult = !ferror(hFile);
+fail:
+    if(hFile) { fclose(hFile); }
+    LocalFree(pb);
+    return fResult;
+}
+
+/*
+* Persist the outputs of a successful forensic initialization to the forensic
+* database cache. The '.done' marker is written last.
+* -- return
+*/
+_Success_(return)
+BOOL FcCache_Save()
+{
+    FILE *hFile = NULL;
+    CHAR uszPath[MAX_PATH];
+    if(!FcCache_SaveMemFile(ctxFc->FileJSON.pGen, ".general.json")) { goto fail; }
+    if(!FcCache_SaveMemFile(ctxFc->FileJSON.pGenVerbose, ".general-v.json")) { goto fail; }
+    if(!FcCache_SaveMemFile(ctxFc->FileJSON.pReg, ".registry.json")) { goto fail; }
+    if(!ctxFc->Timeline.Index.pHdr) { goto fail; }
+    FcCache_Path(".done", uszPath);
+    if(fopen_s(&hFile, uszPath, "wb") || !hFile) { goto fail; }
+    fprintf(hFile, "%s\n%i.%i.%i-%i\n", ctxFc->Cache.szFingerprint, VERSION_MAJOR, VERSION_MINOR, VERSION_REVISION, VERSION_BUILD);
+    fclose(hFile);
+    return TRUE;
+fail:
+    VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "FORENSIC CACHE: unable to save '%s'\n", ctxFc->Cache.uszPathBase);
+    return FALSE;
+}
+
+/*
+* Load the outputs of a previous forensic initialization from the forensic
+* database cache. The database is already opened read-only.
+* -- return
+*/
+_Success_(return)
+BOOL FcCache_Load()
+{
+    if(!FcCache_LoadMemFile(ctxFc->FileJSON.pGen, ".general.json")) { goto fail; }
+    if(!FcCache_LoadMemFile(ctxFc->FileJSON.pGenVerbose, ".general-v.json")) { goto fail; }
+    if(!FcCache_LoadMemFile(ctxFc->FileJSON.pReg, ".registry.json")) { goto fail; }
+    if(!FcTimeline_InitializeInfo()) { goto fail; }
+    ctxFc->Timeline.Index.fKeep = TRUE;
+    FcCache_Path(".timeline", ctxFc->Timeline.Index.szPath);
+    if(!FcTimeline_Index_Map()) { goto fail; }
+    return TRUE;
+fail:
+    VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "FORENSIC CACHE: unable to load '%s' - use -forensic-cache-refresh to regenerate.\n", ctxFc->Cache.uszPathBase);
+    return FALSE;
 }
 
 
@@ -740,6 +2221,39 @@ VOID FcJson_Callback_EntryAdd(_In_ PVMMDLL_PLUGIN_FORENSIC_JSONDATA pDataJSON)
 // FORENSIC INITIALIZATION FUNCTIONALITY BELOW:
 // ----------------------------------------------------------------------------
 
+/*
+* Restore default durability pragmas on all connections if relaxed pragmas were
+* applied for the insert-bound init phase (-forensic-ingest-relaxed). Called in
+* single-thread mode on both successful and failed initialization.
+*/
+VOID FcInitialize_IngestRestorePragma()
+{
+    DWORD i;
+    if(!ctxFc->db.fIngestRelaxed) { return; }
+    WaitForSingleObject(ctxFc->db.hEvent[0], INFINITE);
+    for(i = 0; i < FC_SQL_POOL_CONNECTION_NUM; i++) {
+        sqlite3_exec(ctxFc->db.hSql[i], "PRAGMA synchronous = FULL; PRAGMA journal_mode = DELETE;", NULL, NULL, NULL);
+    }
+    ctxFc->db.fIngestRelaxed = FALSE;
+    SetEvent(ctxFc->db.hEvent[0]);
+}
+
+/*
+* Finish the insert-bound init phase: restore default durability pragmas and
+* log the bulk ingest rate. The rate is also shown in progress_physmem.txt.
+* Called in single-thread mode before the connection pool is opened up for
+* multi-threaded use.
+*/
+VOID FcInitialize_IngestFinish()
+{
+    QWORD qwFreq, qwMs;
+    FcInitialize_IngestRestorePragma();
+    QueryPerformanceCounter((PLARGE_INTEGER)&ctxFc->db.tmIngestEnd);
+    QueryPerformanceFrequency((PLARGE_INTEGER)&qwFreq);
+    qwMs = max(1, ((ctxFc->db.tmIngestEnd - ctxFc->db.tmIngestStart) * 1000) / max(1, qwFreq));
+    VmmLog(MID_FORENSIC, LOGLEVEL_INFO, "DATABASE INGEST: %llu rows in %llu ms (%llu rows/s)\n", ctxFc->db.cInsertRow, qwMs, (ctxFc->db.cInsertRow * 1000) / qwMs);
+}
+
 /*
 * The core asynchronous forensic initialization function.
 */
@@ -748,6 +2262,24 @@ VOID FcInitialize_ThreadProc(_In_ PVOID pvContext)
     PVMMOB_MAP_EVIL pObEvilMap = NULL;
     HANDLE hEventAsyncLogJSON = 0;
     QWORD tmStart = Statistics_CallStart();
+    QueryPerformanceCounter((PLARGE_INTEGER)&ctxFc->db.tmIngestStart);
+    if(ctxFc->Cache.fReuse) {
+        // reuse persisted forensic database cache - skip scan/ingest/timeline.
+        // plugins are not initialized (NULL plugin forensic context) but the
+        // finalize pass is run for plugins to complete their post-init work.
+        PluginManager_Notify(VMMDLL_PLUGIN_NOTIFY_FORENSIC_INIT, NULL, 0);
+        VmmMap_GetEvil(NULL, &pObEvilMap);  // start findevil (in 'async' mode)
+        Ob_DECREF_NULL(&pObEvilMap);
+        if(!FcCache_Load()) { goto fail; }
+        PluginManager_FcFinalize();
+        ctxFc->cProgressPercent = 100;
+        ctxFc->db.fSingleThread = FALSE;
+        ctxFc->fInitFinish = TRUE;
+        PluginManager_Notify(VMMDLL_PLUGIN_NOTIFY_FORENSIC_INIT, NULL, 100);
+        PluginManager_Notify(VMMDLL_PLUGIN_NOTIFY_FORENSIC_INIT_COMPLETE, NULL, 0);
+        Statistics_CallEnd(STATISTICS_ID_FORENSIC_FcInitialize, tmStart);
+        return;
+    }
     if(SQLITE_OK != Fc_SqlExec(FC_SQL_SCHEMA_STR)) { goto fail; }
     if(!ctxVmm->Work.fEnabled) { goto fail; }
     if(!(hEventAsyncLogJSON = CreateEvent(NULL, TRUE, FALSE, NULL))) { goto fail; }
@@ -772,8 +2304,13 @@ VOID FcInitialize_ThreadProc(_In_ PVOID pvContext)
     ctxFc->cProgressPercent = 90;
     if(!ctxVmm->Work.fEnabled) { goto fail; }
     WaitForSingleObject(hEventAsyncLogJSON, INFINITE);
+    FcJson_Flush();
     PluginManager_FcFinalize();         // 91-100%
     ctxFc->cProgressPercent = 100;
+    FcInitialize_IngestFinish();
+    if(ctxFc->Cache.fEnabled) {
+        FcCache_Save();
+    }
     ctxFc->db.fSingleThread = FALSE;
     ctxFc->fInitFinish = TRUE;
     PluginManager_Notify(VMMDLL_PLUGIN_NOTIFY_FORENSIC_INIT, NULL, 100);
@@ -782,6 +2319,7 @@ VOID FcInitialize_ThreadProc(_In_ PVOID pvContext)
 fail:
     if(hEventAsyncLogJSON) { CloseHandle(hEventAsyncLogJSON); }
     if(ctxFc->cProgressPercent != 100) {
+        FcInitialize_IngestRestorePragma();
         ctxFc->cProgressPercent = 0;
     }
 }
@@ -800,6 +2338,7 @@ VOID FcClose()
             CloseHandle(ctxFc->db.hEvent[i]);
             ctxFc->db.hEvent[i] = NULL;
         }
+        Fc_SqlPrepareCached_Close(&ctxFc->db.Conn[i]);
         if(ctxFc->db.hSql[i]) { sqlite3_close(ctxFc->db.hSql[i]); }
     }
     if(ctxFc->db.tp == FC_DATABASE_TYPE_TEMPFILE_CLOSE) {
@@ -808,7 +2347,9 @@ VOID FcClose()
     Ob_DECREF_NULL(&ctxFc->FileJSON.pGen);
     Ob_DECREF_NULL(&ctxFc->FileJSON.pGenVerbose);
     Ob_DECREF_NULL(&ctxFc->FileJSON.pReg);
+    FcJson_Close();
     LocalFree(ctxFc->Timeline.pInfo);
+    FcTimeline_Index_Close();
     LeaveCriticalSection(&ctxFc->Lock);
     DeleteCriticalSection(&ctxFc->Lock);
 }
@@ -826,6 +2367,10 @@ BOOL FcInitialize_SetPath(_In_ DWORD dwDatabaseType)
     CHAR uszTemp[MAX_PATH];
     WCHAR wszTemp[MAX_PATH], wszTempShort[MAX_PATH];
     SYSTEMTIME st;
+    if(ctxFc->Cache.fEnabled) {
+        // persisted forensic database cache is always a file database kept on exit.
+        dwDatabaseType = FC_DATABASE_TYPE_TEMPFILE_STATIC;
+    }
     if(dwDatabaseType == FC_DATABASE_TYPE_MEMORY) {
         ctxFc->db.tp = FC_DATABASE_TYPE_MEMORY;
         strcpy_s(ctxFc->db.szuDatabase, _countof(ctxFc->db.szuDatabase), "file:///memorydb?mode=memory");
@@ -857,6 +2402,9 @@ BOOL FcInitialize_SetPath(_In_ DWORD dwDatabaseType)
     } else {
         strcat_s(uszTemp, _countof(wszTemp), "vmm.sqlite3");
     }
+    if(ctxFc->Cache.fEnabled) {
+        FcCache_Path(".sqlite3", uszTemp);
+    }
     // check length, copy into ctxFc and finish
     if(strlen(uszTemp) > MAX_PATH - 10) { return FALSE; }
     strncpy_s(ctxFc->db.uszDatabasePath, _countof(ctxFc->db.uszDatabasePath), uszTemp, _TRUNCATE);
@@ -899,6 +2447,10 @@ BOOL FcInitialize_Impl(_In_ DWORD dwDatabaseType, _In_ BOOL fForceReInit)
         VmmLog(MID_FORENSIC, LOGLEVEL_CRITICAL, "WRONG SQLITE THREADING MODE - TERMINATING!\n");
         ExitProcess(0);
     }
+    if(!FcCache_Initialize()) {
+        VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "Unable to initialize forensic database cache.\n");
+        goto fail;
+    }
     if(!FcInitialize_SetPath(dwDatabaseType)) {
         VmmLog(MID_FORENSIC, LOGLEVEL_WARNING, "Unable to set Sqlite path.\n");
         goto fail;
@@ -906,7 +2458,18 @@ BOOL FcInitialize_Impl(_In_ DWORD dwDatabaseType, _In_ BOOL fForceReInit)
     ctxFc->db.fSingleThread = TRUE;     // single thread during INSERT-bound init phase
     for(i = 0; i < FC_SQL_POOL_CONNECTION_NUM; i++) {
         if(!(ctxFc->db.hEvent[i] = CreateEvent(NULL, FALSE, TRUE, NULL))) { goto fail; }
+        if(ctxFc->Cache.fReuse) {
+            // reuse persisted forensic database cache - open read-only.
+            if(SQLITE_OK != sqlite3_open_v2(ctxFc->db.szuDatabase, &ctxFc->db.hSql[i], SQLITE_OPEN_URI | SQLITE_OPEN_READONLY | SQLITE_OPEN_SHAREDCACHE | SQLITE_OPEN_NOMUTEX, NULL)) { goto fail; }
+            continue;
+        }
         if(SQLITE_OK != sqlite3_open_v2(ctxFc->db.szuDatabase, &ctxFc->db.hSql[i], SQLITE_OPEN_URI | SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_SHAREDCACHE | SQLITE_OPEN_NOMUTEX, NULL)) { goto fail; }
+        if(ctxMain->cfg.fForensicIngestRelaxed && (ctxFc->db.tp != FC_DATABASE_TYPE_MEMORY)) {
+            // relaxed durability during the insert-bound init phase - a database
+            // interrupted during ingest is incomplete and unusable regardless.
+            sqlite3_exec(ctxFc->db.hSql[i], "PRAGMA synchronous = OFF; PRAGMA journal_mode = MEMORY; PRAGMA cache_size = -65536;", NULL, NULL, NULL);
+            ctxFc->db.fIngestRelaxed = TRUE;
+        }
     }
     VmmWork((LPTHREAD_START_ROUTINE)FcInitialize_ThreadProc, NULL, 0);
     ctxFc->fInitStart = TRUE;
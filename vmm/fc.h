@@ -20,7 +20,14 @@
 #include "sqlite/sqlite3.h"
 
 #define FC_SQL_POOL_CONNECTION_NUM          4
+#define FC_SQL_STMT_CACHE_NUM               32          // cached prepared statements per connection
+#define FC_SQL_STR_BULK_ROWS                32          // rows per multi-row 'str' table insert
+#define FC_SQL_STR_BULK_BUFFER              0x00100000  // text buffer for pending 'str' table rows
+#define FC_SQL_TRANSACTION_ROWS_MAX         0x00100000  // commit bulk transaction after # rows
+#define FC_SQL_TRANSACTION_BYTES_MAX        0x10000000  // commit bulk transaction after # bytes
 #define FC_PHYSMEM_NUM_CHUNKS               0x1000
+#define FC_PHYSMEM_PIPELINE_DEPTH_DEFAULT   4
+#define FC_PHYSMEM_PIPELINE_DEPTH_MAX       16
 
 typedef struct tdFCSQL_INSERTSTRTABLE {
     QWORD id;
@@ -28,6 +35,70 @@ typedef struct tdFCSQL_INSERTSTRTABLE {
     DWORD cbj;      // JSON byte count (excl. NULL)
 } FCSQL_INSERTSTRTABLE, *PFCSQL_INSERTSTRTABLE;
 
+typedef struct tdFCSQL_STMT_CACHE_ENTRY {
+    LPCSTR szSql;
+    sqlite3_stmt *hStmt;
+    QWORD qwTickLastUse;
+    QWORD qwReserve;            // connection reservation in which statement was last retrieved
+} FCSQL_STMT_CACHE_ENTRY, *PFCSQL_STMT_CACHE_ENTRY;
+
+typedef struct tdFCSQL_STR_BULK_ENTRY {
+    QWORD id;
+    DWORD cbu;
+    DWORD cbj;
+    DWORD oText;                // offset of utf-8 text in bulk text buffer
+} FCSQL_STR_BULK_ENTRY, *PFCSQL_STR_BULK_ENTRY;
+
+typedef struct tdFCSQL_CONNECTION {
+    QWORD qwTick;               // statement cache use counter
+    QWORD qwReserve;            // reservation counter - statements retrieved in the current reservation are never evicted
+    FCSQL_STMT_CACHE_ENTRY Stmt[FC_SQL_STMT_CACHE_NUM];
+    POB_SET psObStmtOverflow;   // uncached statements (cache full) - finalized when the connection is returned
+    BOOL fTransaction;          // bulk transaction started by Fc_SqlTransactionBegin()
+    QWORD cTransactionRow;
+    QWORD cbTransaction;
+    DWORD cStr;                 // pending 'str' rows
+    DWORD cbStr;                // pending 'str' text bytes
+    FCSQL_STR_BULK_ENTRY Str[FC_SQL_STR_BULK_ROWS];
+    PBYTE pbStr;                // FC_SQL_STR_BULK_BUFFER text buffer
+} FCSQL_CONNECTION, *PFCSQL_CONNECTION;
+
+#define FC_CACHE_VERSION                    1
+#define FC_CACHE_FINGERPRINT_SAMPLES        64
+#define FC_CACHE_FINGERPRINT_HASH_SIZE      16      // bytes of sha256 used in cache file names
+
+#define FC_TIMELINE_INDEX_MAGIC             0x3158444e494c5446  // 'FTLINDX1'
+#define FC_TIMELINE_INDEX_VERSION           1
+
+typedef struct tdFC_TIMELINE_INDEX_RECORD {
+    QWORD ft;
+    QWORD data64;
+    QWORD oStr;                 // offset of null-terminated utf-8 text in string pool
+    QWORD oLnU;                 // cumulative utf-8 text offset in 'all' timeline file
+    QWORD oLnUtp;               // cumulative utf-8 text offset in per-type timeline file
+    DWORD tp;
+    DWORD ac;
+    DWORD pid;
+    DWORD data32;
+    DWORD cbu;                  // utf-8 text byte count (excl. null terminator)
+    DWORD _Filler;
+} FC_TIMELINE_INDEX_RECORD, *PFC_TIMELINE_INDEX_RECORD;
+
+typedef struct tdFC_TIMELINE_INDEX_HEADER {
+    QWORD qwMagic;
+    DWORD dwVersion;
+    DWORD cTp;
+    QWORD cRecord;
+    QWORD oRecord;              // file offset of FC_TIMELINE_INDEX_RECORD[cRecord] in 'all' order
+    QWORD oStr;                 // file offset of string pool
+    QWORD cbStr;
+    QWORD cbFile;
+    struct {
+        QWORD o;                // file offset of DWORD[c] record indexes of type
+        QWORD c;
+    } Tp[];                     // per-type record indexes (Tp[0] unused)
+} FC_TIMELINE_INDEX_HEADER, *PFC_TIMELINE_INDEX_HEADER;
+
 typedef struct tdFC_TIMELINE_INFO {
     DWORD dwId;
     DWORD dwFileSizeUTF8;
@@ -48,16 +119,50 @@ typedef struct tdFC_CONTEXT {
         BOOL fSingleThread;                 // enforce single-thread access (used during insert-bound init phase)
         HANDLE hEvent[FC_SQL_POOL_CONNECTION_NUM];
         sqlite3 *hSql[FC_SQL_POOL_CONNECTION_NUM];
+        FCSQL_CONNECTION Conn[FC_SQL_POOL_CONNECTION_NUM];
         QWORD qwIdStr;
+        volatile QWORD cInsertRow;          // rows inserted by bulk ingest (statistics)
+        QWORD tmIngestStart;                // performance counter at start of ingest (statistics)
+        QWORD tmIngestEnd;                  // performance counter at end of ingest (statistics)
+        BOOL fIngestRelaxed;                // relaxed durability pragmas active (-forensic-ingest-relaxed)
     } db;
     struct {
         DWORD cTp;
         PFC_TIMELINE_INFO pInfo;    // array of cTp items
+        struct {
+            CHAR szPath[MAX_PATH];
+            PFC_TIMELINE_INDEX_HEADER pHdr;     // memory-mapped index file (NULL if not available)
+            QWORD cb;
+            BOOL fKeep;                         // keep index file on close (forensic database cache)
+#ifdef _WIN32
+            HANDLE hFile;
+            HANDLE hMap;
+#endif /* _WIN32 */
+        } Index;
     } Timeline;
+    struct {
+        BOOL fEnabled;                      // persisted forensic database cache enabled (-forensic-cache)
+        BOOL fReuse;                        // reuse previously generated cache (database opened read-only)
+        CHAR szFingerprint[2 * FC_CACHE_FINGERPRINT_HASH_SIZE + 1];
+        CHAR uszPathBase[MAX_PATH];         // cache file path excluding extension
+    } Cache;
+    struct {
+        DWORD cDepth;                       // pipeline depth (number of 16MB chunks in flight)
+        volatile QWORD cbRead;              // bytes read and ingested
+        volatile QWORD cbSkip;              // bytes skipped (free/zero pages only)
+        volatile QWORD tmPfn;               // performance counter ticks - pfn stage
+        volatile QWORD tmRead;              // performance counter ticks - read stage
+        QWORD tmIngest;                     // performance counter ticks - ingest stage
+        QWORD tmStart;
+        QWORD tmEnd;
+    } PhysmemScan;
     struct {
         POB_MEMFILE pGen;
         POB_MEMFILE pGenVerbose;
         POB_MEMFILE pReg;
+        SRWLOCK LockSRW;                    // lock for per-thread json line buffer list
+        struct tdFCJSON_THREAD_BUFFER *pThreadBufferFirst;
+        BOOL fThreadBufferDisable;          // json log phase ended - lines are appended directly
     } FileJSON;
 } FC_CONTEXT, *PFC_CONTEXT;
 
@@ -97,6 +202,15 @@ BOOL FcInitialize(_In_ DWORD dwDatabaseType, _In_ BOOL fForceReInit);
 */
 VOID FcClose();
 
+/*
+* Retrieve the physical memory scan pipeline statistics (pipeline depth,
+* scanned/skipped MB and MB/s per stage) as a human readable string.
+* -- sz = buffer to receive the statistics (or NULL to retrieve size only).
+* -- cch
+* -- return = number of characters (excl. NULL).
+*/
+DWORD FcScanPhysmem_StatisticsToString(_Out_writes_opt_(cch) LPSTR sz, _In_ DWORD cch);
+
 
 
 // ----------------------------------------------------------------------------
@@ -150,18 +264,56 @@ int Fc_SqlQueryN(
     _Out_opt_ PDWORD pcResultValues
 );
 
+/*
+* Retrieve a prepared statement from the per-connection statement cache. The
+* statement is prepared on first use and is reset and has its bindings cleared
+* when retrieved. The statement is owned by the cache and must not be finalized
+* by the caller; it remains valid as long as the connection is reserved - it is
+* never evicted from the cache before the connection is returned.
+* -- hSql = reserved SQLITE database handle.
+* -- szSql = SQL statement (should be a static string).
+* -- return = the prepared statement, or NULL on error.
+*/
+_Success_(return != NULL)
+sqlite3_stmt* Fc_SqlPrepareCached(_In_ sqlite3 *hSql, _In_ LPCSTR szSql);
+
+/*
+* Begin a bulk ingest transaction on a reserved connection. Rows inserted with
+* Fc_SqlInsertStr() and Fc_SqlInsertStep() are batched and the transaction is
+* committed (and re-opened) automatically when exceeding the row/byte budget.
+* -- hSql
+*/
+VOID Fc_SqlTransactionBegin(_In_ sqlite3 *hSql);
+
+/*
+* Flush pending bulk rows and commit a transaction previously started with
+* Fc_SqlTransactionBegin().
+* -- hSql
+*/
+VOID Fc_SqlTransactionCommit(_In_ sqlite3 *hSql);
+
+/*
+* Step a bound INSERT statement as part of a bulk ingest transaction.
+* -- hSql
+* -- hStmt
+* -- return = sqlite return code.
+*/
+int Fc_SqlInsertStep(_In_ sqlite3 *hSql, _In_ sqlite3_stmt *hStmt);
+
 /*
 * Helper function to insert a string into the database 'str' table.
 * Wide-Char string must not exceed 2048 characters. Only one of utf-8
 * and wide-char string is inserted (preferential treatment to utf-8).
-* -- hStmt
+* Inside a bulk transaction the row is buffered and inserted by multi-row
+* insert - the string id is however assigned immediately.
+* -- hSql = reserved SQLITE database handle.
 * -- usz = utf-8 string to be inserted
 * -- pThis
 * -- return
 */
 _Success_(return)
 BOOL Fc_SqlInsertStr(
-    _In_ sqlite3_stmt *hStmt,
+    _In_ sqlite3 *hSql,
     _In_ LPSTR usz,
     _Out_ PFCSQL_INSERTSTRTABLE pThis
 );
@@ -246,6 +398,37 @@ BOOL FcTimelineMap_GetFromIdRange(
     _Out_ PFCOB_MAP_TIMELINE *ppObTimelineMap
 );
 
+/*
+* Retrieve the index of the timeline entry containing a utf-8 file position in
+* a timeline file by binary search in the memory-mapped timeline index.
+* -- dwTimelineType = the timeline type, 0 for all.
+* -- qwFilePos = the utf-8 file position.
+* -- piEntry = pointer to receive the 0-based entry index within the file.
+* -- return = FALSE if the index is unavailable or position is out of range.
+*/
+_Success_(return)
+BOOL FcTimelineIndex_GetFromPosition(
+    _In_ DWORD dwTimelineType,
+    _In_ QWORD qwFilePos,
+    _Out_ PQWORD piEntry
+);
+
+/*
+* Retrieve a timeline entry from the memory-mapped timeline index. The text of
+* the entry points into the index and is valid until the forensic sub-system
+* is closed.
+* -- dwTimelineType = the timeline type, 0 for all.
+* -- iEntry = the 0-based entry index within the timeline file.
+* -- pe = entry to populate, cuszOffset is the utf-8 offset in the file.
+* -- return
+*/
+_Success_(return)
+BOOL FcTimelineIndex_GetEntry(
+    _In_ DWORD dwTimelineType,
+    _In_ QWORD iEntry,
+    _Out_ PFC_MAP_TIMELINEENTRY pe
+);
+
 /*
 * Retrieve the minimum timeline id that exists within a byte range inside a
 * timeline file of a specific type.
@@ -11,6 +11,19 @@
 
 #define INFODB_SQL_POOL_CONNECTION_NUM          4
 
+#define INFODB_SYMCACHE_SYMBOL_OFFSET           1
+#define INFODB_SYMCACHE_TYPE_SIZE               2
+
+typedef struct tdINFODB_SYMCACHE {
+    BOOL fFail;                         // bulk load failed - lookups fall back to sqlite queries
+    DWORD cSlotMask;
+    DWORD cEntries;
+    struct {
+        QWORD qwHash;                   // 0 = empty slot
+        QWORD qwData;
+    } Slot[0];
+} INFODB_SYMCACHE, *PINFODB_SYMCACHE;
+
 typedef struct tdOB_INFODB_CONTEXT {
     OB ObHdr;
     DWORD dwPdbId_NT;
@@ -18,6 +31,9 @@ typedef struct tdOB_INFODB_CONTEXT {
     BOOL fPdbId_TcpIp_TryComplete;
     HANDLE hEvent[INFODB_SQL_POOL_CONNECTION_NUM];
     sqlite3 *hSql[INFODB_SQL_POOL_CONNECTION_NUM];
+    SRWLOCK LockSRW;
+    POB_MAP pmSymCache;                 // ((INFODB_SYMCACHE_* << 32) | pdbid) -> PINFODB_SYMCACHE
+    POB_MAP pmTypeChild;                // type_child hash -> QWORD ((fFound << 32) | offset)
 } OB_INFODB_CONTEXT, *POB_INFODB_CONTEXT;
 
 
@@ -186,6 +202,136 @@ DWORD InfoDB_EnsureTcpIp(_In_ POB_INFODB_CONTEXT ctx)
 
 
 
+// ----------------------------------------------------------------------------
+// SYMBOL CACHE FUNCTIONALITY BELOW:
+// Symbol offsets and type sizes of a PDB are bulk loaded into an in-memory
+// hash table on first use and are looked up without SQLITE queries after
+// that. Rows belonging to a PDB are located in the hash range:
+// [dwPdbId << 32, (dwPdbId + 1) << 32).
+// A failed bulk load is remembered (as an entry with fFail set) so that it is
+// not retried under the exclusive lock on every subsequent lookup.
+// ----------------------------------------------------------------------------
+
+/*
+* Bulk load all rows belonging to a PDB from a symbol table into a new hash table.
+* CALLER LocalFree: return
+* -- ctx
+* -- szTable = 'symbol_offset' or 'type_size'.
+* -- dwPdbId
+* -- return
+*/
+PINFODB_SYMCACHE InfoDB_SymCache_Load(_In_ POB_INFODB_CONTEXT ctx, _In_ LPSTR szTable, _In_ DWORD dwPdbId)
+{
+    int rc;
+    QWORD qwHash, qwCount = 0, qwRange[2];
+    DWORD i, cSlot = 0x100;
+    CHAR szSql[MAX_PATH];
+    PINFODB_SYMCACHE pc = NULL;
+    sqlite3 *hSql = NULL;
+    sqlite3_stmt *hStmt = NULL;
+    qwRange[0] = (QWORD)dwPdbId << 32;
+    qwRange[1] = (QWORD)(dwPdbId + 1) << 32;
+    // 1: count rows and allocate table (load factor <= 50%)
+    _snprintf_s(szSql, sizeof(szSql), _TRUNCATE, "SELECT count(*) FROM %s WHERE hash >= ? AND hash < ?", szTable);
+    if(SQLITE_OK != InfoDB_SqlQueryN(ctx, szSql, 2, qwRange, 1, &qwCount, NULL)) { goto fail; }
+    if(qwCount > 0x01000000) { goto fail; }
+    while(cSlot < 2 * qwCount) { cSlot <<= 1; }
+    if(!(pc = LocalAlloc(LMEM_ZEROINIT, sizeof(INFODB_SYMCACHE) + cSlot * sizeof(pc->Slot[0])))) { goto fail; }
+    pc->cSlotMask = cSlot - 1;
+    // 2: load rows
+    if(!(hSql = InfoDB_SqlReserve(ctx))) { goto fail; }
+    _snprintf_s(szSql, sizeof(szSql), _TRUNCATE, "SELECT hash, data FROM %s WHERE hash >= ? AND hash < ?", szTable);
+    rc = sqlite3_prepare_v2(hSql, szSql, -1, &hStmt, 0);
+    if(rc != SQLITE_OK) { goto fail; }
+    sqlite3_bind_int64(hStmt, 1, qwRange[0]);
+    sqlite3_bind_int64(hStmt, 2, qwRange[1]);
+    while((SQLITE_ROW == (rc = sqlite3_step(hStmt))) && (pc->cEntries < cSlot / 2)) {
+        qwHash = sqlite3_column_int64(hStmt, 0);
+        if(!qwHash) { continue; }
+        for(i = (DWORD)qwHash & pc->cSlotMask; pc->Slot[i].qwHash && (pc->Slot[i].qwHash != qwHash); i = (i + 1) & pc->cSlotMask);
+        if(!pc->Slot[i].qwHash) { pc->cEntries++; }
+        pc->Slot[i].qwHash = qwHash;
+        pc->Slot[i].qwData = sqlite3_column_int64(hStmt, 1);
+    }
+    if(rc != SQLITE_DONE) { goto fail; }
+    sqlite3_finalize(hStmt);
+    InfoDB_SqlReserveReturn(ctx, hSql);
+    VmmLog(MID_INFODB, LOGLEVEL_DEBUG, "SYMCACHE: LOAD table=%s pdb=%i entries=%i", szTable, dwPdbId, pc->cEntries);
+    return pc;
+fail:
+    sqlite3_finalize(hStmt);
+    InfoDB_SqlReserveReturn(ctx, hSql);
+    LocalFree(pc);
+    return NULL;
+}
+
+/*
+* Retrieve the symbol cache hash table for a table/PDB. The table is bulk
+* loaded on first use.
+* -- ctx
+* -- dwTable = INFODB_SYMCACHE_*
+* -- dwPdbId
+* -- return = the hash table (valid for the lifetime of ctx), or NULL on fail.
+*/
+PINFODB_SYMCACHE InfoDB_SymCache_Get(_In_ POB_INFODB_CONTEXT ctx, _In_ DWORD dwTable, _In_ DWORD dwPdbId)
+{
+    PINFODB_SYMCACHE pc;
+    QWORD qwKey = ((QWORD)dwTable << 32) | dwPdbId;
+    if(!(pc = ObMap_GetByKey(ctx->pmSymCache, qwKey))) {
+        AcquireSRWLockExclusive(&ctx->LockSRW);
+        if(!(pc = ObMap_GetByKey(ctx->pmSymCache, qwKey))) {
+            pc = InfoDB_SymCache_Load(ctx, ((dwTable == INFODB_SYMCACHE_SYMBOL_OFFSET) ? "symbol_offset" : "type_size"), dwPdbId);
+            if(!pc && (pc = LocalAlloc(LMEM_ZEROINIT, sizeof(INFODB_SYMCACHE)))) {
+                VmmLog(MID_INFODB, LOGLEVEL_DEBUG, "SYMCACHE: LOAD FAIL pdb=%i table=%i", dwPdbId, dwTable);
+                pc->fFail = TRUE;
+            }
+            if(pc && !ObMap_Push(ctx->pmSymCache, qwKey, pc)) {
+                LocalFree(pc);
+                pc = NULL;
+            }
+        }
+        ReleaseSRWLockExclusive(&ctx->LockSRW);
+    }
+    return (pc && !pc->fFail) ? pc : NULL;
+}
+
+/*
+* Look up a hash in the symbol cache. If the symbol cache is unavailable the
+* lookup falls back to a single SQLITE query.
+* -- ctx
+* -- dwTable = INFODB_SYMCACHE_*
+* -- dwPdbId
+* -- qwHash
+* -- pdwData
+* -- return
+*/
+_Success_(return)
+BOOL InfoDB_SymCache_Lookup(_In_ POB_INFODB_CONTEXT ctx, _In_ DWORD dwTable, _In_ DWORD dwPdbId, _In_ QWORD qwHash, _Out_ PDWORD pdwData)
+{
+    DWORD i;
+    QWORD qwResult = 0;
+    PINFODB_SYMCACHE pc;
+    if((pc = InfoDB_SymCache_Get(ctx, dwTable, dwPdbId))) {
+        for(i = (DWORD)qwHash & pc->cSlotMask; pc->Slot[i].qwHash; i = (i + 1) & pc->cSlotMask) {
+            if(pc->Slot[i].qwHash == qwHash) {
+                InterlockedIncrement64(&ctxVmm->stat.cInfoDbCacheHit);
+                *pdwData = (DWORD)pc->Slot[i].qwData;
+                return TRUE;
+            }
+        }
+        InterlockedIncrement64(&ctxVmm->stat.cInfoDbCacheNotFound);
+        return FALSE;
+    }
+    InterlockedIncrement64(&ctxVmm->stat.cInfoDbCacheMiss);
+    if(SQLITE_OK == InfoDB_SqlQueryN(ctx, ((dwTable == INFODB_SYMCACHE_SYMBOL_OFFSET) ? "SELECT data FROM symbol_offset WHERE hash = ?" : "SELECT data FROM type_size WHERE hash = ?"), 1, &qwHash, 1, &qwResult, NULL)) {
+        *pdwData = (DWORD)qwResult;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+
+
 // ----------------------------------------------------------------------------
 // INFO QUERY FUNCTIONALITY BELOW:
 // ----------------------------------------------------------------------------
@@ -221,7 +367,7 @@ BOOL InfoDB_SymbolOffset(_In_ LPSTR szModule, _In_ LPSTR szSymbolName, _Out_ PDW
 {
     BOOL fResult = FALSE;
     POB_INFODB_CONTEXT pObCtx = NULL;
-    QWORD qwHash, qwResult = 0, qwPdbId = 0;
+    QWORD qwHash, qwPdbId = 0;
     *pdwSymbolOffset = 0;
     if(!(pObCtx = ObContainer_GetOb(ctxVmm->pObCInfoDB))) { goto fail; }
     if(!strcmp(szModule, "nt") || !strcmp(szModule, "ntoskrnl")) {
@@ -231,10 +377,7 @@ BOOL InfoDB_SymbolOffset(_In_ LPSTR szModule, _In_ LPSTR szSymbolName, _Out_ PDW
     }
     if(!qwPdbId) { goto fail; }
     qwHash = CharUtil_Hash32A(szSymbolName, FALSE) + (qwPdbId << 32);
-    if(SQLITE_OK == InfoDB_SqlQueryN(pObCtx, "SELECT data FROM symbol_offset WHERE hash = ?", 1, &qwHash, 1, &qwResult, NULL)) {
-        *pdwSymbolOffset = (DWORD)qwResult;
-        fResult = TRUE;
-    }
+    fResult = InfoDB_SymCache_Lookup(pObCtx, INFODB_SYMCACHE_SYMBOL_OFFSET, (DWORD)qwPdbId, qwHash, pdwSymbolOffset);
 fail:
     Ob_DECREF(pObCtx);
     return fResult;
@@ -316,14 +459,11 @@ BOOL InfoDB_TypeSize(_In_ LPSTR szModule, _In_ LPSTR szTypeName, _Out_ PDWORD pd
 {
     BOOL fResult = FALSE;
     POB_INFODB_CONTEXT pObCtx = NULL;
-    QWORD qwHash, qwResult = 0;
+    QWORD qwHash;
     if(strcmp(szModule, "nt") && strcmp(szModule, "ntoskrnl")) { goto fail; }
     if(!(pObCtx = ObContainer_GetOb(ctxVmm->pObCInfoDB)) || !pObCtx->dwPdbId_NT) { goto fail; }
     qwHash = CharUtil_Hash32A(szTypeName, FALSE) + ((QWORD)pObCtx->dwPdbId_NT << 32);
-    if(SQLITE_OK == InfoDB_SqlQueryN(pObCtx, "SELECT data FROM type_size WHERE hash = ?", 1, &qwHash, 1, &qwResult, NULL)) {
-        *pdwTypeSize = (DWORD)qwResult;
-        fResult = TRUE;
-    }
+    fResult = InfoDB_SymCache_Lookup(pObCtx, INFODB_SYMCACHE_TYPE_SIZE, pObCtx->dwPdbId_NT, qwHash, pdwTypeSize);
 fail:
     Ob_DECREF(pObCtx);
     return fResult;
@@ -344,16 +484,31 @@ BOOL InfoDB_TypeChildOffset(_In_ LPSTR szModule, _In_ LPSTR szTypeName, _In_ LPS
     BOOL fResult = FALSE;
     POB_INFODB_CONTEXT pObCtx = NULL;
     QWORD qwHash, qwHash1, qwHash2, qwResult = 0;
+    PQWORD pqwCached;
     if(strcmp(szModule, "nt") && strcmp(szModule, "ntoskrnl")) { goto fail; }
     if(!(pObCtx = ObContainer_GetOb(ctxVmm->pObCInfoDB)) || !pObCtx->dwPdbId_NT) { goto fail; }
     qwHash1 = CharUtil_Hash32A(szTypeName, FALSE);
     qwHash2 = CharUtil_Hash32U(uszTypeChildName, FALSE);
     qwHash = ((qwHash2 << 32) + qwHash1 + ((QWORD)pObCtx->dwPdbId_NT << 32)) & 0x7fffffffffffffff;
+    // type child hashes mix the pdb id with the child name hash and can't be
+    // bulk loaded per pdb - results (incl. misses) are memoized on first use.
+    if((pqwCached = ObMap_GetByKey(pObCtx->pmTypeChild, qwHash))) {
+        *pdwTypeOffset = (DWORD)*pqwCached;
+        fResult = (*pqwCached >> 32) ? TRUE : FALSE;
+        if(fResult) {
+            InterlockedIncrement64(&ctxVmm->stat.cInfoDbCacheHit);
+        } else {
+            InterlockedIncrement64(&ctxVmm->stat.cInfoDbCacheNotFound);
+        }
+        goto fail;
+    }
+    InterlockedIncrement64(&ctxVmm->stat.cInfoDbCacheMiss);
     if(SQLITE_OK == InfoDB_SqlQueryN(pObCtx, "SELECT data FROM type_child WHERE hash = ?", 1, &qwHash, 1, &qwResult, NULL)) {
         *pdwTypeOffset = (DWORD)qwResult;
         fResult = TRUE;
     }
-
+    qwResult = ((QWORD)fResult << 32) | (DWORD)qwResult;
+    ObMap_PushCopy(pObCtx->pmTypeChild, qwHash, &qwResult, sizeof(QWORD));
 fail:
     Ob_DECREF(pObCtx);
     return fResult;
@@ -401,6 +556,8 @@ VOID InfoDB_Context_CleanupCB(POB_INFODB_CONTEXT pOb)
         }
         if(pOb->hSql[i]) { sqlite3_close(pOb->hSql[i]); }
     }
+    Ob_DECREF(pOb->pmSymCache);
+    Ob_DECREF(pOb->pmTypeChild);
 }
 
 VOID InfoDB_Initialize_DoWork()
@@ -410,6 +567,8 @@ VOID InfoDB_Initialize_DoWork()
     CHAR szDbPathFile[MAX_PATH] = { 0 };
     // 1: INIT
     if(!(pObCtx = Ob_Alloc(OB_TAG_INFODB_CTX, LMEM_ZEROINIT, sizeof(OB_INFODB_CONTEXT), (OB_CLEANUP_CB)InfoDB_Context_CleanupCB, NULL))) { goto fail; }
+    if(!(pObCtx->pmSymCache = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
+    if(!(pObCtx->pmTypeChild = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
     // 2: SQLITE INIT:
     Util_GetPathLib(szDbPathFile);
     strncat_s(szDbPathFile, sizeof(szDbPathFile), "info.db", _TRUNCATE);
@@ -35,10 +35,11 @@
 NTSTATUS MConf_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
     DWORD cchBuffer;
-    CHAR szBuffer[0x800];
+    CHAR szBuffer[0x1000];
     DWORD cbCallStatistics = 0;
     LPSTR szCallStatistics = NULL;
     QWORD cPageReadTotal, cPageFailTotal;
+    QWORD cHitPHYS, cMissPHYS, cHitTLB, cMissTLB, cHitPAGING, cMissPAGING;
     NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
     if(!_stricmp(ctx->uszPath, "config_process_show_terminated.txt")) {
         return Util_VfsReadFile_FromBOOL(ctxVmm->flags & VMM_FLAG_PROCESS_SHOW_TERMINATED, pb, cb, pcbRead, cbOffset);
@@ -73,10 +74,19 @@ NTSTATUS MConf_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRea
     if(!_stricmp(ctx->uszPath, "config_refresh_registry.txt")) {
         return Util_VfsReadFile_FromDWORD(ctxVmm->ThreadProcCache.cTick_Slow, pb, cb, pcbRead, cbOffset, FALSE);
     }
+    if(!_stricmp(ctx->uszPath, "config_readahead_trigger.txt")) {
+        return Util_VfsReadFile_FromDWORD(ctxVmm->Cache.ReadStream.cTrigger, pb, cb, pcbRead, cbOffset, FALSE);
+    }
+    if(!_stricmp(ctx->uszPath, "config_readahead_size.txt")) {
+        return Util_VfsReadFile_FromDWORD(ctxVmm->Cache.ReadStream.cbReadAhead, pb, cb, pcbRead, cbOffset, FALSE);
+    }
     if(!_stricmp(ctx->uszPath, "statistics.txt")) {
+        VmmCacheStatistics(VMM_CACHE_TAG_PHYS, &cHitPHYS, &cMissPHYS);
+        VmmCacheStatistics(VMM_CACHE_TAG_TLB, &cHitTLB, &cMissTLB);
+        VmmCacheStatistics(VMM_CACHE_TAG_PAGING, &cHitPAGING, &cMissPAGING);
         cPageReadTotal = ctxVmm->stat.page.cPrototype + ctxVmm->stat.page.cTransition + ctxVmm->stat.page.cDemandZero + ctxVmm->stat.page.cVAD + ctxVmm->stat.page.cCacheHit + ctxVmm->stat.page.cPageFile + ctxVmm->stat.page.cCompressed;
         cPageFailTotal = ctxVmm->stat.page.cFailCacheHit + ctxVmm->stat.page.cFailVAD + ctxVmm->stat.page.cFailPageFile + ctxVmm->stat.page.cFailCompressed + ctxVmm->stat.page.cFail;
-        cchBuffer = snprintf(szBuffer, 0x800,
+        cchBuffer = snprintf(szBuffer, sizeof(szBuffer),
             "VMM STATISTICS   (4kB PAGES / COUNTS - HEXADECIMAL)\n" \
             "===================================================\n" \
             "PHYSICAL MEMORY:                      \n" \
@@ -84,6 +94,9 @@ NTSTATUS MConf_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRea
             "  READ RETRIEVED:               %16llx\n" \
             "  READ FAIL:                    %16llx\n" \
             "  WRITE:                        %16llx\n" \
+            "  READ-AHEAD READ:              %16llx\n" \
+            "  READ-AHEAD USED:              %16llx\n" \
+            "  READ-AHEAD WASTED:            %16llx\n" \
             "PAGED VIRTUAL MEMORY:                 \n" \
             "  READ SUCCESS:                 %16llx\n" \
             "    Prototype:                  %16llx\n" \
@@ -102,14 +115,26 @@ NTSTATUS MConf_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRea
             "  CACHE HIT:                    %16llx\n" \
             "  RETRIEVED:                    %16llx\n" \
             "  FAILED:                       %16llx\n" \
+            "  VIRT2PHYS CACHE HIT:          %16llx\n" \
+            "CACHE ENTRIES (HIT / MISS / EVICT / EXPIRE):\n" \
+            "  PHYS:   %16llx %16llx %16llx %16llx\n" \
+            "  TLB:    %16llx %16llx %16llx %16llx\n" \
+            "  PAGING: %16llx %16llx %16llx %16llx\n" \
+            "INFODB SYMBOL CACHE (HIT / NOT FOUND / MISS):\n" \
+            "  LOOKUP: %16llx %16llx %16llx\n" \
             "PHYSICAL MEMORY REFRESH:        %16llx\n" \
             "TLB MEMORY REFRESH:             %16llx\n" \
             "PROCESS PARTIAL REFRESH:        %16llx\n" \
             "PROCESS FULL REFRESH:           %16llx\n",
             ctxVmm->stat.cPhysCacheHit, ctxVmm->stat.cPhysReadSuccess, ctxVmm->stat.cPhysReadFail, ctxVmm->stat.cPhysWrite,
+            ctxVmm->stat.cPhysReadAheadRead, ctxVmm->stat.cPhysReadAheadUsed, ctxVmm->stat.cPhysReadAheadWasted,
             cPageReadTotal, ctxVmm->stat.page.cPrototype, ctxVmm->stat.page.cTransition, ctxVmm->stat.page.cDemandZero, ctxVmm->stat.page.cVAD, ctxVmm->stat.page.cCacheHit, ctxVmm->stat.page.cPageFile, ctxVmm->stat.page.cCompressed,
             cPageFailTotal, ctxVmm->stat.page.cFailCacheHit, ctxVmm->stat.page.cFailVAD, ctxVmm->stat.page.cFailPageFile, ctxVmm->stat.page.cFailCompressed,
-            ctxVmm->stat.cTlbCacheHit, ctxVmm->stat.cTlbReadSuccess, ctxVmm->stat.cTlbReadFail,
+            ctxVmm->stat.cTlbCacheHit, ctxVmm->stat.cTlbReadSuccess, ctxVmm->stat.cTlbReadFail, ctxVmm->stat.cTlbVirt2PhysCacheHit,
+            cHitPHYS, cMissPHYS, ctxVmm->Cache.PHYS.cEvict, ctxVmm->Cache.PHYS.cExpire,
+            cHitTLB, cMissTLB, ctxVmm->Cache.TLB.cEvict, ctxVmm->Cache.TLB.cExpire,
+            cHitPAGING, cMissPAGING, ctxVmm->Cache.PAGING.cEvict, ctxVmm->Cache.PAGING.cExpire,
+            ctxVmm->stat.cInfoDbCacheHit, ctxVmm->stat.cInfoDbCacheNotFound, ctxVmm->stat.cInfoDbCacheMiss,
             ctxVmm->stat.cPhysRefreshCache, ctxVmm->stat.cTlbRefreshCache, ctxVmm->stat.cProcessRefreshPartial, ctxVmm->stat.cProcessRefreshFull
         );
         return Util_VfsReadFile_FromPBYTE(szBuffer, cchBuffer, pb, cb, pcbRead, cbOffset);
@@ -228,6 +253,12 @@ NTSTATUS MConf_Write(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _In_reads_(cb) PBYTE pb, _
         VmmWinReg_Refresh();
         return Util_VfsWriteFile_DWORD(&ctxVmm->ThreadProcCache.cTick_Slow, pb, cb, pcbWrite, cbOffset, 1, 0);
     }
+    if(!_stricmp(ctx->uszPath, "config_readahead_trigger.txt")) {
+        return Util_VfsWriteFile_DWORD(&ctxVmm->Cache.ReadStream.cTrigger, pb, cb, pcbWrite, cbOffset, 0, 0);
+    }
+    if(!_stricmp(ctx->uszPath, "config_readahead_size.txt")) {
+        return Util_VfsWriteFile_DWORD(&ctxVmm->Cache.ReadStream.cbReadAhead, pb, cb, pcbWrite, cbOffset, 0, VMM_READSTREAM_SIZE_MAX);
+    }
     if(!_stricmp(ctx->uszPath, "config_fileinfoheader_enable.txt")) {
         Util_VfsWriteFile_BOOL(&ctxMain->cfg.fFileInfoHeader, pb, cb, pcbWrite, cbOffset);
     }
@@ -294,11 +325,13 @@ BOOL MConf_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
         VMMDLL_VfsList_AddFile(pFileList, "config_refresh_proc_partial.txt", 8, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_refresh_proc_total.txt", 8, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_refresh_registry.txt", 8, NULL);
+        VMMDLL_VfsList_AddFile(pFileList, "config_readahead_trigger.txt", 8, NULL);
+        VMMDLL_VfsList_AddFile(pFileList, "config_readahead_size.txt", 8, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_symbol_enable.txt", 1, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_symbolcache.txt", strlen(ctxMain->pdb.szLocal), NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_symbolserver.txt", strlen(ctxMain->pdb.szServer), NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_symbolserver_enable.txt", 1, NULL);
-        VMMDLL_VfsList_AddFile(pFileList, "statistics.txt", 1103, NULL);
+        VMMDLL_VfsList_AddFile(pFileList, "statistics.txt", 1979, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_printf_enable.txt", 1, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_printf_v.txt", 1, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_printf_vv.txt", 1, NULL);
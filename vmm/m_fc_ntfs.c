@@ -200,6 +200,8 @@ typedef struct tdFCNTFS {
         DWORD dwParentRecordNumber;
         WORD  wParentSeqenceNumber;
         struct tdFCNTFS *pNextDir;      // next directory with same RecordNumber (in case of multiple)
+        struct tdFCNTFS *pNextIngest;   // next ingested entry (in ingest order)
+        QWORD qwHashDuplicateCheck;
     } Setup;
     struct tdFCNTFS *pParent;           // parent entry [not counted as reference]
     struct tdFCNTFS *pChild;            // 1st child entry [not counted as reference]
@@ -212,18 +214,52 @@ typedef struct tdFCNTFS {
     CHAR uszName[0];
 } FCNTFS, *PFCNTFS;
 
+#define FCNTFS_ARENA_BLOCK_SIZE         0x00100000
+#define FCNTFS_TABLE_SIZE_INITIAL       0x00010000
+#define FCNTFS_INGEST_PARALLEL_MIN      8
+
+typedef struct tdFCNTFS_ARENA_BLOCK {
+    struct tdFCNTFS_ARENA_BLOCK *FLink;
+    volatile QWORD cbUsed;
+    QWORD _Filler;
+    BYTE pb[0];
+} FCNTFS_ARENA_BLOCK, *PFCNTFS_ARENA_BLOCK;
+
+typedef struct tdFCNTFS_TABLE_ENTRY {
+    QWORD qwKey;
+    PFCNTFS pe;                         // NULL == empty slot
+} FCNTFS_TABLE_ENTRY, *PFCNTFS_TABLE_ENTRY;
+
+// open-addressed (linear probing) hash table: key -> PFCNTFS
+typedef struct tdFCNTFS_TABLE {
+    DWORD cSlot;                        // power of two
+    DWORD c;
+    PFCNTFS_TABLE_ENTRY pe;
+} FCNTFS_TABLE, *PFCNTFS_TABLE;
+
 typedef struct tdFCNTFS_SETUP_CONTEXT {
-    POB_MAP pmDuplicate;    // duplicate checks
-    POB_SET psRoot;         // root '.' entries
-    POB_SET psDirFile;      // non-root entries
-    POB_MAP pmDir;          // directory map
-    POB_SET psOrphan;       // orphan entries
+    FCNTFS_TABLE tDuplicate;            // duplicate checks: (record#, lsn) -> entry
+    FCNTFS_TABLE tDir;                  // directory table: record# -> 1st entry (pNextDir list)
+    POB_SET psRoot;                     // root '.' entries
+    POB_SET psDirFile;                  // non-root entries
+    POB_SET psOrphan;                   // orphan entries
+    struct {
+        SRWLOCK LockSRW;
+        PFCNTFS_ARENA_BLOCK volatile pBlock;
+    } Arena;
+    struct {
+        PFCNTFS pFirst;                 // ingested entries in ingest order (merged at finalize)
+        PFCNTFS pLast;
+        DWORD cPage;
+        QWORD pa[0x1000];
+        PBYTE pb[0x1000];
+        PFCNTFS pe[0x4000];             // 4 entries per candidate page
+    } Ingest;
 } FCNTFS_SETUP_CONTEXT, *PFCNTFS_SETUP_CONTEXT;
 
 typedef struct tdFCNTFS_FINALIZE_CONTEXT {
     sqlite3 *hSql;
     sqlite3_stmt *st;
-    sqlite3_stmt *st_str;
     QWORD cbUtf8Total;
     QWORD cbJsonTotal;
 } FCNTFS_FINALIZE_CONTEXT, *PFCNTFS_FINALIZE_CONTEXT;
@@ -245,18 +281,120 @@ typedef struct tdFCNTFS_FINALIZE_CONTEXT {
 //     working at the moment and provides the functionality needed.
 //-----------------------------------------------------------------------------
 
+/*
+* Allocate zero-initialized memory from the setup context bump arena. The
+* allocation is lock-free except when a new arena block is required. Arena
+* memory is only released when the setup context is closed.
+* -- ctx
+* -- cb
+* -- return
+*/
+PVOID FcNtfs_ArenaAlloc(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ DWORD cb)
+{
+    QWORD o;
+    PFCNTFS_ARENA_BLOCK pBlock, pBlockNew;
+    cb = (cb + 7) & ~7;
+    if(cb > FCNTFS_ARENA_BLOCK_SIZE) { return NULL; }
+    while(TRUE) {
+        if((pBlock = ctx->Arena.pBlock)) {
+            o = InterlockedAdd64(&pBlock->cbUsed, cb);
+            if(o <= FCNTFS_ARENA_BLOCK_SIZE) {
+                return pBlock->pb + o - cb;
+            }
+        }
+        AcquireSRWLockExclusive(&ctx->Arena.LockSRW);
+        if(pBlock == ctx->Arena.pBlock) {
+            if(!(pBlockNew = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS_ARENA_BLOCK) + FCNTFS_ARENA_BLOCK_SIZE))) {
+                ReleaseSRWLockExclusive(&ctx->Arena.LockSRW);
+                return NULL;
+            }
+            pBlockNew->FLink = pBlock;
+            ctx->Arena.pBlock = pBlockNew;
+        }
+        ReleaseSRWLockExclusive(&ctx->Arena.LockSRW);
+    }
+}
+
+/*
+* Retrieve the table slot of a key in a FCNTFS_TABLE. The returned slot is
+* either the slot holding the key or the empty slot where it should be added.
+* -- pt
+* -- qwKey
+* -- return
+*/
+PFCNTFS_TABLE_ENTRY FcNtfs_TableSlot(_In_ PFCNTFS_TABLE pt, _In_ QWORD qwKey)
+{
+    PFCNTFS_TABLE_ENTRY pe;
+    DWORD i = (DWORD)((qwKey * 0x9E3779B97F4A7C15) >> 32) & (pt->cSlot - 1);
+    while(TRUE) {
+        pe = pt->pe + i;
+        if(!pe->pe || (pe->qwKey == qwKey)) { return pe; }
+        i = (i + 1) & (pt->cSlot - 1);
+    }
+}
+
+/*
+* Retrieve the entry of a key from a FCNTFS_TABLE.
+* -- pt
+* -- qwKey
+* -- return = the entry or NULL if not found.
+*/
+PFCNTFS FcNtfs_TableGet(_In_ PFCNTFS_TABLE pt, _In_ QWORD qwKey)
+{
+    return pt->pe ? FcNtfs_TableSlot(pt, qwKey)->pe : NULL;
+}
+
+/*
+* Add a key/entry to a FCNTFS_TABLE. The table is grown to keep the load
+* factor below 50%.
+* -- pt
+* -- qwKey
+* -- pe
+* -- return = TRUE on success, FALSE if the key already exists or on fail.
+*/
+_Success_(return)
+BOOL FcNtfs_TablePush(_In_ PFCNTFS_TABLE pt, _In_ QWORD qwKey, _In_ PFCNTFS pe)
+{
+    DWORD i;
+    FCNTFS_TABLE tNew;
+    PFCNTFS_TABLE_ENTRY pSlot;
+    if(2 * (pt->c + 1) > pt->cSlot) {
+        tNew.c = pt->c;
+        tNew.cSlot = pt->cSlot ? (2 * pt->cSlot) : FCNTFS_TABLE_SIZE_INITIAL;
+        if(!(tNew.pe = LocalAlloc(LMEM_ZEROINIT, tNew.cSlot * sizeof(FCNTFS_TABLE_ENTRY)))) { return FALSE; }
+        for(i = 0; i < pt->cSlot; i++) {
+            if(pt->pe[i].pe) {
+                *FcNtfs_TableSlot(&tNew, pt->pe[i].qwKey) = pt->pe[i];
+            }
+        }
+        LocalFree(pt->pe);
+        *pt = tNew;
+    }
+    pSlot = FcNtfs_TableSlot(pt, qwKey);
+    if(pSlot->pe) { return FALSE; }
+    pSlot->qwKey = qwKey;
+    pSlot->pe = pe;
+    pt->c++;
+    return TRUE;
+}
+
 /*
 * Close and clean up PFCNTFS_SETUP_CONTEXT.
 * -- ctx
 */
 VOID FcNtfs_Close(_Frees_ptr_opt_ PFCNTFS_SETUP_CONTEXT ctx)
 {
+    PFCNTFS_ARENA_BLOCK pBlock;
     if(ctx) {
-        Ob_DECREF(ctx->pmDuplicate);
+        LocalFree(ctx->tDuplicate.pe);
+        LocalFree(ctx->tDir.pe);
         Ob_DECREF(ctx->psRoot);
         Ob_DECREF(ctx->psDirFile);
-        Ob_DECREF(ctx->pmDir);
         Ob_DECREF(ctx->psOrphan);
+        while((pBlock = ctx->Arena.pBlock)) {
+            ctx->Arena.pBlock = pBlock->FLink;
+            LocalFree(pBlock);
+        }
         LocalFree(ctx);
     }
 }
@@ -270,10 +408,8 @@ PVOID FcNtfs_Initialize(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP)
     PFCNTFS_SETUP_CONTEXT ctx;
     Fc_SqlExec(FC_SQL_SCHEMA_NTFS);
     if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS_SETUP_CONTEXT)))) { goto fail; }
-    if(!(ctx->pmDuplicate = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
     if(!(ctx->psRoot = ObSet_New())) { goto fail; }
     if(!(ctx->psDirFile = ObSet_New())) { goto fail; }
-    if(!(ctx->pmDir = ObMap_New(0))) { goto fail; }
     if(!(ctx->psOrphan = ObSet_New())) { goto fail; }
     return ctx;
 fail:
@@ -282,24 +418,26 @@ fail:
 }
 
 /*
-* Try add a single MFT entry to the NTFS MFT dataset.
+* Try parse a single MFT entry into a new NTFS entry allocated from the arena.
+* This function is thread-safe - the entry is added to the NTFS MFT dataset
+* at finalize time (FcNtfs_FinalizeIngest).
 * -- ctx
 * -- qwPhysicalAddress
 * -- qwVirtualAddress
 * -- pb
+* -- return = the parsed entry or NULL if not a valid MFT entry.
 */
-VOID FcNtfs_IngestMftEntry(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ QWORD qwPhysicalAddress, _In_opt_ QWORD qwVirtualAddress, _In_reads_(0x400) PBYTE pb)
+PFCNTFS FcNtfs_IngestMftEntry(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ QWORD qwPhysicalAddress, _In_opt_ QWORD qwVirtualAddress, _In_reads_(0x400) PBYTE pb)
 {
-    QWORD qwHashDuplicateCheck;
     DWORD oA, cbData = 0, cbuName;
     PNTFS_FILE_RECORD pr;
     PNTFS_ATTR pa;
     PNTFS_FILE_NAME pfnC, pfn = NULL;
     PNTFS_STANDARD_INFORMATION psi = NULL;
-    PFCNTFS pNtfs = NULL, pNtfs_Coll = NULL;
+    PFCNTFS pNtfs = NULL;
     pr = (PNTFS_FILE_RECORD)pb;
     // Check MFT record number is within the correct location inside the page:
-    if((((qwPhysicalAddress >> 10) & 0x3) != (0x3 & pr->MftRecordNumber)) || (pr->MftRecordNumber == 0)) { return; }
+    if((((qwPhysicalAddress >> 10) & 0x3) != (0x3 & pr->MftRecordNumber)) || (pr->MftRecordNumber == 0)) { return NULL; }
     // Extract attributes loop:
     oA = pr->FirstAttributeOffset;
     while((oA + sizeof(NTFS_ATTR) < 0x400)) {
@@ -324,14 +462,11 @@ VOID FcNtfs_IngestMftEntry(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ QWORD qwPhysical
         }
         oA += pa->Length;
     }
-    if(!psi || !pfn || (pfn->ParentDirectory.SegmentNumber > 0xfffffff0)) { return; }
-    // Duplicate check by MftRecordNumber and LogFileSequenceNumber:
-    qwHashDuplicateCheck = (((QWORD)pr->MftRecordNumber << 32) ^ pr->LogFileSequenceNumber);
-    if(ObMap_ExistsKey(ctx->pmDuplicate, qwHashDuplicateCheck)) { return; }
+    if(!psi || !pfn || (pfn->ParentDirectory.SegmentNumber > 0xfffffff0)) { return NULL; }
     // Create NTFS object and populate:
-    if(!CharUtil_WtoU(pfn->Name, pfn->NameLength, NULL, 0, NULL, &cbuName, 0)) { return; }
-    if(!(pNtfs = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS) + cbuName))) { return; }
-    if(!CharUtil_WtoU(pfn->Name, pfn->NameLength, pNtfs->uszName, cbuName, NULL, &cbuName, CHARUTIL_FLAG_STR_BUFONLY)) { return; }
+    if(!CharUtil_WtoU(pfn->Name, pfn->NameLength, NULL, 0, NULL, &cbuName, 0)) { return NULL; }
+    if(!(pNtfs = FcNtfs_ArenaAlloc(ctx, sizeof(FCNTFS) + cbuName))) { return NULL; }
+    if(!CharUtil_WtoU(pfn->Name, pfn->NameLength, pNtfs->uszName, cbuName, NULL, &cbuName, CHARUTIL_FLAG_STR_BUFONLY)) { return NULL; }
     pNtfs->pa = qwPhysicalAddress;
     pNtfs->va = qwVirtualAddress;
     pNtfs->ftCreate = psi->TimeCreate;
@@ -346,70 +481,57 @@ VOID FcNtfs_IngestMftEntry(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ QWORD qwPhysical
     pNtfs->wMftSequenceNumber = pr->SequenceNumber;
     pNtfs->Setup.dwParentRecordNumber = (DWORD)pfn->ParentDirectory.SegmentNumber;
     pNtfs->Setup.wParentSeqenceNumber = (WORD)pfn->ParentDirectory.SequenceNumber;
-    // Commit:
-    ObMap_Push(ctx->pmDuplicate, qwHashDuplicateCheck, pNtfs);
-    if(pNtfs->fDir) {
-        if(pNtfs->dwMftRecordNumber == pNtfs->Setup.dwParentRecordNumber) {
-            pNtfs->fRootDir = TRUE;
-            ObSet_Push(ctx->psRoot, (QWORD)pNtfs);
-        }
-        if(!ObMap_Push(ctx->pmDir, (QWORD)pNtfs->dwMftRecordNumber, pNtfs)) {
-            // fail == already exists -> queue on NextDir list
-            if((pNtfs_Coll = ObMap_GetByKey(ctx->pmDir, (QWORD)pNtfs->dwMftRecordNumber))) {
-                pNtfs->Setup.pNextDir = pNtfs_Coll->Setup.pNextDir;
-                pNtfs_Coll->Setup.pNextDir = pNtfs;
-            }
-        }
-    }
-    if(!pNtfs->fRootDir) {
-        ObSet_Push(ctx->psDirFile, (QWORD)pNtfs);
-    }
-    // Debug output:
-    VmmLog(MID_FORENSIC, LOGLEVEL_DEBUG, "   %08x:%04x %12llx %8lli : %c : %s \n",
-        pNtfs->Setup.dwParentRecordNumber,
-        pNtfs->Setup.wParentSeqenceNumber,
-        pNtfs->pa,
-        pNtfs->cbFileSize,
-        (pNtfs->fDir ? 'D' : ' '),
-        pNtfs->uszName
-    );
+    // Duplicate check by MftRecordNumber and LogFileSequenceNumber (at finalize):
+    pNtfs->Setup.qwHashDuplicateCheck = (((QWORD)pr->MftRecordNumber << 32) ^ pr->LogFileSequenceNumber);
+    return pNtfs;
 }
 
 /*
-* Try add a physical memory page to the NTFS MFT dataset.
+* Try parse a physical memory page into NTFS MFT entries.
 * -- ctx
 * -- pa
 * -- pbPage
+* -- ppe = array of 4 entries receiving parsed entries (or NULL).
 */
-VOID FcNtfs_IngestMftPage(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ QWORD pa, _In_reads_(0x1000) PBYTE pbPage)
+VOID FcNtfs_IngestMftPage(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ QWORD pa, _In_reads_(0x1000) PBYTE pbPage, _Out_writes_(4) PFCNTFS *ppe)
 {
     QWORD i, va = 0;
     PNTFS_FILE_RECORD pr;
-    if(*(PDWORD)pbPage != 'ELIF') { return; }     // file signature
     for(i = 0; i < 0x1000; i += 0x400) {
+        ppe[i >> 10] = NULL;
         pr = (PNTFS_FILE_RECORD)(pbPage + i);
         if(pr->Signature != 'ELIF') { continue; }
         if((pr->UpdateSequenceArrayOffset > 0x100) || (pr->UpdateSequenceArraySize > 0x100)) { continue; }
         if(pr->BaseFileRecordSegment.SegmentNumber) { continue; }
         if(pr->FirstAttributeOffset > 0x300) { continue; }
-        FcNtfs_IngestMftEntry(ctx, pa + i, (va ? va + i : 0), pbPage + i);
+        ppe[i >> 10] = FcNtfs_IngestMftEntry(ctx, pa + i, (va ? va + i : 0), pbPage + i);
     }
 }
 
+/*
+* Parallel-for callback: parse a single candidate page.
+* -- ctx
+* -- pvPartial
+* -- iItem
+*/
+VOID FcNtfs_IngestMftPage_ParallelAction(_In_opt_ PFCNTFS_SETUP_CONTEXT ctx, _In_opt_ PVOID pvPartial, _In_ DWORD iItem)
+{
+    FcNtfs_IngestMftPage(ctx, ctx->Ingest.pa[iItem], ctx->Ingest.pb[iItem], ctx->Ingest.pe + 4ULL * iItem);
+}
+
 /*
 * Filter incoming POB_FC_SCANPHYSMEM_CHUNK to retrieve potential MFT entry
-* physical page addresses and their data in a map [pa -> pb].
-* CALLER DECREF: return
+* physical page addresses and their data into ctx->Ingest.
+* -- ctx
 * -- pc
-* -- return = MAP or NULL if no candidate pages found.
+* -- return = the number of candidate pages.
 */
-POB_MAP FcNtfs_IngestGetValidAddrMap(_In_ PVMMDLL_PLUGIN_FORENSIC_INGEST_PHYSMEM pc)
+DWORD FcNtfs_IngestGetCandidatePages(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ PVMMDLL_PLUGIN_FORENSIC_INGEST_PHYSMEM pc)
 {
     BOOL fPfnValidForMft;
     DWORD i;
-    POB_MAP pmObAddr;
     PVMMDLL_MAP_PFNENTRY pePfn;
-    if(!(pmObAddr = ObMap_New(0))) { return NULL; }
+    ctx->Ingest.cPage = 0;
     for(i = 0; i < 0x1000; i++) {
         if((pc->ppMEMs[i]->qwA != (QWORD)-1) && pc->ppMEMs[i]->f && (pc->ppMEMs[i]->cb == 0x1000) && (*(PDWORD)pc->ppMEMs[i]->pb == 'ELIF')) {
             pePfn = (pc->pPfnMap && (i < pc->pPfnMap->cMap)) ? (pc->pPfnMap->pMap + i) : NULL;
@@ -421,34 +543,101 @@ POB_MAP FcNtfs_IngestGetValidAddrMap(_In_ PVMMDLL_PLUGIN_FORENSIC_INGEST_PHYSMEM
                 (pePfn->PageLocation == MmPfnTypeTransition) ||
                 ((pePfn->PageLocation == MmPfnTypeActive) && (pePfn->Priority >= 5));
             if(fPfnValidForMft) {
-                ObMap_Push(pmObAddr, pc->ppMEMs[i]->qwA, pc->ppMEMs[i]->pb);
+                ctx->Ingest.pa[ctx->Ingest.cPage] = pc->ppMEMs[i]->qwA;
+                ctx->Ingest.pb[ctx->Ingest.cPage] = pc->ppMEMs[i]->pb;
+                ctx->Ingest.cPage++;
             }
         }
     }
-    if(0 == ObMap_Size(pmObAddr)) {
-        Ob_DECREF_NULL(&pmObAddr);
-    }
-    return pmObAddr;
+    return ctx->Ingest.cPage;
 }
 
 /*
 * Analyze a POB_FC_SCANPHYSMEM_CHUNK 16MB memory chunk for MFT file candidates
-* and add any found to the internal data sets.
+* and add any found to the internal ingest list. Candidate pages are parsed in
+* parallel; parsed entries are appended to the ingest list in descending page
+* address order (records within a page in ascending order). This preserves the
+* original ingest order in which the highest address wins among duplicates.
 * -- ctxfc
 * -- pIngestPhysmem
 */
 VOID FcNtfs_Ingest(_In_opt_ PVOID ctxfc, _In_ PVMMDLL_PLUGIN_FORENSIC_INGEST_PHYSMEM pIngestPhysmem)
 {
-    QWORD pa;
-    PBYTE pb;
-    POB_MAP pmObAddr = NULL;
+    DWORD i, iPage, cPage;
+    PFCNTFS pe;
     PFCNTFS_SETUP_CONTEXT ctx = (PFCNTFS_SETUP_CONTEXT)ctxfc;
-    if(ctx && (pmObAddr = FcNtfs_IngestGetValidAddrMap(pIngestPhysmem))) {
-        while((pb = ObMap_PopWithKey(pmObAddr, &pa))) {
-            FcNtfs_IngestMftPage(ctx, pa, pb);
+    if(!ctx || !(cPage = FcNtfs_IngestGetCandidatePages(ctx, pIngestPhysmem))) { return; }
+    // 1: parse candidate pages (multi-threaded if many candidates):
+    if((cPage < FCNTFS_INGEST_PARALLEL_MIN) || !VmmWorkParallelFor(ctx, cPage, NULL, 0, (VOID(*)(PVOID, PVOID, DWORD))FcNtfs_IngestMftPage_ParallelAction, NULL, NULL)) {
+        for(i = 0; i < cPage; i++) {
+            FcNtfs_IngestMftPage_ParallelAction(ctx, NULL, i);
+        }
+    }
+    // 2: append parsed entries to ingest list (pages in descending order):
+    for(iPage = cPage; iPage; iPage--) {
+        for(i = 4 * (iPage - 1); i < 4 * iPage; i++) {
+            if(!(pe = ctx->Ingest.pe[i])) { continue; }
+            if(ctx->Ingest.pLast) {
+                ctx->Ingest.pLast->Setup.pNextIngest = pe;
+            } else {
+                ctx->Ingest.pFirst = pe;
+            }
+            ctx->Ingest.pLast = pe;
         }
     }
-    Ob_DECREF(pmObAddr);
+}
+
+/*
+* Add a directory entry to the directory table. If a directory with the same
+* record number already exists the entry is queued on its NextDir list.
+* -- ctx
+* -- pNtfs
+*/
+VOID FcNtfs_FinalizeDirAdd(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ PFCNTFS pNtfs)
+{
+    PFCNTFS pNtfs_Coll;
+    if(!FcNtfs_TablePush(&ctx->tDir, pNtfs->dwMftRecordNumber, pNtfs)) {
+        // fail == already exists -> queue on NextDir list
+        if((pNtfs_Coll = FcNtfs_TableGet(&ctx->tDir, pNtfs->dwMftRecordNumber))) {
+            pNtfs->Setup.pNextDir = pNtfs_Coll->Setup.pNextDir;
+            pNtfs_Coll->Setup.pNextDir = pNtfs;
+        }
+    }
+}
+
+/*
+* Merge the ingested entries into the NTFS MFT dataset in ingest order.
+* Duplicate entries are discarded (their arena memory is freed on close).
+* -- ctx
+*/
+VOID FcNtfs_FinalizeIngest(_In_ PFCNTFS_SETUP_CONTEXT ctx)
+{
+    PFCNTFS pNtfs, pNtfsNext;
+    for(pNtfs = ctx->Ingest.pFirst; pNtfs; pNtfs = pNtfsNext) {
+        pNtfsNext = pNtfs->Setup.pNextIngest;
+        if(!FcNtfs_TablePush(&ctx->tDuplicate, pNtfs->Setup.qwHashDuplicateCheck, pNtfs)) { continue; }
+        if(pNtfs->fDir) {
+            if(pNtfs->dwMftRecordNumber == pNtfs->Setup.dwParentRecordNumber) {
+                pNtfs->fRootDir = TRUE;
+                ObSet_Push(ctx->psRoot, (QWORD)pNtfs);
+            }
+            FcNtfs_FinalizeDirAdd(ctx, pNtfs);
+        }
+        if(!pNtfs->fRootDir) {
+            ObSet_Push(ctx->psDirFile, (QWORD)pNtfs);
+        }
+        // Debug output:
+        VmmLog(MID_FORENSIC, LOGLEVEL_DEBUG, "   %08x:%04x %12llx %8lli : %c : %s \n",
+            pNtfs->Setup.dwParentRecordNumber,
+            pNtfs->Setup.wParentSeqenceNumber,
+            pNtfs->pa,
+            pNtfs->cbFileSize,
+            (pNtfs->fDir ? 'D' : ' '),
+            pNtfs->uszName
+        );
+    }
+    ctx->Ingest.pFirst = NULL;
+    ctx->Ingest.pLast = NULL;
 }
 
 /*
@@ -489,7 +678,7 @@ PFCNTFS FcNtfs_FinalizeMergeFind(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ PFCNTFS pe
 {
     PFCNTFS pDir, pMergeDir = NULL;;
     DWORD dwMergeScoreThis, dwMergeScoreMax = 0;
-    if((pDir = ObMap_GetByKey(ctx->pmDir, (QWORD)pe->Setup.dwParentRecordNumber))) {
+    if((pDir = FcNtfs_TableGet(&ctx->tDir, pe->Setup.dwParentRecordNumber))) {
         while(pDir && (dwMergeScoreMax < 100)) {
             dwMergeScoreThis = FcNtfs_FinalizeMergeScore(pDir, pe);
             if(dwMergeScoreThis > dwMergeScoreMax) {
@@ -524,9 +713,9 @@ VOID FcNtfs_FinalizeMerge1(_In_ PFCNTFS_SETUP_CONTEXT ctx)
 */
 PFCNTFS FcNtfs_FinalizeCreateSynthenticDir(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_ DWORD dwMftRecordNumber, _In_ LPSTR uszName, _In_ BOOL fRootDir)
 {
-    PFCNTFS pNtfs, pNtfs_Coll;
+    PFCNTFS pNtfs;
     SIZE_T cuszName = strlen(uszName);
-    if(!(pNtfs = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS) + cuszName + 1))) { return NULL; }
+    if(!(pNtfs = FcNtfs_ArenaAlloc(ctx, (DWORD)(sizeof(FCNTFS) + cuszName + 1)))) { return NULL; }
     memcpy(pNtfs->uszName, uszName, cuszName + 1);
     pNtfs->dwMftRecordNumber = dwMftRecordNumber;
     pNtfs->wMftSequenceNumber = (WORD)-1;
@@ -534,17 +723,10 @@ PFCNTFS FcNtfs_FinalizeCreateSynthenticDir(_In_ PFCNTFS_SETUP_CONTEXT ctx, _In_
     pNtfs->fRootDir = fRootDir;
     pNtfs->fDir = TRUE;
     pNtfs->Flags = 0x03;    // active directory
-    if(!ObMap_Push(ctx->pmDir, (QWORD)pNtfs->dwMftRecordNumber, pNtfs)) {
-        // fail == already exists -> queue on NextDir list
-        if((pNtfs_Coll = ObMap_GetByKey(ctx->pmDir, (QWORD)pNtfs->dwMftRecordNumber))) {
-            pNtfs->Setup.pNextDir = pNtfs_Coll->Setup.pNextDir;
-            pNtfs_Coll->Setup.pNextDir = pNtfs;
-        }
-    }
+    FcNtfs_FinalizeDirAdd(ctx, pNtfs);
     if(pNtfs->fRootDir) {
         ObSet_Push(ctx->psRoot, (QWORD)pNtfs);
     }
-    ObMap_Push(ctx->pmDuplicate, ((QWORD)dwMftRecordNumber << 32 | dwMftRecordNumber), pNtfs);  // for later free
     return pNtfs;
 }
 
@@ -612,7 +794,7 @@ VOID FcNtfs_Finalize_DatabaseAdd(_In_ PFCNTFS_FINALIZE_CONTEXT ctx, _In_ PFCNTFS
 {
     QWORD id = pe->iMap;
     FCSQL_INSERTSTRTABLE SqlStrInsert = { 0 };
-    if(!Fc_SqlInsertStr(ctx->st_str, uszPathName + 1, &SqlStrInsert)) { return; }
+    if(!Fc_SqlInsertStr(ctx->hSql, uszPathName + 1, &SqlStrInsert)) { return; }
     sqlite3_reset(ctx->st);
     sqlite3_bind_int64(ctx->st, 1, id);
     sqlite3_bind_int64(ctx->st, 2, pe->pParent ? pe->pParent->iMap : -1);
@@ -631,7 +813,7 @@ VOID FcNtfs_Finalize_DatabaseAdd(_In_ PFCNTFS_FINALIZE_CONTEXT ctx, _In_ PFCNTFS
     sqlite3_bind_int64(ctx->st, 15, pe->wName_SeqNbr);
     sqlite3_bind_int64(ctx->st, 16, ctx->cbUtf8Total + id * M_NTFS_INFO_LINELENGTH_UTF8);
     sqlite3_bind_int64(ctx->st, 17, ctx->cbJsonTotal + id * M_NTFS_INFO_LINELENGTH_JSON);
-    sqlite3_step(ctx->st);
+    Fc_SqlInsertStep(ctx->hSql, ctx->st);
     ctx->cbUtf8Total += SqlStrInsert.cbu;
     ctx->cbJsonTotal += SqlStrInsert.cbj;
 }
@@ -680,31 +862,26 @@ VOID FcNtfs_Finalize(_In_opt_ PVOID ctxfc)
     CHAR uszPath[2048] = { 0 };
     POB_SET psObHashPath = NULL;
     PFCNTFS pNtfsGlobalRoot;
-    int rc;
     // initialize general
     if(!ctx) { goto fail; }
     if(!(psObHashPath = ObSet_New())) { goto fail; }
     // merge ingested items and retrieve global root
+    FcNtfs_FinalizeIngest(ctx);
     FcNtfs_FinalizeMerge1(ctx);
     pNtfsGlobalRoot = FcNtfs_FinalizeMerge2(ctx);
     if(!pNtfsGlobalRoot) { goto fail; }
     // SETUP FINISH:
     if(!(ctxFinal.hSql = Fc_SqlReserve())) { goto fail; }
-    rc = sqlite3_prepare_v2(ctxFinal.hSql,
+    ctxFinal.st = Fc_SqlPrepareCached(ctxFinal.hSql,
         "INSERT INTO ntfs " \
         "(id, id_parent, id_str, hash, hash_parent, addr_phys, inode, mft_flags, depth, size_file, size_fileres, time_create, time_modify, time_read, name_seq, oln_u, oln_j) " \
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);"
-        , -1, &ctxFinal.st, NULL);
-    if(rc != SQLITE_OK) { goto fail; }
-    rc = sqlite3_prepare_v2(ctxFinal.hSql, "INSERT INTO str (id, cbu, cbj, sz) VALUES (?, ?, ?, ?);", -1, &ctxFinal.st_str, NULL);
-    if(rc != SQLITE_OK) { goto fail; }
-    sqlite3_exec(ctxFinal.hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
-    DWORD DEBUG_NUM = FcNtfs_FinalizeFinish(&ctxFinal, psObHashPath, pNtfsGlobalRoot, 0, 0, uszPath, 0);
-    sqlite3_exec(ctxFinal.hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+    if(!ctxFinal.st) { goto fail; }
+    Fc_SqlTransactionBegin(ctxFinal.hSql);
+    FcNtfs_FinalizeFinish(&ctxFinal, psObHashPath, pNtfsGlobalRoot, 0, 0, uszPath, 0);
+    Fc_SqlTransactionCommit(ctxFinal.hSql);
     // CLEAN UP:
 fail:
-    sqlite3_finalize(ctxFinal.st);
-    sqlite3_finalize(ctxFinal.st_str);
     Fc_SqlReserveReturn(ctxFinal.hSql);
     Ob_DECREF(psObHashPath);
     FcNtfs_Close(ctx);
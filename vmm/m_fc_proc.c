@@ -29,22 +29,21 @@ PVOID MFcProc_FcInitialize(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP)
     BOOL fWellKnownAccount = FALSE;
     PVMM_PROCESS pObProcess = NULL;
     sqlite3 *hSql = NULL;
-    sqlite3_stmt *hStmt = NULL, *hStmtStr = NULL;
+    sqlite3_stmt *hStmt = NULL;
     FCSQL_INSERTSTRTABLE SqlStrInsert[4];
     CHAR uszUserName[MAX_PATH], uszFullInfo[2048];
     if(SQLITE_OK != Fc_SqlExec(FC_SQL_SCHEMA_PROCESS)) { goto fail; }
     if(!(hSql = Fc_SqlReserve())) { goto fail; }
-    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO process (id_str_name, id_str_path, id_str_user, id_str_all, pid, ppid, eprocess, dtb, dtb_user, state, wow64, peb, peb32, time_create, time_exit) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", -1, &hStmt, NULL)) { goto fail; }
-    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO str (id, cbu, cbj, sz) VALUES (?, ?, ?, ?);", -1, &hStmtStr, NULL)) { goto fail; }
-    sqlite3_exec(hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
+    if(!(hStmt = Fc_SqlPrepareCached(hSql, "INSERT INTO process (id_str_name, id_str_path, id_str_user, id_str_all, pid, ppid, eprocess, dtb, dtb_user, state, wow64, peb, peb32, time_create, time_exit) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);"))) { goto fail; }
+    Fc_SqlTransactionBegin(hSql);
     while((pObProcess = VmmProcessGetNext(pObProcess, VMM_FLAG_PROCESS_TOKEN | VMM_FLAG_PROCESS_SHOW_TERMINATED))) {
         // build and insert string data into 'str' table.
-        if(!Fc_SqlInsertStr(hStmtStr, pObProcess->pObPersistent->uszNameLong, &SqlStrInsert[0])) { goto fail_transact; }
-        if(!Fc_SqlInsertStr(hStmtStr, pObProcess->pObPersistent->uszPathKernel, &SqlStrInsert[1])) { goto fail_transact; }
+        if(!Fc_SqlInsertStr(hSql, pObProcess->pObPersistent->uszNameLong, &SqlStrInsert[0])) { goto fail_transact; }
+        if(!Fc_SqlInsertStr(hSql, pObProcess->pObPersistent->uszPathKernel, &SqlStrInsert[1])) { goto fail_transact; }
         if(!pObProcess->win.TOKEN.fSID || !VmmWinUser_GetName(&pObProcess->win.TOKEN.SID, uszUserName, MAX_PATH, &fWellKnownAccount)) { uszUserName[0] = 0; }
-        if(!Fc_SqlInsertStr(hStmtStr, uszUserName, &SqlStrInsert[2])) { goto fail_transact; }
+        if(!Fc_SqlInsertStr(hSql, uszUserName, &SqlStrInsert[2])) { goto fail_transact; }
         _snprintf_s(uszFullInfo, 2048 - 2, 2048 - 3, "%s [%s%s] %s", pObProcess->pObPersistent->uszNameLong, (fWellKnownAccount ? "*" : ""), uszUserName, pObProcess->pObPersistent->uszPathKernel);
-        if(!Fc_SqlInsertStr(hStmtStr, uszFullInfo, &SqlStrInsert[3])) { goto fail_transact; }
+        if(!Fc_SqlInsertStr(hSql, uszFullInfo, &SqlStrInsert[3])) { goto fail_transact; }
         // insert into 'process' table.
         sqlite3_reset(hStmt);
         rc = Fc_SqlBindMultiInt64(hStmt, 1, 15,
@@ -65,17 +64,15 @@ PVOID MFcProc_FcInitialize(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP)
             VmmProcess_GetExitTimeOpt(pObProcess)
         );
         if(SQLITE_OK != rc) { goto fail_transact; }
-        sqlite3_step(hStmt);
+        Fc_SqlInsertStep(hSql, hStmt);
     }
-    sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+    Fc_SqlTransactionCommit(hSql);
 fail:
     Ob_DECREF(pObProcess);
-    sqlite3_finalize(hStmt);
-    sqlite3_finalize(hStmtStr);
     Fc_SqlReserveReturn(hSql);
     return NULL;
 fail_transact:
-    sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+    Fc_SqlTransactionCommit(hSql);
     goto fail;
 }
 
@@ -113,9 +113,9 @@ VOID MFcRegistry_KeyCB(_In_ HANDLE hCallback1, _In_ HANDLE hCallback2, _In_ LPST
 {
     FCSQL_INSERTSTRTABLE SqlStrInsert;
     sqlite3_stmt *hStmt = (sqlite3_stmt *)hCallback1;
-    sqlite3_stmt *hStmtStr = (sqlite3_stmt *)hCallback2;
+    sqlite3 *hSql = (sqlite3 *)hCallback2;
     // build and insert string data into 'str' table.
-    if(!Fc_SqlInsertStr(hStmtStr, uszPathName, &SqlStrInsert)) { return; }
+    if(!Fc_SqlInsertStr(hSql, uszPathName, &SqlStrInsert)) { return; }
     // insert into 'process' table.
     sqlite3_reset(hStmt);
     Fc_SqlBindMultiInt64(hStmt, 1, 5,
@@ -125,7 +125,7 @@ VOID MFcRegistry_KeyCB(_In_ HANDLE hCallback1, _In_ HANDLE hCallback2, _In_ LPST
         (QWORD)dwCellParent,
         ftLastWrite
     );
-    sqlite3_step(hStmt);
+    Fc_SqlInsertStep(hSql, hStmt);
 }
 
 /*
@@ -135,20 +135,17 @@ PVOID M_FcRegistry_FcInitialize(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP)
 {
     POB_REGISTRY_HIVE pObHive = NULL;
     sqlite3 *hSql = NULL;
-    sqlite3_stmt *hStmt = NULL, *hStmtStr = NULL;
+    sqlite3_stmt *hStmt = NULL;
     if(SQLITE_OK != Fc_SqlExec(FC_SQL_SCHEMA_REGISTRY)) { goto fail; }
     if(!(hSql = Fc_SqlReserve())) { goto fail; }
-    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO registry (id_str, hive, cell, cell_parent, time) VALUES (?, ?, ?, ?, ?);", -1, &hStmt, NULL)) { goto fail; }
-    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO str (id, cbu, cbj, sz) VALUES (?, ?, ?, ?);", -1, &hStmtStr, NULL)) { goto fail; }
-    sqlite3_exec(hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
+    if(!(hStmt = Fc_SqlPrepareCached(hSql, "INSERT INTO registry (id_str, hive, cell, cell_parent, time) VALUES (?, ?, ?, ?, ?);"))) { goto fail; }
+    Fc_SqlTransactionBegin(hSql);
     while((pObHive = VmmWinReg_HiveGetNext(pObHive))) {
-        VmmWinReg_ForensicGetAllKeysAndValues(pObHive, hStmt, hStmtStr, MFcRegistry_KeyCB, MFcRegistry_JsonKeyCB, MFcRegistry_JsonValueCB);
+        VmmWinReg_ForensicGetAllKeysAndValues(pObHive, hStmt, hSql, MFcRegistry_KeyCB, MFcRegistry_JsonKeyCB, MFcRegistry_JsonValueCB);
     }
-    sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+    Fc_SqlTransactionCommit(hSql);
 fail:
     Ob_DECREF(pObHive);
-    sqlite3_finalize(hStmt);
-    sqlite3_finalize(hStmtStr);
     Fc_SqlReserveReturn(hSql);
     return NULL;
 }
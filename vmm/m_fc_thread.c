@@ -23,7 +23,7 @@ VOID M_FcThread_FcInitialize_ThreadProc(_In_ PVMM_PROCESS pProcess, _In_ PVOID p
 {
     int rc;
     sqlite3 *hSql = NULL;
-    sqlite3_stmt *hStmt = NULL, *hStmtStr = NULL;
+    sqlite3_stmt *hStmt = NULL;
     DWORD i;
     PVMMOB_MAP_THREAD pObThreadMap = NULL;
     PVMM_MAP_THREADENTRY pe;
@@ -31,13 +31,12 @@ VOID M_FcThread_FcInitialize_ThreadProc(_In_ PVMM_PROCESS pProcess, _In_ PVOID p
     FCSQL_INSERTSTRTABLE SqlStrInsert;
     if(!VmmMap_GetThread(pProcess, &pObThreadMap)) { goto fail; }
     if(!(hSql = Fc_SqlReserve())) { goto fail; }
-    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO thread (id_str, pid, tid, ethread, teb, state, exitstatus, running, prio, priobase, startaddr, stackbase_u, stacklimit_u, stackbase_k, stacklimit_k, trapframe, sp, ip, time_create, time_exit) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", -1, &hStmt, NULL)) { goto fail; }
-    if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO str (id, cbu, cbj, sz) VALUES (?, ?, ?, ?);", -1, &hStmtStr, NULL)) { goto fail; }
-    sqlite3_exec(hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
+    if(!(hStmt = Fc_SqlPrepareCached(hSql, "INSERT INTO thread (id_str, pid, tid, ethread, teb, state, exitstatus, running, prio, priobase, startaddr, stackbase_u, stacklimit_u, stackbase_k, stacklimit_k, trapframe, sp, ip, time_create, time_exit) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);"))) { goto fail; }
+    Fc_SqlTransactionBegin(hSql);
     for(i = 0; i < pObThreadMap->cMap; i++) {
         pe = pObThreadMap->pMap + i;
         snprintf(szStr, _countof(szStr), "TID: %i", pe->dwTID);
-        if(!Fc_SqlInsertStr(hStmtStr, szStr, &SqlStrInsert)) { goto fail_transact; }
+        if(!Fc_SqlInsertStr(hSql, szStr, &SqlStrInsert)) { goto fail_transact; }
         sqlite3_reset(hStmt);
         rc = Fc_SqlBindMultiInt64(hStmt, 1, 20,
             SqlStrInsert.id,
@@ -62,13 +61,11 @@ VOID M_FcThread_FcInitialize_ThreadProc(_In_ PVMM_PROCESS pProcess, _In_ PVOID p
             pe->ftExitTime
         );
         if(SQLITE_OK != rc) { goto fail_transact; }
-        sqlite3_step(hStmt);
+        Fc_SqlInsertStep(hSql, hStmt);
     }
 fail_transact:
-    sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+    Fc_SqlTransactionCommit(hSql);
 fail:
-    sqlite3_finalize(hStmt);
-    sqlite3_finalize(hStmtStr);
     Fc_SqlReserveReturn(hSql);
     Ob_DECREF(pObThreadMap);
     return;
@@ -12,6 +12,62 @@
 #include "charutil.h"
 #include "util.h"
 
+/*
+* Format a single timeline entry as a text line.
+* -- pe
+* -- szu = buffer to receive the line.
+* -- cszu
+* -- return = number of characters written (excl. null terminator).
+*/
+QWORD M_FcTimeline_FormatEntry(_In_ PFC_MAP_TIMELINEENTRY pe, _Out_writes_(cszu) LPSTR szu, _In_ QWORD cszu)
+{
+    DWORD dwEntryType, dwEntryAction;
+    CHAR szTime[24];
+    Util_FileTime2String(pe->ft, szTime);
+    dwEntryType = (pe->tp < ctxFc->Timeline.cTp) ? pe->tp : 0;
+    dwEntryAction = (pe->ac <= FC_TIMELINE_ACTION_MAX) ? pe->ac : FC_TIMELINE_ACTION_NONE;
+    return snprintf(
+        szu,
+        (SIZE_T)cszu,
+        "%s  %-*s %s%10u%10u %16llx %s\n",
+        szTime,
+        6,
+        ctxFc->Timeline.pInfo[dwEntryType].szNameShort,
+        FC_TIMELINE_ACTION_STR[dwEntryAction],
+        pe->pid,
+        pe->data32,
+        pe->data64,
+        pe->uszText
+    );
+}
+
+/*
+* Read the text version of the timeline info files from the memory-mapped
+* timeline index - binary search for the first entry, no database access.
+*/
+NTSTATUS M_FcTimeline_ReadInfoIndex(_In_ DWORD dwTimelineType, _Out_ PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+{
+    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
+    FC_MAP_TIMELINEENTRY e;
+    QWORD i, o, cszuBuffer, cbOffsetBuffer;
+    LPSTR szuBuffer = NULL;
+    if(!FcTimelineIndex_GetFromPosition(dwTimelineType, cbOffset, &i)) { goto fail; }
+    if(!FcTimelineIndex_GetEntry(dwTimelineType, i, &e)) { goto fail; }
+    cbOffsetBuffer = e.cuszOffset;
+    if(cbOffsetBuffer > cbOffset) { goto fail; }
+    cszuBuffer = (cbOffset - cbOffsetBuffer) + cb + 0x10000;
+    if(!(szuBuffer = LocalAlloc(0, (SIZE_T)cszuBuffer))) { goto fail; }
+    for(o = 0; o < (cbOffset - cbOffsetBuffer) + cb; ) {
+        if(o + FC_LINELENGTH_TIMELINE_UTF8 + e.cuszText + 1 > cszuBuffer) { break; }
+        o += M_FcTimeline_FormatEntry(&e, szuBuffer + o, cszuBuffer - o);
+        if(!FcTimelineIndex_GetEntry(dwTimelineType, ++i, &e)) { break; }
+    }
+    nt = Util_VfsReadFile_FromPBYTE(szuBuffer, o, pb, cb, pcbRead, cbOffset - cbOffsetBuffer);
+fail:
+    LocalFree(szuBuffer);
+    return nt;
+}
+
 /*
 * Read the text version of the timeline info files.
 */
@@ -22,8 +78,9 @@ NTSTATUS M_FcTimeline_ReadInfo(_In_ DWORD dwTimelineType, _Out_ PBYTE pb, _In_ D
     PFCOB_MAP_TIMELINE pObMap = NULL;
     QWORD i, o, qwIdBase, qwIdTop, cId, cszuBuffer, cbOffsetBuffer;
     LPSTR szuBuffer = NULL;
-    DWORD dwEntryType, dwEntryAction;
-    CHAR szTime[24];
+    if(ctxFc->Timeline.Index.pHdr) {
+        return M_FcTimeline_ReadInfoIndex(dwTimelineType, pb, cb, pcbRead, cbOffset);
+    }
     if(!FcTimeline_GetIdFromPosition(dwTimelineType, FALSE, cbOffset, &qwIdBase)) { goto fail; }
     if(!FcTimeline_GetIdFromPosition(dwTimelineType, FALSE, cbOffset + cb, &qwIdTop)) { goto fail; }
     cId = min(cb / FC_LINELENGTH_TIMELINE_UTF8, qwIdTop - qwIdBase) + 1;
@@ -34,22 +91,7 @@ NTSTATUS M_FcTimeline_ReadInfo(_In_ DWORD dwTimelineType, _Out_ PBYTE pb, _In_ D
     if(!(szuBuffer = LocalAlloc(0, (SIZE_T)cszuBuffer))) { goto fail; }
     for(i = 0, o = 0; (i < pObMap->cMap) && (o < cszuBuffer - 0x1000); i++) {
         pe = pObMap->pMap + i;
-        Util_FileTime2String(pe->ft, szTime);
-        dwEntryType = (pe->tp < ctxFc->Timeline.cTp) ? pe->tp : 0;
-        dwEntryAction = (pe->ac <= FC_TIMELINE_ACTION_MAX) ? pe->ac : FC_TIMELINE_ACTION_NONE;
-        o += snprintf(
-            szuBuffer + o,
-            (SIZE_T)(cszuBuffer - o),
-            "%s  %-*s %s%10u%10u %16llx %s\n",
-            szTime,
-            6,
-            ctxFc->Timeline.pInfo[dwEntryType].szNameShort,
-            FC_TIMELINE_ACTION_STR[dwEntryAction],
-            pe->pid,
-            pe->data32,
-            pe->data64,
-            pe->uszText
-        );
+        o += M_FcTimeline_FormatEntry(pe, szuBuffer + o, cszuBuffer - o);
     }
     nt = Util_VfsReadFile_FromPBYTE(szuBuffer, o, pb, cb, pcbRead, cbOffset - cbOffsetBuffer);
 fail:
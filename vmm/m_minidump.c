@@ -348,6 +348,7 @@ typedef struct _MINIDUMP_UNLOADED_MODULE_LIST {
 #endif /* LINUX */
 
 #define M_MINIDUMP_DYNAMIC_DUMP_MAX_AGE_MS      30*1000
+#define M_MINIDUMP_READSTREAM                   'mdmp'
 
 LPCSTR szMMINIDUMP_README =
 "Information about the minidump module                                        \n" \
@@ -358,6 +359,7 @@ LPCSTR szMMINIDUMP_README =
 
 typedef struct tdOB_M_MINIDUMP_CONTEXT {
     OB ObHdr;
+    DWORD dwPID;
     DWORD cb;
     PBYTE pb;
     QWORD cbMemory;
@@ -582,6 +584,7 @@ POB_M_MINIDUMP_CONTEXT M_MiniDump_Initialize_Internal(_In_ PVMM_PROCESS pProcess
     if(!VmmMap_GetModule(pProcess, &pObModuleMap) || !pObModuleMap->cMap || (pObModuleMap->cMap > 0x4000)) { goto fail; }
     if(!VmmMap_GetUnloadedModule(pProcess, &pObUnloadedModuleMap)) { goto fail; }
     if(!(ctx = Ob_Alloc(OB_TAG_MOD_MINIDUMP_CTX, LMEM_ZEROINIT, sizeof(OB_M_MINIDUMP_CONTEXT), (OB_CLEANUP_CB)M_MiniDump_CallbackCleanup_ObMiniDumpContext, NULL))) { goto fail; }
+    ctx->dwPID = pProcess->dwPID;
     if(!(ctx->pb = LocalAlloc(LMEM_ZEROINIT, MINIDUMP_BUFFER_INITIAL))) { goto fail; }
     _snprintf_s(
         szComment,
@@ -1041,15 +1044,19 @@ finish:
     return pObCtx;
 }
 
-_Success_(return == STATUS_SUCCESS)
-NTSTATUS M_MiniDump_ReadMiniDump(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+/*
+* Synchronous read of minidump.dmp - read function of the file stream.
+* -- pObMiniDump
+* -- pb
+* -- cb
+* -- cbOffset
+*/
+VOID M_MiniDump_ReadMiniDump_Stream(_In_ POB_M_MINIDUMP_CONTEXT pObMiniDump, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _In_ QWORD cbOffset)
 {
     DWORD i, cbHead = 0, cbReadMem = 0, dwIntraSize;
     QWORD cbBase = 0, cbIntraOffset;
     PMINIDUMP_MEMORY_DESCRIPTOR64 pmd;
-    POB_M_MINIDUMP_CONTEXT pObMiniDump = NULL;
-    PVMM_PROCESS pProcess = (PVMM_PROCESS)ctxP->pProcess;
-    if(!(pObMiniDump = M_MiniDump_GetContext(ctxP))) { return VMMDLL_STATUS_FILE_INVALID; }
+    PVMM_PROCESS pObProcess = NULL;
     // read minidmump header
     if(cbOffset < pObMiniDump->cb) {
         cbHead = min(cb, pObMiniDump->cb - (DWORD)cbOffset);
@@ -1058,8 +1065,12 @@ NTSTATUS M_MiniDump_ReadMiniDump(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_writes_t
         cb -= cbHead;
         cbOffset += cbHead;
     }
-    if(cb == 0) { goto finish; }
+    if(cb == 0) { return; }
     cbOffset -= pObMiniDump->cb;
+    if(!(pObProcess = VmmProcessGet(pObMiniDump->dwPID))) {
+        ZeroMemory(pb, cb);
+        return;
+    }
     // read memory
     for(i = 0; i < pObMiniDump->MemoryList.p->NumberOfMemoryRanges; i++) {
         pmd = &pObMiniDump->MemoryList.p->MemoryRanges[i];
@@ -1070,14 +1081,32 @@ NTSTATUS M_MiniDump_ReadMiniDump(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_writes_t
         if(cbBase >= cbOffset + cbReadMem + cb) { break; }
         cbIntraOffset = (cbBase < cbOffset) ? cbOffset - cbBase : 0;
         dwIntraSize = (DWORD)min(cb, pmd->DataSize - cbIntraOffset);
-        VmmReadEx(pProcess, pmd->StartOfMemoryRange + cbIntraOffset, pb, dwIntraSize, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
+        VmmReadEx(pObProcess, pmd->StartOfMemoryRange + cbIntraOffset, pb, dwIntraSize, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
         cbReadMem += dwIntraSize;
         pb += dwIntraSize;
         cb -= dwIntraSize;
         if(cb == 0) { break; }
     }
-finish:
-    if(pcbRead) { *pcbRead = cbHead + cbReadMem; }
+    Ob_DECREF(pObProcess);
+}
+
+/*
+* Read minidump.dmp. Sequential reads are read ahead asynchronously by the
+* VmmReadStream functionality.
+*/
+_Success_(return == STATUS_SUCCESS)
+NTSTATUS M_MiniDump_ReadMiniDump(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+{
+    POB_M_MINIDUMP_CONTEXT pObMiniDump = NULL;
+    if(!(pObMiniDump = M_MiniDump_GetContext(ctxP))) { return VMMDLL_STATUS_FILE_INVALID; }
+    VmmReadStream(
+        ((QWORD)M_MINIDUMP_READSTREAM << 32) | pObMiniDump->dwPID,
+        PluginManager_ContextHandleId(ctxP),
+        (PVMM_READSTREAM_PFN)M_MiniDump_ReadMiniDump_Stream,
+        (POB)pObMiniDump,
+        pObMiniDump->cb + pObMiniDump->cbMemory,
+        pb, cb, pcbRead, cbOffset
+    );
     Ob_DECREF(pObMiniDump);
     return VMM_STATUS_SUCCESS;
 }
@@ -30,24 +30,62 @@ typedef struct tdM_PHYS2VIRT_MULTIENTRY_CONTEXT {
     M_PHYS2VIRT_MULTIENTRY e[0];
 } M_PHYS2VIRT_MULTIENTRY_CONTEXT, *PM_PHYS2VIRT_MULTIENTRY_CONTEXT;
 
-VOID Phys2Virt_GetUpdateAll_CallbackAction(_In_ PVMM_PROCESS pProcess, _In_opt_ PVOID ctxIn)
+typedef struct tdM_PHYS2VIRT_PARTIAL {
+    DWORD c;
+    DWORD cMax;
+    PM_PHYS2VIRT_MULTIENTRY pe;
+} M_PHYS2VIRT_PARTIAL, *PM_PHYS2VIRT_PARTIAL;
+
+typedef struct tdM_PHYS2VIRT_UPDATEALL_CONTEXT {
+    PM_PHYS2VIRT_MULTIENTRY_CONTEXT pResult;
+    DWORD dwPIDs[];
+} M_PHYS2VIRT_UPDATEALL_CONTEXT, *PM_PHYS2VIRT_UPDATEALL_CONTEXT;
+
+/*
+* Parallel-for action: retrieve phys2virt information for a single process and
+* append the result to the per-thread partial result.
+*/
+VOID Phys2Virt_GetUpdateAll_Action(_In_ PM_PHYS2VIRT_UPDATEALL_CONTEXT ctx, _In_ PM_PHYS2VIRT_PARTIAL pPartial, _In_ DWORD iItem)
 {
-    PM_PHYS2VIRT_MULTIENTRY_CONTEXT ctx = (PM_PHYS2VIRT_MULTIENTRY_CONTEXT)ctxIn;
-    DWORD i, j;
+    DWORD j, cMax;
+    PM_PHYS2VIRT_MULTIENTRY pe;
+    PVMM_PROCESS pObProcess = NULL;
     PVMMOB_PHYS2VIRT_INFORMATION pObPhys2Virt = NULL;
-    if(!ctx) { return; }
-    pObPhys2Virt = VmmPhys2VirtGetInformation(pProcess, ctx->pa);
-    if(!pObPhys2Virt) { return; }
+    if(!(pObProcess = VmmProcessGet(ctx->dwPIDs[iItem]))) { goto fail; }
+    if(!(pObPhys2Virt = VmmPhys2VirtGetInformation(pObProcess, ctx->pResult->pa))) { goto fail; }
     for(j = 0; j < pObPhys2Virt->cvaList; j++) {
-        if(pObPhys2Virt->pvaList[j]) {
-            i = InterlockedIncrement(&ctx->c);
-            if(i < ctx->cMax) {
-                ctx->e[i].dwPID = pProcess->dwPID;
-                ctx->e[i].va = pObPhys2Virt->pvaList[j];
+        if(!pObPhys2Virt->pvaList[j]) { continue; }
+        if(pPartial->c == pPartial->cMax) {
+            cMax = max(0x40, 2 * pPartial->cMax);
+            if(!(pe = LocalAlloc(0, cMax * sizeof(M_PHYS2VIRT_MULTIENTRY)))) { goto fail; }
+            if(pPartial->c) {
+                memcpy(pe, pPartial->pe, pPartial->c * sizeof(M_PHYS2VIRT_MULTIENTRY));
             }
+            LocalFree(pPartial->pe);
+            pPartial->pe = pe;
+            pPartial->cMax = cMax;
         }
+        pPartial->pe[pPartial->c].dwPID = pObProcess->dwPID;
+        pPartial->pe[pPartial->c].va = pObPhys2Virt->pvaList[j];
+        pPartial->c++;
     }
+fail:
     Ob_DECREF(pObPhys2Virt);
+    Ob_DECREF(pObProcess);
+}
+
+/*
+* Parallel-for reduction: merge a per-thread partial result into the result.
+*/
+VOID Phys2Virt_GetUpdateAll_Reduce(_In_ PM_PHYS2VIRT_UPDATEALL_CONTEXT ctx, _In_ PM_PHYS2VIRT_PARTIAL pPartial)
+{
+    PM_PHYS2VIRT_MULTIENTRY_CONTEXT pResult = ctx->pResult;
+    DWORD c = min(pPartial->c, pResult->cMax - pResult->c);
+    if(c) {
+        memcpy(pResult->e + pResult->c, pPartial->pe, c * sizeof(M_PHYS2VIRT_MULTIENTRY));
+        pResult->c += c;
+    }
+    LocalFree(pPartial->pe);
 }
 
 /*
@@ -56,22 +94,47 @@ VOID Phys2Virt_GetUpdateAll_CallbackAction(_In_ PVMM_PROCESS pProcess, _In_opt_
 _Success_(return)
 BOOL Phys2Virt_GetUpdateAll(_Out_opt_ PM_PHYS2VIRT_MULTIENTRY_CONTEXT *ppMultiEntry, _Out_opt_ PDWORD pcMultiEntry)
 {
-    PM_PHYS2VIRT_MULTIENTRY_CONTEXT ctx = NULL;
+    BOOL fResult = FALSE;
+    DWORD cProcess = 0;
     SIZE_T cPIDs = 0;
+    PQWORD pqwWeight = NULL;
+    PVMM_PROCESS pObProcess = NULL;
+    PM_PHYS2VIRT_UPDATEALL_CONTEXT ctx = NULL;
+    PM_PHYS2VIRT_MULTIENTRY_CONTEXT pResult = NULL;
+    // 1: select active processes and their weights
     VmmProcessListPIDs(NULL, &cPIDs, 0);
-    ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(M_PHYS2VIRT_MULTIENTRY_CONTEXT) + cPIDs * 4 * sizeof(M_PHYS2VIRT_MULTIENTRY));
-    if(!ctx) { return FALSE; }
-    ctx->pa = ctxVmm->paPluginPhys2VirtRoot;
-    ctx->cMax = (DWORD)cPIDs * 4;
-    VmmProcessActionForeachParallel(ctx, VmmProcessActionForeachParallel_CriteriaActiveOnly, Phys2Virt_GetUpdateAll_CallbackAction);
-    ctx->c = min(ctx->c, ctx->cMax - 1);
-    if(pcMultiEntry) { *pcMultiEntry = ctx->c; }
+    if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(M_PHYS2VIRT_UPDATEALL_CONTEXT) + cPIDs * sizeof(DWORD)))) { goto fail; }
+    if(!(pqwWeight = LocalAlloc(0, cPIDs * sizeof(QWORD)))) { goto fail; }
+    while((pObProcess = VmmProcessGetNext(pObProcess, 0))) {
+        if((cProcess < cPIDs) && VmmProcessActionForeachParallel_CriteriaActiveOnly(pObProcess, NULL)) {
+            ctx->dwPIDs[cProcess] = pObProcess->dwPID;
+            pqwWeight[cProcess] = VmmProcessWeight(pObProcess);
+            cProcess++;
+        }
+    }
+    // 2: allocate result and process in parallel
+    pResult = LocalAlloc(LMEM_ZEROINIT, sizeof(M_PHYS2VIRT_MULTIENTRY_CONTEXT) + cProcess * VMM_PHYS2VIRT_INFORMATION_MAX_PROCESS_RESULT * sizeof(M_PHYS2VIRT_MULTIENTRY));
+    if(!pResult) { goto fail; }
+    pResult->pa = ctxVmm->paPluginPhys2VirtRoot;
+    pResult->cMax = cProcess * VMM_PHYS2VIRT_INFORMATION_MAX_PROCESS_RESULT;
+    ctx->pResult = pResult;
+    VmmWorkParallelFor(
+        ctx, cProcess, pqwWeight, sizeof(M_PHYS2VIRT_PARTIAL),
+        (VOID(*)(PVOID, PVOID, DWORD))Phys2Virt_GetUpdateAll_Action,
+        (VOID(*)(PVOID, PVOID))Phys2Virt_GetUpdateAll_Reduce,
+        NULL
+    );
+    if(pcMultiEntry) { *pcMultiEntry = pResult->c; }
     if(ppMultiEntry) {
-        *ppMultiEntry = ctx;
-    } else {
-        LocalFree(ctx);
+        *ppMultiEntry = pResult;
+        pResult = NULL;
     }
-    return TRUE;
+    fResult = TRUE;
+fail:
+    LocalFree(pResult);
+    LocalFree(pqwWeight);
+    LocalFree(ctx);
+    return fResult;
 }
 
 /*
@@ -96,10 +159,8 @@ NTSTATUS Phys2Virt_ReadVirtRoot(_Out_ PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbR
         cbBufferMax = 24 * ctx->c + 0x10;
         pbBuffer = LocalAlloc(0, cbBufferMax);
         if(pbBuffer) {
-            if(ctx->c > 1) {
-                qsort(ctx->e + 1, ctx->c - 1, sizeof(M_PHYS2VIRT_MULTIENTRY), (_CoreCrtNonSecureSearchSortCompareFunction)Phys2Virt_ReadVirtRoot_CmpSort);
-            }
-            for(i = 1; i <= ctx->c; i++) {
+            qsort(ctx->e, ctx->c, sizeof(M_PHYS2VIRT_MULTIENTRY), (_CoreCrtNonSecureSearchSortCompareFunction)Phys2Virt_ReadVirtRoot_CmpSort);
+            for(i = 0; i < ctx->c; i++) {
                 cbBuffer += snprintf(
                     pbBuffer + cbBuffer,
                     cbBufferMax - cbBuffer,
@@ -11,8 +11,8 @@ LPCSTR szSEARCH_README =
 "Information about the search module                                          \n" \
 "===================================                                          \n" \
 "Write a hexascii sequence into search.txt and save to trigger a binary search\n" \
-"in virtual address space for the data searched. The results once completed is\n" \
-"shown in result.txt                                                          \n" \
+"in virtual address space for the data searched. Results are shown in        \n" \
+"result.txt as they are found - also while the search is still running.       \n" \
 "---                                                                          \n" \
 "Before a search is initiated (by writing to search.txt) it is possible to add\n" \
 "additional constraints to writeable files:                                   \n" \
@@ -27,7 +27,10 @@ typedef struct tdMOB_SEARCH_CONTEXT {
     BOOL fActive;
     BOOL fCompleted;
     VMM_MEMORY_SEARCH_CONTEXT sctx;
-    POB_DATA pObDataResult;
+    SRWLOCK LockSRW;            // protects result below
+    DWORD cResult;
+    DWORD cResultMax;
+    PQWORD pvaResult;
 } MOB_SEARCH_CONTEXT, *PMOB_SEARCH_CONTEXT;
 
 VOID MSearch_ContextUpdate(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _In_opt_ PMOB_SEARCH_CONTEXT ctxS)
@@ -47,7 +50,37 @@ VOID MSearch_ContextCleanup1_CB(PVOID pOb)
 
 VOID MSearch_ContextCleanup_CB(PVOID pOb)
 {
-    Ob_DECREF(((PMOB_SEARCH_CONTEXT)pOb)->pObDataResult);
+    LocalFree(((PMOB_SEARCH_CONTEXT)pOb)->pvaResult);
+}
+
+/*
+* Streaming search result callback - append results to the search context so
+* that they are visible in result.txt while the search is still running.
+*/
+BOOL MSearch_ResultBatch_CB(_In_ PVMM_MEMORY_SEARCH_CONTEXT ctxs, _In_ DWORD cResult, _In_reads_(cResult) PQWORD pva, _In_reads_(cResult) PDWORD piSearch)
+{
+    PMOB_SEARCH_CONTEXT ctxS = (PMOB_SEARCH_CONTEXT)ctxs->pvUserPtrOpt;
+    DWORD cResultMax;
+    PQWORD pvaResult;
+    if(ctxS->cResult + cResult > ctxS->cResultMax) {
+        cResultMax = max(0x1000, 2 * (ctxS->cResult + cResult));
+        if(!(pvaResult = LocalAlloc(0, cResultMax * sizeof(QWORD)))) { return FALSE; }
+        AcquireSRWLockExclusive(&ctxS->LockSRW);
+        if(ctxS->cResult) {
+            memcpy(pvaResult, ctxS->pvaResult, ctxS->cResult * sizeof(QWORD));
+        }
+        LocalFree(ctxS->pvaResult);
+        ctxS->pvaResult = pvaResult;
+        ctxS->cResultMax = cResultMax;
+        ReleaseSRWLockExclusive(&ctxS->LockSRW);
+    }
+    // results are appended beyond cResult and only become visible to readers
+    // once cResult is updated.
+    memcpy(ctxS->pvaResult + ctxS->cResult, pva, cResult * sizeof(QWORD));
+    AcquireSRWLockExclusive(&ctxS->LockSRW);
+    ctxS->cResult += cResult;
+    ReleaseSRWLockExclusive(&ctxS->LockSRW);
+    return TRUE;
 }
 
 /*
@@ -60,7 +93,10 @@ PMOB_SEARCH_CONTEXT MSearch_ContextGet(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP)
     pObCtx = ObMap_GetByKey((POB_MAP)ctxP->ctxM, ctxP->dwPID);
     LeaveCriticalSection(&ctxVmm->LockPlugin);
     if(!pObCtx && (pObCtx = Ob_Alloc(OB_TAG_MOD_SEARCH_CTX, LMEM_ZEROINIT, sizeof(MOB_SEARCH_CONTEXT), MSearch_ContextCleanup_CB, MSearch_ContextCleanup1_CB))) {
+        InitializeSRWLock(&pObCtx->LockSRW);
         pObCtx->sctx.cSearch = 1;
+        pObCtx->sctx.pvUserPtrOpt = pObCtx;
+        pObCtx->sctx.pfnResultBatchOptCB = MSearch_ResultBatch_CB;
         pObCtx->dwPID = ((PVMM_PROCESS)ctxP->pProcess)->dwPID;
         if(((PVMM_PROCESS)ctxP->pProcess)->fUserOnly) {
             pObCtx->sctx.vaMax = ctxVmm->f32 ? 0x7fffffff : 0x7fffffffffff;
@@ -79,7 +115,7 @@ DWORD WINAPI MSearch_PerformSeach_ThreadProc(_In_ PMOB_SEARCH_CONTEXT ctxS)
 {
     PVMM_PROCESS pObProcess = NULL;
     if((pObProcess = VmmProcessGet(ctxS->dwPID))) {
-        VmmSearch(pObProcess, &ctxS->sctx, &ctxS->pObDataResult);
+        VmmSearch(pObProcess, &ctxS->sctx, NULL);
     }
     ctxS->fCompleted = TRUE;
     ctxS->fActive = FALSE;
@@ -274,13 +310,15 @@ NTSTATUS MSearch_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_writes_to_(cb, *pcb
         nt = Util_VfsReadFile_FromBOOL(FALSE, pb, cb, pcbRead, cbOffset);
     } else if(!_stricmp(ctxP->uszPath, "result.txt")) {
         nt = VMMDLL_STATUS_END_OF_FILE;
-        if(pObCtx->pObDataResult) {
+        AcquireSRWLockShared(&pObCtx->LockSRW);
+        if(pObCtx->cResult) {
             nt = Util_VfsLineFixed_Read(
                 (UTIL_VFSLINEFIXED_PFN_CB)MSearch_ReadLine_CB, NULL, ctxVmm->f32 ? 9 : 17, NULL,
-                pObCtx->pObDataResult->pqw, pObCtx->pObDataResult->ObHdr.cbData / sizeof(QWORD), sizeof(QWORD),
+                pObCtx->pvaResult, pObCtx->cResult, sizeof(QWORD),
                 pb, cb, pcbRead, cbOffset
             );
         }
+        ReleaseSRWLockShared(&pObCtx->LockSRW);
     } else if(!_stricmp(ctxP->uszPath, "search.txt")) {
         nt = Util_VfsReadFile_FromHEXASCII(pObCtx->sctx.search[0].pb, pObCtx->sctx.search[0].cb, pb, cb, pcbRead, cbOffset);
     } else if(!_stricmp(ctxP->uszPath, "search-skip-bitmask.txt")) {
@@ -302,7 +340,8 @@ NTSTATUS MSearch_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_writes_to_(cb, *pcb
 */
 BOOL MSearch_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Inout_ PHANDLE pFileList)
 {
-    DWORD cbResult = 0;
+    DWORD cbStatus, cResult;
+    QWORD cbResult;
     PMOB_SEARCH_CONTEXT pObCtx = NULL;
     if(ctxP->uszPath[0]) { return FALSE; }
     if(!(pObCtx = MSearch_ContextGet(ctxP))) { return FALSE; }
@@ -311,13 +350,16 @@ BOOL MSearch_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Inout_ PHANDLE pFileList)
     VMMDLL_VfsList_AddFile(pFileList, "align.txt", 3, NULL);
     VMMDLL_VfsList_AddFile(pFileList, "readme.txt", strlen(szSEARCH_README), NULL);
     VMMDLL_VfsList_AddFile(pFileList, "reset.txt", 1, NULL);
-    cbResult = pObCtx->pObDataResult ? ((ctxVmm->f32 ? 9ULL : 17ULL) * pObCtx->pObDataResult->ObHdr.cbData / sizeof(QWORD)) : 0;
+    AcquireSRWLockShared(&pObCtx->LockSRW);
+    cResult = pObCtx->cResult;
+    ReleaseSRWLockShared(&pObCtx->LockSRW);
+    cbResult = (ctxVmm->f32 ? 9ULL : 17ULL) * cResult;
     VMMDLL_VfsList_AddFile(pFileList, "result.txt", cbResult, NULL);
     VMMDLL_VfsList_AddFile(pFileList, "search.txt", pObCtx->sctx.search[0].cb * 2ULL, NULL);
     VMMDLL_VfsList_AddFile(pFileList, "search-skip-bitmask.txt", pObCtx->sctx.search[0].cb * 2ULL, NULL);
-    cbResult = 0;
-    MSearch_ReadStatus(pObCtx, NULL, 0, &cbResult, 0);
-    VMMDLL_VfsList_AddFile(pFileList, "status.txt", cbResult, NULL);
+    cbStatus = 0;
+    MSearch_ReadStatus(pObCtx, NULL, 0, &cbStatus, 0);
+    VMMDLL_VfsList_AddFile(pFileList, "status.txt", cbStatus, NULL);
     Ob_DECREF(pObCtx);
     return TRUE;
 }
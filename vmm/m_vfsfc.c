@@ -29,6 +29,7 @@ LPCSTR szMFC_README =
 "will take place. This may take some time due to scanning of the whole memory\n" \
 "image and timeline construction.                                            \n" \
 "If possible the file name of the sqlite will show in database.txt.          \n" \
+"Physical memory scan throughput (MB/s per stage) shows in progress_physmem. \n" \
 "Valid initialization values for forensic_enable.txt are listed below:       \n" \
 " 1 = in-memory sqlite database.                                             \n" \
 " 2 = temporary sqlite database which will be deleted upon MemProcFS exit.   \n" \
@@ -43,12 +44,17 @@ LPCSTR szMFC_README =
 NTSTATUS M_VfsFc_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
     BYTE btp;
+    CHAR szStatistics[0x400];
     if(!_stricmp(ctx->uszPath, "readme.txt")) {
         return Util_VfsReadFile_FromStrA(szMFC_README, pb, cb, pcbRead, cbOffset);
     }
     if(!_stricmp(ctx->uszPath, "progress_percent.txt")) {
         return Util_VfsReadFile_FromNumber(ctxFc ? ctxFc->cProgressPercent : 0, pb, cb, pcbRead, cbOffset);
     }
+    if(!_stricmp(ctx->uszPath, "progress_physmem.txt")) {
+        FcScanPhysmem_StatisticsToString(szStatistics, sizeof(szStatistics));
+        return Util_VfsReadFile_FromPBYTE((PBYTE)szStatistics, strlen(szStatistics), pb, cb, pcbRead, cbOffset);
+    }
     if(!_stricmp(ctx->uszPath, "forensic_enable.txt")) {
         btp = '0' + (ctxFc ? (BYTE)ctxFc->db.tp : 0);
         return Util_VfsReadFile_FromPBYTE(&btp, 1, pb, cb, pcbRead, cbOffset);
@@ -81,6 +87,7 @@ BOOL M_VfsFc_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
     qwProgress = ctxFc ? ctxFc->cProgressPercent : 0;
     qwProgress = (qwProgress == 100) ? 3 : ((qwProgress >= 10) ? 2 : 1);
     VMMDLL_VfsList_AddFile(pFileList, "progress_percent.txt", qwProgress, NULL);
+    VMMDLL_VfsList_AddFile(pFileList, "progress_physmem.txt", FcScanPhysmem_StatisticsToString(NULL, 0), NULL);
     VMMDLL_VfsList_AddFile(pFileList, "forensic_enable.txt", 1, NULL);
     VMMDLL_VfsList_AddFile(pFileList, "database.txt", ctxFc ? strlen(ctxFc->db.uszDatabasePath) : 0, NULL);
     VMMDLL_VfsList_AddFile(pFileList, "readme.txt", strlen(szMFC_README), NULL);
@@ -19,6 +19,9 @@
 #define KDBG64_ContextKPRCB         0x338
 #define KDBG64_OffsetPrcbNumber     0x2be
 
+#define MVFSROOT_READSTREAM_PMEM    'pmem'
+#define MVFSROOT_READSTREAM_DMP     'dmp '
+
 typedef struct tdVMMVFS_DUMP_CONTEXT_OVERLAY {
     QWORD pa;
     DWORD cb;
@@ -331,7 +334,64 @@ POB_VMMVFS_DUMP_CONTEXT MVfsRoot_GetDumpContext()
 }
 
 /*
-* Read from memory dump files in the virtual file system root.
+* Synchronous read of memory.pmem - read function of the file stream.
+* -- pObCtx
+* -- pb
+* -- cb
+* -- cbOffset
+*/
+VOID MVfsRoot_ReadPmem(_In_opt_ POB pObCtx, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _In_ QWORD cbOffset)
+{
+    VmmReadEx(NULL, cbOffset, pb, cb, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
+}
+
+/*
+* Synchronous read of memory.dmp - read function of the file stream.
+* -- pObDumpCtx
+* -- pb
+* -- cb
+* -- cbOffset
+*/
+VOID MVfsRoot_ReadDmp(_In_ POB_VMMVFS_DUMP_CONTEXT pObDumpCtx, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _In_ QWORD cbOffset)
+{
+    PVMMVFS_DUMP_CONTEXT_OVERLAY po;
+    DWORD io, cbHead;
+    DWORD cbOverlayOffset, cbOverlay;
+    QWORD cbOverlayAdjust;
+    // read dump header
+    if(cbOffset < pObDumpCtx->cbHdr) {
+        cbHead = min(cb, pObDumpCtx->cbHdr - (DWORD)cbOffset);
+        memcpy(pb, pObDumpCtx->Hdr.pb + cbOffset, cbHead);
+        pb += cbHead;
+        cb -= cbHead;
+        cbOffset += cbHead;
+    }
+    if(cb == 0) { return; }
+    cbOffset -= pObDumpCtx->cbHdr;
+    // read memory
+    VmmReadEx(NULL, cbOffset, pb, cb, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
+    // overlay decrypted KDBG, KdpDataBlockEncoded (if encrypted) and ProcessorContext0
+    for(io = 0; io < sizeof(pObDumpCtx->OVERLAY) / sizeof(VMMVFS_DUMP_CONTEXT_OVERLAY); io++) {
+        po = pObDumpCtx->OVERLAY + io;
+        if(!po->cb) { continue; }
+        if((cbOffset <= po->pa + po->cb) && (cbOffset + cb > po->pa)) {
+            if(po->pa <= cbOffset) {
+                cbOverlayAdjust = 0;
+                cbOverlayOffset = (DWORD)(cbOffset - po->pa);
+                cbOverlay = min(po->cb - cbOverlayOffset, cb);
+            } else {
+                cbOverlayAdjust = po->pa - cbOffset;
+                cbOverlayOffset = 0;
+                cbOverlay = (DWORD)min(po->cb, cb - cbOverlayAdjust);
+            }
+            memcpy(pb + cbOverlayAdjust, po->pb + cbOverlayOffset, cbOverlay);
+        }
+    }
+}
+
+/*
+* Read from memory dump files in the virtual file system root. Sequential
+* reads are read ahead asynchronously by the VmmReadStream functionality.
 * -- ctx
 * -- pb
 * -- cb
@@ -341,57 +401,18 @@ POB_VMMVFS_DUMP_CONTEXT MVfsRoot_GetDumpContext()
 */
 NTSTATUS MVfsRoot_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
-    NTSTATUS nt = VMM_STATUS_FILE_INVALID;
     POB_VMMVFS_DUMP_CONTEXT pObDumpCtx = NULL;
-    PVMMVFS_DUMP_CONTEXT_OVERLAY po;
-    DWORD io, cbHead = 0, cbReadMem = 0;
-    DWORD cbOverlayOffset, cbOverlay;
-    QWORD cbOverlayAdjust;
     if(!_stricmp(ctx->uszPath, "memory.pmem")) {
-        VmmReadEx(NULL, cbOffset, pb, cb, pcbRead, VMM_FLAG_ZEROPAD_ON_FAIL);
+        VmmReadStream(MVFSROOT_READSTREAM_PMEM, PluginManager_ContextHandleId(ctx), MVfsRoot_ReadPmem, NULL, ctxMain->dev.paMax, pb, cb, pcbRead, cbOffset);
         return VMM_STATUS_SUCCESS;
     }
     if(!_stricmp(ctx->uszPath, "memory.dmp")) {
-        if(!(pObDumpCtx = MVfsRoot_GetDumpContext())) { goto finish; }
-        // read dump header
-        if(cbOffset < pObDumpCtx->cbHdr) {
-            cbHead = min(cb, pObDumpCtx->cbHdr - (DWORD)cbOffset);
-            memcpy(pb, pObDumpCtx->Hdr.pb + cbOffset, cbHead);
-            pb += cbHead;
-            cb -= cbHead;
-            cbOffset += cbHead;
-        }
-        if(cb == 0) {
-            if(pcbRead) { *pcbRead = cbHead; }
-            nt = VMM_STATUS_SUCCESS;
-            goto finish;
-        }
-        cbOffset -= pObDumpCtx->cbHdr;
-        // read memory
-        VmmReadEx(NULL, cbOffset, pb, cb, &cbReadMem, VMM_FLAG_ZEROPAD_ON_FAIL);
-        if(pcbRead) { *pcbRead = cbHead + cbReadMem; }
-        // overlay decrypted KDBG, KdpDataBlockEncoded (if encrypted) and ProcessorContext0
-        for(io = 0; io < sizeof(pObDumpCtx->OVERLAY) / sizeof(VMMVFS_DUMP_CONTEXT_OVERLAY); io++) {
-            po = pObDumpCtx->OVERLAY + io;
-            if(!po->cb) { continue; }
-            if((cbOffset <= po->pa + po->cb) && (cbOffset + cb > po->pa)) {
-                if(po->pa <= cbOffset) {
-                    cbOverlayAdjust = 0;
-                    cbOverlayOffset = (DWORD)(cbOffset - po->pa);
-                    cbOverlay = min(po->cb - cbOverlayOffset, cb);
-                } else {
-                    cbOverlayAdjust = po->pa - cbOffset;
-                    cbOverlayOffset = 0;
-                    cbOverlay = (DWORD)min(po->cb, cb - cbOverlayAdjust);
-                }
-                memcpy(pb + cbOverlayAdjust, po->pb + cbOverlayOffset, cbOverlay);
-            }
-        }
-        nt = VMM_STATUS_SUCCESS;
+        if(!(pObDumpCtx = MVfsRoot_GetDumpContext())) { return VMM_STATUS_FILE_INVALID; }
+        VmmReadStream(MVFSROOT_READSTREAM_DMP, PluginManager_ContextHandleId(ctx), (PVMM_READSTREAM_PFN)MVfsRoot_ReadDmp, (POB)pObDumpCtx, ctxMain->dev.paMax + pObDumpCtx->cbHdr, pb, cb, pcbRead, cbOffset);
+        Ob_DECREF(pObDumpCtx);
+        return VMM_STATUS_SUCCESS;
     }
-finish:
-    Ob_DECREF(pObDumpCtx);
-    return nt;
+    return VMM_STATUS_FILE_INVALID;
 }
 
 /*
@@ -42,6 +42,33 @@ VOID MmWin_PagingInitialize(_In_ BOOL fModeFull);
 */
 VOID MmWin_PagingClose();
 
+/*
+* Read multiple pages from a page file. Reads are sorted by offset and adjacent
+* pages are coalesced into larger reads. Page files are read without a global
+* lock and may be called concurrently from multiple threads.
+* -- dwPfNumber
+* -- cPages
+* -- pdwPfOffset = page file offsets (in pages).
+* -- ppbPages = buffers (4096 bytes each) receiving the pages.
+* -- pfResult = per-page result.
+* -- return = number of successfully read pages.
+*/
+DWORD MmWin_PfReadFileBatch(_In_ DWORD dwPfNumber, _In_ DWORD cPages, _In_reads_(cPages) PDWORD pdwPfOffset, _Out_writes_(cPages) PBYTE *ppbPages, _Out_writes_(cPages) PBOOL pfResult);
+
+/*
+* Decompress multiple pages from the Win10+ compressed virtual store in one
+* pass. Store metadata is resolved once and shared between pages of the same
+* store; compressed data is prefetched in a single scatter read.
+* -- pProcess
+* -- cPages
+* -- pqwPTE = compressed software PTEs.
+* -- ppbPages = buffers (4096 bytes each) receiving the decompressed pages.
+* -- pfResult = per-page result.
+* -- fVmmRead = flags to VmmRead function calls.
+* -- return = number of successfully decompressed pages.
+*/
+DWORD MmWin_MemCompressBatch(_In_ PVMM_PROCESS pProcess, _In_ DWORD cPages, _In_reads_(cPages) PQWORD pqwPTE, _Out_writes_(cPages) PBYTE *ppbPages, _Out_writes_(cPages) PBOOL pfResult, _In_ QWORD fVmmRead);
+
 /*
 * Initialize / Ensure that a VAD map is initialized for the specific process.
 * -- pProcess
@@ -52,6 +52,25 @@ typedef struct tdMMWIN_MEMCOMPRESS_OFFSET {
     } SMKM_STORE;
 } MMWIN_MEMCOMPRESS_OFFSET, *PMMWIN_MEMCOMPRESS_OFFSET;
 
+#define MMWIN_BTREE_LEAFCACHE_SLOTS                 4
+
+/*
+* Small cache of recently walked B+-tree leaf pages. A leaf page is valid for
+* the medium refresh tick it was read in; keys within [kMin, kMax] of a cached
+* leaf are resolved without walking the tree from its root.
+*/
+typedef struct tdMMWIN_BTREE_LEAFCACHE {
+    SRWLOCK LockSRW;
+    QWORD tc;                   // ctxVmm->tcRefreshMedium at time of fill
+    DWORD iSlotNext;
+    struct {
+        QWORD va;
+        DWORD kMin;
+        DWORD kMax;
+        BYTE pb[0x1000];
+    } Slot[MMWIN_BTREE_LEAFCACHE_SLOTS];
+} MMWIN_BTREE_LEAFCACHE, *PMMWIN_BTREE_LEAFCACHE;
+
 typedef struct tdMMWIN_MEMCOMPRESS_CONTEXT {
     QWORD vaEPROCESS;
     DWORD dwPid;
@@ -62,11 +81,23 @@ typedef struct tdMMWIN_MEMCOMPRESS_CONTEXT {
     QWORD vaSmGlobals;
     QWORD vaKeyToStoreTree;
     MMWIN_MEMCOMPRESS_OFFSET O;
+    POB_CACHEMAP pObCacheMapStore;              // iSmkm -> PMMWINOB_MEMCOMPRESS_STORE
+    MMWIN_BTREE_LEAFCACHE KeyToStoreLeafCache;
 } MMWIN_MEMCOMPRESS_CONTEXT, *PMMWIN_MEMCOMPRESS_CONTEXT;
 
+typedef struct tdMMWIN_PAGEFILE {
+    BOOL fValid;
+    QWORD cb;
+#ifdef _WIN32
+    HANDLE hFile;
+#endif /* _WIN32 */
+#ifdef LINUX
+    int fd;
+#endif /* LINUX */
+} MMWIN_PAGEFILE, *PMMWIN_PAGEFILE;
+
 typedef struct tdMMWIN_CONTEXT {
-    CRITICAL_SECTION Lock;
-    FILE *pPageFile[10];
+    MMWIN_PAGEFILE PageFile[10];
     MMWIN_MEMCOMPRESS_CONTEXT MemCompress;
 } MMWIN_CONTEXT, *PMMWIN_CONTEXT;
 
@@ -114,10 +145,12 @@ typedef struct td_BTREE64 {
 } _BTREE64, *P_BTREE64;
 
 _Success_(return)
-BOOL MmWin_BTree32_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _In_ QWORD fVmmRead);
+BOOL MmWin_BTree32_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _Inout_opt_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD fVmmRead);
 
 _Success_(return)
-BOOL MmWin_BTree64_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _In_ QWORD fVmmRead);
+BOOL MmWin_BTree64_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _Inout_opt_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD fVmmRead);
+
+VOID MmWin_BTree_LeafCachePut(_Inout_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD vaLeaf, _In_reads_(0x1000) PBYTE pbLeaf);
 
 _Success_(return)
 BOOL MmWin_BTree32_SearchLeaf(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE32 pT, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _In_ QWORD fVmmRead)
@@ -187,7 +220,7 @@ BOOL MmWin_BTree64_SearchLeaf(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE64 p
 }
 
 _Success_(return)
-BOOL MmWin_BTree32_SearchNode(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE32 pT, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _In_ QWORD fVmmRead)
+BOOL MmWin_BTree32_SearchNode(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE32 pT, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _Inout_opt_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD fVmmRead)
 {
     BOOL fSearchPreFail = FALSE;
     DWORD i, dwSearchStep, dwSearchIndex = 1;
@@ -207,7 +240,7 @@ BOOL MmWin_BTree32_SearchNode(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE32 p
             } else {
                 vaSubTree = pT->NodeEntries[dwSearchIndex].vaLeaf;
             }
-            return MmWin_BTree32_Search(pSystemProcess, vaSubTree, dwKey, pdwValue, MM_LOOP_PROTECT_ADD(fVmmRead));
+            return MmWin_BTree32_Search(pSystemProcess, vaSubTree, dwKey, pdwValue, plc, MM_LOOP_PROTECT_ADD(fVmmRead));
         } else if(pT->NodeEntries[dwSearchIndex].k < dwKey) {
             if(dwSearchIndex + dwSearchStep < pT->cEntries) {
                 dwSearchIndex += dwSearchStep;
@@ -221,7 +254,7 @@ BOOL MmWin_BTree32_SearchNode(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE32 p
 }
 
 _Success_(return)
-BOOL MmWin_BTree64_SearchNode(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE64 pT, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _In_ QWORD fVmmRead)
+BOOL MmWin_BTree64_SearchNode(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE64 pT, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _Inout_opt_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD fVmmRead)
 {
     BOOL fSearchPreFail = FALSE;
     DWORD i, dwSearchStep, dwSearchIndex = 1, dwSearchCount = 0;
@@ -242,7 +275,7 @@ BOOL MmWin_BTree64_SearchNode(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE64 p
             } else {
                 vaSubTree = pT->NodeEntries[dwSearchIndex].vaLeaf;
             }
-            return MmWin_BTree64_Search(pSystemProcess, vaSubTree, dwKey, pdwValue, MM_LOOP_PROTECT_ADD(fVmmRead));
+            return MmWin_BTree64_Search(pSystemProcess, vaSubTree, dwKey, pdwValue, plc, MM_LOOP_PROTECT_ADD(fVmmRead));
         } else if(pT->NodeEntries[dwSearchIndex].k < dwKey) {
             if(dwSearchIndex + dwSearchStep < pT->cEntries) {
                 dwSearchIndex += dwSearchStep;
@@ -256,7 +289,7 @@ BOOL MmWin_BTree64_SearchNode(_In_ PVMM_PROCESS pSystemProcess, _In_ P_BTREE64 p
 }
 
 _Success_(return)
-BOOL MmWin_BTree32_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _In_ QWORD fVmmRead)
+BOOL MmWin_BTree32_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _Inout_opt_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD fVmmRead)
 {
     BOOL f;
     BYTE pbBuffer[0x1000];
@@ -270,16 +303,17 @@ BOOL MmWin_BTree32_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DW
     if(pT->fLeaf) {
         // Leaf
         if(pT->cEntries > 0x1ff) { return FALSE; }
+        if(plc) { MmWin_BTree_LeafCachePut(plc, vaTree, pbBuffer); }
         return MmWin_BTree32_SearchLeaf(pProcess, pT, dwKey, pdwValue, fVmmRead);
     } else {
         // Node
         if(pT->cEntries > 0x1ff) { return FALSE; }
-        return MmWin_BTree32_SearchNode(pProcess, pT, dwKey, pdwValue, fVmmRead);
+        return MmWin_BTree32_SearchNode(pProcess, pT, dwKey, pdwValue, plc, fVmmRead);
     }
 }
 
 _Success_(return)
-BOOL MmWin_BTree64_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _In_ QWORD fVmmRead)
+BOOL MmWin_BTree64_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _Inout_opt_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD fVmmRead)
 {
     BOOL f;
     BYTE pbBuffer[0x1000];
@@ -293,18 +327,89 @@ BOOL MmWin_BTree64_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DW
     if(pT->fLeaf) {
         // Leaf
         if(pT->cEntries > 0x1ff) { return FALSE; }
+        if(plc) { MmWin_BTree_LeafCachePut(plc, vaTree, pbBuffer); }
         return MmWin_BTree64_SearchLeaf(pProcess, pT, dwKey, pdwValue, fVmmRead);
     } else {
         // Node
         if(pT->cEntries > 0xff) { return FALSE; }
-        return MmWin_BTree64_SearchNode(pProcess, pT, dwKey, pdwValue, fVmmRead);
+        return MmWin_BTree64_SearchNode(pProcess, pT, dwKey, pdwValue, plc, fVmmRead);
     }
 }
 
+/*
+* Insert a B+-tree leaf page into the leaf cache. The least recently inserted
+* leaf is evicted. The whole cache is reset on a new medium refresh tick.
+* -- plc
+* -- vaLeaf
+* -- pbLeaf
+*/
+VOID MmWin_BTree_LeafCachePut(_Inout_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD vaLeaf, _In_reads_(0x1000) PBYTE pbLeaf)
+{
+    DWORD i, kMin, kMax, cEntries = *(PWORD)pbLeaf;
+    if(!cEntries) { return; }
+    if(ctxVmm->f32) {
+        kMin = ((P_BTREE32)pbLeaf)->LeafEntries[0].k;
+        kMax = ((P_BTREE32)pbLeaf)->LeafEntries[cEntries - 1].k;
+    } else {
+        kMin = ((P_BTREE64)pbLeaf)->LeafEntries[0].k;
+        kMax = ((P_BTREE64)pbLeaf)->LeafEntries[cEntries - 1].k;
+    }
+    if(kMin > kMax) { return; }
+    AcquireSRWLockExclusive(&plc->LockSRW);
+    if(plc->tc != ctxVmm->tcRefreshMedium) {
+        for(i = 0; i < MMWIN_BTREE_LEAFCACHE_SLOTS; i++) {
+            plc->Slot[i].va = 0;
+        }
+        plc->tc = ctxVmm->tcRefreshMedium;
+    }
+    for(i = 0; i < MMWIN_BTREE_LEAFCACHE_SLOTS; i++) {
+        if(plc->Slot[i].va == vaLeaf) { break; }
+    }
+    if(i == MMWIN_BTREE_LEAFCACHE_SLOTS) {
+        i = plc->iSlotNext++ % MMWIN_BTREE_LEAFCACHE_SLOTS;
+    }
+    plc->Slot[i].va = vaLeaf;
+    plc->Slot[i].kMin = kMin;
+    plc->Slot[i].kMax = kMax;
+    memcpy(plc->Slot[i].pb, pbLeaf, 0x1000);
+    ReleaseSRWLockExclusive(&plc->LockSRW);
+}
+
+/*
+* Search the cached B+-tree leaf pages for a key. Keys not found in the cache
+* (including keys within range of a cached leaf) should be looked up by a
+* regular tree walk by the caller.
+* -- plc
+* -- dwKey
+* -- pdwValue
+* -- return
+*/
+_Success_(return)
+BOOL MmWin_BTree_LeafCacheSearch(_In_ PMMWIN_BTREE_LEAFCACHE plc, _In_ DWORD dwKey, _Out_ PDWORD pdwValue)
+{
+    BOOL fResult = FALSE;
+    DWORD i;
+    AcquireSRWLockShared(&plc->LockSRW);
+    if(plc->tc == ctxVmm->tcRefreshMedium) {
+        for(i = 0; i < MMWIN_BTREE_LEAFCACHE_SLOTS; i++) {
+            if(plc->Slot[i].va && (dwKey >= plc->Slot[i].kMin) && (dwKey <= plc->Slot[i].kMax)) {
+                fResult = ctxVmm->f32 ?
+                    MmWin_BTree32_SearchLeaf(NULL, (P_BTREE32)plc->Slot[i].pb, dwKey, pdwValue, 0) :
+                    MmWin_BTree64_SearchLeaf(NULL, (P_BTREE64)plc->Slot[i].pb, dwKey, pdwValue, 0);
+                break;
+            }
+        }
+    }
+    ReleaseSRWLockShared(&plc->LockSRW);
+    return fResult;
+}
+
 _Success_(return)
-BOOL MmWin_BTree_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _In_ QWORD fVmmRead)
+BOOL MmWin_BTree_Search(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaTree, _In_ DWORD dwKey, _Out_ PDWORD pdwValue, _Inout_opt_ PMMWIN_BTREE_LEAFCACHE plc, _In_ QWORD fVmmRead)
 {
-    return ctxVmm->f32 ? MmWin_BTree32_Search(pProcess, vaTree, dwKey, pdwValue, fVmmRead) : MmWin_BTree64_Search(pProcess, vaTree, dwKey, pdwValue, fVmmRead);
+    if(plc && (fVmmRead & VMM_FLAG_NOCACHE)) { plc = NULL; }
+    if(plc && MmWin_BTree_LeafCacheSearch(plc, dwKey, pdwValue)) { return TRUE; }
+    return ctxVmm->f32 ? MmWin_BTree32_Search(pProcess, vaTree, dwKey, pdwValue, plc, fVmmRead) : MmWin_BTree64_Search(pProcess, vaTree, dwKey, pdwValue, plc, fVmmRead);
 }
 
 
@@ -647,11 +752,38 @@ fail:
 #define COMPRESS_ALGORITHM_MAX          6
 #define COMPRESS_RAW                    (1 << 29)
 
+#define MMWIN_SMKMSTORE_TABLE_SIZE      0x100
+
+typedef struct tdMMWIN_SMKMSTORE_TABLE_ENTRY {
+    QWORD qwKey;
+    QWORD va;
+} MMWIN_SMKMSTORE_TABLE_ENTRY, *PMMWIN_SMKMSTORE_TABLE_ENTRY;
+
+/*
+* Resolved and validated SmkmStore. Store objects are cached in the store
+* cache map keyed by store index (iSmkm) until the next medium refresh.
+* Chunk page record arrays, region pointers and B+-tree leaf pages of the
+* store are cached lazily as they are resolved.
+*/
+typedef struct tdMMWINOB_MEMCOMPRESS_STORE {
+    OB ObHdr;
+    DWORD iSmkm;
+    QWORD vaSmkmStore;
+    QWORD vaEPROCESS;
+    QWORD vaOwnerEPROCESS;
+    BYTE pbSmkm[0x2000];
+    SRWLOCK LockSRW;
+    MMWIN_SMKMSTORE_TABLE_ENTRY PageRecordArray[MMWIN_SMKMSTORE_TABLE_SIZE];     // ((iChunkPtr << 16) | iChunkArray) -> vaPageRecordArray
+    MMWIN_SMKMSTORE_TABLE_ENTRY Region[MMWIN_SMKMSTORE_TABLE_SIZE];              // dwRegionIndex -> vaRegion
+    MMWIN_BTREE_LEAFCACHE PagesTreeLeafCache;
+} MMWINOB_MEMCOMPRESS_STORE, *PMMWINOB_MEMCOMPRESS_STORE;
+
 typedef struct tdMMWINX64_COMPRESS_CONTEXT {
     QWORD fVmmRead;
     PVMM_PROCESS pProcess;
     PVMM_PROCESS pSystemProcess;
     PVMM_PROCESS pProcessMemCompress;
+    PMMWINOB_MEMCOMPRESS_STORE pObStore;    // store of most recently resolved page
     // per page items
     struct {
         QWORD va;
@@ -661,7 +793,7 @@ typedef struct tdMMWINX64_COMPRESS_CONTEXT {
         QWORD vaSmkmStore;
         QWORD vaEPROCESS;
         QWORD vaOwnerEPROCESS;
-        BYTE pbSmkm[0x2000];
+        PBYTE pbSmkm;
         DWORD dwRegionKey;
         QWORD vaPageRecord;
         QWORD vaRegion;
@@ -738,7 +870,8 @@ _Success_(return)
 BOOL MmWin_MemCompress1_SmkmStoreIndex(_In_ PMMWINX64_COMPRESS_CONTEXT ctx)
 {
     DWORD v;
-    if(!MmWin_BTree_Search(ctx->pSystemProcess, ((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.vaKeyToStoreTree, ctx->e.dwPageKey, &v, ctx->fVmmRead)) {
+    PMMWIN_MEMCOMPRESS_CONTEXT pmc = &((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress;
+    if(!MmWin_BTree_Search(ctx->pSystemProcess, pmc->vaKeyToStoreTree, ctx->e.dwPageKey, &v, &pmc->KeyToStoreLeafCache, ctx->fVmmRead)) {
         return MmWin_MemCompress_LogError(ctx, "#11 BTreeSearch");
     }
     if(v & 0x01000000) { return MmWin_MemCompress_LogError(ctx, "#12 InvalidValue"); }
@@ -787,33 +920,133 @@ BOOL MmWin_MemCompress2_SmkmStoreMetadata64(_In_ PMMWINX64_COMPRESS_CONTEXT ctx)
 }
 
 /*
-* Retrieve the SmkmStore and the PageRecord.
+* Look up a cached SmkmStore table entry (page record array or region).
+* -- pStore
+* -- pTable
+* -- qwKey
+* -- pva
+* -- return
+*/
+_Success_(return)
+BOOL MmWin_MemCompress_StoreTableGet(_In_ PMMWINOB_MEMCOMPRESS_STORE pStore, _In_ PMMWIN_SMKMSTORE_TABLE_ENTRY pTable, _In_ QWORD qwKey, _Out_ PQWORD pva)
+{
+    PMMWIN_SMKMSTORE_TABLE_ENTRY pe = pTable + (qwKey % MMWIN_SMKMSTORE_TABLE_SIZE);
+    AcquireSRWLockShared(&pStore->LockSRW);
+    *pva = (pe->qwKey == qwKey) ? pe->va : 0;
+    ReleaseSRWLockShared(&pStore->LockSRW);
+    return *pva != 0;
+}
+
+VOID MmWin_MemCompress_StoreTablePut(_In_ PMMWINOB_MEMCOMPRESS_STORE pStore, _In_ PMMWIN_SMKMSTORE_TABLE_ENTRY pTable, _In_ QWORD qwKey, _In_ QWORD va)
+{
+    PMMWIN_SMKMSTORE_TABLE_ENTRY pe = pTable + (qwKey % MMWIN_SMKMSTORE_TABLE_SIZE);
+    AcquireSRWLockExclusive(&pStore->LockSRW);
+    pe->qwKey = qwKey;
+    pe->va = va;
+    ReleaseSRWLockExclusive(&pStore->LockSRW);
+}
+
+/*
+* Callback function for the store cache map - a store is valid if it's in the
+* same medium refresh tickcount.
+*/
+BOOL MmWin_MemCompress_StoreCache_ValidEntry(_Inout_ PQWORD qwContext, _In_ QWORD qwKey, _In_ PVOID pvObject)
+{
+    return *qwContext == ctxVmm->tcRefreshMedium;
+}
+
+/*
+* Retrieve the SmkmStore belonging to ctx->e.iSmkm. The store is retrieved from
+* the store cache if possible; otherwise it's located via the 32x32 array in
+* SmGlobals, loaded, validated and inserted into the store cache.
 * -- ctx
 * -- return
 */
 _Success_(return)
-BOOL MmWin_MemCompress3_SmkmStoreAndPageRecord32(_In_ PMMWINX64_COMPRESS_CONTEXT ctx)
+BOOL MmWin_MemCompress2_SmkmStore(_In_ PMMWINX64_COMPRESS_CONTEXT ctx)
 {
-    DWORD vaPageRecordArray;
-    DWORD i, dwEncodedMetadata, iChunkPtr = 0, iChunkArray, dwPoolHdr = 0;
-    P_SMHP_CHUNK_METADATA32 pc;
-    PMMWIN_MEMCOMPRESS_OFFSET po = &((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.O;
-    // 1: Load SmkmStore
-    if(!VmmRead2(ctx->pSystemProcess, ctx->e.vaSmkmStore, ctx->e.pbSmkm, sizeof(ctx->e.pbSmkm), ctx->fVmmRead)) {
-        return MmWin_MemCompress_LogError(ctx, "#31 ReadSmkmStore");
+    BOOL f;
+    PMMWINOB_MEMCOMPRESS_STORE pStore;
+    PMMWIN_MEMCOMPRESS_CONTEXT pmc = &((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress;
+    PMMWIN_MEMCOMPRESS_OFFSET po = &pmc->O;
+    // 1: store already in use by context (batch) or cached
+    if(!ctx->pObStore || (ctx->pObStore->iSmkm != ctx->e.iSmkm)) {
+        Ob_DECREF_NULL(&ctx->pObStore);
+        if(!(ctx->fVmmRead & VMM_FLAG_NOCACHE)) {
+            ctx->pObStore = ObCacheMap_GetByKey(pmc->pObCacheMapStore, ctx->e.iSmkm);
+        }
+    }
+    if((pStore = ctx->pObStore)) {
+        ctx->e.vaSmkmStore = pStore->vaSmkmStore;
+        ctx->e.vaEPROCESS = pStore->vaEPROCESS;
+        ctx->e.vaOwnerEPROCESS = pStore->vaOwnerEPROCESS;
+        ctx->e.pbSmkm = pStore->pbSmkm;
+        return TRUE;
+    }
+    // 2: locate store in SmGlobals
+    f = ctxVmm->f32 ? MmWin_MemCompress2_SmkmStoreMetadata32(ctx) : MmWin_MemCompress2_SmkmStoreMetadata64(ctx);
+    if(!f) { return FALSE; }
+    if(!(pStore = Ob_Alloc(OB_TAG_MM_SMKMSTORE, LMEM_ZEROINIT, sizeof(MMWINOB_MEMCOMPRESS_STORE), NULL, NULL))) { return FALSE; }
+    pStore->iSmkm = ctx->e.iSmkm;
+    pStore->vaSmkmStore = ctx->e.vaSmkmStore;
+    pStore->vaEPROCESS = ctx->e.vaEPROCESS;
+    ctx->e.pbSmkm = pStore->pbSmkm;
+    // 3: load SmkmStore
+    if(!VmmRead2(ctx->pSystemProcess, pStore->vaSmkmStore, pStore->pbSmkm, sizeof(pStore->pbSmkm), ctx->fVmmRead)) {
+        MmWin_MemCompress_LogError(ctx, "#31 ReadSmkmStore");
+        goto fail;
     }
-    // 2: Validate
-    if(!VMM_KADDR32_8(*(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.PagesTree))) {
-        return MmWin_MemCompress_LogError(ctx, "#32 PagesTreePtrNoKADDR");
+    // 4: validate
+    f = ctxVmm->f32 ?
+        VMM_KADDR32_8(*(PDWORD)(pStore->pbSmkm + po->SMKM_STORE.PagesTree)) :
+        VMM_KADDR64_16(*(PQWORD)(pStore->pbSmkm + po->SMKM_STORE.PagesTree));
+    if(!f) {
+        MmWin_MemCompress_LogError(ctx, "#32 PagesTreePtrNoKADDR");
+        goto fail;
+    }
+    if(COMPRESS_ALGORITHM_XPRESS != *(PWORD)(pStore->pbSmkm + po->SMKM_STORE.CompressionAlgorithm)) {
+        MmWin_MemCompress_LogError(ctx, "#33 InvalidCompressionAlgorithm");
+        goto fail;
+    }
+    // 5: validate owner EPROCESS
+    pStore->vaOwnerEPROCESS = ctxVmm->f32 ?
+        *(PDWORD)(pStore->pbSmkm + po->SMKM_STORE.OwnerProcess) :
+        *(PQWORD)(pStore->pbSmkm + po->SMKM_STORE.OwnerProcess);
+    ctx->e.vaOwnerEPROCESS = pStore->vaOwnerEPROCESS;
+    if(pStore->vaOwnerEPROCESS != pmc->vaEPROCESS) {
+        MmWin_MemCompress_LogError(ctx, "#39 OwnerEPROCESS");
+        goto fail;
     }
-    if(COMPRESS_ALGORITHM_XPRESS != *(PWORD)(ctx->e.pbSmkm + po->SMKM_STORE.CompressionAlgorithm)) {
-        return MmWin_MemCompress_LogError(ctx, "#33 InvalidCompressionAlgorithm");
+    // 6: insert into cache
+    if(!(ctx->fVmmRead & VMM_FLAG_NOCACHE)) {
+        ObCacheMap_Push(pmc->pObCacheMapStore, pStore->iSmkm, pStore, ctxVmm->tcRefreshMedium);
     }
-    // 3: Get region key
-    if(!MmWin_BTree_Search(ctx->pSystemProcess, *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.PagesTree), ctx->e.dwPageKey, &ctx->e.dwRegionKey, ctx->fVmmRead)) {
+    ctx->pObStore = pStore;
+    return TRUE;
+fail:
+    ctx->e.pbSmkm = NULL;
+    Ob_DECREF(pStore);
+    return FALSE;
+}
+
+/*
+* Retrieve the PageRecord from the SmkmStore.
+* -- ctx
+* -- return
+*/
+_Success_(return)
+BOOL MmWin_MemCompress3_PageRecord32(_In_ PMMWINX64_COMPRESS_CONTEXT ctx)
+{
+    QWORD qwKey, vaPageRecordArrayCached;
+    DWORD vaPageRecordArray = 0;
+    DWORD i, dwEncodedMetadata, iChunkPtr = 0, iChunkArray, dwPoolHdr = 0;
+    P_SMHP_CHUNK_METADATA32 pc;
+    PMMWIN_MEMCOMPRESS_OFFSET po = &((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.O;
+    // 1: Get region key
+    if(!MmWin_BTree_Search(ctx->pSystemProcess, *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.PagesTree), ctx->e.dwPageKey, &ctx->e.dwRegionKey, &ctx->pObStore->PagesTreeLeafCache, ctx->fVmmRead)) {
         return MmWin_MemCompress_LogError(ctx, "#34 RegionKeyBTreeSearch");
     }
-    // 4: Get page record and calculate:
+    // 2: Get page record and calculate:
     //    - chunk "encoded metadata"
     //    - index into chunk metadata array (= highest non-zero bit position of encoded_metadata)
     //    - index into chunk array (pointed to by chunk metadata array)
@@ -824,58 +1057,48 @@ BOOL MmWin_MemCompress3_SmkmStoreAndPageRecord32(_In_ PMMWINX64_COMPRESS_CONTEXT
         iChunkPtr = i;
     }
     iChunkArray = (1 << iChunkPtr) ^ dwEncodedMetadata;
-    // 5: Validate and fetch page record address
-    if(iChunkArray > 0x400) {
-        return MmWin_MemCompress_LogError(ctx, "#35 ChunkArrayTooLarge");
-    }
-    if(!VMM_KADDR32_8(pc->avaChunkPtr[iChunkPtr])) {
-        return MmWin_MemCompress_LogError(ctx, "#36 ChunkPtrNoKADDR");
-    }
-    if(pc->avaChunkPtr[iChunkPtr] & 0xfff) {
-        if(!VmmRead2(ctx->pSystemProcess, pc->avaChunkPtr[iChunkPtr] - 4, (PBYTE)&dwPoolHdr, 4, ctx->fVmmRead) || (dwPoolHdr != 'ABms')) {
-            return MmWin_MemCompress_LogError(ctx, "#37 ChunkBadPoolHdr");
+    // 3: Validate and fetch page record address (cached per store)
+    qwKey = ((QWORD)iChunkPtr << 16) | iChunkArray;
+    if(MmWin_MemCompress_StoreTableGet(ctx->pObStore, ctx->pObStore->PageRecordArray, qwKey, &vaPageRecordArrayCached)) {
+        vaPageRecordArray = (DWORD)vaPageRecordArrayCached;
+    } else {
+        if(iChunkArray > 0x400) {
+            return MmWin_MemCompress_LogError(ctx, "#35 ChunkArrayTooLarge");
         }
-    }
-    if(!VmmRead2(ctx->pSystemProcess, pc->avaChunkPtr[iChunkPtr] + 0x0cULL * iChunkArray, (PBYTE)&vaPageRecordArray, sizeof(DWORD), ctx->fVmmRead) || !VMM_KADDR32_PAGE(vaPageRecordArray)) {
-        return MmWin_MemCompress_LogError(ctx, "#38 PageRecordArray");
+        if(!VMM_KADDR32_8(pc->avaChunkPtr[iChunkPtr])) {
+            return MmWin_MemCompress_LogError(ctx, "#36 ChunkPtrNoKADDR");
+        }
+        if(pc->avaChunkPtr[iChunkPtr] & 0xfff) {
+            if(!VmmRead2(ctx->pSystemProcess, pc->avaChunkPtr[iChunkPtr] - 4, (PBYTE)&dwPoolHdr, 4, ctx->fVmmRead) || (dwPoolHdr != 'ABms')) {
+                return MmWin_MemCompress_LogError(ctx, "#37 ChunkBadPoolHdr");
+            }
+        }
+        if(!VmmRead2(ctx->pSystemProcess, pc->avaChunkPtr[iChunkPtr] + 0x0cULL * iChunkArray, (PBYTE)&vaPageRecordArray, sizeof(DWORD), ctx->fVmmRead) || !VMM_KADDR32_PAGE(vaPageRecordArray)) {
+            return MmWin_MemCompress_LogError(ctx, "#38 PageRecordArray");
+        }
+        MmWin_MemCompress_StoreTablePut(ctx->pObStore, ctx->pObStore->PageRecordArray, qwKey, vaPageRecordArray);
     }
     ctx->e.vaPageRecord = (DWORD)((QWORD)vaPageRecordArray + pc->dwChunkPageHeaderSize + ((QWORD)pc->dwPageRecordSize * (ctx->e.dwRegionKey & pc->dwPageRecordsPerChunkMask)));
-    // 6: Get owner EPROCESS
-    ctx->e.vaOwnerEPROCESS = *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.OwnerProcess);
-    if(ctx->e.vaOwnerEPROCESS != ((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.vaEPROCESS) {
-        return MmWin_MemCompress_LogError(ctx, "#39 OwnerEPROCESS");
-    }
     return TRUE;
 }
 
 /*
-* Retrieve the SmkmStore and the PageRecord.
+* Retrieve the PageRecord from the SmkmStore.
 * -- ctx
 * -- return
 */
 _Success_(return)
-BOOL MmWin_MemCompress3_SmkmStoreAndPageRecord64(_In_ PMMWINX64_COMPRESS_CONTEXT ctx)
+BOOL MmWin_MemCompress3_PageRecord64(_In_ PMMWINX64_COMPRESS_CONTEXT ctx)
 {
-    QWORD vaPageRecordArray;
+    QWORD qwKey, vaPageRecordArray = 0;
     DWORD i, dwEncodedMetadata, iChunkPtr = 0, iChunkArray, dwPoolHdr = 0;
     P_SMHP_CHUNK_METADATA64 pc;
     PMMWIN_MEMCOMPRESS_OFFSET po = &((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.O;
-    // 1: Load SmkmStore
-    if(!VmmRead2(ctx->pSystemProcess, ctx->e.vaSmkmStore, ctx->e.pbSmkm, sizeof(ctx->e.pbSmkm), ctx->fVmmRead)) {
-        return MmWin_MemCompress_LogError(ctx, "#31 ReadSmkmStore");
-    }
-    // 2: Validate
-    if(!VMM_KADDR64_16(*(PQWORD)(ctx->e.pbSmkm + po->SMKM_STORE.PagesTree))) {
-        return MmWin_MemCompress_LogError(ctx, "#32 PagesTreePtrNoKADDR");
-    }
-    if(COMPRESS_ALGORITHM_XPRESS != *(PWORD)(ctx->e.pbSmkm + po->SMKM_STORE.CompressionAlgorithm)) {
-        return MmWin_MemCompress_LogError(ctx, "#33 InvalidCompressionAlgorithm");
-    }
-    // 3: Get region key
-    if(!MmWin_BTree_Search(ctx->pSystemProcess, *(PQWORD)(ctx->e.pbSmkm + po->SMKM_STORE.PagesTree), ctx->e.dwPageKey, &ctx->e.dwRegionKey, ctx->fVmmRead)) {
+    // 1: Get region key
+    if(!MmWin_BTree_Search(ctx->pSystemProcess, *(PQWORD)(ctx->e.pbSmkm + po->SMKM_STORE.PagesTree), ctx->e.dwPageKey, &ctx->e.dwRegionKey, &ctx->pObStore->PagesTreeLeafCache, ctx->fVmmRead)) {
         return MmWin_MemCompress_LogError(ctx, "#34 RegionKeyBTreeSearch");
     }
-    // 4: Get page record and calculate:
+    // 2: Get page record and calculate:
     //    - chunk "encoded metadata"
     //    - index into chunk metadata array (= highest non-zero bit position of encoded_metadata)
     //    - index into chunk array (pointed to by chunk metadata array)
@@ -886,27 +1109,26 @@ BOOL MmWin_MemCompress3_SmkmStoreAndPageRecord64(_In_ PMMWINX64_COMPRESS_CONTEXT
         iChunkPtr = i;
     }
     iChunkArray = (1 << iChunkPtr) ^ dwEncodedMetadata;
-    // 5: Validate and fetch page record address
-    if(iChunkArray > 0x400) {
-        return MmWin_MemCompress_LogError(ctx, "#35 ChunkArrayTooLarge");
-    }
-    if(!VMM_KADDR64_16(pc->avaChunkPtr[iChunkPtr])) {
-        return MmWin_MemCompress_LogError(ctx, "#36 ChunkPtrNoKADDR");
-    }
-    if(pc->avaChunkPtr[iChunkPtr] & 0xfff) {
-        if(!VmmRead2(ctx->pSystemProcess, pc->avaChunkPtr[iChunkPtr] - 12, (PBYTE)&dwPoolHdr, 4, ctx->fVmmRead) || (dwPoolHdr != 'ABms')) {
-            return MmWin_MemCompress_LogError(ctx, "#37 ChunkBadPoolHdr");
+    // 3: Validate and fetch page record address (cached per store)
+    qwKey = ((QWORD)iChunkPtr << 16) | iChunkArray;
+    if(!MmWin_MemCompress_StoreTableGet(ctx->pObStore, ctx->pObStore->PageRecordArray, qwKey, &vaPageRecordArray)) {
+        if(iChunkArray > 0x400) {
+            return MmWin_MemCompress_LogError(ctx, "#35 ChunkArrayTooLarge");
         }
-    }
-    if(!VmmRead2(ctx->pSystemProcess, pc->avaChunkPtr[iChunkPtr] + 0x10ULL * iChunkArray, (PBYTE)&vaPageRecordArray, sizeof(QWORD), ctx->fVmmRead) || !VMM_KADDR64_PAGE(vaPageRecordArray)) {
-        return MmWin_MemCompress_LogError(ctx, "#38 PageRecordArray");
+        if(!VMM_KADDR64_16(pc->avaChunkPtr[iChunkPtr])) {
+            return MmWin_MemCompress_LogError(ctx, "#36 ChunkPtrNoKADDR");
+        }
+        if(pc->avaChunkPtr[iChunkPtr] & 0xfff) {
+            if(!VmmRead2(ctx->pSystemProcess, pc->avaChunkPtr[iChunkPtr] - 12, (PBYTE)&dwPoolHdr, 4, ctx->fVmmRead) || (dwPoolHdr != 'ABms')) {
+                return MmWin_MemCompress_LogError(ctx, "#37 ChunkBadPoolHdr");
+            }
+        }
+        if(!VmmRead2(ctx->pSystemProcess, pc->avaChunkPtr[iChunkPtr] + 0x10ULL * iChunkArray, (PBYTE)&vaPageRecordArray, sizeof(QWORD), ctx->fVmmRead) || !VMM_KADDR64_PAGE(vaPageRecordArray)) {
+            return MmWin_MemCompress_LogError(ctx, "#38 PageRecordArray");
+        }
+        MmWin_MemCompress_StoreTablePut(ctx->pObStore, ctx->pObStore->PageRecordArray, qwKey, vaPageRecordArray);
     }
     ctx->e.vaPageRecord = (QWORD)(vaPageRecordArray + pc->dwChunkPageHeaderSize + ((QWORD)pc->dwPageRecordSize * (ctx->e.dwRegionKey & pc->dwPageRecordsPerChunkMask)));
-    // 6: Get owner EPROCESS
-    ctx->e.vaOwnerEPROCESS = *(PQWORD)(ctx->e.pbSmkm + po->SMKM_STORE.OwnerProcess);
-    if(ctx->e.vaOwnerEPROCESS != ((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.vaEPROCESS) {
-        return MmWin_MemCompress_LogError(ctx, "#39 OwnerEPROCESS");
-    }
     return TRUE;
 }
 
@@ -931,31 +1153,34 @@ BOOL MmWin_MemCompress4_CompressedRegionData(_In_ PMMWINX64_COMPRESS_CONTEXT ctx
         return MmWin_MemCompress_LogError(ctx, "#42 InvalidPageRecord");
     }
     ctx->e.cbCompressedData = (PageRecord.CompressedSize == 0x1000) ? 0x1000 : PageRecord.CompressedSize & 0xfff;
-    if(ctxVmm->f32) {
-        // 2: Get pointer to region (32-bit)
-        dwRegionIndexMask = *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.RegionIndexMask) & 0xff;
-        dwRegionIndex = PageRecord.Key >> dwRegionIndexMask;
-        vaRegionPtr = *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.CompressedRegionPtrArray) + dwRegionIndex * sizeof(DWORD);
-        // 3: Get region and offset (32-bit)
-        if(!VmmRead2(ctx->pSystemProcess, vaRegionPtr, (PBYTE)&ctx->e.vaRegion, sizeof(DWORD), ctx->fVmmRead)) {
-            return MmWin_MemCompress_LogError(ctx, "#43 ReadRegionVA");
-        }
-        if(!ctx->e.vaRegion || (ctx->e.vaRegion & 0x8000ffff)) {
-            return MmWin_MemCompress_LogError(ctx, "#44 InvalidRegionVA");
-        }
-    } else {
-        // 2: Get pointer to region (64-bit)
-        dwRegionIndexMask = *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.RegionIndexMask) & 0xff;
-        dwRegionIndex = PageRecord.Key >> dwRegionIndexMask;
-        vaRegionPtr = *(PQWORD)(ctx->e.pbSmkm + po->SMKM_STORE.CompressedRegionPtrArray) + dwRegionIndex * sizeof(QWORD);
-        // 3: Get region and offset (64-bit)
-        if(!VmmRead2(ctx->pSystemProcess, vaRegionPtr, (PBYTE)&ctx->e.vaRegion, sizeof(QWORD), ctx->fVmmRead)) {
-            return MmWin_MemCompress_LogError(ctx, "#45 ReadRegionVA");
-        }
-        if(!ctx->e.vaRegion || (ctx->e.vaRegion & 0xffff80000000ffff)) {
-            return MmWin_MemCompress_LogError(ctx, "#46 InvalidRegionVA");
+    // 2: Get region (cached per store)
+    dwRegionIndexMask = *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.RegionIndexMask) & 0xff;
+    dwRegionIndex = PageRecord.Key >> dwRegionIndexMask;
+    if(!MmWin_MemCompress_StoreTableGet(ctx->pObStore, ctx->pObStore->Region, dwRegionIndex, &ctx->e.vaRegion)) {
+        if(ctxVmm->f32) {
+            // 2.1: Get pointer to region (32-bit)
+            vaRegionPtr = *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.CompressedRegionPtrArray) + dwRegionIndex * sizeof(DWORD);
+            // 2.2: Get region (32-bit)
+            if(!VmmRead2(ctx->pSystemProcess, vaRegionPtr, (PBYTE)&ctx->e.vaRegion, sizeof(DWORD), ctx->fVmmRead)) {
+                return MmWin_MemCompress_LogError(ctx, "#43 ReadRegionVA");
+            }
+            if(!ctx->e.vaRegion || (ctx->e.vaRegion & 0x8000ffff)) {
+                return MmWin_MemCompress_LogError(ctx, "#44 InvalidRegionVA");
+            }
+        } else {
+            // 2.1: Get pointer to region (64-bit)
+            vaRegionPtr = *(PQWORD)(ctx->e.pbSmkm + po->SMKM_STORE.CompressedRegionPtrArray) + dwRegionIndex * sizeof(QWORD);
+            // 2.2: Get region (64-bit)
+            if(!VmmRead2(ctx->pSystemProcess, vaRegionPtr, (PBYTE)&ctx->e.vaRegion, sizeof(QWORD), ctx->fVmmRead)) {
+                return MmWin_MemCompress_LogError(ctx, "#45 ReadRegionVA");
+            }
+            if(!ctx->e.vaRegion || (ctx->e.vaRegion & 0xffff80000000ffff)) {
+                return MmWin_MemCompress_LogError(ctx, "#46 InvalidRegionVA");
+            }
         }
+        MmWin_MemCompress_StoreTablePut(ctx->pObStore, ctx->pObStore->Region, dwRegionIndex, ctx->e.vaRegion);
     }
+    // 3: Get offset
     ctx->e.cbRegionOffset = (PageRecord.Key & *(PDWORD)(ctx->e.pbSmkm + po->SMKM_STORE.RegionSizeMask)) << 4;
     return TRUE;
 }
@@ -991,6 +1216,60 @@ BOOL MmWin_MemCompress5_DecompressPage(_In_ PMMWINX64_COMPRESS_CONTEXT ctx, _Out
     return TRUE;
 }
 
+/*
+* Resolve the compressed data (region address, offset and size) of the page
+* with the page key ctx->e.dwPageKey.
+* -- ctx
+* -- return
+*/
+_Success_(return)
+BOOL MmWin_MemCompress_Resolve(_In_ PMMWINX64_COMPRESS_CONTEXT ctx)
+{
+    if(ctxVmm->f32) {
+        // 32-bit system
+        return
+            MmWin_MemCompress1_SmkmStoreIndex(ctx) &&
+            MmWin_MemCompress2_SmkmStore(ctx) &&
+            MmWin_MemCompress3_PageRecord32(ctx) &&
+            MmWin_MemCompress4_CompressedRegionData(ctx);
+    } else {
+        // 64-bit system
+        return
+            MmWin_MemCompress1_SmkmStoreIndex(ctx) &&
+            MmWin_MemCompress2_SmkmStore(ctx) &&
+            MmWin_MemCompress3_PageRecord64(ctx) &&
+            MmWin_MemCompress4_CompressedRegionData(ctx);
+    }
+}
+
+/*
+* Set up a decompression context.
+* CALLER LocalFree: return (after MmWin_MemCompress_ContextClose)
+* -- pProcess
+* -- fVmmRead
+* -- return
+*/
+PMMWINX64_COMPRESS_CONTEXT MmWin_MemCompress_ContextNew(_In_ PVMM_PROCESS pProcess, _In_ QWORD fVmmRead)
+{
+    PMMWINX64_COMPRESS_CONTEXT ctx;
+    if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(MMWINX64_COMPRESS_CONTEXT)))) { return NULL; }
+    ctx->fVmmRead = fVmmRead;
+    ctx->pProcess = pProcess;
+    ctx->pSystemProcess = VmmProcessGet(4);
+    ctx->pProcessMemCompress = VmmProcessGet(((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.dwPid);
+    return ctx;
+}
+
+VOID MmWin_MemCompress_ContextClose(_In_opt_ PMMWINX64_COMPRESS_CONTEXT ctx)
+{
+    if(ctx) {
+        Ob_DECREF(ctx->pObStore);
+        Ob_DECREF(ctx->pSystemProcess);
+        Ob_DECREF(ctx->pProcessMemCompress);
+        LocalFree(ctx);
+    }
+}
+
 /*
 * Decompress a page.
 * -- pProcess
@@ -1005,62 +1284,259 @@ BOOL MmWin_MemCompress(_In_ PVMM_PROCESS pProcess, _In_opt_ QWORD va, _In_ QWORD
 {
     BOOL fResult = FALSE;
     PMMWINX64_COMPRESS_CONTEXT ctx = NULL;
-    PVMM_PROCESS pObSystemProcess = NULL, pObMemCompressProcess = NULL;
     QWORD tm = Statistics_CallStart();
-    if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(MMWINX64_COMPRESS_CONTEXT)))) { goto fail; }
-    ctx->fVmmRead = fVmmRead;
+    if(!(ctx = MmWin_MemCompress_ContextNew(pProcess, fVmmRead))) { goto fail; }
     ctx->e.va = va;
     ctx->e.PTE = pte;
-    if(ctxVmm->f32) {
-        // 32-bit system
-        ctx->e.dwPageKey = MMWINX86PAE_PTE_PAGE_KEY_COMPRESSED(pte);
-        fResult =
-            (ctx->pProcess = pProcess) &&
-            (ctx->pSystemProcess = pObSystemProcess = VmmProcessGet(4)) &&
-            (ctx->pProcessMemCompress = pObMemCompressProcess = VmmProcessGet(((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.dwPid)) &&
-            MmWin_MemCompress1_SmkmStoreIndex(ctx) &&
-            MmWin_MemCompress2_SmkmStoreMetadata32(ctx) &&
-            MmWin_MemCompress3_SmkmStoreAndPageRecord32(ctx) &&
-            MmWin_MemCompress4_CompressedRegionData(ctx) &&
-            MmWin_MemCompress5_DecompressPage(ctx, pbPage);
-    } else {
-        // 64-bit system
-        ctx->e.dwPageKey = MMWINX64_PTE_PAGE_KEY_COMPRESSED(pte);
-        fResult =
-            (ctx->pProcess = pProcess) &&
-            (ctx->pSystemProcess = pObSystemProcess = VmmProcessGet(4)) &&
-            (ctx->pProcessMemCompress = pObMemCompressProcess = VmmProcessGet(((PMMWIN_CONTEXT)ctxVmm->pMmContext)->MemCompress.dwPid)) &&
-            MmWin_MemCompress1_SmkmStoreIndex(ctx) &&
-            MmWin_MemCompress2_SmkmStoreMetadata64(ctx) &&
-            MmWin_MemCompress3_SmkmStoreAndPageRecord64(ctx) &&
-            MmWin_MemCompress4_CompressedRegionData(ctx) &&
-            MmWin_MemCompress5_DecompressPage(ctx, pbPage);
-    }
+    ctx->e.dwPageKey = ctxVmm->f32 ? MMWINX86PAE_PTE_PAGE_KEY_COMPRESSED(pte) : MMWINX64_PTE_PAGE_KEY_COMPRESSED(pte);
+    fResult =
+        ctx->pProcess &&
+        ctx->pSystemProcess &&
+        ctx->pProcessMemCompress &&
+        MmWin_MemCompress_Resolve(ctx) &&
+        MmWin_MemCompress5_DecompressPage(ctx, pbPage);
 fail:
-    LocalFree(ctx);
-    Ob_DECREF(pObSystemProcess);
-    Ob_DECREF(pObMemCompressProcess);
+    MmWin_MemCompress_ContextClose(ctx);
     Statistics_CallEnd(STATISTICS_ID_VMM_PagedCompressedMemory, tm);
     return fResult;
 }
 
+/*
+* Decompress multiple compressed pages in one pass. The decompression context
+* and the resolved SmkmStore is shared between consecutive pages belonging to
+* the same store. All pages are resolved first, then the compressed data of
+* all resolved pages is prefetched from the MemCompression process in a single
+* scatter read before the pages are decompressed.
+* -- pProcess
+* -- cPages
+* -- pqwPTE = compressed software PTEs.
+* -- ppbPages = buffers (4096 bytes each) receiving the decompressed pages.
+* -- pfResult = per-page result.
+* -- fVmmRead = flags to VmmRead function calls.
+* -- return = number of successfully decompressed pages.
+*/
+DWORD MmWin_MemCompressBatch(_In_ PVMM_PROCESS pProcess, _In_ DWORD cPages, _In_reads_(cPages) PQWORD pqwPTE, _Out_writes_(cPages) PBYTE *ppbPages, _Out_writes_(cPages) PBOOL pfResult, _In_ QWORD fVmmRead)
+{
+    DWORD i, cResult = 0;
+    PMMWINX64_COMPRESS_CONTEXT ctx = NULL;
+    PMMWIN_CONTEXT ctxMm = (PMMWIN_CONTEXT)ctxVmm->pMmContext;
+    POB_SET psObPrefetch = NULL;
+    PQWORD pqwRegionData = NULL;
+    PDWORD pcbCompressedData = NULL;
+    QWORD tm = Statistics_CallStart();
+    ZeroMemory(pfResult, cPages * sizeof(BOOL));
+    if(!ctxMm || !ctxMm->MemCompress.fValid || !cPages) { goto fail; }
+    if(!(pqwRegionData = LocalAlloc(LMEM_ZEROINIT, cPages * (sizeof(QWORD) + sizeof(DWORD))))) { goto fail; }
+    pcbCompressedData = (PDWORD)(pqwRegionData + cPages);
+    if(!(ctx = MmWin_MemCompress_ContextNew(pProcess, fVmmRead))) { goto fail; }
+    if(!ctx->pProcess || !ctx->pSystemProcess || !ctx->pProcessMemCompress) { goto fail; }
+    if(!(fVmmRead & VMM_FLAG_NOCACHE) && !(psObPrefetch = ObSet_New())) { goto fail; }
+    // 1: resolve compressed data location of all pages
+    for(i = 0; i < cPages; i++) {
+        ZeroMemory(&ctx->e, sizeof(ctx->e));
+        ctx->e.PTE = pqwPTE[i];
+        ctx->e.dwPageKey = ctxVmm->f32 ? MMWINX86PAE_PTE_PAGE_KEY_COMPRESSED(pqwPTE[i]) : MMWINX64_PTE_PAGE_KEY_COMPRESSED(pqwPTE[i]);
+        if(MmWin_MemCompress_Resolve(ctx)) {
+            pqwRegionData[i] = ctx->e.vaRegion + ctx->e.cbRegionOffset;
+            pcbCompressedData[i] = ctx->e.cbCompressedData;
+            ObSet_Push(psObPrefetch, pqwRegionData[i]);
+        }
+    }
+    // 2: prefetch compressed data
+    VmmCachePrefetchPages3(ctx->pProcessMemCompress, psObPrefetch, 0x1000, fVmmRead);
+    // 3: read and decompress
+    for(i = 0; i < cPages; i++) {
+        if(!pqwRegionData[i]) { continue; }
+        ZeroMemory(&ctx->e, sizeof(ctx->e));
+        ctx->e.PTE = pqwPTE[i];
+        ctx->e.vaRegion = pqwRegionData[i];
+        ctx->e.cbCompressedData = pcbCompressedData[i];
+        if((pfResult[i] = MmWin_MemCompress5_DecompressPage(ctx, ppbPages[i]))) {
+            cResult++;
+        }
+    }
+fail:
+    MmWin_MemCompress_ContextClose(ctx);
+    Ob_DECREF(psObPrefetch);
+    LocalFree(pqwRegionData);
+    Statistics_CallEnd(STATISTICS_ID_VMM_PagedCompressedMemory, tm);
+    return cResult;
+}
 
 //-----------------------------------------------------------------------------
 // PAGE FILE FUNCTIONALITY BELOW:
+// Page files are read with positional reads without any global lock - allowing
+// for concurrent page file reads. Page files are not memory-mapped since reads
+// from a mapping of a truncated page file (or a page file on a network share)
+// would fault instead of fail.
 //-----------------------------------------------------------------------------
 
+#define MMWIN_PF_BATCH_MAXPAGES         0x10
+
+/*
+* Open a page file for positional reads. On Windows the file is opened for
+* overlapped i/o so that concurrent reads are not serialized on the handle.
+* -- pPf
+* -- szPageFile
+* -- return
+*/
+_Success_(return)
+BOOL MmWin_PfOpen(_Out_ PMMWIN_PAGEFILE pPf, _In_ LPSTR szPageFile)
+{
+#ifdef _WIN32
+    LARGE_INTEGER li;
+    pPf->hFile = CreateFileA(szPageFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+    if(pPf->hFile == INVALID_HANDLE_VALUE) {
+        pPf->hFile = NULL;
+        return FALSE;
+    }
+    if(!GetFileSizeEx(pPf->hFile, &li)) {
+        CloseHandle(pPf->hFile);
+        pPf->hFile = NULL;
+        return FALSE;
+    }
+    pPf->cb = li.QuadPart;
+#endif /* _WIN32 */
+#ifdef LINUX
+    off_t cb;
+    if(-1 == (pPf->fd = open(szPageFile, O_RDONLY))) { return FALSE; }
+    if((cb = lseek(pPf->fd, 0, SEEK_END)) == (off_t)-1) {
+        close(pPf->fd);
+        return FALSE;
+    }
+    pPf->cb = cb;
+#endif /* LINUX */
+    pPf->fValid = TRUE;
+    return TRUE;
+}
+
+/*
+* Close a page file opened by MmWin_PfOpen().
+* -- pPf
+*/
+VOID MmWin_PfClose(_Inout_ PMMWIN_PAGEFILE pPf)
+{
+    if(!pPf->fValid) { return; }
+#ifdef _WIN32
+    if(pPf->hFile) { CloseHandle(pPf->hFile); }
+#endif /* _WIN32 */
+#ifdef LINUX
+    close(pPf->fd);
+#endif /* LINUX */
+    ZeroMemory(pPf, sizeof(MMWIN_PAGEFILE));
+}
+
+/*
+* Read from a page file at a given offset. Thread safe - no lock is taken.
+* On Windows each read waits on its own event since the file handle may have
+* multiple overlapped reads outstanding.
+* -- pPf
+* -- qwOffset
+* -- pb
+* -- cb
+* -- return = TRUE if all cb bytes were read.
+*/
+_Success_(return)
+BOOL MmWin_PfReadFileRaw(_In_ PMMWIN_PAGEFILE pPf, _In_ QWORD qwOffset, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb)
+{
+    if((qwOffset + cb > pPf->cb) || (qwOffset + cb < qwOffset)) { return FALSE; }
+#ifdef _WIN32
+    BOOL fResult;
+    DWORD cbRead = 0;
+    OVERLAPPED ov = { 0 };
+    ov.Offset = (DWORD)qwOffset;
+    ov.OffsetHigh = (DWORD)(qwOffset >> 32);
+    if(!(ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL))) { return FALSE; }
+    fResult =
+        (ReadFile(pPf->hFile, pb, cb, NULL, &ov) || (GetLastError() == ERROR_IO_PENDING)) &&
+        GetOverlappedResult(pPf->hFile, &ov, &cbRead, TRUE) &&
+        (cbRead == cb);
+    CloseHandle(ov.hEvent);
+    return fResult;
+#endif /* _WIN32 */
+#ifdef LINUX
+    ssize_t cbRead;
+    while(cb) {
+        cbRead = pread(pPf->fd, pb, cb, (off_t)qwOffset);
+        if(cbRead <= 0) {
+            if((cbRead == -1) && (errno == EINTR)) { continue; }
+            return FALSE;
+        }
+        pb += cbRead;
+        qwOffset += cbRead;
+        cb -= (DWORD)cbRead;
+    }
+    return TRUE;
+#endif /* LINUX */
+}
+
 _Success_(return)
 BOOL MmWin_PfReadFile(_In_ DWORD dwPfNumber, _In_ DWORD dwPfOffset, _Out_writes_(4096) PBYTE pbPage)
 {
     PMMWIN_CONTEXT ctx = (PMMWIN_CONTEXT)ctxVmm->pMmContext;
-    DWORD cb = 0;
-    if(!ctx || !ctx->pPageFile[dwPfNumber]) { return FALSE; }
-    EnterCriticalSection(&ctx->Lock);
-    if(!_fseeki64(ctx->pPageFile[dwPfNumber], (QWORD)dwPfOffset << 12, SEEK_SET)) {
-        cb = (DWORD)fread(pbPage, 1, 0x1000, ctx->pPageFile[dwPfNumber]);
-    }
-    LeaveCriticalSection(&ctx->Lock);
-    return cb == 0x1000;
+    if(!ctx || (dwPfNumber >= 10) || !ctx->PageFile[dwPfNumber].fValid) { return FALSE; }
+    return MmWin_PfReadFileRaw(&ctx->PageFile[dwPfNumber], (QWORD)dwPfOffset << 12, pbPage, 0x1000);
+}
+
+int MmWin_PfReadFileBatch_CmpSort(_In_ PQWORD pqw1, _In_ PQWORD pqw2)
+{
+    return (*pqw1 < *pqw2) ? -1 : ((*pqw1 > *pqw2) ? 1 : 0);
+}
+
+/*
+* Read multiple pages from a page file. Page reads are sorted by offset and
+* adjacent pages are coalesced into larger merged reads.
+* -- dwPfNumber
+* -- cPages
+* -- pdwPfOffset = page file offsets (in pages).
+* -- ppbPages = buffers (4096 bytes each) receiving the pages.
+* -- pfResult = per-page result.
+* -- return = number of successfully read pages.
+*/
+DWORD MmWin_PfReadFileBatch(_In_ DWORD dwPfNumber, _In_ DWORD cPages, _In_reads_(cPages) PDWORD pdwPfOffset, _Out_writes_(cPages) PBYTE *ppbPages, _Out_writes_(cPages) PBOOL pfResult)
+{
+    PMMWIN_CONTEXT ctx = (PMMWIN_CONTEXT)ctxVmm->pMmContext;
+    PMMWIN_PAGEFILE pPf;
+    PQWORD pqwSort = NULL;
+    PBYTE pbBuffer = NULL;
+    DWORD i, j, iRunStart, cRun, dwOffset, dwDelta, cResult = 0;
+    ZeroMemory(pfResult, cPages * sizeof(BOOL));
+    if(!ctx || (dwPfNumber >= 10) || !ctx->PageFile[dwPfNumber].fValid || !cPages) { return 0; }
+    pPf = &ctx->PageFile[dwPfNumber];
+    // 1: sort page reads by offset: sort key = (offset << 32) | index
+    if(!(pqwSort = LocalAlloc(0, cPages * sizeof(QWORD) + MMWIN_PF_BATCH_MAXPAGES * 0x1000))) { return 0; }
+    pbBuffer = (PBYTE)(pqwSort + cPages);
+    for(i = 0; i < cPages; i++) {
+        pqwSort[i] = ((QWORD)pdwPfOffset[i] << 32) | i;
+    }
+    qsort(pqwSort, cPages, sizeof(QWORD), (int(*)(const void *, const void *))MmWin_PfReadFileBatch_CmpSort);
+    // 2: coalesce runs of adjacent (or duplicate) pages into single reads
+    for(iRunStart = 0; iRunStart < cPages; iRunStart = j) {
+        dwOffset = (DWORD)(pqwSort[iRunStart] >> 32);
+        cRun = 1;
+        for(j = iRunStart + 1; j < cPages; j++) {
+            dwDelta = (DWORD)(pqwSort[j] >> 32) - dwOffset;
+            if(dwDelta == cRun - 1) { continue; }
+            if((dwDelta != cRun) || (cRun == MMWIN_PF_BATCH_MAXPAGES)) { break; }
+            cRun++;
+        }
+        if(!MmWin_PfReadFileRaw(pPf, (QWORD)dwOffset << 12, pbBuffer, cRun << 12)) {
+            // merged read failed (e.g. partially beyond end of file) - fall back to single page reads.
+            for(i = iRunStart; i < j; i++) {
+                if((pfResult[(DWORD)pqwSort[i]] = MmWin_PfReadFileRaw(pPf, (pqwSort[i] >> 32) << 12, ppbPages[(DWORD)pqwSort[i]], 0x1000))) {
+                    cResult++;
+                }
+            }
+            continue;
+        }
+        for(i = iRunStart; i < j; i++) {
+            memcpy(ppbPages[(DWORD)pqwSort[i]], pbBuffer + (((DWORD)(pqwSort[i] >> 32) - dwOffset) << 12), 0x1000);
+            pfResult[(DWORD)pqwSort[i]] = TRUE;
+            cResult++;
+        }
+    }
+    LocalFree(pqwSort);
+    return cResult;
 }
 
 _Success_(return)
@@ -1114,6 +1590,142 @@ BOOL MmWin_PfRead(_In_ PVMM_PROCESS pProcess, _In_opt_ QWORD va, _In_ QWORD pte,
 }
 
 
+
+//-----------------------------------------------------------------------------
+// BATCHED PAGED READ FUNCTIONALITY BELOW:
+// Paged out pages of a virtual scatter read are read in batches and are put
+// into the paging cache before the per-page paged read takes place - which
+// will then be served from the paging cache.
+//-----------------------------------------------------------------------------
+
+#define MMWIN_PAGED_BATCH_MAXPAGES      0x40
+
+/*
+* Retrieve the page file number and page file offset of a software PTE which
+* directly references the page file or the compressed store. Prototype PTEs,
+* transition PTEs, demand zero PTEs and VAD-backed PTEs are not handled.
+* -- pte
+* -- pdwPfNumber
+* -- pdwPfOffset
+* -- return
+*/
+_Success_(return)
+BOOL MmWin_PagedReadScatter_PteDecode(_In_ QWORD pte, _Out_ PDWORD pdwPfNumber, _Out_ PDWORD pdwPfOffset)
+{
+    switch(ctxVmm->tpMemoryModel) {
+        case VMM_MEMORYMODEL_X64:
+            if(MMWINX64_PTE_IS_HARDWARE(pte) || MMWINX64_PTE_PROTOTYPE(pte) || MMWINX64_PTE_TRANSITION(pte)) { return FALSE; }
+            *pdwPfNumber = (DWORD)MMWINX64_PTE_PAGE_FILE_NUMBER(pte);
+            *pdwPfOffset = (DWORD)MMWINX64_PTE_PAGE_FILE_OFFSET(pte);
+            return *pdwPfOffset && (*pdwPfOffset != 0xffffffff);
+        case VMM_MEMORYMODEL_X86PAE:
+            if(MMWINX86PAE_PTE_IS_HARDWARE(pte) || MMWINX86PAE_PTE_PROTOTYPE(pte) || MMWINX86PAE_PTE_TRANSITION(pte)) { return FALSE; }
+            *pdwPfNumber = (DWORD)MMWINX86PAE_PTE_PAGE_FILE_NUMBER(pte);
+            *pdwPfOffset = (DWORD)MMWINX86PAE_PTE_PAGE_FILE_OFFSET(pte);
+            return *pdwPfOffset && (*pdwPfOffset != 0xffffffff);
+        case VMM_MEMORYMODEL_X86:
+            if((pte >> 32) || MMWINX86_PTE_IS_HARDWARE(pte) || MMWINX86_PTE_PROTOTYPE((DWORD)pte) || MMWINX86_PTE_TRANSITION(pte)) { return FALSE; }
+            *pdwPfNumber = (DWORD)MMWINX86_PTE_PAGE_FILE_NUMBER(pte);
+            *pdwPfOffset = (DWORD)MMWINX86_PTE_PAGE_FILE_OFFSET(pte);
+            return *pdwPfOffset && (*pdwPfOffset != 0x000fffff);
+        default:
+            return FALSE;
+    }
+}
+
+/*
+* Read a batch of pages from the compressed store or from a page file and
+* update the paging cache and the paging statistics with the result.
+* -- pProcess
+* -- fCompressed
+* -- dwPfNumber
+* -- c
+* -- pqwPTE
+* -- pdwPfOffset
+* -- ppbPages
+* -- pfResult
+* -- flags
+*/
+VOID MmWin_PagedReadScatter_Batch(_In_ PVMM_PROCESS pProcess, _In_ BOOL fCompressed, _In_ DWORD dwPfNumber, _In_ DWORD c, _In_reads_(c) PQWORD pqwPTE, _In_reads_(c) PDWORD pdwPfOffset, _In_reads_(c) PBYTE *ppbPages, _Out_writes_(c) PBOOL pfResult, _In_ QWORD flags)
+{
+    DWORD i, cResult;
+    PVMMOB_CACHE_MEM pObCacheEntry;
+    if(fCompressed) {
+        cResult = MmWin_MemCompressBatch(pProcess, c, pqwPTE, ppbPages, pfResult, flags);
+        InterlockedAdd64(&ctxVmm->stat.page.cCompressed, cResult);
+        InterlockedAdd64(&ctxVmm->stat.page.cFailCompressed, c - cResult);
+    } else {
+        cResult = MmWin_PfReadFileBatch(dwPfNumber, c, pdwPfOffset, ppbPages, pfResult);
+        InterlockedAdd64(&ctxVmm->stat.page.cPageFile, cResult);
+        InterlockedAdd64(&ctxVmm->stat.page.cFailPageFile, c - cResult);
+    }
+    for(i = 0; i < c; i++) {
+        if(!pfResult[i]) {
+            ObSet_Push(ctxVmm->Cache.PAGING_FAILED, pqwPTE[i]);
+            continue;
+        }
+        if((pObCacheEntry = VmmCacheReserve(VMM_CACHE_TAG_PAGING))) {
+            pObCacheEntry->h.f = TRUE;
+            pObCacheEntry->h.qwA = pqwPTE[i];
+            memcpy(pObCacheEntry->pb, ppbPages[i], 0x1000);
+            VmmCacheReserveReturn(pObCacheEntry);
+        }
+    }
+}
+
+/*
+* Read the paged out pages referenced by the software PTEs of a virtual scatter
+* read in batches and put them into the paging cache. PTEs which are already
+* cached (or have previously failed) and PTEs not directly referencing a page
+* file or the compressed store are skipped - they are left to the per-page
+* paged read. One pass is made per page file number in use.
+* -- pProcess
+* -- cPTE
+* -- pqwPTE
+* -- flags = VMM_FLAG_* flags.
+*/
+VOID MmWin_PagedReadScatter(_In_ PVMM_PROCESS pProcess, _In_ DWORD cPTE, _In_reads_(cPTE) PQWORD pqwPTE, _In_ QWORD flags)
+{
+    PMMWIN_CONTEXT ctx = (PMMWIN_CONTEXT)ctxVmm->pMmContext;
+    QWORD pte;
+    BOOL fCompressed;
+    DWORD i, iPf, iPte, c, dwPfNumber, dwPfOffset;
+    PBYTE pbBuffer;
+    QWORD pqwBatch[MMWIN_PAGED_BATCH_MAXPAGES];
+    DWORD pdwBatch[MMWIN_PAGED_BATCH_MAXPAGES];
+    PBYTE ppbBatch[MMWIN_PAGED_BATCH_MAXPAGES];
+    BOOL pfBatch[MMWIN_PAGED_BATCH_MAXPAGES];
+    if(!ctx || (cPTE < 2) || (flags & (VMM_FLAG_NOPAGING_IO | VMM_FLAG_FORCECACHE_READ))) { return; }
+    if(MM_LOOP_PROTECT_MAX(flags)) { return; }
+    flags = MM_LOOP_PROTECT_ADD(flags);
+    if(!(pbBuffer = LocalAlloc(0, MMWIN_PAGED_BATCH_MAXPAGES << 12))) { return; }
+    for(i = 0; i < MMWIN_PAGED_BATCH_MAXPAGES; i++) {
+        ppbBatch[i] = pbBuffer + ((QWORD)i << 12);
+    }
+    for(iPf = 0; iPf < 10; iPf++) {
+        fCompressed = ctx->MemCompress.fValid && (iPf == ctx->MemCompress.dwPageFileNumber);
+        if(!fCompressed && !ctx->PageFile[iPf].fValid) { continue; }
+        for(iPte = 0, c = 0; iPte < cPTE; iPte++) {
+            pte = pqwPTE[iPte];
+            if(!MmWin_PagedReadScatter_PteDecode(pte, &dwPfNumber, &dwPfOffset) || (dwPfNumber != iPf)) { continue; }
+            if(VmmCacheExists(VMM_CACHE_TAG_PAGING, pte) || ObSet_Exists(ctxVmm->Cache.PAGING_FAILED, pte)) { continue; }
+            for(i = 0; (i < c) && (pqwBatch[i] != pte); i++);
+            if(i < c) { continue; }
+            pqwBatch[c] = pte;
+            pdwBatch[c] = dwPfOffset;
+            if(++c == MMWIN_PAGED_BATCH_MAXPAGES) {
+                MmWin_PagedReadScatter_Batch(pProcess, fCompressed, iPf, c, pqwBatch, pdwBatch, ppbBatch, pfBatch, flags);
+                c = 0;
+            }
+        }
+        if(c > 1) {
+            MmWin_PagedReadScatter_Batch(pProcess, fCompressed, iPf, c, pqwBatch, pdwBatch, ppbBatch, pfBatch, flags);
+        }
+    }
+    LocalFree(pbBuffer);
+}
+
+
 //-----------------------------------------------------------------------------
 // X86 VIRTUAL MEMORY BELOW:
 //-----------------------------------------------------------------------------
@@ -1129,7 +1741,7 @@ DWORD MmWinX86_Prototype(_In_ DWORD pte, _In_ QWORD fVmmRead)
     PVMM_PROCESS pObSystemProcess;
     DWORD cbRead, dwPtePage = 0;
     if(!(pObSystemProcess = VmmProcessGet(4))) { goto fail; }
-    VmmReadEx(pObSystemProcess, MMWINX86_PTE_PROTOTYPE(pte), (PBYTE)&dwPtePage, 4, &cbRead, fVmmRead);
+    VmmReadEx(pObSystemProcess, MMWINX86_PTE_PROTOTYPE(pte), (PBYTE)&dwPtePage, 4, &cbRead, fVmmRead | VMM_FLAG_PAGING_STRUCTURE);
     if(cbRead != 4) { goto fail; }
     if((MMWINX86_PTE_IS_HARDWARE(dwPtePage) && (dwPtePage >= ctxMain->dev.paMax)) || MMWINX86_PTE_PROTOTYPE(dwPtePage)) {
         dwPtePage = 0;
@@ -1239,7 +1851,7 @@ QWORD MmWinX86PAE_Prototype(_In_ QWORD pte, _In_ QWORD fVmmRead)
     QWORD qwPtePage = 0;
     PVMM_PROCESS pObSystemProcess;
     if(!(pObSystemProcess = VmmProcessGet(4))) { goto fail; }
-    VmmReadEx(pObSystemProcess, MMWINX86PAE_PTE_PROTOTYPE(pte), (PBYTE)&qwPtePage, 8, &cbRead, fVmmRead);
+    VmmReadEx(pObSystemProcess, MMWINX86PAE_PTE_PROTOTYPE(pte), (PBYTE)&qwPtePage, 8, &cbRead, fVmmRead | VMM_FLAG_PAGING_STRUCTURE);
     if(cbRead != 8) { goto fail; }
     if((MMWINX86PAE_PTE_IS_HARDWARE(qwPtePage) && ((qwPtePage & 0x0000003ffffff000) >= ctxMain->dev.paMax)) || MMWINX86PAE_PTE_PROTOTYPE(qwPtePage)) {
         qwPtePage = 0;
@@ -1349,7 +1961,7 @@ QWORD MmWinX64_Prototype(_In_ QWORD pte, _In_ QWORD fVmmRead)
     QWORD qwPtePage = 0;
     PVMM_PROCESS pObSystemProcess;
     if(!(pObSystemProcess = VmmProcessGet(4))) { goto fail; }
-    VmmReadEx(pObSystemProcess, MMWINX64_PTE_PROTOTYPE(pte), (PBYTE)&qwPtePage, 8, &cbRead, fVmmRead);
+    VmmReadEx(pObSystemProcess, MMWINX64_PTE_PROTOTYPE(pte), (PBYTE)&qwPtePage, 8, &cbRead, fVmmRead | VMM_FLAG_PAGING_STRUCTURE);
     if(cbRead != 8) { goto fail; }
     if((MMWINX64_PTE_IS_HARDWARE(qwPtePage) && ((qwPtePage & 0x0000fffffffff000) >= ctxMain->dev.paMax)) || MMWINX64_PTE_PROTOTYPE(qwPtePage)) {
         qwPtePage = 0;
@@ -1455,10 +2067,9 @@ VOID MmWin_PagingClose()
     if(ctx) {
         ctxVmm->pMmContext = NULL;
         for(i = 0; i < 10; i++) {
-            if(ctx->pPageFile[i]) {
-                fclose(ctx->pPageFile[i]);
-            }
+            MmWin_PfClose(&ctx->PageFile[i]);
         }
+        Ob_DECREF(ctx->MemCompress.pObCacheMapStore);
         LocalFree(ctx);
     }
 }
@@ -1481,14 +2092,15 @@ VOID MmWin_PagingInitialize(_In_ BOOL fModeFull)
         default:
             return;
     }
+    ctxVmm->fnMemoryModel.pfnPagedReadScatter = MmWin_PagedReadScatter;
     // 2: Initialize Page Files (if any)
     if(!ctx) {
         ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(MMWIN_CONTEXT));
         if(!ctx) { return; }
-        InitializeCriticalSection(&ctx->Lock);
+        ctx->MemCompress.pObCacheMapStore = ObCacheMap_New(0x40, MmWin_MemCompress_StoreCache_ValidEntry, OB_CACHEMAP_FLAGS_OBJECT_OB);
         for(i = 0; i < 10; i++) {
             if(ctxMain->cfg.szPageFile[i][0]) {
-                if(fopen_s(&ctx->pPageFile[i], ctxMain->cfg.szPageFile[i], "rb")) {
+                if(!MmWin_PfOpen(&ctx->PageFile[i], ctxMain->cfg.szPageFile[i])) {
                     VmmLog(MID_VMM, LOGLEVEL_VERBOSE, "WARNING: CANNOT OPEN PAGE FILE #%i '%s'", i, ctxMain->cfg.szPageFile[i]);
                 } else {
                     VmmLog(MID_VMM, LOGLEVEL_DEBUG, "Successfully opened page file #%i '%s'", i, ctxMain->cfg.szPageFile[i]);
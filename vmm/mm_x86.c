@@ -149,7 +149,7 @@ BOOL MmX86_PteMapInitialize(_In_ PVMM_PROCESS pProcess)
 }
 
 _Success_(return)
-BOOL MmX86_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ QWORD va, _Out_ PQWORD ppa)
+BOOL MmX86_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ QWORD va, _Out_ PQWORD ppa, _Out_opt_ PDWORD pcPageShift)
 {
     DWORD pte, i;
     PVMMOB_CACHE_MEM pObPTEs;
@@ -168,18 +168,89 @@ BOOL MmX86_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_
     }
     if(fUserOnly && !(pte & 0x04)) { return FALSE; }        // SUPERVISOR PAGE & USER MODE REQ
     if((iPML == 2) && !(pte & 0x80) /* PS */) {
-        return MmX86_Virt2Phys(pte, fUserOnly, 1, va, ppa);
+        return MmX86_Virt2Phys(pte, fUserOnly, 1, va, ppa, pcPageShift);
     }
     if(iPML == 1) { // 4kB PAGE
         *ppa = pte & 0xfffff000;
+        if(pcPageShift) { *pcPageShift = 12; }
         return TRUE;
     }
     // 4MB PAGE
     if(pte & 0x003e0000) { return FALSE; }                  // RESERVED
     *ppa = (((QWORD)(pte & 0x0001e000)) << (32 - 13)) + (pte & 0xffc00000) + (va & 0x003ff000);
+    if(pcPageShift) { *pcPageShift = 22; }
     return TRUE;
 }
 
+/*
+* Batched page table walk of entries sharing the page table paPT. Entries must
+* be sorted by virtual address. Entries sharing a page table entry are resolved
+* together and page tables not already in the TLB cache are fetched in a single
+* device read before descending.
+*/
+VOID MmX86_Virt2PhysScatter_DoWork(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ DWORD cV2P, _Inout_updates_(cV2P) PPVMM_VIRT2PHYS_SCATTER ppV2Ps)
+{
+    DWORD pte, i, iBase, iNext, cShift;
+    POB_SET psObPrefetch = NULL;
+    PVMMOB_CACHE_MEM pObPTEs;
+    if(paPT > 0xffffffff) { return; }
+    pObPTEs = VmmTlbGetPageTable(paPT & 0xfffff000, FALSE);
+    if(!pObPTEs) { return; }
+    cShift = MMX86_PAGETABLEMAP_PML_REGION_SIZE[iPML];
+    // 1: fetch missing page tables in one read
+    if((iPML == 2) && (cV2P > 1) && (psObPrefetch = ObSet_New())) {
+        for(iBase = 0; iBase < cV2P; iBase = iNext) {
+            for(iNext = iBase + 1; (iNext < cV2P) && ((ppV2Ps[iNext]->va >> cShift) == (ppV2Ps[iBase]->va >> cShift)); iNext++);
+            pte = pObPTEs->pdw[0x3ff & (ppV2Ps[iBase]->va >> cShift)];
+            if(MMX86_PTE_IS_VALID(pte, iPML) && !(pte & 0x80) && !VmmCacheExists(VMM_CACHE_TAG_TLB, pte & 0xfffff000)) {
+                ObSet_Push(psObPrefetch, pte & 0xfffff000);
+            }
+        }
+        if(ObSet_Size(psObPrefetch) > 1) {
+            VmmTlbPrefetch(psObPrefetch);
+        }
+        Ob_DECREF_NULL(&psObPrefetch);
+    }
+    // 2: resolve entries sharing the same page table entry
+    for(iBase = 0; iBase < cV2P; iBase = iNext) {
+        for(iNext = iBase + 1; (iNext < cV2P) && ((ppV2Ps[iNext]->va >> cShift) == (ppV2Ps[iBase]->va >> cShift)); iNext++);
+        pte = pObPTEs->pdw[0x3ff & (ppV2Ps[iBase]->va >> cShift)];
+        if(!MMX86_PTE_IS_VALID(pte, iPML)) {
+            if(iPML == 1) {                                 // NOT VALID
+                for(i = iBase; i < iNext; i++) {
+                    ppV2Ps[i]->pa = pte;
+                }
+            }
+            continue;
+        }
+        if(fUserOnly && !(pte & 0x04)) { continue; }        // SUPERVISOR PAGE & USER MODE REQ
+        if((iPML == 2) && !(pte & 0x80) /* PS */) {
+            MmX86_Virt2PhysScatter_DoWork(pte, fUserOnly, 1, iNext - iBase, ppV2Ps + iBase);
+            continue;
+        }
+        if((iPML == 2) && (pte & 0x003e0000)) { continue; } // RESERVED
+        for(i = iBase; i < iNext; i++) {
+            if(iPML == 1) {     // 4kB PAGE
+                ppV2Ps[i]->pa = pte & 0xfffff000;
+            } else {            // 4MB PAGE
+                ppV2Ps[i]->pa = (((QWORD)(pte & 0x0001e000)) << (32 - 13)) + (pte & 0xffc00000) + (ppV2Ps[i]->va & 0x003ff000);
+            }
+            ppV2Ps[i]->cPageShift = cShift;
+            ppV2Ps[i]->f = TRUE;
+        }
+    }
+    Ob_DECREF(pObPTEs);
+}
+
+VOID MmX86_Virt2PhysScatter(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ DWORD cV2P, _Inout_updates_(cV2P) PPVMM_VIRT2PHYS_SCATTER ppV2Ps)
+{
+    // entries are sorted - skip trailing entries above 4GB.
+    while(cV2P && (ppV2Ps[cV2P - 1]->va > 0xffffffff)) { cV2P--; }
+    if(cV2P) {
+        MmX86_Virt2PhysScatter_DoWork(paDTB, fUserOnly, 2, cV2P, ppV2Ps);
+    }
+}
+
 VOID MmX86_Virt2PhysVadEx(_In_ QWORD paPT, _Inout_ PVMMOB_MAP_VADEX pVadEx, _In_ BYTE iPML, _Inout_ PDWORD piVadEx)
 {
     DWORD pte, iPte, iVadEx;
@@ -319,6 +390,7 @@ VOID MmX86_Initialize()
     }
     ctxVmm->fnMemoryModel.pfnClose = MmX86_Close;
     ctxVmm->fnMemoryModel.pfnVirt2Phys = MmX86_Virt2Phys;
+    ctxVmm->fnMemoryModel.pfnVirt2PhysScatter = MmX86_Virt2PhysScatter;
     ctxVmm->fnMemoryModel.pfnVirt2PhysVadEx = MmX86_Virt2PhysVadEx;
     ctxVmm->fnMemoryModel.pfnVirt2PhysGetInformation = MmX86_Virt2PhysGetInformation;
     ctxVmm->fnMemoryModel.pfnPhys2VirtGetInformation = MmX86_Phys2VirtGetInformation;
@@ -200,7 +200,7 @@ BOOL MmX86PAE_PteMapInitialize(_In_ PVMM_PROCESS pProcess)
 }
 
 _Success_(return)
-BOOL MmX86PAE_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ QWORD va, _Out_ PQWORD ppa)
+BOOL MmX86PAE_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ QWORD va, _Out_ PQWORD ppa, _Out_opt_ PDWORD pcPageShift)
 {
     PBYTE pbPTEs;
     QWORD pte, i, qwMask;
@@ -221,7 +221,7 @@ BOOL MmX86PAE_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _I
         Ob_DECREF(pObPTEs);
         if(!(pte & 0x01)) { return FALSE; }                 // NOT VALID
         if(pte & 0xffff0000000001e6) { return FALSE; }      // RESERVED BITS IN PDPTE
-        return MmX86PAE_Virt2Phys(pte, fUserOnly, 2, va, ppa);
+        return MmX86PAE_Virt2Phys(pte, fUserOnly, 2, va, ppa, pcPageShift);
     }
     // PT or PD
     pte = pObPTEs->pqw[i];
@@ -237,9 +237,86 @@ BOOL MmX86PAE_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _I
         *ppa = pte & 0x0000fffffffff000 & qwMask;           // MASK AWAY BITS FOR 4kB/2MB/1GB PAGES
         qwMask = qwMask ^ 0xffffffffffffffff;
         *ppa = *ppa | (qwMask & va);                        // FILL LOWER ADDRESS BITS
+        if(pcPageShift) { *pcPageShift = MMX86PAE_PAGETABLEMAP_PML_REGION_SIZE[iPML]; }
         return TRUE;
     }
-    return MmX86PAE_Virt2Phys(pte, fUserOnly, 1, va, ppa);
+    return MmX86PAE_Virt2Phys(pte, fUserOnly, 1, va, ppa, pcPageShift);
+}
+
+/*
+* Batched page table walk of entries sharing the page table paPT. Entries must
+* be sorted by virtual address. Entries sharing a page table entry are resolved
+* together and next level page tables not already in the TLB cache are fetched
+* in a single device read before descending.
+*/
+VOID MmX86PAE_Virt2PhysScatter_DoWork(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ DWORD cV2P, _Inout_updates_(cV2P) PPVMM_VIRT2PHYS_SCATTER ppV2Ps)
+{
+    PQWORD pqwPTEs;
+    QWORD pte, qwMask;
+    DWORD i, iBase, iNext, cShift;
+    POB_SET psObPrefetch = NULL;
+    PVMMOB_CACHE_MEM pObPTEs;
+    pObPTEs = VmmTlbGetPageTable(paPT & 0x0000fffffffff000, FALSE);
+    if(!pObPTEs) { return; }
+    cShift = MMX86PAE_PAGETABLEMAP_PML_REGION_SIZE[iPML];
+    pqwPTEs = (iPML == 3) ? (PQWORD)(pObPTEs->pb + (paPT & 0xfe0)) : pObPTEs->pqw;    // ADJUST PDPT TO 32-BYTE BOUNDARY
+    // 1: fetch missing next level page tables in one read
+    if((iPML > 1) && (cV2P > 1) && (psObPrefetch = ObSet_New())) {
+        for(iBase = 0; iBase < cV2P; iBase = iNext) {
+            for(iNext = iBase + 1; (iNext < cV2P) && ((ppV2Ps[iNext]->va >> cShift) == (ppV2Ps[iBase]->va >> cShift)); iNext++);
+            pte = pqwPTEs[0x1ff & (ppV2Ps[iBase]->va >> cShift)];
+            if((pte & 0x01) && !(pte & 0x80) && !(pte & 0x000f000000000000) && !VmmCacheExists(VMM_CACHE_TAG_TLB, pte & 0x0000fffffffff000)) {
+                ObSet_Push(psObPrefetch, pte & 0x0000fffffffff000);
+            }
+        }
+        if(ObSet_Size(psObPrefetch) > 1) {
+            VmmTlbPrefetch(psObPrefetch);
+        }
+        Ob_DECREF_NULL(&psObPrefetch);
+    }
+    // 2: resolve entries sharing the same page table entry
+    for(iBase = 0; iBase < cV2P; iBase = iNext) {
+        for(iNext = iBase + 1; (iNext < cV2P) && ((ppV2Ps[iNext]->va >> cShift) == (ppV2Ps[iBase]->va >> cShift)); iNext++);
+        pte = pqwPTEs[0x1ff & (ppV2Ps[iBase]->va >> cShift)];
+        if(iPML == 3) {
+            // PDPT
+            if(!(pte & 0x01)) { continue; }                 // NOT VALID
+            if(pte & 0xffff0000000001e6) { continue; }      // RESERVED BITS IN PDPTE
+            MmX86PAE_Virt2PhysScatter_DoWork(pte, fUserOnly, 2, iNext - iBase, ppV2Ps + iBase);
+            continue;
+        }
+        // PT or PD
+        if(!MMX86PAE_PTE_IS_VALID(pte, iPML)) {
+            if(iPML == 1) {                                 // NOT VALID
+                for(i = iBase; i < iNext; i++) {
+                    ppV2Ps[i]->pa = pte;
+                }
+            }
+            continue;
+        }
+        if(fUserOnly && !(pte & 0x04)) { continue; }        // SUPERVISOR PAGE & USER MODE REQ
+        if(pte & 0x000f000000000000) { continue; }          // RESERVED
+        if((iPML == 1) || (pte & 0x80) /* PS */) {
+            qwMask = 0xffffffffffffffff << cShift;
+            for(i = iBase; i < iNext; i++) {
+                ppV2Ps[i]->pa = (pte & 0x0000fffffffff000 & qwMask) | (ppV2Ps[i]->va & ~qwMask);
+                ppV2Ps[i]->cPageShift = cShift;
+                ppV2Ps[i]->f = TRUE;
+            }
+            continue;
+        }
+        MmX86PAE_Virt2PhysScatter_DoWork(pte, fUserOnly, 1, iNext - iBase, ppV2Ps + iBase);
+    }
+    Ob_DECREF(pObPTEs);
+}
+
+VOID MmX86PAE_Virt2PhysScatter(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ DWORD cV2P, _Inout_updates_(cV2P) PPVMM_VIRT2PHYS_SCATTER ppV2Ps)
+{
+    // entries are sorted - skip trailing entries above 4GB.
+    while(cV2P && (ppV2Ps[cV2P - 1]->va > 0xffffffff)) { cV2P--; }
+    if(cV2P) {
+        MmX86PAE_Virt2PhysScatter_DoWork(paDTB, fUserOnly, 3, cV2P, ppV2Ps);
+    }
 }
 
 VOID MmX86PAE_Virt2PhysVadEx(_In_ QWORD paPT, _Inout_ PVMMOB_MAP_VADEX pVadEx, _In_ BYTE iPML, _Inout_ PDWORD piVadEx)
@@ -406,6 +483,7 @@ VOID MmX86PAE_Initialize()
     }
     ctxVmm->fnMemoryModel.pfnClose = MmX86PAE_Close;
     ctxVmm->fnMemoryModel.pfnVirt2Phys = MmX86PAE_Virt2Phys;
+    ctxVmm->fnMemoryModel.pfnVirt2PhysScatter = MmX86PAE_Virt2PhysScatter;
     ctxVmm->fnMemoryModel.pfnVirt2PhysVadEx = MmX86PAE_Virt2PhysVadEx;
     ctxVmm->fnMemoryModel.pfnVirt2PhysGetInformation = MmX86PAE_Virt2PhysGetInformation;
     ctxVmm->fnMemoryModel.pfnPhys2VirtGetInformation = MmX86PAE_Phys2VirtGetInformation;
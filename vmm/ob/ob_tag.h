@@ -28,6 +28,7 @@
 #define OB_TAG_MAP_PFN                  'Mpfn'
 #define OB_TAG_MAP_EVIL                 'Mevl'
 #define OB_TAG_MAP_TASK                 'Mtsk'
+#define OB_TAG_MM_SMKMSTORE             'MmSs'
 #define OB_TAG_MOD_MINIDUMP_CTX         'mMDx'
 #define OB_TAG_MOD_SEARCH_CTX           'mSHx'
 #define OB_TAG_OBJ_ERROR                'Oerr'
@@ -44,6 +45,8 @@
 #define OB_TAG_VMM_PROCESS_CLONE        'PsC_'
 #define OB_TAG_VMM_PROCESS_PERSISTENT   'PsSt'
 #define OB_TAG_VMM_PROCESSTABLE         'PsTb'
+#define OB_TAG_VMM_SEARCH_BATCH         'SrBt'
+#define OB_TAG_VMM_WORK_PARALLELFOR     'WkPF'
 #define OB_TAG_VMMVFS_DUMPCONTEXT       'CDmp'
 
 #endif /* __OB_TAG_H__ */
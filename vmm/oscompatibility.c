@@ -495,13 +495,283 @@ PSLIST_ENTRY InterlockedPushEntrySList(_Inout_ PSLIST_HEADER ListHead, _Inout_ P
 }
 
 // ----------------------------------------------------------------------------
-// VARIOUS FUNCTIONALITY BELOW:
+// XPRESS DECOMPRESSION BELOW:
+// Native implementation of RtlDecompressBuffer for the XPRESS (plain LZ77)
+// and XPRESS Huffman compression formats as specified in [MS-XCA]. Used to
+// decompress pages of the Windows 10+ MemCompression (SMKM) store on Linux.
 // ----------------------------------------------------------------------------
 
+#define OSCOMPAT_COMPRESSION_FORMAT_XPRESS          3
+#define OSCOMPAT_COMPRESSION_FORMAT_XPRESS_HUFF     4
+#define OSCOMPAT_XPRESS_HUFF_SYMBOLS                512
+#define OSCOMPAT_XPRESS_HUFF_TABLE_BITS             10
+#define OSCOMPAT_XPRESS_HUFF_BLOCK_SIZE             0x10000
+
+typedef struct tdOSCOMPAT_XPRESS_HUFF_TABLE {
+    // primary lookup table: [symbol:12 | length:4] for codes <= TABLE_BITS long
+    WORD Fast[1 << OSCOMPAT_XPRESS_HUFF_TABLE_BITS];
+    // canonical decoding of longer codes:
+    WORD cLength[16];               // number of codes per bit length
+    WORD oLength[16];               // offset into Symbol[] per bit length
+    WORD Symbol[OSCOMPAT_XPRESS_HUFF_SYMBOLS];  // symbols sorted by (length, symbol)
+} OSCOMPAT_XPRESS_HUFF_TABLE, *POSCOMPAT_XPRESS_HUFF_TABLE;
+
+/*
+* Copy a LZ77 match within the output buffer. Non-overlapping matches and
+* matches with an offset of at least 8 are copied 8 bytes at a time.
+* -- pbOut
+* -- oOut
+* -- cbOut
+* -- cbOffset
+* -- cbLength
+* -- return = FALSE if the match is out of bounds.
+*/
+static inline BOOL OSCOMPAT_Xpress_CopyMatch(_Inout_ PBYTE pbOut, _In_ SIZE_T oOut, _In_ SIZE_T cbOut, _In_ SIZE_T cbOffset, _In_ SIZE_T cbLength)
+{
+    PBYTE pbDst, pbSrc;
+    if((cbOffset > oOut) || (cbLength > cbOut - oOut)) { return FALSE; }
+    pbDst = pbOut + oOut;
+    pbSrc = pbDst - cbOffset;
+    if(cbOffset >= cbLength) {
+        memcpy(pbDst, pbSrc, cbLength);
+    } else if(cbOffset >= 8) {
+        while(cbLength >= 8) {
+            memcpy(pbDst, pbSrc, 8);
+            pbDst += 8; pbSrc += 8; cbLength -= 8;
+        }
+        while(cbLength--) { *pbDst++ = *pbSrc++; }
+    } else if(cbOffset == 1) {
+        memset(pbDst, *pbSrc, cbLength);
+    } else {
+        while(cbLength--) { *pbDst++ = *pbSrc++; }
+    }
+    return TRUE;
+}
+
+/*
+* Decompress XPRESS (plain LZ77) compressed data - [MS-XCA] 2.4.
+*/
+NTSTATUS OSCOMPAT_Xpress_Decompress(_Out_writes_(cbOut) PBYTE pbOut, _In_ ULONG cbOut, _In_reads_(cbIn) PBYTE pbIn, _In_ ULONG cbIn, _Out_ PULONG pcbOut)
+{
+    DWORD dwFlags = 0, cFlags = 0;
+    SIZE_T oIn = 0, oOut = 0, oHalfByte = 0, cbLength, cbOffset;
+    *pcbOut = 0;
+    while(TRUE) {
+        if(cFlags == 0) {
+            if(oIn + 4 > cbIn) { break; }
+            dwFlags = *(PDWORD)(pbIn + oIn);
+            oIn += 4;
+            cFlags = 32;
+        }
+        cFlags--;
+        if(!(dwFlags & (1 << cFlags))) {
+            // literal:
+            if(oIn >= cbIn) { break; }
+            if(oOut >= cbOut) { return VMM_STATUS_UNSUCCESSFUL; }
+            pbOut[oOut++] = pbIn[oIn++];
+            continue;
+        }
+        // match:
+        if(oIn == cbIn) { break; }
+        if(oIn + 2 > cbIn) { return VMM_STATUS_UNSUCCESSFUL; }
+        cbLength = *(PWORD)(pbIn + oIn);
+        oIn += 2;
+        cbOffset = (cbLength >> 3) + 1;
+        cbLength &= 7;
+        if(cbLength == 7) {
+            if(oHalfByte == 0) {
+                if(oIn >= cbIn) { return VMM_STATUS_UNSUCCESSFUL; }
+                cbLength = pbIn[oIn] & 0xf;
+                oHalfByte = oIn++;
+            } else {
+                cbLength = pbIn[oHalfByte] >> 4;
+                oHalfByte = 0;
+            }
+            if(cbLength == 15) {
+                if(oIn >= cbIn) { return VMM_STATUS_UNSUCCESSFUL; }
+                cbLength = pbIn[oIn++];
+                if(cbLength == 255) {
+                    if(oIn + 2 > cbIn) { return VMM_STATUS_UNSUCCESSFUL; }
+                    cbLength = *(PWORD)(pbIn + oIn);
+                    oIn += 2;
+                    if(cbLength == 0) {
+                        if(oIn + 4 > cbIn) { return VMM_STATUS_UNSUCCESSFUL; }
+                        cbLength = *(PDWORD)(pbIn + oIn);
+                        oIn += 4;
+                    }
+                    if(cbLength < 15 + 7) { return VMM_STATUS_UNSUCCESSFUL; }
+                    cbLength -= 15 + 7;
+                }
+                cbLength += 15;
+            }
+            cbLength += 7;
+        }
+        cbLength += 3;
+        if(!OSCOMPAT_Xpress_CopyMatch(pbOut, oOut, cbOut, cbOffset, cbLength)) { return VMM_STATUS_UNSUCCESSFUL; }
+        oOut += cbLength;
+    }
+    *pcbOut = (ULONG)oOut;
+    return VMM_STATUS_SUCCESS;
+}
+
+/*
+* Build a XPRESS Huffman decoding table from the 256-byte table of 4-bit code
+* lengths preceding each compressed block.
+* -- pbLengths
+* -- pt
+* -- return
+*/
+_Success_(return)
+BOOL OSCOMPAT_XpressHuff_TableBuild(_In_reads_(256) PBYTE pbLengths, _Out_ POSCOMPAT_XPRESS_HUFF_TABLE pt)
+{
+    DWORD i, j, cbits, dwCode = 0, cAvailable = 1, oFill, cFill;
+    WORD o[16];
+    ZeroMemory(pt->Fast, sizeof(pt->Fast));
+    ZeroMemory(pt->cLength, sizeof(pt->cLength));
+    for(i = 0; i < OSCOMPAT_XPRESS_HUFF_SYMBOLS; i++) {
+        pt->cLength[(pbLengths[i >> 1] >> ((i & 1) << 2)) & 0xf]++;
+    }
+    // verify code is not over-subscribed and calculate symbol offsets:
+    pt->cLength[0] = 0;
+    for(i = 1, j = 0; i < 16; i++) {
+        cAvailable = (cAvailable << 1) - pt->cLength[i];
+        if((int)cAvailable < 0) { return FALSE; }
+        o[i] = pt->oLength[i] = (WORD)j;
+        j += pt->cLength[i];
+    }
+    if(!j) { return FALSE; }
+    // sort symbols by (length, symbol):
+    for(i = 0; i < OSCOMPAT_XPRESS_HUFF_SYMBOLS; i++) {
+        if((cbits = (pbLengths[i >> 1] >> ((i & 1) << 2)) & 0xf)) {
+            pt->Symbol[o[cbits]++] = (WORD)i;
+        }
+    }
+    // fill primary lookup table with canonical codes <= TABLE_BITS:
+    for(cbits = 1, j = 0; cbits <= OSCOMPAT_XPRESS_HUFF_TABLE_BITS; cbits++) {
+        for(i = 0; i < pt->cLength[cbits]; i++, j++, dwCode++) {
+            cFill = 1 << (OSCOMPAT_XPRESS_HUFF_TABLE_BITS - cbits);
+            oFill = dwCode << (OSCOMPAT_XPRESS_HUFF_TABLE_BITS - cbits);
+            while(cFill--) {
+                pt->Fast[oFill++] = (WORD)((pt->Symbol[j] << 4) | cbits);
+            }
+        }
+        dwCode <<= 1;
+    }
+    return TRUE;
+}
+
+/*
+* Decode the next XPRESS Huffman symbol from the (MSB aligned) bit buffer.
+* -- pt
+* -- dwBits = next 32 bits with at least 16 valid bits.
+* -- pcbits = receives the symbol bit length.
+* -- return = the symbol or (DWORD)-1 on invalid code.
+*/
+static inline DWORD OSCOMPAT_XpressHuff_Symbol(_In_ POSCOMPAT_XPRESS_HUFF_TABLE pt, _In_ DWORD dwBits, _Out_ PDWORD pcbits)
+{
+    DWORD cbits, dwCode, dwFirst = 0;
+    WORD w = pt->Fast[dwBits >> (32 - OSCOMPAT_XPRESS_HUFF_TABLE_BITS)];
+    if(w) {
+        *pcbits = w & 0xf;
+        return w >> 4;
+    }
+    // slow path: canonical decode of codes longer than TABLE_BITS:
+    for(cbits = 1; cbits < 16; cbits++) {
+        dwCode = dwBits >> (32 - cbits);
+        if(dwCode - dwFirst < pt->cLength[cbits]) {
+            *pcbits = cbits;
+            return pt->Symbol[pt->oLength[cbits] + dwCode - dwFirst];
+        }
+        dwFirst = (dwFirst + pt->cLength[cbits]) << 1;
+    }
+    *pcbits = 0;
+    return (DWORD)-1;
+}
+
+#define OSCOMPAT_XPRESSHUFF_READ16(o)   (((o) + 2 <= cbIn) ? *(PWORD)(pbIn + (o)) : (((o) < cbIn) ? pbIn[o] : 0))
+
+/*
+* Decompress XPRESS Huffman compressed data - [MS-XCA] 2.2.
+*/
+NTSTATUS OSCOMPAT_XpressHuff_Decompress(_Out_writes_(cbOut) PBYTE pbOut, _In_ ULONG cbOut, _In_reads_(cbIn) PBYTE pbIn, _In_ ULONG cbIn, _Out_ PULONG pcbOut)
+{
+    DWORD dwBits, dwSymbol, cbits, cbOffsetBits;
+    int cExtraBits;
+    SIZE_T oIn = 0, oOut = 0, oBlockEnd, cbLength, cbOffset;
+    OSCOMPAT_XPRESS_HUFF_TABLE t, *pt = &t;
+    *pcbOut = 0;
+    while(oOut < cbOut) {
+        if(oIn + 256 + 4 > cbIn) { break; }
+        if(!OSCOMPAT_XpressHuff_TableBuild(pbIn + oIn, pt)) { return VMM_STATUS_UNSUCCESSFUL; }
+        oIn += 256;
+        dwBits = ((DWORD)OSCOMPAT_XPRESSHUFF_READ16(oIn) << 16) | OSCOMPAT_XPRESSHUFF_READ16(oIn + 2);
+        oIn += 4;
+        cExtraBits = 16;
+        oBlockEnd = oOut + OSCOMPAT_XPRESS_HUFF_BLOCK_SIZE;
+        while((oOut < oBlockEnd) && (oOut < cbOut)) {
+            if((DWORD)-1 == (dwSymbol = OSCOMPAT_XpressHuff_Symbol(pt, dwBits, &cbits))) { return VMM_STATUS_UNSUCCESSFUL; }
+            dwBits <<= cbits;
+            cExtraBits -= cbits;
+            if(cExtraBits < 0) {
+                dwBits |= (DWORD)OSCOMPAT_XPRESSHUFF_READ16(oIn) << (-cExtraBits);
+                cExtraBits += 16;
+                oIn += 2;
+            }
+            if(dwSymbol < 256) {
+                pbOut[oOut++] = (BYTE)dwSymbol;
+                continue;
+            }
+            // NB! symbol 256 is also end-of-stream, but only once the expected
+            //     (i.e. the buffer) size is reached - which ends the loop above.
+            dwSymbol -= 256;
+            cbLength = dwSymbol & 0xf;
+            cbOffsetBits = dwSymbol >> 4;
+            if(cbLength == 15) {
+                if(oIn >= cbIn) { return VMM_STATUS_UNSUCCESSFUL; }
+                cbLength = pbIn[oIn++];
+                if(cbLength == 255) {
+                    if(oIn + 2 > cbIn) { return VMM_STATUS_UNSUCCESSFUL; }
+                    cbLength = *(PWORD)(pbIn + oIn);
+                    oIn += 2;
+                    if(cbLength == 0) {
+                        if(oIn + 4 > cbIn) { return VMM_STATUS_UNSUCCESSFUL; }
+                        cbLength = *(PDWORD)(pbIn + oIn);
+                        oIn += 4;
+                    }
+                    if(cbLength < 15) { return VMM_STATUS_UNSUCCESSFUL; }
+                    cbLength -= 15;
+                }
+                cbLength += 15;
+            }
+            cbLength += 3;
+            cbOffset = cbOffsetBits ? (dwBits >> (32 - cbOffsetBits)) : 0;
+            cbOffset += (SIZE_T)1 << cbOffsetBits;
+            dwBits = cbOffsetBits ? (dwBits << cbOffsetBits) : dwBits;
+            cExtraBits -= cbOffsetBits;
+            if(cExtraBits < 0) {
+                dwBits |= (DWORD)OSCOMPAT_XPRESSHUFF_READ16(oIn) << (-cExtraBits);
+                cExtraBits += 16;
+                oIn += 2;
+            }
+            if(!OSCOMPAT_Xpress_CopyMatch(pbOut, oOut, cbOut, cbOffset, cbLength)) { return VMM_STATUS_UNSUCCESSFUL; }
+            oOut += cbLength;
+        }
+        if(oOut < oBlockEnd) { break; }
+    }
+    *pcbOut = (ULONG)oOut;
+    return VMM_STATUS_SUCCESS;
+}
+
 NTSTATUS OSCOMPAT_RtlDecompressBuffer(USHORT CompressionFormat, PUCHAR UncompressedBuffer, ULONG  UncompressedBufferSize, PUCHAR CompressedBuffer, ULONG  CompressedBufferSize, PULONG FinalUncompressedSize)
 {
-    // TODO: not implemented yet
-    return VMM_STATUS_UNSUCCESSFUL;
+    switch(CompressionFormat & 0xff) {
+        case OSCOMPAT_COMPRESSION_FORMAT_XPRESS:
+            return OSCOMPAT_Xpress_Decompress(UncompressedBuffer, UncompressedBufferSize, CompressedBuffer, CompressedBufferSize, FinalUncompressedSize);
+        case OSCOMPAT_COMPRESSION_FORMAT_XPRESS_HUFF:
+            return OSCOMPAT_XpressHuff_Decompress(UncompressedBuffer, UncompressedBufferSize, CompressedBuffer, CompressedBufferSize, FinalUncompressedSize);
+        default:
+            return VMM_STATUS_UNSUCCESSFUL;
+    }
 }
 
 #endif /* LINUX */
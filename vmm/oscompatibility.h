@@ -26,6 +26,7 @@ typedef unsigned __int64                    QWORD, *PQWORD;
 #include <dirent.h>
 #include <dlfcn.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <stdarg.h>
 #include <stddef.h>
@@ -37,6 +38,8 @@ typedef unsigned __int64                    QWORD, *PQWORD;
 #include <time.h>
 #include <unistd.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -169,6 +172,7 @@ typedef int(*_CoreCrtNonSecureSearchSortCompareFunction)(void const *, void cons
 #define _snprintf_s(s,l,c,...)              (snprintf(s,min((QWORD)(l), (QWORD)(c)),__VA_ARGS__))
 #define sscanf_s(s, f, ...)                 (sscanf(s, f, __VA_ARGS__))
 #define SwitchToThread()                    (sched_yield())
+#define GetCurrentThreadId()                ((DWORD)syscall(SYS_gettid))
 #define ExitThread(dwExitCode)              (pthread_exit(dwExitCode))
 #define ExitProcess(c)                      (exit(c ? EXIT_SUCCESS : EXIT_FAILURE))
 #define Sleep(dwMilliseconds)               (usleep(1000*dwMilliseconds))
@@ -183,6 +187,10 @@ typedef int(*_CoreCrtNonSecureSearchSortCompareFunction)(void const *, void cons
 #define InterlockedIncrement64(p)           (__sync_add_and_fetch(p, 1))
 #define InterlockedIncrement(p)             (__sync_add_and_fetch_4(p, 1))
 #define InterlockedDecrement(p)             (__sync_sub_and_fetch_4(p, 1))
+#define InterlockedExchange(p, v)           (__sync_lock_test_and_set(p, v))
+#define InterlockedCompareExchange(p, v, c)   (__sync_val_compare_and_swap(p, c, v))
+#define InterlockedCompareExchange64(p, v, c) (__sync_val_compare_and_swap(p, c, v))
+#define MemoryBarrier()                     (__sync_synchronize())
 #define GetCurrentProcess()					((HANDLE)-1)
 #define InetNtopA                           inet_ntop
 #define closesocket(s)                      close(s)
@@ -0,0 +1,318 @@
+// oscompatibility_test.c : decode check and throughput benchmark of the native
+//     XPRESS / XPRESS Huffman decompressor (OSCOMPAT_RtlDecompressBuffer) used on
+//     Linux to decompress pages of the Windows MemCompression store.
+//
+// Build and run with: make xpress_test
+//
+// The plain LZ77 vectors are the [MS-XCA] examples. The remaining
+// vectors are generated by an independent [MS-XCA] reference encoder; their
+// uncompressed data is re-generated by XpressTest_PageText().
+//
+// (c) Ulf Frisk, 2022
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+#ifdef LINUX
+
+#include "oscompatibility.h"
+#include <stdio.h>
+#include <time.h>
+
+#define XPRESS_TEST_FORMAT_XPRESS           3
+#define XPRESS_TEST_FORMAT_XPRESS_HUFF      4
+#define XPRESS_TEST_BENCH_ITERATIONS        0x8000      // 128MB per format
+
+NTSTATUS OSCOMPAT_RtlDecompressBuffer(USHORT CompressionFormat, PUCHAR UncompressedBuffer, ULONG  UncompressedBufferSize, PUCHAR CompressedBuffer, ULONG  CompressedBufferSize, PULONG FinalUncompressedSize);
+
+// ----------------------------------------------------------------------------
+// TEST VECTORS BELOW:
+// ----------------------------------------------------------------------------
+
+// [MS-XCA] example: plain LZ77 - "abcdefghijklmnopqrstuvwxyz".
+static BYTE XPRESS_ALPHABET[] = {
+    0x3f, 0x00, 0x00, 0x00, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c,
+    0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a,
+};
+
+// [MS-XCA] example: plain LZ77 - "abc" repeated 100 times (extended match length).
+static BYTE XPRESS_ABC[] = {
+    0xff, 0xff, 0xff, 0x1f, 0x61, 0x62, 0x63, 0x17, 0x00, 0x0f, 0xff, 0x26, 0x01,
+};
+
+// XPRESS Huffman - "abc" repeated 100 times (extended match length).
+static BYTE XPRESS_HUFF_ABC[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xa8, 0xdc, 0x00, 0x00, 0xff, 0x26, 0x01,
+};
+
+// plain LZ77 - 4kB page of XpressTest_PageText().
+static BYTE XPRESS_PAGE[] = {
+    0x01, 0x00, 0x00, 0x00, 0x74, 0x69, 0x6d, 0x65, 0x6c, 0x69, 0x6e, 0x65, 0x0a, 0x70, 0x72, 0x6f,
+    0x63, 0x65, 0x73, 0x73, 0x20, 0x68, 0x61, 0x6e, 0x64, 0x6c, 0x65, 0x20, 0x74, 0x68, 0x72, 0x65,
+    0x61, 0x64, 0x20, 0xf5, 0x00, 0x87, 0x04, 0x30, 0x80, 0x47, 0x00, 0x00, 0x72, 0x65, 0x67, 0x69,
+    0x73, 0x74, 0x72, 0x79, 0x0a, 0x0c, 0x01, 0xbc, 0x01, 0x0a, 0x70, 0x68, 0x79, 0x73, 0x69, 0x63,
+    0x61, 0x6c, 0x4f, 0x01, 0x66, 0x69, 0x38, 0x02, 0x6d, 0x6f, 0x64, 0x75, 0x30, 0x00, 0xac, 0x02,
+    0x26, 0x01, 0x3f, 0x38, 0xc4, 0xa0, 0x45, 0x00, 0x0a, 0x75, 0x02, 0x20, 0x63, 0x61, 0x63, 0x68,
+    0x00, 0x01, 0x2c, 0x04, 0x74, 0x61, 0x62, 0x70, 0x01, 0x61, 0x64, 0x64, 0x72, 0xd9, 0x02, 0x6b,
+    0x00, 0x2a, 0x00, 0x0a, 0x6d, 0x65, 0x6d, 0x6f, 0x70, 0x01, 0x36, 0x04, 0x7c, 0x00, 0xae, 0x03,
+    0x4c, 0x03, 0xbe, 0x02, 0xef, 0xff, 0x83, 0x07, 0x76, 0x69, 0x72, 0x74, 0x75, 0x40, 0x03, 0xcd,
+    0x02, 0x9c, 0x02, 0x87, 0x01, 0x00, 0x6b, 0x65, 0x72, 0x6e, 0x65, 0xb0, 0x05, 0x1a, 0x03, 0x6c,
+    0x02, 0x25, 0x01, 0xa3, 0x04, 0x4c, 0x07, 0x54, 0x06, 0x34, 0x00, 0x7b, 0x01, 0xaf, 0x07, 0x72,
+    0x00, 0xae, 0x03, 0xd9, 0x07, 0x0a, 0x17, 0x03, 0x06, 0x54, 0x04, 0x5c, 0x01, 0x3f, 0x09, 0x7f,
+    0xfc, 0xff, 0x0f, 0x6f, 0x72, 0x65, 0x6e, 0x28, 0x02, 0xe5, 0x03, 0x4d, 0x05, 0xac, 0x01, 0x16,
+    0x03, 0x7a, 0x0a, 0xf4, 0x06, 0xdc, 0x00, 0xfc, 0x04, 0x27, 0x0d, 0x07, 0x4d, 0x03, 0x3d, 0x06,
+    0x1e, 0x02, 0xe4, 0x05, 0xc5, 0x0a, 0x66, 0x08, 0x07, 0x0b, 0x33, 0x03, 0x70, 0x61, 0x67, 0x65,
+    0x08, 0xcf, 0x0e, 0x40, 0x46, 0x05, 0xaf, 0x07, 0x2f, 0x02, 0x05, 0xd2, 0x01, 0xfc, 0x04, 0xfb,
+    0xff, 0xfe, 0xff, 0x7f, 0x08, 0x1f, 0x07, 0x25, 0x95, 0x01, 0x62, 0x03, 0x67, 0x00, 0xa7, 0x09,
+    0x57, 0x7f, 0x0f, 0x27, 0x03, 0x62, 0x2f, 0x07, 0x6b, 0x08, 0x2a, 0x02, 0x7f, 0x13, 0x46, 0xfe,
+    0x03, 0x5e, 0x05, 0x9a, 0x0e, 0x0a, 0x7c, 0x08, 0xef, 0x02, 0x87, 0x06, 0x80, 0x5d, 0x04, 0xcb,
+    0x02, 0x64, 0x01, 0xda, 0x03, 0x25, 0x0d, 0x0f, 0x07, 0x0f, 0x03, 0x54, 0x26, 0x05, 0x3d, 0x14,
+    0x23, 0x02, 0x0a, 0xad, 0x13, 0x6f, 0x07, 0xff, 0xff, 0xff, 0xff, 0x9f, 0x19, 0x52, 0xe6, 0x0d,
+    0x54, 0x03, 0xfd, 0x13, 0x87, 0x17, 0xb4, 0x00, 0x37, 0x16, 0x43, 0x9f, 0x11, 0x1e, 0x05, 0x8d,
+    0x02, 0x9f, 0x04, 0x65, 0x95, 0x02, 0x85, 0x13, 0x7d, 0x03, 0xf4, 0x0f, 0x70, 0x07, 0x22, 0x00,
+    0xf6, 0x01, 0x74, 0x01, 0xed, 0x01, 0xf6, 0x02, 0x9f, 0x06, 0xac, 0x12, 0x3c, 0x21, 0xd6, 0x1f,
+    0x57, 0x02, 0x41, 0xbb, 0x02, 0xbf, 0x0f, 0x8f, 0x21, 0x03, 0xb7, 0x00, 0xfc, 0x1c, 0x1f, 0x1c,
+    0x53, 0xff, 0xff, 0xff, 0xff, 0xb7, 0x0d, 0xfd, 0x19, 0x99, 0x02, 0x37, 0x11, 0x61, 0xb4, 0x10,
+    0xfd, 0x0c, 0x87, 0x20, 0x26, 0x02, 0xbf, 0x07, 0x04, 0x36, 0x06, 0x17, 0x04, 0x05, 0x01, 0x0d,
+    0x02, 0x9f, 0x28, 0x67, 0x5e, 0x07, 0xd7, 0x02, 0x9f, 0x0d, 0xa6, 0xec, 0x04, 0x34, 0x01, 0xfa,
+    0x07, 0x07, 0x17, 0x34, 0x07, 0x8f, 0x1c, 0x50, 0x3c, 0x14, 0xbf, 0x1c, 0xed, 0x02, 0xc2, 0x01,
+    0xfd, 0x2d, 0x0f, 0x03, 0x33, 0x55, 0x0d, 0x27, 0x11, 0x8e, 0x08, 0xff, 0xff, 0xff, 0xff, 0xe7,
+    0x1c, 0x10, 0x07, 0x17, 0x0f, 0x1d, 0x43, 0x64, 0x0c, 0xa6, 0x2b, 0x4f, 0x26, 0x67, 0x21, 0x11,
+    0x35, 0x2e, 0x8f, 0x00, 0xc7, 0x0e, 0x66, 0xb5, 0x00, 0x53, 0x09, 0xb7, 0x0c, 0x3e, 0x00, 0x7f,
+    0x2d, 0x26, 0xb7, 0x22, 0xed, 0x1e, 0x14, 0x01, 0x9f, 0x03, 0x21, 0x15, 0x16, 0x12, 0x1d, 0x1f,
+    0x21, 0xc6, 0x32, 0x5c, 0x2e, 0x23, 0x04, 0x44, 0x02, 0x76, 0x06, 0x9f, 0x04, 0x45, 0x6f, 0x20,
+    0xa7, 0x07, 0x74, 0xc7, 0x05, 0x35, 0x01, 0xff, 0xff, 0xff, 0xff, 0xe5, 0x04, 0x7f, 0x0d, 0x70,
+    0xb4, 0x02, 0x47, 0x13, 0xf7, 0x22, 0x05, 0xa6, 0x05, 0x8e, 0x03, 0x87, 0x2b, 0x57, 0x06, 0x23,
+    0xf7, 0x0c, 0x8f, 0x10, 0x02, 0x0f, 0x03, 0x27, 0x3e, 0x25, 0x67, 0x3a, 0x27, 0x07, 0x2c, 0x4f,
+    0x0e, 0x8a, 0x0f, 0x66, 0x03, 0x25, 0x13, 0xcb, 0x0a, 0x5f, 0x2f, 0x0a, 0x2f, 0x17, 0xe7, 0x1c,
+    0x4b, 0xec, 0x3d, 0x94, 0x04, 0xc7, 0x0b, 0x26, 0x04, 0xb7, 0x36, 0xf4, 0x87, 0x25, 0x08, 0x0f,
+    0x0a, 0x07, 0x8f, 0x34, 0xeb, 0x06, 0xff, 0x77, 0xff, 0xff, 0xc5, 0x01, 0x97, 0x24, 0x57, 0x7f,
+    0x2b, 0x9b, 0x0b, 0x27, 0x3e, 0x74, 0xcf, 0x0e, 0x3f, 0x1f, 0x58, 0x12, 0x09, 0xe7, 0x3b, 0xcf,
+    0x08, 0x04, 0x3c, 0x07, 0x0f, 0x0e, 0xf7, 0x4a, 0x23, 0xfd, 0x34, 0x6c, 0x05, 0xb7, 0x1c, 0x0a,
+    0x57, 0x39, 0x66, 0xef, 0x1c, 0xa7, 0x10, 0x03, 0x0a, 0x22, 0x04, 0x4f, 0x24, 0x9b, 0x04, 0xb7,
+    0x16, 0x65, 0x67, 0x0b, 0x74, 0x03, 0x1f, 0x42, 0x43, 0x07, 0x0c, 0xa7, 0x3b, 0x37, 0x0f, 0x48,
+    0xc7, 0x01, 0x73, 0xff, 0xff, 0xff, 0xff, 0x47, 0x4b, 0xb3, 0x00, 0xa7, 0x2b, 0x64, 0x65, 0x51,
+    0xa7, 0x13, 0xe6, 0x53, 0xe7, 0x51, 0x77, 0xbb, 0x06, 0xcb, 0x27, 0x27, 0x3e, 0x7f, 0x4a, 0x55,
+    0x66, 0x52, 0x37, 0x27, 0x8d, 0x0c, 0x77, 0x12, 0x56, 0x93, 0x36, 0xe7, 0x37, 0x77, 0x15, 0x60,
+    0x07, 0x44, 0xa4, 0x28, 0x3d, 0x57, 0xd9, 0x01, 0xbe, 0x06, 0x67, 0x0d, 0x56, 0x9f, 0x0d, 0x94,
+    0x34, 0x35, 0x43, 0xff, 0x04, 0x45, 0x9f, 0x01, 0xe5, 0x00, 0x9f, 0x21, 0x5c, 0x0f, 0x0f, 0xff,
+    0xff, 0xff, 0xff, 0x6f, 0x36, 0x38, 0x4f, 0x1c, 0x27, 0x58, 0x4d, 0x2e, 0x43, 0x37, 0x0c, 0xff,
+    0x32, 0x30, 0x7b, 0x00, 0x6f, 0x47, 0x9f, 0x22, 0x67, 0x7f, 0x17, 0xc4, 0x20, 0x07, 0x12, 0x64,
+    0x92, 0x02, 0x17, 0x59, 0xcf, 0x01, 0xc6, 0x7f, 0x57, 0x5f, 0x05, 0x75, 0x27, 0x1c, 0xb7, 0x37,
+    0x46, 0x17, 0x1e, 0x37, 0x4c, 0x57, 0xef, 0x02, 0x0d, 0x3d, 0x67, 0x31, 0x41, 0x1f, 0x49, 0x7d,
+    0x01, 0xd7, 0x41, 0x8f, 0x03, 0xaf, 0x0c, 0x17, 0x61, 0x85, 0xab, 0x0f, 0x97, 0x12, 0x2f, 0x65,
+    0x6f, 0x07, 0xff, 0xff, 0xff, 0xff, 0xf7, 0x25, 0xbf, 0x0d, 0xc6, 0x49, 0x05, 0x7c, 0x0b, 0x1c,
+    0x03, 0x0f, 0x05, 0x3c, 0x52, 0x37, 0x04, 0x14, 0xa5, 0x03, 0x07, 0x1d, 0x26, 0x18, 0x77, 0x43,
+    0x32, 0x47, 0x14, 0x07, 0x4c, 0x15, 0xc6, 0x25, 0xcd, 0x1d, 0x5e, 0x48, 0xcf, 0x11, 0x2b, 0x00,
+    0x47, 0x6b, 0xee, 0xd7, 0x07, 0x6f, 0x18, 0x44, 0x77, 0x70, 0x1e, 0x01, 0x5f, 0x1c, 0x53, 0x3f,
+    0x1a, 0xbf, 0x4f, 0xc2, 0x07, 0x4c, 0x9f, 0x4f, 0x58, 0x57, 0x3f, 0xaf, 0x77, 0x56, 0x1f, 0x36,
+    0xff, 0xff, 0xff, 0xff, 0xa7, 0x24, 0x42, 0xa7, 0x5c, 0xa7, 0x2f, 0x43, 0x26, 0x0c, 0xe6, 0x02,
+    0x57, 0x60, 0x7e, 0x25, 0x87, 0x0c, 0x43, 0xbf, 0x48, 0x6f, 0x1b, 0x36, 0x9f, 0x2b, 0x37, 0x48,
+    0x6c, 0x3f, 0x3c, 0xf7, 0x5b, 0x13, 0x7c, 0x67, 0x53, 0x5b, 0x1f, 0x09,
+};
+
+// XPRESS Huffman - 4kB page of XpressTest_PageText().
+static BYTE XPRESS_HUFF_PAGE[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x60, 0x79, 0x67, 0x89, 0x67, 0x90, 0x77, 0x77, 0x07, 0x76, 0x87, 0x09, 0x80, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x09, 0x98, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x99, 0x90, 0x99, 0x90, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x77, 0x90, 0x09, 0x00, 0x00, 0x00, 0x97, 0x98, 0x66, 0x87, 0x00, 0x99, 0x90, 0x00,
+    0x87, 0x77, 0x66, 0x96, 0x98, 0x89, 0x88, 0x00, 0x88, 0x79, 0x75, 0x75, 0x00, 0x79, 0x86, 0x79,
+    0x00, 0x66, 0x67, 0x67, 0x89, 0x69, 0x67, 0x97, 0x00, 0x09, 0x67, 0x78, 0x77, 0x76, 0x67, 0x78,
+    0x00, 0x80, 0x76, 0x77, 0x78, 0x67, 0x66, 0x76, 0x00, 0x90, 0x78, 0x07, 0x80, 0x66, 0x77, 0x67,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3c, 0x94, 0xa2, 0x51, 0x18, 0x0f, 0x24, 0x61, 0x1e, 0x11, 0xd2, 0x08, 0xc0, 0x64, 0x2c, 0x86,
+    0x51, 0x68, 0x81, 0x06, 0x19, 0x2a, 0x0b, 0x03, 0x04, 0x0a, 0xf6, 0xcf, 0x06, 0x12, 0x1e, 0xda,
+    0xa2, 0x4c, 0x04, 0x37, 0x44, 0x24, 0x49, 0xe0, 0xf7, 0x10, 0x8f, 0x24, 0x58, 0x04, 0x0a, 0x9c,
+    0x8f, 0xf0, 0x88, 0x3c, 0xe1, 0xb1, 0xf9, 0x6d, 0xd6, 0x72, 0x5f, 0x9c, 0x10, 0x51, 0xe0, 0xc3,
+    0x16, 0x41, 0x39, 0x0c, 0x00, 0xa1, 0x42, 0x69, 0x26, 0xf8, 0x58, 0xbc, 0x88, 0x50, 0x73, 0xe1,
+    0xb7, 0xd3, 0x22, 0x61, 0x16, 0x8d, 0xd7, 0x3c, 0x3c, 0x84, 0x37, 0xb0, 0xea, 0x62, 0x8f, 0x35,
+    0xe4, 0x18, 0xdb, 0x4a, 0x49, 0x9f, 0x16, 0x8d, 0x04, 0xa7, 0x43, 0x7c, 0x18, 0x11, 0x66, 0x6e,
+    0x24, 0xf4, 0xe2, 0x2c, 0x48, 0x8b, 0x35, 0xa8, 0x5f, 0x02, 0xf8, 0x9f, 0xa7, 0xc2, 0x47, 0x6f,
+    0x6e, 0x37, 0x82, 0x7f, 0xc6, 0x72, 0x64, 0x01, 0x22, 0xb1, 0xe4, 0x88, 0x1a, 0x0d, 0xc6, 0x78,
+    0x4d, 0x7b, 0x36, 0x51, 0x33, 0x36, 0x01, 0xd4, 0x5e, 0x7e, 0x05, 0x01, 0x53, 0xaa, 0xa7, 0x2a,
+    0xd1, 0x20, 0xf5, 0x00, 0x9b, 0x15, 0xa9, 0x01, 0xd1, 0x30, 0x40, 0x9e, 0x48, 0xbb, 0xa5, 0x86,
+    0x15, 0xb4, 0x7b, 0x35, 0x0d, 0x72, 0xb0, 0xbf, 0x48, 0x20, 0xec, 0x40, 0x4e, 0x85, 0xbe, 0x85,
+    0x68, 0xdb, 0xcf, 0xd6, 0xda, 0x87, 0x8c, 0x5e, 0x07, 0xc8, 0x19, 0x50, 0x80, 0x73, 0x05, 0x40,
+    0xfa, 0x61, 0x57, 0x82, 0xe3, 0x10, 0xa5, 0x7a, 0x63, 0x1a, 0xb4, 0x28, 0x68, 0x4b, 0x8d, 0x78,
+    0x6c, 0x2d, 0x71, 0x5c, 0x00, 0x2a, 0x05, 0x8a, 0xa8, 0x88, 0x22, 0xd8, 0xa9, 0xd7, 0xed, 0x96,
+    0xa6, 0x4b, 0x2f, 0x54, 0xad, 0x07, 0x06, 0xb7, 0x8c, 0x8f, 0x59, 0x68, 0x7c, 0x86, 0x14, 0x71,
+    0x24, 0x13, 0x43, 0xe2, 0x54, 0x15, 0x66, 0xf9, 0xff, 0xee, 0xb7, 0xbe, 0xb3, 0xca, 0x4b, 0xaf,
+    0xf1, 0x54, 0xf4, 0x56, 0xb6, 0x28, 0x60, 0xfd, 0xea, 0x17, 0xf1, 0x84, 0x45, 0x33, 0xfe, 0x5e,
+    0x06, 0xb7, 0xe7, 0x5b, 0xa0, 0x66, 0x09, 0x5a, 0xdd, 0x0a, 0x07, 0x44, 0x97, 0xc2, 0xf6, 0xd0,
+    0xe8, 0x08, 0x36, 0x2d, 0x9a, 0x01, 0x5f, 0x50, 0x8f, 0x41, 0x19, 0x27, 0x30, 0x40, 0x11, 0xe5,
+    0xec, 0x4b, 0x6d, 0x1e, 0x40, 0xe7, 0x24, 0x61, 0x80, 0x83, 0x70, 0x02, 0xcc, 0x3d, 0xb4, 0x95,
+    0x0c, 0x46, 0x8f, 0xc1, 0xe7, 0x6f, 0x81, 0x13, 0x89, 0xf7, 0xb5, 0x1a, 0xb6, 0x84, 0xae, 0x04,
+    0x6e, 0x67, 0x56, 0xb8, 0x57, 0xd1, 0xc6, 0x8d, 0xb2, 0xba, 0x76, 0x65, 0xb8, 0x85, 0x7f, 0x9c,
+    0x29, 0x79, 0x31, 0xb3, 0x2b, 0xd0, 0x5f, 0x52, 0x1b, 0xd6, 0x32, 0x6c, 0xea, 0x8a, 0x89, 0xf7,
+    0x16, 0x1f, 0xb0, 0x8a, 0xda, 0xff, 0xa1, 0x3c, 0x39, 0x26, 0x87, 0x65, 0x90, 0x32, 0xc9, 0x52,
+    0xf3, 0x0c, 0x32, 0x8a, 0x55, 0x07, 0xfa, 0xeb, 0x51, 0x72, 0x9d, 0xe9, 0xc0, 0x4a, 0xfa, 0xb5,
+    0x2d, 0xcd, 0xe1, 0x0b, 0x6e, 0x6a, 0x17, 0x59, 0xcc, 0x1f, 0x99, 0xbe, 0xc1, 0xfb, 0xac, 0x2f,
+    0x78, 0x4d, 0x74, 0xb9, 0xd9, 0xda, 0x72, 0x7a, 0x04, 0xf2, 0x8f, 0xd5, 0x36, 0xa8, 0x4c, 0x67,
+    0x2d, 0x2e, 0x7b, 0x02, 0xb0, 0x39, 0x58, 0xe7, 0x80, 0xef, 0x03, 0x37, 0x4d, 0x85, 0x90, 0xd7,
+    0x66, 0x58, 0xce, 0x42, 0xda, 0x0f, 0x49, 0xc9, 0xbc, 0x52, 0x5c, 0x56, 0xda, 0x24, 0x10, 0x5c,
+    0x67, 0x74, 0xb5, 0xc5, 0x87, 0xb5, 0x79, 0xd0, 0x00, 0x5b, 0x1b, 0x63, 0xea, 0xd0, 0x40, 0x13,
+    0x96, 0x7f, 0xa5, 0x40, 0x15, 0xd7, 0x05, 0xe2, 0xb2, 0x95, 0x37, 0x9e, 0xaf, 0x2a, 0x58, 0xe0,
+    0x27, 0x42, 0x2e, 0x91, 0x2a, 0x0d, 0x4c, 0x1b, 0x75, 0xbd, 0x4b, 0x88, 0xd0, 0x0b, 0x9c, 0xab,
+    0x9b, 0x0b, 0xa4, 0x9d, 0xe5, 0xa7, 0x85, 0xd9, 0x79, 0x74, 0x5d, 0xd5, 0x22, 0xba, 0xce, 0xee,
+    0x53, 0x7b, 0xc4, 0xc7, 0x4a, 0xf4, 0x61, 0x8b, 0xe7, 0xa8, 0xa8, 0x49, 0x69, 0x1c, 0xad, 0xc9,
+    0xe8, 0x4f, 0x2e, 0xb4, 0xec, 0xbf, 0xda, 0x2b, 0x6e, 0x88, 0xf5, 0x11, 0x16, 0x0b, 0x5d, 0xe1,
+    0xa3, 0xd8, 0xc0, 0xb6, 0x52, 0xa3, 0xcd, 0x9e, 0x14, 0xce, 0x80, 0x0f, 0x72, 0x26, 0x9d, 0x70,
+    0x6e, 0xcf, 0xd2, 0x04, 0x7b, 0x16, 0x6c, 0x39, 0x00, 0xec, 0x53, 0x48, 0x17, 0x05, 0x4e, 0x66,
+    0x24, 0x1f, 0xbc, 0xc1, 0x8e, 0x0e, 0x05, 0xe7, 0xde, 0x45, 0x03, 0x0c, 0xc8, 0x37, 0x13, 0x34,
+    0xc8, 0xd6, 0x9a, 0xfe, 0x78, 0x7d, 0xb3, 0x1c, 0x04, 0x0a, 0xaf, 0xef, 0xdd, 0x87, 0x7f, 0xc3,
+    0xb0, 0x3d, 0xf2, 0xa2, 0x8b, 0x8b, 0xed, 0x24, 0x5e, 0x41, 0x85, 0x77, 0xf0, 0x96, 0xfd, 0x0a,
+    0x08, 0xd5, 0x00, 0xf6, 0xd0, 0x53, 0xc2, 0x53, 0x7e, 0x00, 0x5f, 0x36, 0x0e, 0x71, 0xa9, 0xaa,
+    0xce, 0x81, 0xbb, 0x56, 0x72, 0xdc, 0x45, 0x04, 0x2a, 0x92, 0x33, 0x87, 0xba, 0x5b, 0xa8, 0x1e,
+    0x78, 0x2f, 0x59, 0x6f, 0xa8, 0x13, 0xe3, 0xc0, 0x55, 0x2e, 0x69, 0xdd, 0x97, 0x21, 0x5e, 0x47,
+    0xfa, 0x69, 0x5b, 0xd3, 0x06, 0xf8, 0xdd, 0x06, 0xd8, 0x73, 0x71, 0x3e, 0xc6, 0x16, 0xa4, 0x60,
+    0x9f, 0x77, 0xcc, 0x87, 0xe7, 0x0b, 0x04, 0xaf, 0xd1, 0x00, 0x5e, 0xaf, 0x6a, 0xf6, 0xca, 0xc4,
+    0xbc, 0x4a, 0x73, 0xe5, 0xb6, 0x3e, 0x4d, 0x21, 0xe8, 0x75, 0x8c, 0x17, 0xfe, 0xb0, 0xbc, 0x48,
+    0x17, 0x46, 0x66, 0xb7, 0x1f, 0x5d, 0xed, 0x20, 0x04, 0x0e, 0xf1, 0xfe, 0xb7, 0xe1, 0xe9, 0x6d,
+    0xff, 0xb2, 0x7f, 0x20, 0x4f, 0x00, 0x00,
+};
+
+
+
+// ----------------------------------------------------------------------------
+// TEST FUNCTIONALITY BELOW:
+// ----------------------------------------------------------------------------
+
+/*
+* Generate the deterministic 4kB text page compressed in the page test vectors.
+* -- pb
+*/
+VOID XpressTest_PageText(_Out_writes_(0x1000) PBYTE pb)
+{
+    static LPCSTR szWords[16] = {
+        "memory", "process", "kernel", "page", "table", "virtual", "physical", "address",
+        "thread", "handle", "module", "registry", "forensic", "timeline", "cache", "file"
+    };
+    DWORD o = 0, cb, dwSeed = 0x1337;
+    while(o < 0x1000) {
+        dwSeed = dwSeed * 1103515245 + 12345;
+        cb = (DWORD)min(strlen(szWords[(dwSeed >> 16) % 16]), 0x1000 - o);
+        memcpy(pb + o, szWords[(dwSeed >> 16) % 16], cb);
+        o += cb;
+        if(o < 0x1000) {
+            pb[o++] = (dwSeed & 0x700) ? ' ' : '\n';
+        }
+    }
+}
+
+/*
+* Decompress a test vector and compare it with the expected data.
+* -- szName
+* -- wFormat
+* -- pbIn
+* -- cbIn
+* -- pbExpect
+* -- cbExpect
+* -- return
+*/
+BOOL XpressTest_Vector(_In_ LPSTR szName, _In_ USHORT wFormat, _In_reads_(cbIn) PBYTE pbIn, _In_ DWORD cbIn, _In_reads_(cbExpect) PBYTE pbExpect, _In_ DWORD cbExpect)
+{
+    BOOL fResult;
+    NTSTATUS nt;
+    ULONG cbOut = 0;
+    BYTE pbOut[0x1000];
+    nt = OSCOMPAT_RtlDecompressBuffer(wFormat, pbOut, cbExpect, pbIn, cbIn, &cbOut);
+    fResult = !nt && (cbOut == cbExpect) && !memcmp(pbOut, pbExpect, cbExpect);
+    printf("  %-32s %s\n", szName, fResult ? "OK" : "FAIL");
+    return fResult;
+}
+
+/*
+* Verify that invalid input is rejected.
+* -- szName
+* -- wFormat
+* -- pbIn
+* -- cbIn
+* -- cbOut
+* -- return
+*/
+BOOL XpressTest_VectorInvalid(_In_ LPSTR szName, _In_ USHORT wFormat, _In_reads_(cbIn) PBYTE pbIn, _In_ DWORD cbIn, _In_ DWORD cbOut)
+{
+    BOOL fResult;
+    ULONG cbResult = 0;
+    BYTE pbOut[0x1000];
+    fResult = (0 != OSCOMPAT_RtlDecompressBuffer(wFormat, pbOut, cbOut, pbIn, cbIn, &cbResult));
+    printf("  %-32s %s\n", szName, fResult ? "OK" : "FAIL");
+    return fResult;
+}
+
+/*
+* Measure decompression throughput of a 4kB page test vector.
+* -- szName
+* -- wFormat
+* -- pbIn
+* -- cbIn
+*/
+VOID XpressTest_Bench(_In_ LPSTR szName, _In_ USHORT wFormat, _In_reads_(cbIn) PBYTE pbIn, _In_ DWORD cbIn)
+{
+    DWORD i;
+    ULONG cbOut;
+    QWORD tm;
+    struct timespec ts1, ts2;
+    BYTE pbOut[0x1000];
+    clock_gettime(CLOCK_MONOTONIC, &ts1);
+    for(i = 0; i < XPRESS_TEST_BENCH_ITERATIONS; i++) {
+        OSCOMPAT_RtlDecompressBuffer(wFormat, pbOut, sizeof(pbOut), pbIn, cbIn, &cbOut);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts2);
+    tm = max(1, (QWORD)(ts2.tv_sec - ts1.tv_sec) * 1000000 + (ts2.tv_nsec - ts1.tv_nsec) / 1000);
+    printf("  %-32s %8.1f MB/s\n", szName, (double)XPRESS_TEST_BENCH_ITERATIONS * sizeof(pbOut) / tm);
+}
+
+int main(_In_ int argc, _In_ char* argv[])
+{
+    BOOL fResult = TRUE;
+    BYTE pbPage[0x1000], pbAbc[300], pbHuffBad[256 + 4] = { 0 };
+    DWORD i;
+    XpressTest_PageText(pbPage);
+    for(i = 0; i < sizeof(pbAbc); i++) {
+        pbAbc[i] = "abc"[i % 3];
+    }
+    memset(pbHuffBad, 0x11, 256);       // 512 symbols of length 1 - over-subscribed code
+    printf("XPRESS DECODE CHECK:\n");
+    fResult = XpressTest_Vector("lz77 alphabet", XPRESS_TEST_FORMAT_XPRESS, XPRESS_ALPHABET, sizeof(XPRESS_ALPHABET), (PBYTE)"abcdefghijklmnopqrstuvwxyz", 26) && fResult;
+    fResult = XpressTest_Vector("lz77 abc x100", XPRESS_TEST_FORMAT_XPRESS, XPRESS_ABC, sizeof(XPRESS_ABC), pbAbc, sizeof(pbAbc)) && fResult;
+    fResult = XpressTest_Vector("lz77 page", XPRESS_TEST_FORMAT_XPRESS, XPRESS_PAGE, sizeof(XPRESS_PAGE), pbPage, sizeof(pbPage)) && fResult;
+    fResult = XpressTest_Vector("huffman abc x100", XPRESS_TEST_FORMAT_XPRESS_HUFF, XPRESS_HUFF_ABC, sizeof(XPRESS_HUFF_ABC), pbAbc, sizeof(pbAbc)) && fResult;
+    fResult = XpressTest_Vector("huffman page", XPRESS_TEST_FORMAT_XPRESS_HUFF, XPRESS_HUFF_PAGE, sizeof(XPRESS_HUFF_PAGE), pbPage, sizeof(pbPage)) && fResult;
+    fResult = XpressTest_VectorInvalid("lz77 truncated match", XPRESS_TEST_FORMAT_XPRESS, XPRESS_ABC, sizeof(XPRESS_ABC) - 1, sizeof(pbAbc)) && fResult;
+    fResult = XpressTest_VectorInvalid("lz77 output overflow", XPRESS_TEST_FORMAT_XPRESS, XPRESS_ABC, sizeof(XPRESS_ABC), sizeof(pbAbc) - 1) && fResult;
+    fResult = XpressTest_VectorInvalid("huffman over-subscribed table", XPRESS_TEST_FORMAT_XPRESS_HUFF, pbHuffBad, sizeof(pbHuffBad), 0x100) && fResult;
+    if(!fResult) {
+        printf("XPRESS DECODE CHECK: FAIL\n");
+        return 1;
+    }
+    printf("XPRESS DECODE THROUGHPUT (4kB pages):\n");
+    XpressTest_Bench("lz77 page", XPRESS_TEST_FORMAT_XPRESS, XPRESS_PAGE, sizeof(XPRESS_PAGE));
+    XpressTest_Bench("huffman page", XPRESS_TEST_FORMAT_XPRESS_HUFF, XPRESS_HUFF_PAGE, sizeof(XPRESS_HUFF_PAGE));
+    return 0;
+}
+
+#endif /* LINUX */
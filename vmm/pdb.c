@@ -1,6 +1,7 @@
 // pdb.h : implementation related to parsing of program databases (PDB) files
 //         used for debug symbols and automatic retrieval from the Microsoft
-//         Symbol Server. (Windows exclusive functionality).
+//         Symbol Server. On Linux PDBs are parsed natively from the local
+//         symbol cache only.
 //
 // (c) Ulf Frisk, 2019-2022
 // Author: Ulf Frisk, pcileech@frizk.net
@@ -12,6 +13,9 @@
 #include "util.h"
 #include "vmmwindef.h"
 #include "vmmwininit.h"
+#ifdef LINUX
+#include <sys/stat.h>
+#endif /* LINUX */
 
 VOID PDB_PrintError(_In_ LPSTR szErrorMessage)
 {
@@ -82,6 +86,51 @@ BOOL PDB_GetSymbolPTR(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szSymbolName, _In_ PV
     return PDB_GetSymbolPBYTE(hPDB, szSymbolName, pProcess, (PBYTE)pv, (ctxVmm->f32 ? sizeof(DWORD) : sizeof(QWORD)));
 }
 
+QWORD PDB_HashPdb(_In_ LPSTR szPdbName, _In_reads_(16) PBYTE pbPdbGUID, _In_ DWORD dwPdbAge)
+{
+    QWORD qwHash = 0;
+    qwHash = Util_HashStringA(szPdbName);
+    qwHash = dwPdbAge + ((qwHash >> 13) | (qwHash << 51));
+    qwHash = *(PQWORD)pbPdbGUID + ((qwHash >> 13) | (qwHash << 51));
+    qwHash = *(PQWORD)(pbPdbGUID + 8) + ((qwHash >> 13) | (qwHash << 51));
+    return qwHash;
+}
+
+DWORD PDB_HashModuleName(_In_ LPSTR uszModuleName)
+{
+    return CharUtil_HashNameFsU(uszModuleName, 0);
+}
+
+_Success_(return)
+BOOL PDB_Initialize_Async_Kernel_ScanForPdbInfo(_In_ PVMM_PROCESS pSystemProcess, _Out_ PPE_CODEVIEW_INFO pCodeViewInfo)
+{
+    PBYTE pb = NULL;
+    DWORD i, cbRead;
+    PPE_CODEVIEW pPdb;
+    ZeroMemory(pCodeViewInfo, sizeof(PE_CODEVIEW_INFO));
+    if(!ctxVmm->kernel.vaBase) { return FALSE; }
+    if(!(pb = LocalAlloc(0, 0x00800000))) { return FALSE; }
+    VmmReadEx(pSystemProcess, ctxVmm->kernel.vaBase, pb, 0x00800000, &cbRead, VMM_FLAG_ZEROPAD_ON_FAIL);
+    // 1: search for pdb debug information adn extract offset of PsInitialSystemProcess
+    for(i = 0; i < 0x00800000 - sizeof(PE_CODEVIEW); i += 4) {
+        pPdb = (PPE_CODEVIEW)(pb + i);
+        if(pPdb->Signature == 0x53445352) {
+            if(pPdb->Age > 0x20) { continue; }
+            if(memcmp("nt", pPdb->PdbFileName, 2)) { continue; }
+            if(memcmp(".pdb", pPdb->PdbFileName + 8, 5)) { continue; }
+            pCodeViewInfo->SizeCodeView = 4 + 16 + 4 + 12;
+            pCodeViewInfo->CodeView.Signature = pPdb->Signature;
+            memcpy(pCodeViewInfo->CodeView.Guid, pPdb->Guid, 16);
+            pCodeViewInfo->CodeView.Age = pPdb->Age;
+            memcpy(pCodeViewInfo->CodeView.PdbFileName, pPdb->PdbFileName, 12);
+            LocalFree(pb);
+            return TRUE;
+        }
+    }
+    LocalFree(pb);
+    return FALSE;
+}
+
 #ifdef _WIN32
 #include <winreg.h>
 #include <io.h>
@@ -161,21 +210,6 @@ typedef struct tdVMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS {
     PE_CODEVIEW_INFO PdbInfo;
 } VMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS, *PVMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS;
 
-QWORD PDB_HashPdb(_In_ LPSTR szPdbName, _In_reads_(16) PBYTE pbPdbGUID, _In_ DWORD dwPdbAge)
-{
-    QWORD qwHash = 0;
-    qwHash = Util_HashStringA(szPdbName);
-    qwHash = dwPdbAge + ((qwHash >> 13) | (qwHash << 51));
-    qwHash = *(PQWORD)pbPdbGUID + ((qwHash >> 13) | (qwHash << 51));
-    qwHash = *(PQWORD)(pbPdbGUID + 8) + ((qwHash >> 13) | (qwHash << 51));
-    return qwHash;
-}
-
-DWORD PDB_HashModuleName(_In_ LPSTR uszModuleName)
-{
-    return CharUtil_HashNameFsU(uszModuleName, 0);
-}
-
 VOID PDB_CallbackCleanup_ObPdbEntry(PPDB_ENTRY pOb)
 {
     LocalFree(pOb->szModuleName);
@@ -687,36 +721,6 @@ VOID PDB_Close()
 /*
 * 
 */
-_Success_(return)
-BOOL PDB_Initialize_Async_Kernel_ScanForPdbInfo(_In_ PVMM_PROCESS pSystemProcess, _Out_ PPE_CODEVIEW_INFO pCodeViewInfo)
-{
-    PBYTE pb = NULL;
-    DWORD i, cbRead;
-    PPE_CODEVIEW pPdb;
-    ZeroMemory(pCodeViewInfo, sizeof(PE_CODEVIEW_INFO));
-    if(!ctxVmm->kernel.vaBase) { return FALSE; }
-    if(!(pb = LocalAlloc(0, 0x00800000))) { return FALSE; }
-    VmmReadEx(pSystemProcess, ctxVmm->kernel.vaBase, pb, 0x00800000, &cbRead, VMM_FLAG_ZEROPAD_ON_FAIL);
-    // 1: search for pdb debug information adn extract offset of PsInitialSystemProcess
-    for(i = 0; i < 0x00800000 - sizeof(PE_CODEVIEW); i += 4) {
-        pPdb = (PPE_CODEVIEW)(pb + i);
-        if(pPdb->Signature == 0x53445352) {
-            if(pPdb->Age > 0x20) { continue; }
-            if(memcmp("nt", pPdb->PdbFileName, 2)) { continue; }
-            if(memcmp(".pdb", pPdb->PdbFileName + 8, 5)) { continue; }
-            pCodeViewInfo->SizeCodeView = 4 + 16 + 4 + 12;
-            pCodeViewInfo->CodeView.Signature = pPdb->Signature;
-            memcpy(pCodeViewInfo->CodeView.Guid, pPdb->Guid, 16);
-            pCodeViewInfo->CodeView.Age = pPdb->Age;
-            memcpy(pCodeViewInfo->CodeView.PdbFileName, pPdb->PdbFileName, 12);
-            LocalFree(pb);
-            return TRUE;
-        }
-    }
-    LocalFree(pb);
-    return FALSE;
-}
-
 VOID PDB_Initialize_WaitComplete()
 {
     POB_PDB_CONTEXT ctxOb = PDB_GetContext();
@@ -1361,69 +1365,1529 @@ fail:
 #endif /* _WIN32 */
 #ifdef LINUX
 
-#include "pdb.h"
+//-----------------------------------------------------------------------------
+// NATIVE PDB FUNCTIONALITY BELOW (LINUX):
+// dbghelp.dll is not available on Linux. Instead the PDB (MSF 7.00) file is
+// parsed natively. Public/global symbols and struct/class/union types with
+// their members are extracted into a compact index sorted by name which is
+// cached next to the .pdb file as '<name>.pdb.mpfidx'. The index is mmap'ed
+// on subsequent loads and queried with binary searches. PDB files are loaded
+// from the local symbol cache only (no symbol server download on Linux).
+//-----------------------------------------------------------------------------
 
-VOID PDB_Initialize_WaitComplete() { return; }
-VOID PDB_Close() { return; }
-VOID PDB_ConfigChange() { return; }
-PDB_HANDLE PDB_GetHandleFromModuleAddress(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaModuleBase) { return 0; }
-PDB_HANDLE PDB_GetHandleFromModuleName(_In_ LPSTR szModuleName) { return 0; }
-_Success_(return) BOOL PDB_LoadEnsure(_In_opt_ PDB_HANDLE hPDB) { return FALSE; }
-_Success_(return) BOOL PDB_GetModuleInfo(_In_opt_ PDB_HANDLE hPDB, _Out_writes_opt_(MAX_PATH) LPSTR szModuleName, _Out_opt_ PQWORD pvaModuleBase, _Out_opt_ PDWORD pcbModuleSize) { return FALSE; }
-_Success_(return) BOOL PDB_GetSymbolFromOffset(_In_opt_ PDB_HANDLE hPDB, _In_ DWORD dwSymbolOffset, _Out_writes_opt_(MAX_PATH) LPSTR szSymbolName, _Out_opt_ PDWORD pdwSymbolDisplacement) { return FALSE; }
-_Success_(return) BOOL PDB_DisplayTypeNt(_In_ LPSTR szTypeName, _In_ BYTE cLevelMax, _In_opt_ QWORD vaType, _In_ BOOL fHexAscii, _In_ BOOL fObjHeader, _Out_opt_ LPSTR * pszResult, _Out_opt_ PDWORD pcbResult, _Out_opt_ PDWORD pcbType) { return FALSE; }
+#define PDB_MSF_MAGIC                   "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0\0"
+#define PDB_MSF_STREAM_PDB              1
+#define PDB_MSF_STREAM_TPI              2
+#define PDB_MSF_STREAM_DBI              3
+#define PDB_MSF_STREAM_NIL              0xffffffff
 
-VOID PDB_Initialize(_In_opt_ PPE_CODEVIEW_INFO pPdbInfoOpt, _In_ BOOL fInitializeKernelAsync)
+#define PDB_INDEX_MAGIC                 0x78646950      // 'Pidx'
+#define PDB_INDEX_VERSION               1
+#define PDB_INDEX_FILE_SUFFIX           ".mpfidx"
+#define PDB_INDEX_FIELDLIST_MAXHOP      0x40
+
+#define PDB_CV_S_LDATA32                0x110c
+#define PDB_CV_S_GDATA32                0x110d
+#define PDB_CV_S_PUB32                  0x110e
+#define PDB_CV_LF_FIELDLIST             0x1203
+#define PDB_CV_LF_BCLASS                0x1400
+#define PDB_CV_LF_VBCLASS               0x1401
+#define PDB_CV_LF_IVBCLASS              0x1402
+#define PDB_CV_LF_INDEX                 0x1404
+#define PDB_CV_LF_VFUNCTAB              0x1409
+#define PDB_CV_LF_FRIENDCLS             0x140b
+#define PDB_CV_LF_ENUMERATE             0x1502
+#define PDB_CV_LF_CLASS                 0x1504
+#define PDB_CV_LF_STRUCTURE             0x1505
+#define PDB_CV_LF_UNION                 0x1506
+#define PDB_CV_LF_FRIENDFCN             0x150c
+#define PDB_CV_LF_MEMBER                0x150d
+#define PDB_CV_LF_STMEMBER              0x150e
+#define PDB_CV_LF_METHOD                0x150f
+#define PDB_CV_LF_NESTTYPE              0x1510
+#define PDB_CV_LF_ONEMETHOD             0x1511
+#define PDB_CV_LF_INTERFACE             0x1519
+#define PDB_CV_PROP_FWDREF              0x0080
+#define PDB_DBI_MACHINE_I386            0x014c
+
+typedef struct tdPDB_MSF_SUPERBLOCK {
+    CHAR szMagic[32];
+    DWORD cbBlock;
+    DWORD iFreeBlockMap;
+    DWORD cBlocks;
+    DWORD cbDirectory;
+    DWORD _Reserved;
+    DWORD iBlockMap;
+} PDB_MSF_SUPERBLOCK, *PPDB_MSF_SUPERBLOCK;
+
+typedef struct tdPDB_MSF {
+    PBYTE pb;                   // mmap'ed .pdb file
+    QWORD cb;
+    DWORD cbBlock;
+    DWORD cStreams;
+    PDWORD pdwDirectory;        // stream directory (LocalAlloc'ed)
+    PDWORD pcbStream;           // stream sizes (ptr into pdwDirectory)
+    PDWORD *ppiStreamBlock;     // stream block indexes (ptrs into pdwDirectory)
+} PDB_MSF, *PPDB_MSF;
+
+typedef struct tdPDB_DBI_HEADER {
+    DWORD dwVersionSignature;
+    DWORD dwVersionHeader;
+    DWORD dwAge;
+    WORD iGlobalStream;
+    WORD wBuildNumber;
+    WORD iPublicStream;
+    WORD wPdbDllVersion;
+    WORD iSymRecordStream;
+    WORD wPdbDllRbld;
+    DWORD cbModInfo;
+    DWORD cbSectionContribution;
+    DWORD cbSectionMap;
+    DWORD cbSourceInfo;
+    DWORD cbTypeServerMap;
+    DWORD dwMFCTypeServerIndex;
+    DWORD cbOptionalDbgHeader;
+    DWORD cbECSubstream;
+    WORD wFlags;
+    WORD wMachine;
+    DWORD _Padding;
+} PDB_DBI_HEADER, *PPDB_DBI_HEADER;
+
+typedef struct tdPDB_TPI_HEADER {
+    DWORD dwVersion;
+    DWORD cbHeader;
+    DWORD tiBegin;
+    DWORD tiEnd;
+    DWORD cbTypeRecord;
+} PDB_TPI_HEADER, *PPDB_TPI_HEADER;
+
+// on-disk index: header followed by entry arrays and a string table (last).
+typedef struct tdPDB_INDEX_HEADER {
+    DWORD dwMagic;
+    DWORD dwVersion;
+    BYTE pbGUID[16];
+    DWORD dwAge;
+    DWORD cbTotal;
+    DWORD cSymbols;
+    DWORD cTypes;
+    DWORD cChildren;
+    DWORD cbStrings;
+    DWORD oSymbols;             // PDB_INDEX_SYMBOL[cSymbols] sorted by name (case insensitive)
+    DWORD oSymbolsByRva;        // DWORD[cSymbols] symbol indexes sorted by rva
+    DWORD oTypes;               // PDB_INDEX_TYPE[cTypes] sorted by name (case insensitive)
+    DWORD oChildren;            // PDB_INDEX_CHILD[cChildren] per-type ranges sorted by name
+    DWORD oStrings;
+    DWORD _Reserved;
+} PDB_INDEX_HEADER, *PPDB_INDEX_HEADER;
+
+typedef struct tdPDB_INDEX_SYMBOL {
+    DWORD oName;
+    DWORD dwRva;
+} PDB_INDEX_SYMBOL, *PPDB_INDEX_SYMBOL;
+
+typedef struct tdPDB_INDEX_TYPE {
+    DWORD oName;
+    DWORD cbSize;
+    DWORD iChild;
+    DWORD cChild;
+} PDB_INDEX_TYPE, *PPDB_INDEX_TYPE;
+
+typedef struct tdPDB_INDEX_CHILD {
+    DWORD oName;
+    DWORD dwOffset;
+} PDB_INDEX_CHILD, *PPDB_INDEX_CHILD;
+
+typedef struct tdPDB_BUILD_BUFFER {
+    PBYTE pb;
+    DWORD cb;
+    DWORD cbMax;
+} PDB_BUILD_BUFFER, *PPDB_BUILD_BUFFER;
+
+typedef struct tdPDB_BUILD_SORT {
+    LPSTR sz;
+    DWORD i;
+} PDB_BUILD_SORT, *PPDB_BUILD_SORT;
+
+typedef struct tdPDB_ENTRY {
+    OB ObHdr;
+    QWORD qwHash;
+    QWORD vaModuleBase;
+    LPSTR szModuleName;
+    LPSTR szName;
+    BYTE pbGUID[16];
+    DWORD dwAge;
+    DWORD cbModuleSize;
+    // load data below
+    BOOL fLoadFailed;
+    BOOL fIndexMapped;          // pIndex is mmap'ed (otherwise LocalAlloc'ed)
+    LPSTR szPath;
+    QWORD cbIndex;
+    PPDB_INDEX_HEADER pIndex;
+} PDB_ENTRY, *PPDB_ENTRY;
+
+typedef struct tdOB_PDB_CONTEXT {
+    OB ObHdr;
+    BOOL fDisabled;
+    CRITICAL_SECTION Lock;
+    POB_MAP pmPdbByHash;
+    POB_MAP pmPdbByModule;
+} OB_PDB_CONTEXT, *POB_PDB_CONTEXT;
+
+typedef struct tdVMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS {
+    PHANDLE phEventThreadStarted;
+    BOOL fPdbInfo;
+    PE_CODEVIEW_INFO PdbInfo;
+} VMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS, *PVMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS;
+
+VOID PDB_CallbackCleanup_ObPdbEntry(PPDB_ENTRY pOb)
 {
-    PDB_PrintError("Full symbol support only available on Windows.");
-    return;
+    if(pOb->pIndex) {
+        if(pOb->fIndexMapped) {
+            munmap(pOb->pIndex, pOb->cbIndex);
+        } else {
+            LocalFree(pOb->pIndex);
+        }
+    }
+    LocalFree(pOb->szModuleName);
+    LocalFree(pOb->szName);
+    LocalFree(pOb->szPath);
+}
+
+/*
+* Cleanup callback to clean up PDB context.
+*/
+VOID PDB_CallbackCleanup_ObPdbContext(POB_PDB_CONTEXT ctx)
+{
+    Ob_DECREF(ctx->pmPdbByHash);
+    Ob_DECREF(ctx->pmPdbByModule);
+    DeleteCriticalSection(&ctx->Lock);
 }
 
-_Success_(return) BOOL PDB_GetSymbolOffset(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szSymbolName, _Out_ PDWORD pdwSymbolOffset)
-{ 
-    return (hPDB == PDB_HANDLE_KERNEL) && InfoDB_SymbolOffset("nt", szSymbolName, pdwSymbolOffset);
+/*
+* Retrieve the current PDB context
+* CALLER DECREF: return
+* -- return
+*/
+POB_PDB_CONTEXT PDB_GetContext()
+{
+    return Ob_INCREF(ctxVmm->pObPdbContext);
 }
 
-_Success_(return) BOOL PDB_GetTypeSize(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szTypeName, _Out_ PDWORD pdwTypeSize)
+/*
+* Map a file read-only into memory.
+* -- szPath
+* -- ppb = ptr to receive the mapping; unmap with munmap().
+* -- pcb = ptr to receive the size of the mapping.
+* -- return
+*/
+_Success_(return)
+BOOL PDB_Native_FileMap(_In_ LPSTR szPath, _Out_ PBYTE *ppb, _Out_ PQWORD pcb)
 {
-    return (hPDB == PDB_HANDLE_KERNEL) && InfoDB_TypeSize("nt", szTypeName, pdwTypeSize);
+    int fd;
+    struct stat st;
+    PVOID pv = MAP_FAILED;
+    if((fd = open(szPath, O_RDONLY | O_CLOEXEC)) < 0) { return FALSE; }
+    if(!fstat(fd, &st) && (st.st_size > 0) && ((QWORD)st.st_size < 0x80000000)) {
+        pv = mmap(NULL, (SIZE_T)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if(pv == MAP_FAILED) { return FALSE; }
+    *ppb = (PBYTE)pv;
+    *pcb = (QWORD)st.st_size;
+    return TRUE;
 }
 
-_Success_(return) BOOL PDB_GetTypeChildOffset(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szTypeName, _In_ LPSTR uszTypeChildName, _Out_ PDWORD pdwTypeOffset)
+
+
+//-----------------------------------------------------------------------------
+// MSF / CODEVIEW PARSING FUNCTIONALITY BELOW:
+//-----------------------------------------------------------------------------
+
+VOID PDB_Msf_Close(_In_ PPDB_MSF pMsf)
 {
-    return (hPDB == PDB_HANDLE_KERNEL) && InfoDB_TypeChildOffset("nt", szTypeName, uszTypeChildName, pdwTypeOffset);
+    if(pMsf->pb) { munmap(pMsf->pb, pMsf->cb); }
+    LocalFree(pMsf->pdwDirectory);
+    LocalFree(pMsf->ppiStreamBlock);
+    ZeroMemory(pMsf, sizeof(PDB_MSF));
 }
 
-_Success_(return) BOOL PDB_GetSymbolAddress(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szSymbolName, _Out_ PQWORD pvaSymbolAddress)
+/*
+* Open a PDB file and parse its MSF 7.00 superblock and stream directory.
+* -- szPath
+* -- pMsf = the MSF context to initialize; close with PDB_Msf_Close().
+* -- return
+*/
+_Success_(return)
+BOOL PDB_Msf_Open(_In_ LPSTR szPath, _Out_ PPDB_MSF pMsf)
 {
-    DWORD dwSymbolOffset;
-    *pvaSymbolAddress = 0;
-    if((hPDB == PDB_HANDLE_KERNEL) && InfoDB_SymbolOffset("nt", szSymbolName, &dwSymbolOffset)) {
-        *pvaSymbolAddress = ctxVmm->kernel.vaBase + dwSymbolOffset;
-        return TRUE;
+    PPDB_MSF_SUPERBLOCK pSB;
+    PDWORD pdwBlockMap;
+    QWORD oBlockMap;
+    QWORD cStreamBlocks;
+    DWORD i, iDir, cDirBlocks, cdwDirectory;
+    ZeroMemory(pMsf, sizeof(PDB_MSF));
+    if(!PDB_Native_FileMap(szPath, &pMsf->pb, &pMsf->cb)) { return FALSE; }
+    if(pMsf->cb < sizeof(PDB_MSF_SUPERBLOCK)) { goto fail; }
+    pSB = (PPDB_MSF_SUPERBLOCK)pMsf->pb;
+    if(memcmp(pSB->szMagic, PDB_MSF_MAGIC, sizeof(pSB->szMagic))) { goto fail; }
+    if((pSB->cbBlock < 0x200) || (pSB->cbBlock > 0x2000) || (pSB->cbBlock & (pSB->cbBlock - 1))) { goto fail; }
+    if(!pSB->cbDirectory || ((QWORD)pSB->cBlocks * pSB->cbBlock > pMsf->cb)) { goto fail; }
+    pMsf->cbBlock = pSB->cbBlock;
+    // 1: assemble the stream directory from its (non-contiguous) blocks
+    cDirBlocks = (pSB->cbDirectory + pSB->cbBlock - 1) / pSB->cbBlock;
+    oBlockMap = (QWORD)pSB->iBlockMap * pSB->cbBlock;
+    if((pSB->iBlockMap >= pSB->cBlocks) || (cDirBlocks * sizeof(DWORD) > pSB->cbBlock)) { goto fail; }
+    pdwBlockMap = (PDWORD)(pMsf->pb + oBlockMap);
+    if(!(pMsf->pdwDirectory = LocalAlloc(LMEM_ZEROINIT, (SIZE_T)cDirBlocks * pSB->cbBlock))) { goto fail; }
+    for(i = 0; i < cDirBlocks; i++) {
+        if(pdwBlockMap[i] >= pSB->cBlocks) { goto fail; }
+        memcpy((PBYTE)pMsf->pdwDirectory + (QWORD)i * pSB->cbBlock, pMsf->pb + (QWORD)pdwBlockMap[i] * pSB->cbBlock, pSB->cbBlock);
     }
+    // 2: parse the stream directory: [cStreams][cbStream*cStreams][iBlock*...]
+    cdwDirectory = pSB->cbDirectory / sizeof(DWORD);
+    pMsf->cStreams = pMsf->pdwDirectory[0];
+    if(!pMsf->cStreams || (pMsf->cStreams >= cdwDirectory)) { goto fail; }
+    pMsf->pcbStream = pMsf->pdwDirectory + 1;
+    if(!(pMsf->ppiStreamBlock = LocalAlloc(LMEM_ZEROINIT, pMsf->cStreams * sizeof(PDWORD)))) { goto fail; }
+    iDir = 1 + pMsf->cStreams;
+    for(i = 0; i < pMsf->cStreams; i++) {
+        if(pMsf->pcbStream[i] == PDB_MSF_STREAM_NIL) { pMsf->pcbStream[i] = 0; }
+        // stream size must be backed by block indexes in the directory and
+        // by blocks in the file (no DWORD overflow in the block count).
+        cStreamBlocks = ((QWORD)pMsf->pcbStream[i] + pSB->cbBlock - 1) / pSB->cbBlock;
+        if((cStreamBlocks > pSB->cBlocks) || ((QWORD)iDir + cStreamBlocks > cdwDirectory)) { goto fail; }
+        pMsf->ppiStreamBlock[i] = pMsf->pdwDirectory + iDir;
+        iDir += (DWORD)cStreamBlocks;
+    }
+    return TRUE;
+fail:
+    PDB_Msf_Close(pMsf);
     return FALSE;
 }
-_Success_(return) BOOL PDB_GetSymbolPBYTE(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szSymbolName, _In_ PVMM_PROCESS pProcess, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb)
+
+/*
+* Read a whole MSF stream into a contiguous buffer. The buffer is zero-padded
+* with a few bytes at its end to simplify parsing of trailing strings.
+* CALLER LocalFree: return
+* -- pMsf
+* -- iStream
+* -- pcbStream
+* -- return
+*/
+_Success_(return != NULL)
+PBYTE PDB_Msf_StreamRead(_In_ PPDB_MSF pMsf, _In_ DWORD iStream, _Out_ PDWORD pcbStream)
 {
-    QWORD vaSymbolAddress = 0;
-    return PDB_GetSymbolAddress(hPDB, szSymbolName, &vaSymbolAddress) && VmmRead(pProcess, vaSymbolAddress, pb, cb);
+    PBYTE pb;
+    DWORD i, iBlock, cb, cbStream, cBlocks;
+    *pcbStream = 0;
+    if(iStream >= pMsf->cStreams) { return NULL; }
+    cbStream = pMsf->pcbStream[iStream];
+    cBlocks = (cbStream + pMsf->cbBlock - 1) / pMsf->cbBlock;
+    if(!(pb = LocalAlloc(LMEM_ZEROINIT, (SIZE_T)cbStream + 8))) { return NULL; }
+    for(i = 0; i < cBlocks; i++) {
+        iBlock = pMsf->ppiStreamBlock[iStream][i];
+        if(((QWORD)iBlock + 1) * pMsf->cbBlock > pMsf->cb) {
+            LocalFree(pb);
+            return NULL;
+        }
+        cb = min(pMsf->cbBlock, cbStream - i * pMsf->cbBlock);
+        memcpy(pb + (QWORD)i * pMsf->cbBlock, pMsf->pb + (QWORD)iBlock * pMsf->cbBlock, cb);
+    }
+    *pcbStream = cbStream;
+    return pb;
 }
 
-_Success_(return) BOOL PDB_GetTypeSizeShort(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szTypeName, _Out_ PWORD pwTypeSize)
+/*
+* Read a CodeView numeric leaf.
+* -- pb
+* -- cb
+* -- po = offset in pb, updated on success.
+* -- pqwValue
+* -- return
+*/
+_Success_(return)
+BOOL PDB_Cv_ReadNumeric(_In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Inout_ PDWORD po, _Out_ PQWORD pqwValue)
 {
-    DWORD dwTypeSize = 0;
-    if(!PDB_GetTypeSize(hPDB, szTypeName, &dwTypeSize)) { return FALSE; }
-    *pwTypeSize = (WORD)dwTypeSize;
+    WORD wLeaf;
+    DWORD o = *po, cbValue;
+    if(o + 2 > cb) { return FALSE; }
+    wLeaf = *(PWORD)(pb + o);
+    o += 2;
+    if(wLeaf < 0x8000) {
+        *pqwValue = wLeaf;
+        *po = o;
+        return TRUE;
+    }
+    switch(wLeaf) {
+        case 0x8000: cbValue = 1; break;    // LF_CHAR
+        case 0x8001:                        // LF_SHORT
+        case 0x8002: cbValue = 2; break;    // LF_USHORT
+        case 0x8003:                        // LF_LONG
+        case 0x8004: cbValue = 4; break;    // LF_ULONG
+        case 0x8009:                        // LF_QUADWORD
+        case 0x800a: cbValue = 8; break;    // LF_UQUADWORD
+        default: return FALSE;
+    }
+    if(o + cbValue > cb) { return FALSE; }
+    *pqwValue = 0;
+    memcpy(pqwValue, pb + o, cbValue);
+    *po = o + cbValue;
     return TRUE;
 }
 
-_Success_(return) BOOL PDB_GetTypeChildOffsetShort(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szTypeName, _In_ LPSTR uszTypeChildName, _Out_ PWORD pwTypeOffset)
+/*
+* Skip a null-terminated CodeView name.
+* -- return = the name on success; NULL on fail.
+*/
+LPSTR PDB_Cv_ReadName(_In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Inout_ PDWORD po)
 {
-    DWORD dwTypeOffset = 0;
-    if(!PDB_GetTypeChildOffset(hPDB, szTypeName, uszTypeChildName, &dwTypeOffset)) { return FALSE; }
-    *pwTypeOffset = (WORD)dwTypeOffset;
-    return TRUE;
+    LPSTR sz;
+    SIZE_T cch;
+    if(*po >= cb) { return NULL; }
+    sz = (LPSTR)(pb + *po);
+    cch = strnlen(sz, cb - *po);
+    if(*po + cch >= cb) { return NULL; }
+    *po += (DWORD)cch + 1;
+    return sz;
+}
+
+
+
+//-----------------------------------------------------------------------------
+// PDB INDEX BUILD FUNCTIONALITY BELOW:
+//-----------------------------------------------------------------------------
+
+/*
+* Append data to a growable build buffer.
+* -- pBuf
+* -- pv
+* -- cb
+* -- return = offset of the appended data in the buffer; or (DWORD)-1 on fail.
+*/
+DWORD PDB_Build_Append(_In_ PPDB_BUILD_BUFFER pBuf, _In_reads_(cb) PVOID pv, _In_ DWORD cb)
+{
+    PBYTE pbNew;
+    DWORD o, cbMaxNew;
+    if((QWORD)pBuf->cb + cb > 0x40000000) { return (DWORD)-1; }
+    if(pBuf->cb + cb > pBuf->cbMax) {
+        cbMaxNew = max(0x00010000, max(pBuf->cbMax * 2, pBuf->cb + cb));
+        if(!(pbNew = LocalAlloc(0, cbMaxNew))) { return (DWORD)-1; }
+        if(pBuf->pb) {
+            memcpy(pbNew, pBuf->pb, pBuf->cb);
+            LocalFree(pBuf->pb);
+        }
+        pBuf->pb = pbNew;
+        pBuf->cbMax = cbMaxNew;
+    }
+    o = pBuf->cb;
+    memcpy(pBuf->pb + o, pv, cb);
+    pBuf->cb += cb;
+    return o;
+}
+
+/*
+* Append a string (of cch chars) and its null terminator to the string table.
+* -- return = offset of the string; or (DWORD)-1 on fail.
+*/
+DWORD PDB_Build_AppendString(_In_ PPDB_BUILD_BUFFER pBufStr, _In_reads_(cch) LPSTR sz, _In_ DWORD cch)
+{
+    DWORD o;
+    if((DWORD)-1 == (o = PDB_Build_Append(pBufStr, sz, cch))) { return (DWORD)-1; }
+    if((DWORD)-1 == PDB_Build_Append(pBufStr, "", 1)) { return (DWORD)-1; }
+    return o;
+}
+
+int PDB_Build_SortCmpI(PPDB_BUILD_SORT p1, PPDB_BUILD_SORT p2)
+{
+    int i = _stricmp(p1->sz, p2->sz);
+    return i ? i : ((p1->i < p2->i) ? -1 : 1);
+}
+
+int PDB_Build_SortCmp(PPDB_BUILD_SORT p1, PPDB_BUILD_SORT p2)
+{
+    int i = strcmp(p1->sz, p2->sz);
+    return i ? i : ((p1->i < p2->i) ? -1 : 1);
+}
+
+/*
+* Sort index entries (whose first DWORD is a string table offset) by name.
+* Entries with equal names keep their original relative order.
+* -- pbStrings
+* -- pvEntries
+* -- cEntries
+* -- cbEntry
+* -- fCaseSensitive
+* -- return
+*/
+_Success_(return)
+BOOL PDB_Build_SortByName(_In_ PBYTE pbStrings, _Inout_ PBYTE pvEntries, _In_ DWORD cEntries, _In_ DWORD cbEntry, _In_ BOOL fCaseSensitive)
+{
+    DWORD i;
+    BOOL fResult = FALSE;
+    PBYTE pbCopy = NULL;
+    PPDB_BUILD_SORT pSort = NULL;
+    if(cEntries < 2) { return TRUE; }
+    if(!(pSort = LocalAlloc(0, cEntries * sizeof(PDB_BUILD_SORT)))) { goto fail; }
+    if(!(pbCopy = LocalAlloc(0, (SIZE_T)cEntries * cbEntry))) { goto fail; }
+    memcpy(pbCopy, pvEntries, (SIZE_T)cEntries * cbEntry);
+    for(i = 0; i < cEntries; i++) {
+        pSort[i].sz = (LPSTR)(pbStrings + *(PDWORD)(pbCopy + (QWORD)i * cbEntry));
+        pSort[i].i = i;
+    }
+    qsort(pSort, cEntries, sizeof(PDB_BUILD_SORT), (int(*)(const void *, const void *))(fCaseSensitive ? PDB_Build_SortCmp : PDB_Build_SortCmpI));
+    for(i = 0; i < cEntries; i++) {
+        memcpy(pvEntries + (QWORD)i * cbEntry, pbCopy + (QWORD)pSort[i].i * cbEntry, cbEntry);
+    }
+    fResult = TRUE;
+fail:
+    LocalFree(pbCopy);
+    LocalFree(pSort);
+    return fResult;
+}
+
+/*
+* Add a symbol to the build. 32-bit C-decorated public names (_name, _name@N,
+* @name@N) are undecorated to match the dbghelp SYMOPT_UNDNAME behavior.
+*/
+VOID PDB_Build_AddSymbol(_In_ PPDB_BUILD_BUFFER pBufSym, _In_ PPDB_BUILD_BUFFER pBufStr, _In_ LPSTR szName, _In_ DWORD dwRva, _In_ BOOL fUndecorate)
+{
+    PDB_INDEX_SYMBOL e;
+    DWORD i, cch = (DWORD)strlen(szName);
+    if(!cch) { return; }
+    if(fUndecorate && ((szName[0] == '_') || (szName[0] == '@')) && (cch > 1)) {
+        for(i = cch - 1; (i > 1) && (szName[i] >= '0') && (szName[i] <= '9'); i--);
+        if((i > 1) && (i < cch - 1) && (szName[i] == '@')) { cch = i; }
+        szName++;
+        cch--;
+    }
+    if((DWORD)-1 == (e.oName = PDB_Build_AppendString(pBufStr, szName, cch))) { return; }
+    e.dwRva = dwRva;
+    PDB_Build_Append(pBufSym, &e, sizeof(PDB_INDEX_SYMBOL));
+}
+
+/*
+* Parse the DBI stream, the section headers and the symbol record stream and
+* add public and global data symbols (as rva) to the build.
+* -- return
+*/
+_Success_(return)
+BOOL PDB_Build_Symbols(_In_ PPDB_MSF pMsf, _In_ PPDB_BUILD_BUFFER pBufSym, _In_ PPDB_BUILD_BUFFER pBufStr)
+{
+    BOOL fResult = FALSE, fUndecorate;
+    PPDB_DBI_HEADER pDbi;
+    PIMAGE_SECTION_HEADER pSections;
+    PBYTE pbDbi = NULL, pbSec = NULL, pbSym = NULL;
+    DWORD o, oName, cbDbi, cbSec, cbSym, cSections, iSectionStream;
+    WORD cbRecord, wKind, iSegment;
+    QWORD oDbgHeader;
+    LPSTR szName;
+    // 1: DBI stream -> symbol record stream and section header stream
+    if(!(pbDbi = PDB_Msf_StreamRead(pMsf, PDB_MSF_STREAM_DBI, &cbDbi)) || (cbDbi < sizeof(PDB_DBI_HEADER))) { goto fail; }
+    pDbi = (PPDB_DBI_HEADER)pbDbi;
+    if(pDbi->dwVersionSignature != 0xffffffff) { goto fail; }
+    oDbgHeader = sizeof(PDB_DBI_HEADER) + (QWORD)pDbi->cbModInfo + pDbi->cbSectionContribution + pDbi->cbSectionMap + pDbi->cbSourceInfo + pDbi->cbTypeServerMap + pDbi->cbECSubstream;
+    if((pDbi->cbOptionalDbgHeader < 6 * sizeof(WORD)) || (oDbgHeader + 6 * sizeof(WORD) > cbDbi)) { goto fail; }
+    iSectionStream = *(PWORD)(pbDbi + oDbgHeader + 5 * sizeof(WORD));
+    fUndecorate = (pDbi->wMachine == PDB_DBI_MACHINE_I386);
+    if(!(pbSec = PDB_Msf_StreamRead(pMsf, iSectionStream, &cbSec))) { goto fail; }
+    pSections = (PIMAGE_SECTION_HEADER)pbSec;
+    cSections = cbSec / sizeof(IMAGE_SECTION_HEADER);
+    if(!(pbSym = PDB_Msf_StreamRead(pMsf, pDbi->iSymRecordStream, &cbSym))) { goto fail; }
+    // 2: walk symbol records: [WORD cbRecord][WORD wKind][...]
+    for(o = 0; o + 4 <= cbSym; o += 2 + cbRecord) {
+        cbRecord = *(PWORD)(pbSym + o);
+        wKind = *(PWORD)(pbSym + o + 2);
+        if((cbRecord < 2) || (o + 2 + cbRecord > cbSym)) { break; }
+        if((wKind != PDB_CV_S_PUB32) && (wKind != PDB_CV_S_GDATA32) && (wKind != PDB_CV_S_LDATA32)) { continue; }
+        // S_PUB32: [flags][offset][segment][name], S_xDATA32: [type][offset][segment][name]
+        if(cbRecord < 2 + 4 + 4 + 2 + 1) { continue; }
+        iSegment = *(PWORD)(pbSym + o + 12);
+        if(!iSegment || (iSegment > cSections)) { continue; }
+        oName = o + 14;
+        if(!(szName = PDB_Cv_ReadName(pbSym, o + 2 + cbRecord, &oName))) { continue; }
+        PDB_Build_AddSymbol(pBufSym, pBufStr, szName, pSections[iSegment - 1].VirtualAddress + *(PDWORD)(pbSym + o + 8), fUndecorate && (wKind == PDB_CV_S_PUB32));
+    }
+    fResult = TRUE;
+fail:
+    LocalFree(pbDbi);
+    LocalFree(pbSec);
+    LocalFree(pbSym);
+    return fResult;
+}
+
+/*
+* Add the data members of a LF_FIELDLIST (following LF_INDEX continuations)
+* to the build. Parsing stops at the first unknown sub-leaf.
+*/
+VOID PDB_Build_FieldList(_In_ PBYTE pbTpi, _In_ DWORD cbTpi, _In_ PPDB_TPI_HEADER pTpi, _In_ PDWORD poRecord, _In_ DWORD tiFieldList, _In_ PPDB_BUILD_BUFFER pBufChild, _In_ PPDB_BUILD_BUFFER pBufStr)
+{
+    PDB_INDEX_CHILD e;
+    QWORD qwValue;
+    LPSTR szName;
+    WORD wLeaf, wAttr;
+    DWORD o, oEnd, cHop;
+    for(cHop = 0; cHop < PDB_INDEX_FIELDLIST_MAXHOP; cHop++) {
+        if((tiFieldList < pTpi->tiBegin) || (tiFieldList >= pTpi->tiEnd)) { return; }
+        o = poRecord[tiFieldList - pTpi->tiBegin];
+        if(!o || (*(PWORD)(pbTpi + o + 2) != PDB_CV_LF_FIELDLIST)) { return; }
+        oEnd = o + 2 + *(PWORD)(pbTpi + o);
+        o += 4;
+        tiFieldList = 0;
+        while(o + 2 <= oEnd) {
+            if(pbTpi[o] >= 0xf0) {
+                // LF_PAD
+                o += max(1, pbTpi[o] & 0x0f);
+                continue;
+            }
+            wLeaf = *(PWORD)(pbTpi + o);
+            o += 2;
+            switch(wLeaf) {
+                case PDB_CV_LF_MEMBER:
+                    o += 2 + 4;
+                    if(!PDB_Cv_ReadNumeric(pbTpi, oEnd, &o, &qwValue)) { return; }
+                    if(!(szName = PDB_Cv_ReadName(pbTpi, oEnd, &o))) { return; }
+                    if(!szName[0]) { break; }
+                    if((DWORD)-1 == (e.oName = PDB_Build_AppendString(pBufStr, szName, (DWORD)strlen(szName)))) { return; }
+                    e.dwOffset = (DWORD)qwValue;
+                    PDB_Build_Append(pBufChild, &e, sizeof(PDB_INDEX_CHILD));
+                    break;
+                case PDB_CV_LF_STMEMBER:
+                case PDB_CV_LF_NESTTYPE:
+                case PDB_CV_LF_FRIENDFCN:
+                    o += 2 + 4;
+                    if(!PDB_Cv_ReadName(pbTpi, oEnd, &o)) { return; }
+                    break;
+                case PDB_CV_LF_METHOD:
+                    o += 2 + 4;
+                    if(!PDB_Cv_ReadName(pbTpi, oEnd, &o)) { return; }
+                    break;
+                case PDB_CV_LF_ONEMETHOD:
+                    if(o + 6 > oEnd) { return; }
+                    wAttr = *(PWORD)(pbTpi + o);
+                    o += 2 + 4;
+                    if((((wAttr >> 2) & 7) == 4) || (((wAttr >> 2) & 7) == 6)) { o += 4; }  // introducing virtual -> vbaseoff
+                    if(!PDB_Cv_ReadName(pbTpi, oEnd, &o)) { return; }
+                    break;
+                case PDB_CV_LF_BCLASS:
+                    o += 2 + 4;
+                    if(!PDB_Cv_ReadNumeric(pbTpi, oEnd, &o, &qwValue)) { return; }
+                    break;
+                case PDB_CV_LF_VBCLASS:
+                case PDB_CV_LF_IVBCLASS:
+                    o += 2 + 4 + 4;
+                    if(!PDB_Cv_ReadNumeric(pbTpi, oEnd, &o, &qwValue)) { return; }
+                    if(!PDB_Cv_ReadNumeric(pbTpi, oEnd, &o, &qwValue)) { return; }
+                    break;
+                case PDB_CV_LF_ENUMERATE:
+                    o += 2;
+                    if(!PDB_Cv_ReadNumeric(pbTpi, oEnd, &o, &qwValue)) { return; }
+                    if(!PDB_Cv_ReadName(pbTpi, oEnd, &o)) { return; }
+                    break;
+                case PDB_CV_LF_VFUNCTAB:
+                case PDB_CV_LF_FRIENDCLS:
+                    o += 2 + 4;
+                    break;
+                case PDB_CV_LF_INDEX:
+                    if(o + 6 > oEnd) { return; }
+                    tiFieldList = *(PDWORD)(pbTpi + o + 2);
+                    o = oEnd;
+                    break;
+                default:
+                    return;
+            }
+        }
+        if(!tiFieldList) { return; }
+    }
+}
+
+/*
+* Parse the TPI stream and add all non-forward struct/class/union types with
+* their data members to the build.
+* -- return
+*/
+_Success_(return)
+BOOL PDB_Build_Types(_In_ PPDB_MSF pMsf, _In_ PPDB_BUILD_BUFFER pBufType, _In_ PPDB_BUILD_BUFFER pBufChild, _In_ PPDB_BUILD_BUFFER pBufStr)
+{
+    BOOL fResult = FALSE;
+    PPDB_TPI_HEADER pTpi;
+    PDB_INDEX_TYPE e;
+    PBYTE pbTpi = NULL;
+    PDWORD poRecord = NULL;
+    QWORD qwSize;
+    LPSTR szName;
+    WORD cbRecord, wKind, wProperty;
+    DWORD o, oLeaf, oEnd, cbTpi, cTypes, iType, tiFieldList;
+    if(!(pbTpi = PDB_Msf_StreamRead(pMsf, PDB_MSF_STREAM_TPI, &cbTpi)) || (cbTpi < sizeof(PDB_TPI_HEADER))) { goto fail; }
+    pTpi = (PPDB_TPI_HEADER)pbTpi;
+    if((pTpi->cbHeader < sizeof(PDB_TPI_HEADER)) || (pTpi->cbHeader > cbTpi) || (pTpi->tiBegin > pTpi->tiEnd) || (pTpi->tiEnd - pTpi->tiBegin > 0x01000000)) { goto fail; }
+    cTypes = pTpi->tiEnd - pTpi->tiBegin;
+    if(!(poRecord = LocalAlloc(LMEM_ZEROINIT, (cTypes + 1) * sizeof(DWORD)))) { goto fail; }
+    // 1: record offset table indexed by type index: [WORD cbRecord][WORD wKind][...]
+    for(o = pTpi->cbHeader, iType = 0; (iType < cTypes) && (o + 4 <= cbTpi); iType++, o += 2 + cbRecord) {
+        cbRecord = *(PWORD)(pbTpi + o);
+        if((cbRecord < 2) || (o + 2 + cbRecord > cbTpi)) { break; }
+        poRecord[iType] = o;
+    }
+    // 2: struct/class/union types
+    for(iType = 0; iType < cTypes; iType++) {
+        if(!(o = poRecord[iType])) { break; }
+        oEnd = o + 2 + *(PWORD)(pbTpi + o);
+        wKind = *(PWORD)(pbTpi + o + 2);
+        oLeaf = o + 4;
+        switch(wKind) {
+            case PDB_CV_LF_CLASS:
+            case PDB_CV_LF_STRUCTURE:
+            case PDB_CV_LF_INTERFACE:
+                // [count][property][fieldlist][derived][vshape][size][name]
+                if(oLeaf + 16 > oEnd) { continue; }
+                wProperty = *(PWORD)(pbTpi + oLeaf + 2);
+                tiFieldList = *(PDWORD)(pbTpi + oLeaf + 4);
+                oLeaf += 16;
+                break;
+            case PDB_CV_LF_UNION:
+                // [count][property][fieldlist][size][name]
+                if(oLeaf + 8 > oEnd) { continue; }
+                wProperty = *(PWORD)(pbTpi + oLeaf + 2);
+                tiFieldList = *(PDWORD)(pbTpi + oLeaf + 4);
+                oLeaf += 8;
+                break;
+            default:
+                continue;
+        }
+        if(wProperty & PDB_CV_PROP_FWDREF) { continue; }
+        if(!PDB_Cv_ReadNumeric(pbTpi, oEnd, &oLeaf, &qwSize) || !qwSize || (qwSize > 0xffffffff)) { continue; }
+        if(!(szName = PDB_Cv_ReadName(pbTpi, oEnd, &oLeaf)) || !szName[0]) { continue; }
+        if((DWORD)-1 == (e.oName = PDB_Build_AppendString(pBufStr, szName, (DWORD)strlen(szName)))) { goto fail; }
+        e.cbSize = (DWORD)qwSize;
+        e.iChild = pBufChild->cb / sizeof(PDB_INDEX_CHILD);
+        PDB_Build_FieldList(pbTpi, cbTpi, pTpi, poRecord, tiFieldList, pBufChild, pBufStr);
+        e.cChild = pBufChild->cb / sizeof(PDB_INDEX_CHILD) - e.iChild;
+        if((DWORD)-1 == PDB_Build_Append(pBufType, &e, sizeof(PDB_INDEX_TYPE))) { goto fail; }
+    }
+    fResult = TRUE;
+fail:
+    LocalFree(poRecord);
+    LocalFree(pbTpi);
+    return fResult;
+}
+
+/*
+* Build a sorted symbol/type index from a PDB file.
+* CALLER LocalFree: return
+* -- pPdbEntry
+* -- szPdbPath
+* -- pcbIndex
+* -- return
+*/
+_Success_(return != NULL)
+PPDB_INDEX_HEADER PDB_Build(_In_ PPDB_ENTRY pPdbEntry, _In_ LPSTR szPdbPath, _Out_ PDWORD pcbIndex)
+{
+    PDB_MSF Msf = { 0 };
+    PBYTE pbPdbInfo = NULL;
+    PDWORD pdwByRva;
+    PQWORD pqwSortRva = NULL;
+    PPDB_INDEX_HEADER pIdx = NULL;
+    PPDB_INDEX_SYMBOL pSymbols;
+    PPDB_INDEX_TYPE pTypes;
+    PDB_BUILD_BUFFER BufSym = { 0 }, BufType = { 0 }, BufChild = { 0 }, BufStr = { 0 };
+    DWORD i, cbPdbInfo, cSymbols, cTypes, cChildren, cbIndex;
+    *pcbIndex = 0;
+    if(!PDB_Msf_Open(szPdbPath, &Msf)) {
+        VmmLog(MID_PDB, LOGLEVEL_DEBUG, "Failed parsing MSF: '%s'", szPdbPath);
+        goto fail;
+    }
+    // 1: verify guid in the pdb info stream: [version][signature][age][guid]
+    if(!(pbPdbInfo = PDB_Msf_StreamRead(&Msf, PDB_MSF_STREAM_PDB, &cbPdbInfo)) || (cbPdbInfo < 28) || memcmp(pbPdbInfo + 12, pPdbEntry->pbGUID, 16)) {
+        VmmLog(MID_PDB, LOGLEVEL_DEBUG, "PDB GUID mismatch: '%s'", szPdbPath);
+        goto fail;
+    }
+    // 2: parse symbols and types (a pdb without symbol records may still hold useful types)
+    PDB_Build_AppendString(&BufStr, "", 0);
+    if(!PDB_Build_Symbols(&Msf, &BufSym, &BufStr)) {
+        VmmLog(MID_PDB, LOGLEVEL_DEBUG, "No symbols parsed: '%s'", szPdbPath);
+    }
+    if(!PDB_Build_Types(&Msf, &BufType, &BufChild, &BufStr) || !BufStr.pb) { goto fail; }
+    cSymbols = BufSym.cb / sizeof(PDB_INDEX_SYMBOL);
+    cTypes = BufType.cb / sizeof(PDB_INDEX_TYPE);
+    cChildren = BufChild.cb / sizeof(PDB_INDEX_CHILD);
+    // 3: assemble the index: [header][symbols][symbols-by-rva][types][children][strings]
+    cbIndex = sizeof(PDB_INDEX_HEADER) + cSymbols * (sizeof(PDB_INDEX_SYMBOL) + sizeof(DWORD)) + BufType.cb + BufChild.cb + BufStr.cb;
+    if(!(pIdx = LocalAlloc(LMEM_ZEROINIT, cbIndex))) { goto fail; }
+    pIdx->dwMagic = PDB_INDEX_MAGIC;
+    pIdx->dwVersion = PDB_INDEX_VERSION;
+    memcpy(pIdx->pbGUID, pPdbEntry->pbGUID, 16);
+    pIdx->dwAge = pPdbEntry->dwAge;
+    pIdx->cbTotal = cbIndex;
+    pIdx->cSymbols = cSymbols;
+    pIdx->cTypes = cTypes;
+    pIdx->cChildren = cChildren;
+    pIdx->cbStrings = BufStr.cb;
+    pIdx->oSymbols = sizeof(PDB_INDEX_HEADER);
+    pIdx->oSymbolsByRva = pIdx->oSymbols + cSymbols * sizeof(PDB_INDEX_SYMBOL);
+    pIdx->oTypes = pIdx->oSymbolsByRva + cSymbols * sizeof(DWORD);
+    pIdx->oChildren = pIdx->oTypes + BufType.cb;
+    pIdx->oStrings = pIdx->oChildren + BufChild.cb;
+    pSymbols = (PPDB_INDEX_SYMBOL)((PBYTE)pIdx + pIdx->oSymbols);
+    pdwByRva = (PDWORD)((PBYTE)pIdx + pIdx->oSymbolsByRva);
+    pTypes = (PPDB_INDEX_TYPE)((PBYTE)pIdx + pIdx->oTypes);
+    memcpy(pSymbols, BufSym.pb, BufSym.cb);
+    memcpy(pTypes, BufType.pb, BufType.cb);
+    memcpy((PBYTE)pIdx + pIdx->oChildren, BufChild.pb, BufChild.cb);
+    memcpy((PBYTE)pIdx + pIdx->oStrings, BufStr.pb, BufStr.cb);
+    // 4: sort
+    if(!PDB_Build_SortByName(BufStr.pb, (PBYTE)pSymbols, cSymbols, sizeof(PDB_INDEX_SYMBOL), FALSE)) { goto fail; }
+    if(!PDB_Build_SortByName(BufStr.pb, (PBYTE)pTypes, cTypes, sizeof(PDB_INDEX_TYPE), FALSE)) { goto fail; }
+    for(i = 0; i < cTypes; i++) {
+        if(!PDB_Build_SortByName(BufStr.pb, (PBYTE)pIdx + pIdx->oChildren + pTypes[i].iChild * sizeof(PDB_INDEX_CHILD), pTypes[i].cChild, sizeof(PDB_INDEX_CHILD), TRUE)) { goto fail; }
+    }
+    if(cSymbols) {
+        if(!(pqwSortRva = LocalAlloc(0, cSymbols * sizeof(QWORD)))) { goto fail; }
+        for(i = 0; i < cSymbols; i++) {
+            pqwSortRva[i] = ((QWORD)pSymbols[i].dwRva << 32) | i;
+        }
+        qsort(pqwSortRva, cSymbols, sizeof(QWORD), Util_qsort_QWORD);
+        for(i = 0; i < cSymbols; i++) {
+            pdwByRva[i] = (DWORD)pqwSortRva[i];
+        }
+    }
+    VmmLog(MID_PDB, LOGLEVEL_DEBUG, "Index built: '%s' symbols=%i types=%i members=%i", szPdbPath, cSymbols, cTypes, cChildren);
+    *pcbIndex = cbIndex;
+fail:
+    if(!*pcbIndex) {
+        LocalFree(pIdx);
+        pIdx = NULL;
+    }
+    PDB_Msf_Close(&Msf);
+    LocalFree(pbPdbInfo);
+    LocalFree(pqwSortRva);
+    LocalFree(BufSym.pb);
+    LocalFree(BufType.pb);
+    LocalFree(BufChild.pb);
+    LocalFree(BufStr.pb);
+    return pIdx;
+}
+
+
+
+//-----------------------------------------------------------------------------
+// PDB INDEX LOAD/QUERY FUNCTIONALITY BELOW:
+//-----------------------------------------------------------------------------
+
+#define PDB_INDEX_SYMBOLS(pIdx)         ((PPDB_INDEX_SYMBOL)((PBYTE)(pIdx) + (pIdx)->oSymbols))
+#define PDB_INDEX_SYMBOLSBYRVA(pIdx)    ((PDWORD)((PBYTE)(pIdx) + (pIdx)->oSymbolsByRva))
+#define PDB_INDEX_TYPES(pIdx)           ((PPDB_INDEX_TYPE)((PBYTE)(pIdx) + (pIdx)->oTypes))
+#define PDB_INDEX_CHILDREN(pIdx)        ((PPDB_INDEX_CHILD)((PBYTE)(pIdx) + (pIdx)->oChildren))
+#define PDB_INDEX_STRING(pIdx, oName)   ((LPSTR)((PBYTE)(pIdx) + (pIdx)->oStrings + (oName)))
+
+/*
+* Verify an index (loaded from disk or freshly built) against the PDB entry.
+* All offsets are validated once so that queries may run without checks.
+* -- pIdx
+* -- cbIdx
+* -- pPdbEntry
+* -- return
+*/
+_Success_(return)
+BOOL PDB_Index_Verify(_In_ PPDB_INDEX_HEADER pIdx, _In_ QWORD cbIdx, _In_ PPDB_ENTRY pPdbEntry)
+{
+    DWORD i;
+    PDWORD pdwByRva;
+    PPDB_INDEX_SYMBOL pSymbols;
+    PPDB_INDEX_TYPE pTypes;
+    PPDB_INDEX_CHILD pChildren;
+    if(cbIdx < sizeof(PDB_INDEX_HEADER)) { return FALSE; }
+    if((pIdx->dwMagic != PDB_INDEX_MAGIC) || (pIdx->dwVersion != PDB_INDEX_VERSION) || (pIdx->cbTotal != cbIdx)) { return FALSE; }
+    if(memcmp(pIdx->pbGUID, pPdbEntry->pbGUID, 16) || (pIdx->dwAge != pPdbEntry->dwAge)) { return FALSE; }
+    if((pIdx->oSymbols | pIdx->oSymbolsByRva | pIdx->oTypes | pIdx->oChildren) & 3) { return FALSE; }
+    if((pIdx->oSymbols < sizeof(PDB_INDEX_HEADER)) || ((QWORD)pIdx->oSymbols + (QWORD)pIdx->cSymbols * sizeof(PDB_INDEX_SYMBOL) > pIdx->oSymbolsByRva)) { return FALSE; }
+    if((QWORD)pIdx->oSymbolsByRva + (QWORD)pIdx->cSymbols * sizeof(DWORD) > pIdx->oTypes) { return FALSE; }
+    if((QWORD)pIdx->oTypes + (QWORD)pIdx->cTypes * sizeof(PDB_INDEX_TYPE) > pIdx->oChildren) { return FALSE; }
+    if((QWORD)pIdx->oChildren + (QWORD)pIdx->cChildren * sizeof(PDB_INDEX_CHILD) > pIdx->oStrings) { return FALSE; }
+    if(!pIdx->cbStrings || ((QWORD)pIdx->oStrings + pIdx->cbStrings != cbIdx) || ((PBYTE)pIdx)[cbIdx - 1]) { return FALSE; }
+    pSymbols = PDB_INDEX_SYMBOLS(pIdx);
+    pdwByRva = PDB_INDEX_SYMBOLSBYRVA(pIdx);
+    pTypes = PDB_INDEX_TYPES(pIdx);
+    pChildren = PDB_INDEX_CHILDREN(pIdx);
+    for(i = 0; i < pIdx->cSymbols; i++) {
+        if((pSymbols[i].oName >= pIdx->cbStrings) || (pdwByRva[i] >= pIdx->cSymbols)) { return FALSE; }
+    }
+    for(i = 0; i < pIdx->cTypes; i++) {
+        if((pTypes[i].oName >= pIdx->cbStrings) || ((QWORD)pTypes[i].iChild + pTypes[i].cChild > pIdx->cChildren)) { return FALSE; }
+    }
+    for(i = 0; i < pIdx->cChildren; i++) {
+        if(pChildren[i].oName >= pIdx->cbStrings) { return FALSE; }
+    }
+    return TRUE;
+}
+
+/*
+* Binary search for the first entry matching a name in a name-sorted range of
+* index entries (whose first DWORD is a string table offset).
+* -- pIdx
+* -- pvEntries
+* -- cEntries
+* -- cbEntry
+* -- szName
+* -- fCaseSensitive
+* -- return = the matching entry; or NULL if not found.
+*/
+PVOID PDB_Index_Find(_In_ PPDB_INDEX_HEADER pIdx, _In_ PBYTE pvEntries, _In_ DWORD cEntries, _In_ DWORD cbEntry, _In_ LPSTR szName, _In_ BOOL fCaseSensitive)
+{
+    LPSTR szEntry;
+    DWORD iLo = 0, iHi = cEntries, iMid;
+    while(iLo < iHi) {
+        iMid = iLo + (iHi - iLo) / 2;
+        szEntry = PDB_INDEX_STRING(pIdx, *(PDWORD)(pvEntries + (QWORD)iMid * cbEntry));
+        if((fCaseSensitive ? strcmp(szEntry, szName) : _stricmp(szEntry, szName)) < 0) {
+            iLo = iMid + 1;
+        } else {
+            iHi = iMid;
+        }
+    }
+    if(iLo >= cEntries) { return NULL; }
+    szEntry = PDB_INDEX_STRING(pIdx, *(PDWORD)(pvEntries + (QWORD)iLo * cbEntry));
+    if(fCaseSensitive ? strcmp(szEntry, szName) : _stricmp(szEntry, szName)) { return NULL; }
+    return pvEntries + (QWORD)iLo * cbEntry;
+}
+
+/*
+* Locate a PDB in the local symbol cache. Both the symbol store layout
+* <cache>/<name>/<GUID><AGE>/<name> and a flat <cache>/<name> are tried.
+* -- pPdbEntry
+* -- szPdbPath
+* -- return
+*/
+_Success_(return)
+BOOL PDB_Index_FindPdb(_In_ PPDB_ENTRY pPdbEntry, _Out_writes_(MAX_PATH) LPSTR szPdbPath)
+{
+    PBYTE pb = pPdbEntry->pbGUID;
+    LPSTR szName = pPdbEntry->szName;
+    LPSTR szNameSlash;
+    if((szNameSlash = strrchr(szName, '\\'))) { szName = szNameSlash + 1; }
+    if((szNameSlash = strrchr(szName, '/'))) { szName = szNameSlash + 1; }
+    snprintf(szPdbPath, MAX_PATH, "%s/%s/%08X%04X%04X%02X%02X%02X%02X%02X%02X%02X%02X%X/%s",
+        ctxMain->pdb.szLocal, szName, *(PDWORD)pb, *(PWORD)(pb + 4), *(PWORD)(pb + 6),
+        pb[8], pb[9], pb[10], pb[11], pb[12], pb[13], pb[14], pb[15], pPdbEntry->dwAge, szName);
+    if(!access(szPdbPath, R_OK)) { return TRUE; }
+    snprintf(szPdbPath, MAX_PATH, "%s/%s", ctxMain->pdb.szLocal, szName);
+    if(!access(szPdbPath, R_OK)) { return TRUE; }
+    return FALSE;
+}
+
+/*
+* Write an index to disk; a temporary file is renamed into place so that
+* concurrent readers never observe a partially written index.
+*/
+_Success_(return)
+BOOL PDB_Index_Write(_In_ LPSTR szIndexPath, _In_ PPDB_INDEX_HEADER pIdx)
+{
+    FILE *hFile = NULL;
+    BOOL fResult = FALSE;
+    CHAR szTmpPath[MAX_PATH];
+    if(snprintf(szTmpPath, MAX_PATH, "%s.%i", szIndexPath, getpid()) >= MAX_PATH) { return FALSE; }
+    if(fopen_s(&hFile, szTmpPath, "wb") || !hFile) { return FALSE; }
+    fResult = (1 == fwrite(pIdx, pIdx->cbTotal, 1, hFile));
+    fResult = !fclose(hFile) && fResult;
+    fResult = fResult && !rename(szTmpPath, szIndexPath);
+    if(!fResult) { remove(szTmpPath); }
+    return fResult;
+}
+
+/*
+* Ensure that the PDB_ENTRY have its index loaded into memory. A cached index
+* is mmap'ed if valid; otherwise it's built from the .pdb and cached on disk.
+* NB! this function must be called with the PDB context lock held!
+* -- pPdbEntry
+* -- return
+*/
+_Success_(return)
+BOOL PDB_LoadEnsureEx(POB_PDB_CONTEXT ctx, _In_ PPDB_ENTRY pPdbEntry)
+{
+    PBYTE pbIdx = NULL;
+    QWORD cbIdx = 0;
+    DWORD cbIdxBuild = 0;
+    PPDB_INDEX_HEADER pIdxBuild = NULL;
+    CHAR szPdbPath[MAX_PATH], szIndexPath[MAX_PATH];
+    if(!ctx || pPdbEntry->fLoadFailed) { return FALSE; }
+    if(pPdbEntry->pIndex) { return TRUE; }
+    if(!PDB_Index_FindPdb(pPdbEntry, szPdbPath)) { goto fail; }
+    if(snprintf(szIndexPath, MAX_PATH, "%s%s", szPdbPath, PDB_INDEX_FILE_SUFFIX) >= MAX_PATH) { goto fail; }
+    if(!(pPdbEntry->szPath = Util_StrDupA(szPdbPath))) { goto fail; }
+    // 1: try mmap cached index
+    if(PDB_Native_FileMap(szIndexPath, &pbIdx, &cbIdx)) {
+        if(PDB_Index_Verify((PPDB_INDEX_HEADER)pbIdx, cbIdx, pPdbEntry)) {
+            pPdbEntry->fIndexMapped = TRUE;
+            pPdbEntry->cbIndex = cbIdx;
+            pPdbEntry->pIndex = (PPDB_INDEX_HEADER)pbIdx;
+            return TRUE;
+        }
+        munmap(pbIdx, cbIdx);
+    }
+    // 2: build index from .pdb and cache it on disk (if possible)
+    if(!(pIdxBuild = PDB_Build(pPdbEntry, szPdbPath, &cbIdxBuild))) { goto fail; }
+    if(!PDB_Index_Verify(pIdxBuild, cbIdxBuild, pPdbEntry)) { goto fail; }
+    if(PDB_Index_Write(szIndexPath, pIdxBuild) && PDB_Native_FileMap(szIndexPath, &pbIdx, &cbIdx)) {
+        if(PDB_Index_Verify((PPDB_INDEX_HEADER)pbIdx, cbIdx, pPdbEntry)) {
+            LocalFree(pIdxBuild);
+            pPdbEntry->fIndexMapped = TRUE;
+            pPdbEntry->cbIndex = cbIdx;
+            pPdbEntry->pIndex = (PPDB_INDEX_HEADER)pbIdx;
+            return TRUE;
+        }
+        munmap(pbIdx, cbIdx);
+    }
+    VmmLog(MID_PDB, LOGLEVEL_DEBUG, "Unable to cache index - using in-memory index: '%s'", szIndexPath);
+    pPdbEntry->cbIndex = cbIdxBuild;
+    pPdbEntry->pIndex = pIdxBuild;
+    return TRUE;
+fail:
+    LocalFree(pIdxBuild);
+    pPdbEntry->fLoadFailed = TRUE;
+    return FALSE;
+}
+
+/*
+* Retrieve a loaded PDB entry given a PDB handle.
+* CALLER DECREF: return
+* -- ctx
+* -- hPDB
+* -- return
+*/
+PPDB_ENTRY PDB_GetEntryLoaded(_In_ POB_PDB_CONTEXT ctx, _In_opt_ PDB_HANDLE hPDB)
+{
+    BOOL fResult;
+    PPDB_ENTRY pObPdbEntry;
+    if(!ctx || ctx->fDisabled || !hPDB) { return NULL; }
+    if(hPDB == PDB_HANDLE_KERNEL) { hPDB = PDB_GetHandleFromModuleName("ntoskrnl"); }
+    if(!(pObPdbEntry = ObMap_GetByKey(ctx->pmPdbByHash, hPDB))) { return NULL; }
+    EnterCriticalSection(&ctx->Lock);
+    fResult = PDB_LoadEnsureEx(ctx, pObPdbEntry);
+    LeaveCriticalSection(&ctx->Lock);
+    if(!fResult) { Ob_DECREF_NULL(&pObPdbEntry); }
+    return pObPdbEntry;
+}
+
+
+
+//-----------------------------------------------------------------------------
+// PDB API FUNCTIONALITY BELOW (LINUX):
+//-----------------------------------------------------------------------------
+
+/*
+* Add a module to the PDB database and return its handle.
+* NB! The PDB for the added module won't be loaded until required.
+* -- vaModuleBase
+* -- cbModuleSize = optional size of the module (required if using GetSymbolFromAddress functionality).
+* -- szModuleName
+* -- szPdbName
+* -- pbPdbGUID
+* -- dwPdbAge
+* -- return = The PDB handle on success (no need to close handle); or zero on fail.
+*/
+PDB_HANDLE PDB_AddModuleEntry(_In_ QWORD vaModuleBase, _In_opt_ DWORD cbModuleSize, _In_ LPSTR szModuleName, _In_ LPSTR szPdbName, _In_reads_(16) PBYTE pbPdbGUID, _In_ DWORD dwPdbAge)
+{
+    POB_PDB_CONTEXT ctxOb = PDB_GetContext();
+    PPDB_ENTRY pObPdbEntry;
+    QWORD qwPdbHash = 0;
+    if(!ctxOb) { return 0; }
+    qwPdbHash = PDB_HashPdb(szPdbName, pbPdbGUID, dwPdbAge);
+    EnterCriticalSection(&ctxOb->Lock);
+    if(!ObMap_ExistsKey(ctxOb->pmPdbByHash, qwPdbHash)) {
+        pObPdbEntry = Ob_Alloc(OB_TAG_PDB_ENTRY, LMEM_ZEROINIT, sizeof(PDB_ENTRY), (OB_CLEANUP_CB)PDB_CallbackCleanup_ObPdbEntry, NULL);
+        if(!pObPdbEntry) { goto fail; }
+        pObPdbEntry->dwAge = dwPdbAge;
+        pObPdbEntry->qwHash = qwPdbHash;
+        memcpy(pObPdbEntry->pbGUID, pbPdbGUID, 16);
+        pObPdbEntry->szName = Util_StrDupA(szPdbName);
+        pObPdbEntry->szModuleName = Util_StrDupA(szModuleName);
+        pObPdbEntry->vaModuleBase = vaModuleBase;
+        pObPdbEntry->cbModuleSize = cbModuleSize;
+        ObMap_Push(ctxOb->pmPdbByHash, qwPdbHash, pObPdbEntry);
+        ObMap_Push(ctxOb->pmPdbByModule, PDB_HashModuleName(szModuleName), pObPdbEntry);
+        Ob_DECREF(pObPdbEntry);
+    }
+fail:
+    LeaveCriticalSection(&ctxOb->Lock);
+    Ob_DECREF(ctxOb);
+    return qwPdbHash;
+}
+
+/*
+* Retrieve a PDB handle given a process and module base address. If the handle
+* is not found in the database an attempt to automatically add it is performed.
+* NB! Only one PDB with the same base address may exist regardless of process.
+* NB! There is no symbol server download on Linux - the PDB is loaded by this
+*     function and zero is returned unless it exists in the local symbol cache
+*     so that callers are able to fall back to InfoDB.
+* -- pProcess
+* -- vaModuleBase
+* -- return = The PDB handle on success (no need to close handle); or zero on fail.
+*/
+PDB_HANDLE PDB_GetHandleFromModuleAddress(_In_ PVMM_PROCESS pProcess, _In_ QWORD vaModuleBase)
+{
+    POB_PDB_CONTEXT ctxOb = PDB_GetContext();
+    PPDB_ENTRY pObPdbEntry = 0;
+    PE_CODEVIEW_INFO CodeViewInfo = { 0 };
+    DWORD i, iMax;
+    QWORD qwPdbHash, cbModuleSize;
+    CHAR szModuleName[MAX_PATH] = { 0 }, *szPdbText;
+    if(!ctxOb || ctxOb->fDisabled) {
+        Ob_DECREF(ctxOb);
+        return 0;
+    }
+    // find: module base address already in .pdb database.
+    for(i = 0, iMax = ObMap_Size(ctxOb->pmPdbByHash); i < iMax; i++) {
+        if((pObPdbEntry = ObMap_GetByIndex(ctxOb->pmPdbByHash, i))) {
+            if(vaModuleBase == pObPdbEntry->vaModuleBase) {
+                qwPdbHash = pObPdbEntry->qwHash;
+                Ob_DECREF_NULL(&pObPdbEntry);
+                Ob_DECREF_NULL(&ctxOb);
+                return PDB_LoadEnsure(qwPdbHash) ? qwPdbHash : 0;
+            }
+            Ob_DECREF_NULL(&pObPdbEntry);
+        }
+    }
+    Ob_DECREF_NULL(&ctxOb);
+    // retrieve codeview and add to .pdb database.
+    if(!(cbModuleSize = PE_GetSize(pProcess, vaModuleBase)) || (cbModuleSize > 0x04000000)) { return 0; }
+    if(!PE_GetCodeViewInfo(pProcess, vaModuleBase, NULL, &CodeViewInfo)) { return 0; }
+    strncpy_s(szModuleName, MAX_PATH, CodeViewInfo.CodeView.PdbFileName, _TRUNCATE);
+    if((szPdbText = strstr(szModuleName, ".pdb"))) {
+        szPdbText[0] = 0;
+    }
+    qwPdbHash = PDB_AddModuleEntry(
+        vaModuleBase,
+        (DWORD)cbModuleSize,
+        szModuleName,
+        CodeViewInfo.CodeView.PdbFileName,
+        CodeViewInfo.CodeView.Guid,
+        CodeViewInfo.CodeView.Age
+    );
+    return PDB_LoadEnsure(qwPdbHash) ? qwPdbHash : 0;
+}
+
+/*
+* Retrieve a PDB handle from an already added module.
+* NB! If multiple modules exists with the same name the 1st module to be added
+*     is returned.
+* -- szModuleName
+* -- return = The PDB handle on success (no need to close handle); or zero on fail.
+*/
+PDB_HANDLE PDB_GetHandleFromModuleName(_In_ LPSTR szModuleName)
+{
+    POB_PDB_CONTEXT ctxOb = PDB_GetContext();
+    PPDB_ENTRY pObPdbEntry = NULL;
+    QWORD qwHashPdb = 0;
+    DWORD dwHashModule;
+    if(!ctxOb || ctxOb->fDisabled) { goto fail; }
+    if(!szModuleName || !strcmp("nt", szModuleName)) {
+        szModuleName = "ntoskrnl";
+    }
+    dwHashModule = PDB_HashModuleName(szModuleName);
+    if(!(pObPdbEntry = ObMap_GetByKey(ctxOb->pmPdbByModule, dwHashModule))) { goto fail; }
+    qwHashPdb = pObPdbEntry->fLoadFailed ? 0 : pObPdbEntry->qwHash;
+fail:
+    Ob_DECREF(pObPdbEntry);
+    Ob_DECREF(ctxOb);
+    return qwHashPdb;
+}
+
+/*
+* Ensure that the PDB_HANDLE have its symbols loaded into memory.
+* -- hPDB
+* -- return
+*/
+_Success_(return)
+BOOL PDB_LoadEnsure(_In_opt_ PDB_HANDLE hPDB)
+{
+    POB_PDB_CONTEXT ctxOb = PDB_GetContext();
+    PPDB_ENTRY pObPdbEntry = PDB_GetEntryLoaded(ctxOb, hPDB);
+    BOOL fResult = (pObPdbEntry != NULL);
+    Ob_DECREF(pObPdbEntry);
+    Ob_DECREF(ctxOb);
+    return fResult;
+}
+
+/*
+* Return module information given a PDB handle.
+* -- hPDB
+* -- szModuleName = buffer to receive module name upon success.
+* -- pvaModuleBase
+* -- pcbModuleSize
+* -- return
+*/
+_Success_(return)
+BOOL PDB_GetModuleInfo(_In_opt_ PDB_HANDLE hPDB, _Out_writes_opt_(MAX_PATH) LPSTR szModuleName, _Out_opt_ PQWORD pvaModuleBase, _Out_opt_ PDWORD pcbModuleSize)
+{
+    POB_PDB_CONTEXT ctxOb = PDB_GetContext();
+    PPDB_ENTRY pObPdbEntry = NULL;
+    BOOL fResult = FALSE;
+    if(!ctxOb || ctxOb->fDisabled || !hPDB) { goto fail; }
+    if(hPDB == PDB_HANDLE_KERNEL) { hPDB = PDB_GetHandleFromModuleName("ntoskrnl"); }
+    if(!(pObPdbEntry = ObMap_GetByKey(ctxOb->pmPdbByHash, hPDB))) { goto fail; }
+    if(szModuleName) {
+        strncpy_s(szModuleName, MAX_PATH, pObPdbEntry->szModuleName, MAX_PATH - 1);
+        szModuleName[MAX_PATH - 1] = 0;
+    }
+    if(pvaModuleBase) {
+        *pvaModuleBase = pObPdbEntry->vaModuleBase;
+    }
+    if(pcbModuleSize) {
+        *pcbModuleSize = pObPdbEntry->cbModuleSize;
+    }
+    fResult = TRUE;
+fail:
+    Ob_DECREF(pObPdbEntry);
+    Ob_DECREF(ctxOb);
+    return fResult;
+}
+
+/*
+* Query the PDB for the offset of a symbol.
+* -- hPDB
+* -- szSymbolName
+* -- pdwSymbolOffset
+* -- return
+*/
+_Success_(return)
+BOOL PDB_GetSymbolOffset(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szSymbolName, _Out_ PDWORD pdwSymbolOffset)
+{
+    POB_PDB_CONTEXT ctxOb = NULL;
+    PPDB_ENTRY pObPdbEntry = NULL;
+    PPDB_INDEX_SYMBOL pSymbol;
+    *pdwSymbolOffset = 0;
+    if((hPDB == PDB_HANDLE_KERNEL) && InfoDB_SymbolOffset("nt", szSymbolName, pdwSymbolOffset)) { return TRUE; }
+    ctxOb = PDB_GetContext();
+    if(!(pObPdbEntry = PDB_GetEntryLoaded(ctxOb, hPDB))) { goto fail; }
+    pSymbol = PDB_Index_Find(pObPdbEntry->pIndex, (PBYTE)PDB_INDEX_SYMBOLS(pObPdbEntry->pIndex), pObPdbEntry->pIndex->cSymbols, sizeof(PDB_INDEX_SYMBOL), szSymbolName, FALSE);
+    if(pSymbol && (pSymbol->dwRva < 0x10000000)) {
+        *pdwSymbolOffset = pSymbol->dwRva;
+    }
+fail:
+    Ob_DECREF(pObPdbEntry);
+    Ob_DECREF(ctxOb);
+    return *pdwSymbolOffset ? TRUE : FALSE;
+}
+
+/*
+* Query the PDB for the offset of a symbol and return its virtual address.
+* -- hPDB
+* -- szSymbolName
+* -- pvaSymbolAddress
+* -- return
+*/
+_Success_(return)
+BOOL PDB_GetSymbolAddress(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szSymbolName, _Out_ PQWORD pvaSymbolAddress)
+{
+    QWORD vaModuleBase = 0;
+    DWORD dwSymbolOffset;
+    if(!PDB_GetSymbolOffset(hPDB, szSymbolName, &dwSymbolOffset)) { return FALSE; }
+    if(hPDB == PDB_HANDLE_KERNEL) {
+        vaModuleBase = ctxVmm->kernel.vaBase;
+    } else if(!PDB_GetModuleInfo(hPDB, NULL, &vaModuleBase, NULL)) {
+        return FALSE;
+    }
+    *pvaSymbolAddress = vaModuleBase + dwSymbolOffset;
+    return TRUE;
+}
+
+/*
+* Query the PDB for the closest symbol name given an offset from the module
+* base address.
+* -- hPDB
+* -- dwSymbolOffset = the offset from the module base to query.
+* -- szSymbolName = buffer to receive the name of the symbol.
+* -- pdwSymbolDisplacement = displacement from the beginning of the symbol.
+* -- return
+*/
+_Success_(return)
+BOOL PDB_GetSymbolFromOffset(_In_opt_ PDB_HANDLE hPDB, _In_ DWORD dwSymbolOffset, _Out_writes_opt_(MAX_PATH) LPSTR szSymbolName, _Out_opt_ PDWORD pdwSymbolDisplacement)
+{
+    POB_PDB_CONTEXT ctxOb = PDB_GetContext();
+    PPDB_ENTRY pObPdbEntry = NULL;
+    PPDB_INDEX_HEADER pIdx;
+    PPDB_INDEX_SYMBOL pSymbols;
+    PDWORD pdwByRva;
+    DWORD iLo, iHi, iMid;
+    BOOL fResult = FALSE;
+    if(!(pObPdbEntry = PDB_GetEntryLoaded(ctxOb, hPDB))) { goto fail; }
+    pIdx = pObPdbEntry->pIndex;
+    pSymbols = PDB_INDEX_SYMBOLS(pIdx);
+    pdwByRva = PDB_INDEX_SYMBOLSBYRVA(pIdx);
+    // binary search: last symbol with rva <= dwSymbolOffset
+    iLo = 0; iHi = pIdx->cSymbols;
+    while(iLo < iHi) {
+        iMid = iLo + (iHi - iLo) / 2;
+        if(pSymbols[pdwByRva[iMid]].dwRva <= dwSymbolOffset) {
+            iLo = iMid + 1;
+        } else {
+            iHi = iMid;
+        }
+    }
+    if(!iLo) { goto fail; }
+    if(pObPdbEntry->cbModuleSize && (dwSymbolOffset >= pObPdbEntry->cbModuleSize)) { goto fail; }
+    if(szSymbolName) {
+        strncpy_s(szSymbolName, MAX_PATH, PDB_INDEX_STRING(pIdx, pSymbols[pdwByRva[iLo - 1]].oName), MAX_PATH - 1);
+        szSymbolName[MAX_PATH - 1] = 0;
+    }
+    if(pdwSymbolDisplacement) {
+        *pdwSymbolDisplacement = dwSymbolOffset - pSymbols[pdwByRva[iLo - 1]].dwRva;
+    }
+    fResult = TRUE;
+fail:
+    Ob_DECREF(pObPdbEntry);
+    Ob_DECREF(ctxOb);
+    return fResult;
+}
+
+/*
+* Read memory at the PDB acquired symbol offset.
+* -- hPDB
+* -- szSymbolName
+* -- pProcess
+* -- pb
+* -- cb
+* -- return
+*/
+_Success_(return)
+BOOL PDB_GetSymbolPBYTE(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szSymbolName, _In_ PVMM_PROCESS pProcess, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb)
+{
+    QWORD vaSymbolAddress = 0;
+    return PDB_GetSymbolAddress(hPDB, szSymbolName, &vaSymbolAddress) && VmmRead(pProcess, vaSymbolAddress, pb, cb);
+}
+
+/*
+* Query the PDB for the size of a type.
+* -- hPDB
+* -- szTypeName
+* -- pdwTypeSize
+* -- return
+*/
+_Success_(return)
+BOOL PDB_GetTypeSize(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szTypeName, _Out_ PDWORD pdwTypeSize)
+{
+    POB_PDB_CONTEXT ctxOb = NULL;
+    PPDB_ENTRY pObPdbEntry = NULL;
+    PPDB_INDEX_TYPE pType;
+    BOOL fResult = FALSE;
+    if((hPDB == PDB_HANDLE_KERNEL) && InfoDB_TypeSize("nt", szTypeName, pdwTypeSize)) { return TRUE; }
+    ctxOb = PDB_GetContext();
+    if(!(pObPdbEntry = PDB_GetEntryLoaded(ctxOb, hPDB))) { goto fail; }
+    pType = PDB_Index_Find(pObPdbEntry->pIndex, (PBYTE)PDB_INDEX_TYPES(pObPdbEntry->pIndex), pObPdbEntry->pIndex->cTypes, sizeof(PDB_INDEX_TYPE), szTypeName, FALSE);
+    if(pType) {
+        *pdwTypeSize = pType->cbSize;
+        fResult = TRUE;
+    }
+fail:
+    Ob_DECREF(pObPdbEntry);
+    Ob_DECREF(ctxOb);
+    return fResult;
+}
+
+_Success_(return)
+BOOL PDB_GetTypeSizeShort(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szTypeName, _Out_ PWORD pwTypeSize)
+{
+    DWORD dwTypeSize;
+    if(!PDB_GetTypeSize(hPDB, szTypeName, &dwTypeSize) || (dwTypeSize > 0xffff)) { return FALSE; }
+    if(pwTypeSize) { *pwTypeSize = (WORD)dwTypeSize; }
+    return TRUE;
+}
+
+/*
+* Query the PDB for the offset of a child inside a type - often inside a struct.
+* The child name must match exactly.
+* -- hPDB
+* -- szTypeName
+* -- uszTypeChildName = exact match of child name.
+* -- pdwTypeOffset = offset relative to type base.
+* -- return
+*/
+_Success_(return)
+BOOL PDB_GetTypeChildOffset(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szTypeName, _In_ LPSTR uszTypeChildName, _Out_ PDWORD pdwTypeOffset)
+{
+    POB_PDB_CONTEXT ctxOb = NULL;
+    PPDB_ENTRY pObPdbEntry = NULL;
+    PPDB_INDEX_HEADER pIdx;
+    PPDB_INDEX_TYPE pType;
+    PPDB_INDEX_CHILD pChild;
+    BOOL fResult = FALSE;
+    if((hPDB == PDB_HANDLE_KERNEL) && InfoDB_TypeChildOffset("nt", szTypeName, uszTypeChildName, pdwTypeOffset)) { return TRUE; }
+    ctxOb = PDB_GetContext();
+    if(!(pObPdbEntry = PDB_GetEntryLoaded(ctxOb, hPDB))) { goto fail; }
+    pIdx = pObPdbEntry->pIndex;
+    if(!(pType = PDB_Index_Find(pIdx, (PBYTE)PDB_INDEX_TYPES(pIdx), pIdx->cTypes, sizeof(PDB_INDEX_TYPE), szTypeName, FALSE))) { goto fail; }
+    pChild = PDB_Index_Find(pIdx, (PBYTE)(PDB_INDEX_CHILDREN(pIdx) + pType->iChild), pType->cChild, sizeof(PDB_INDEX_CHILD), uszTypeChildName, TRUE);
+    if(pChild) {
+        *pdwTypeOffset = pChild->dwOffset;
+        fResult = TRUE;
+    }
+fail:
+    Ob_DECREF(pObPdbEntry);
+    Ob_DECREF(ctxOb);
+    return fResult;
+}
+
+_Success_(return)
+BOOL PDB_GetTypeChildOffsetShort(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szTypeName, _In_ LPSTR uszTypeChildName, _Out_ PWORD pwTypeOffset)
+{
+    DWORD dwTypeOffset;
+    if(!PDB_GetTypeChildOffset(hPDB, szTypeName, uszTypeChildName, &dwTypeOffset) || (dwTypeOffset > 0xffff)) { return FALSE; }
+    if(pwTypeOffset) { *pwTypeOffset = (WORD)dwTypeOffset; }
+    return TRUE;
+}
+
+_Success_(return)
+BOOL PDB_DisplayTypeNt(_In_ LPSTR szTypeName, _In_ BYTE cLevelMax, _In_opt_ QWORD vaType, _In_ BOOL fHexAscii, _In_ BOOL fObjHeader, _Out_opt_ LPSTR *pszResult, _Out_opt_ PDWORD pcbResult, _Out_opt_ PDWORD pcbType)
+{
+    return FALSE;
+}
+
+
+
+//-----------------------------------------------------------------------------
+// INITIALIZATION/REFRESH/CLOSE FUNCTIONALITY BELOW (LINUX):
+//-----------------------------------------------------------------------------
+
+/*
+* Cleanup the PDB sub-system. This should ideally be done on Vmm Close().
+*/
+VOID PDB_Close()
+{
+    Ob_DECREF_NULL(&ctxVmm->pObPdbContext);
+    ctxMain->pdb.fInitialized = FALSE;
+}
+
+VOID PDB_Initialize_WaitComplete()
+{
+    POB_PDB_CONTEXT ctxOb = PDB_GetContext();
+    if(ctxOb && ctxMain->pdb.fEnable) {
+        EnterCriticalSection(&ctxOb->Lock);
+        LeaveCriticalSection(&ctxOb->Lock);
+    }
+    Ob_DECREF(ctxOb);
+}
+
+/*
+* Asynchronous initialization of the PDB for the kernel. This is done async
+* since building the index of a large kernel PDB may take some time. Once
+* this initialization is successfully completed the fDisabled flag will be
+* removed - allowing other threads to use the PDB subsystem.
+* -- lpParameter
+* -- return
+*/
+DWORD PDB_Initialize_Async_Kernel_ThreadProc(LPVOID lpParameter)
+{
+    POB_PDB_CONTEXT ctxOb = PDB_GetContext();
+    PVMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS pKernelParameters = (PVMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS)lpParameter;
+    DWORD dwReturnStatus = 0;
+    PVMM_PROCESS pObSystemProcess = NULL;
+    PPDB_ENTRY pObKernelEntry = NULL;
+    QWORD qwPdbHash;
+    if(!ctxOb) { return 0; }
+    EnterCriticalSection(&ctxOb->Lock);
+    SetEvent(*pKernelParameters->phEventThreadStarted);
+    if(!(pObSystemProcess = VmmProcessGet(4))) { goto fail; }
+    pKernelParameters->fPdbInfo = pKernelParameters->fPdbInfo ||
+        PE_GetCodeViewInfo(pObSystemProcess, ctxVmm->kernel.vaBase, NULL, &pKernelParameters->PdbInfo) ||
+        PDB_Initialize_Async_Kernel_ScanForPdbInfo(pObSystemProcess, &pKernelParameters->PdbInfo);
+    if(!pKernelParameters->fPdbInfo) {
+        PDB_PrintError("Reason: Unable to locate debugging information in kernel image.");
+        goto fail;
+    }
+    qwPdbHash = PDB_AddModuleEntry(ctxVmm->kernel.vaBase, (DWORD)ctxVmm->kernel.cbSize, "ntoskrnl", pKernelParameters->PdbInfo.CodeView.PdbFileName, pKernelParameters->PdbInfo.CodeView.Guid, pKernelParameters->PdbInfo.CodeView.Age);
+    pObKernelEntry = ObMap_GetByKey(ctxOb->pmPdbByHash, qwPdbHash);
+    if(!pObKernelEntry) {
+        PDB_PrintError("Reason: Failed creating initial PDB entry.");
+        goto fail;
+    }
+    if(!PDB_LoadEnsureEx(ctxOb, pObKernelEntry)) {
+        PDB_PrintError("Reason: Unable to locate kernel symbols in local symbol cache.");
+        goto fail;
+    }
+    VmmLog(MID_PDB, LOGLEVEL_DEBUG, "Initialization of debug symbol .pdb functionality completed");
+    VmmLog(MID_PDB, LOGLEVEL_DEBUG, "[ %s ]", pObKernelEntry->szPath);
+    ctxOb->fDisabled = FALSE;
+    dwReturnStatus = 1;
+    // fall-through to fail for cleanup
+fail:
+    LeaveCriticalSection(&ctxOb->Lock);
+    Ob_DECREF(pObKernelEntry);
+    Ob_DECREF(pObSystemProcess);
+    LocalFree(pKernelParameters);
+    Ob_DECREF(ctxOb);
+    return dwReturnStatus;
+}
+
+VOID PDB_Initialize_InitialValues()
+{
+    if(!ctxMain->pdb.fInitialized) {
+        ctxMain->pdb.fEnable = 1;
+    }
+    // symbol server download is not supported on linux - local cache only.
+    ctxMain->pdb.fServerEnable = FALSE;
+    if(!ctxMain->pdb.szLocal[0]) {
+        Util_GetPathLib(ctxMain->pdb.szLocal);
+        strncat_s(ctxMain->pdb.szLocal, _countof(ctxMain->pdb.szLocal), "Symbols", _TRUNCATE);
+    }
+    if(!ctxMain->pdb.szServer[0]) {
+        strncpy_s(ctxMain->pdb.szServer, _countof(ctxMain->pdb.szServer), "https://msdl.microsoft.com/download/symbols", _TRUNCATE);
+    }
+    strncpy_s(ctxMain->pdb.szSymbolPath, _countof(ctxMain->pdb.szSymbolPath), ctxMain->pdb.szLocal, _TRUNCATE);
+    ctxMain->pdb.fInitialized = TRUE;
+}
+
+/*
+* Update the PDB configuration. The PDB syb-system will be reloaded on
+* configuration changes - which may cause a short interruption for any
+* caller.
+*/
+VOID PDB_ConfigChange()
+{
+    EnterCriticalSection(&ctxVmm->LockMaster);
+    PDB_Close();
+    PDB_Initialize(NULL, FALSE);
+    LeaveCriticalSection(&ctxVmm->LockMaster);
+}
+
+/*
+* Initialize the PDB sub-system. This should ideally be done on Vmm Init()
+*/
+VOID PDB_Initialize(_In_opt_ PPE_CODEVIEW_INFO pPdbInfoOpt, _In_ BOOL fInitializeKernelAsync)
+{
+    HANDLE hEventThreadStarted = 0;
+    POB_PDB_CONTEXT ctx = NULL;
+    PVMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS pKernelParameters = NULL;
+    if(ctxMain->pdb.fInitialized) { return; }
+    PDB_Initialize_InitialValues();
+    if(!ctxMain->pdb.fEnable) { goto fail; }
+    if(!(ctx = Ob_Alloc(OB_TAG_PDB_CTX, LMEM_ZEROINIT, sizeof(OB_PDB_CONTEXT), (OB_CLEANUP_CB)PDB_CallbackCleanup_ObPdbContext, NULL))) { goto fail; }
+    InitializeCriticalSection(&ctx->Lock);
+    if(!(ctx->pmPdbByHash = ObMap_New(OB_MAP_FLAGS_OBJECT_OB))) { goto fail; }
+    if(!(ctx->pmPdbByModule = ObMap_New(OB_MAP_FLAGS_OBJECT_OB))) { goto fail; }
+    // load kernel .pdb async (to optimize startup time).
+    // pdb subsystem won't be fully initialized until before the kernel is loaded.
+    if(!(hEventThreadStarted = CreateEvent(NULL, TRUE, FALSE, NULL))) { goto fail; }
+    if(!(pKernelParameters = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWIN_PDB_INITIALIZE_KERNEL_PARAMETERS)))) { goto fail; }
+    pKernelParameters->phEventThreadStarted = &hEventThreadStarted;
+    if(pPdbInfoOpt) {
+        pKernelParameters->fPdbInfo = TRUE;
+        memcpy(&pKernelParameters->PdbInfo, pPdbInfoOpt, sizeof(PE_CODEVIEW_INFO));
+    }
+    ctx->fDisabled = TRUE;
+    ctxVmm->pObPdbContext = (POB)ctx;
+    if(fInitializeKernelAsync) {
+        VmmWork((LPTHREAD_START_ROUTINE)PDB_Initialize_Async_Kernel_ThreadProc, (LPVOID)pKernelParameters, NULL);
+        WaitForSingleObject(hEventThreadStarted, 500);  // wait for async thread initialize thread to start (and acquire PDB lock).
+    } else {
+        PDB_Initialize_Async_Kernel_ThreadProc(pKernelParameters); // synchronous call
+    }
+    CloseHandle(hEventThreadStarted);
+    return;
+fail:
+    if(hEventThreadStarted) { CloseHandle(hEventThreadStarted); }
+    Ob_DECREF(ctx);
+    LocalFree(pKernelParameters);
+    ctxMain->pdb.fEnable = FALSE;
 }
 
 #endif /* LINUX */
@@ -1,6 +1,7 @@
 // pdb.h : definitions related to parsing of program databases (PDB) files used
 //         for debug symbols and automatic retrieval from the Microsoft Symbol
-//         Server. (Windows exclusive functionality).
+//         Server. On Linux PDBs are parsed natively from the local symbol cache
+//         only.
 //
 // (c) Ulf Frisk, 2019-2022
 // Author: Ulf Frisk, pcileech@frizk.net
@@ -89,6 +89,14 @@ typedef struct tdPLUGIN_TREE {
 
 VOID PluginManager_Initialize_Python();
 
+// plugin manager generation counter - process global and never reused (also
+// not across VMMDLL_Close/VMMDLL_Initialize) so that a stale resolved file is
+// never mistaken for a file resolved within the current plugin tree.
+static QWORD g_qwPluginManagerGeneration = 0;
+
+// resolved file handle id counter - process global and never reused.
+static QWORD g_qwPluginManagerHandleId = 0;
+
 
 
 // ----------------------------------------------------------------------------
@@ -198,6 +206,7 @@ VOID PluginManager_ContextInitialize(_Out_ PVMMDLL_PLUGIN_CONTEXT ctx, _In_ PPLU
     ctx->uszPath = uszPath;
     ctx->ctxM = pModule->ctxM;
     ctx->MID = pModule->MID;
+    ctx->pvReserved1 = NULL;
 }
 
 VOID PluginManager_List(_In_opt_ PVMM_PROCESS pProcess, _In_ LPSTR uszPath, _Inout_ PHANDLE pFileList)
@@ -283,6 +292,77 @@ NTSTATUS PluginManager_Write(_In_opt_ PVMM_PROCESS pProcess, _In_ LPSTR uszPath,
     return VMMDLL_STATUS_FILE_INVALID;
 }
 
+_Success_(return)
+BOOL PluginManager_FileResolve(_In_ BOOL fProcess, _In_ LPSTR uszPath, _Out_ PPLUGINMANAGER_FILE pFile)
+{
+    LPSTR uszSubPath;
+    PPLUGIN_TREE pTree, pTreeBase;
+    ZeroMemory(pFile, sizeof(PLUGINMANAGER_FILE));
+    if(!ctxVmm->PluginManager.qwGeneration) { return FALSE; }
+    if(!(pTreeBase = fProcess ? ctxVmm->PluginManager.Proc : ctxVmm->PluginManager.Root)) { return FALSE; }
+    PluginManager_GetTree(pTreeBase, uszPath, &pTree, &uszSubPath);
+    if(!pTree->pPlugin || (!pTree->pPlugin->pfnRead && !pTree->pPlugin->pfnWrite)) { return FALSE; }
+    if(strlen(uszSubPath) >= _countof(pFile->uszSubPath)) { return FALSE; }
+    strncpy_s(pFile->uszSubPath, _countof(pFile->uszSubPath), uszSubPath, _TRUNCATE);
+    pFile->pvTree = pTree;
+    pFile->qwGeneration = ctxVmm->PluginManager.qwGeneration;
+    pFile->fProcess = fProcess;
+    pFile->qwHandleId = InterlockedIncrement64(&g_qwPluginManagerHandleId);
+    return TRUE;
+}
+
+/*
+* Verify that a resolved file belongs to the current plugin manager
+* generation and to the plugin tree matching the process (if any).
+* -- pProcess
+* -- pFile
+* -- return
+*/
+_Success_(return)
+BOOL PluginManager_FileValid(_In_opt_ PVMM_PROCESS pProcess, _In_ PPLUGINMANAGER_FILE pFile)
+{
+    return
+        pFile->qwGeneration &&
+        (pFile->qwGeneration == ctxVmm->PluginManager.qwGeneration) &&
+        (pFile->fProcess == (pProcess ? TRUE : FALSE));
+}
+
+NTSTATUS PluginManager_FileRead(_In_opt_ PVMM_PROCESS pProcess, _In_ PPLUGINMANAGER_FILE pFile, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+{
+    QWORD tmStart = Statistics_CallStart();
+    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
+    VMMDLL_PLUGIN_CONTEXT ctxPlugin;
+    PPLUGIN_TREE pTree = (PPLUGIN_TREE)pFile->pvTree;
+    PPLUGIN_ENTRY pPlugin;
+    if(!PluginManager_FileValid(pProcess, pFile)) { goto finish; }
+    if(pTree->fVisible && (pPlugin = pTree->pPlugin) && pPlugin->pfnRead) {
+        PluginManager_ContextInitialize(&ctxPlugin, pPlugin, pProcess, pFile->uszSubPath);
+        ctxPlugin.pvReserved1 = pPlugin->hDLL ? NULL : (PVOID)(SIZE_T)pFile->qwHandleId;
+        nt = pPlugin->pfnRead(&ctxPlugin, pb, cb, pcbRead, cbOffset);
+    }
+finish:
+    Statistics_CallEnd(STATISTICS_ID_PluginManager_Read, tmStart);
+    return nt;
+}
+
+NTSTATUS PluginManager_FileWrite(_In_opt_ PVMM_PROCESS pProcess, _In_ PPLUGINMANAGER_FILE pFile, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ QWORD cbOffset)
+{
+    QWORD tmStart = Statistics_CallStart();
+    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
+    VMMDLL_PLUGIN_CONTEXT ctxPlugin;
+    PPLUGIN_TREE pTree = (PPLUGIN_TREE)pFile->pvTree;
+    PPLUGIN_ENTRY pPlugin;
+    if(!PluginManager_FileValid(pProcess, pFile)) { goto finish; }
+    if(pTree->fVisible && (pPlugin = pTree->pPlugin) && pPlugin->pfnWrite) {
+        PluginManager_ContextInitialize(&ctxPlugin, pPlugin, pProcess, pFile->uszSubPath);
+        ctxPlugin.pvReserved1 = pPlugin->hDLL ? NULL : (PVOID)(SIZE_T)pFile->qwHandleId;
+        nt = pPlugin->pfnWrite(&ctxPlugin, pb, cb, pcbWrite, cbOffset);
+    }
+finish:
+    Statistics_CallEnd(STATISTICS_ID_PluginManager_Write, tmStart);
+    return nt;
+}
+
 BOOL PluginManager_Notify(_In_ DWORD fEvent, _In_opt_ PVOID pvEvent, _In_opt_ DWORD cbEvent)
 {
     VMMDLL_PLUGIN_CONTEXT ctxPlugin;
@@ -544,6 +624,7 @@ VOID PluginManager_Close()
     PPLUGIN_ENTRY pPlugin;
     VMMDLL_PLUGIN_CONTEXT ctxPlugin;
     PPLUGIN_TREE pTreeRoot = ctxVmm->PluginManager.Root, pTreeProc = ctxVmm->PluginManager.Proc;
+    ctxVmm->PluginManager.qwGeneration = 0;
     ctxVmm->PluginManager.Root = NULL;
     ctxVmm->PluginManager.Proc = NULL;
     PluginManager_Close_Tree(pTreeRoot);
@@ -771,6 +852,7 @@ BOOL PluginManager_Initialize()
     PluginManager_Initialize_Python();
     // 6: refresh logging (module specific overrides not yet applied may exist)
     VmmLog_LevelRefresh();
+    ctxVmm->PluginManager.qwGeneration = InterlockedIncrement64(&g_qwPluginManagerGeneration);
     LeaveCriticalSection(&ctxVmm->LockMaster);
     return TRUE;
 fail:
@@ -63,6 +63,61 @@ NTSTATUS PluginManager_Read(_In_opt_ PVMM_PROCESS pProcess, _In_ LPSTR uszPath,
 */
 NTSTATUS PluginManager_Write(_In_opt_ PVMM_PROCESS pProcess, _In_ LPSTR uszPath, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ QWORD cbOffset);
 
+/*
+* A file resolved through the plugin tree once by PluginManager_FileResolve().
+* It may be used to read/write the file repeatedly without walking the plugin
+* tree on each call. The contents are internal to the plugin manager.
+*/
+typedef struct tdPLUGINMANAGER_FILE {
+    PVOID pvTree;                       // resolved plugin tree node
+    QWORD qwGeneration;                 // plugin manager generation at resolve time
+    BOOL fProcess;                      // resolved within the per-process plugin tree
+    QWORD qwHandleId;                   // unique id of this resolved file (never zero)
+    CHAR uszSubPath[3 * MAX_PATH];      // path relative to the resolved plugin
+} PLUGINMANAGER_FILE, *PPLUGINMANAGER_FILE;
+
+/*
+* Resolve a path to the plugin responsible for it.
+* -- fProcess = resolve within the per-process plugin tree.
+* -- uszPath
+* -- pFile
+* -- return
+*/
+_Success_(return)
+BOOL PluginManager_FileResolve(_In_ BOOL fProcess, _In_ LPSTR uszPath, _Out_ PPLUGINMANAGER_FILE pFile);
+
+/*
+* Send a Read command to the plugin of an already resolved file.
+* -- pProcess = must be given if, and only if, resolved with fProcess.
+* -- pFile
+* -- pb
+* -- cb
+* -- pcbRead
+* -- cbOffset
+* -- return
+*/
+NTSTATUS PluginManager_FileRead(_In_opt_ PVMM_PROCESS pProcess, _In_ PPLUGINMANAGER_FILE pFile, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset);
+
+/*
+* Send a Write command to the plugin of an already resolved file.
+* -- pProcess = must be given if, and only if, resolved with fProcess.
+* -- pFile
+* -- pb
+* -- cb
+* -- pcbWrite
+* -- cbOffset
+* -- return
+*/
+NTSTATUS PluginManager_FileWrite(_In_opt_ PVMM_PROCESS pProcess, _In_ PPLUGINMANAGER_FILE pFile, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ QWORD cbOffset);
+
+/*
+* Retrieve the handle id of the resolved file a read/write is made through in
+* a built-in module read/write callback. Zero if the file is accessed by path.
+* -- ctxP
+* -- return
+*/
+#define PluginManager_ContextHandleId(ctxP)     ((QWORD)(SIZE_T)(ctxP)->pvReserved1)
+
 /*
 * Send a notification event to plugins that registered to receive notifications.
 * Officially supported events are listed in vmmdll.h!VMMDLL_PLUGIN_EVENT_*
@@ -132,7 +132,9 @@ VOID PageStatUpdate(_In_opt_ PPAGE_STATISTICS pPageStat, _In_ QWORD qwAddr, _In_
 #define STATISTICS_ID_VMMDLL_PdbTypeSize                        0x3e
 #define STATISTICS_ID_VMMDLL_PdbTypeChildOffset                 0x3f
 #define STATISTICS_ID_VMM_PagedCompressedMemory                 0x40
-#define STATISTICS_ID_MAX                                       0x40
+#define STATISTICS_ID_VMMDLL_VfsOpen                            0x41
+#define STATISTICS_ID_VMMDLL_VfsClose                           0x42
+#define STATISTICS_ID_MAX                                       0x42
 #define STATISTICS_ID_NOLOG                                     0xffffffff
 
 static LPCSTR STATISTICS_ID_STR[] = {
@@ -201,6 +203,8 @@ static LPCSTR STATISTICS_ID_STR[] = {
     "VMMDLL_PdbTypeSize",
     "VMMDLL_PdbTypeChildOffset",
     "VMM_PagedCompressedMemory",
+    "VMMDLL_VfsOpen",
+    "VMMDLL_VfsClose",
 };
 
 VOID Statistics_CallSetEnabled(_In_ BOOL fEnabled);
@@ -38,6 +38,30 @@ PVMM_MAIN_CONTEXT ctxMain = NULL;
 // ----------------------------------------------------------------------------
 
 #define VMM_CACHE_GET_BUCKET(qwA)      ((VMM_CACHE_BUCKETS - 1) & ((qwA >> 12) + 13 * (qwA + _rotr16((WORD)qwA, 9) + _rotr((DWORD)qwA, 17) + _rotr64(qwA, 31))))
+#define VMM_CACHE_BUCKET_SHARD(r, iB)  (&(r)->L[(iB) & (VMM_CACHE_BUCKET_LOCKS - 1)])
+#define VMM_CACHE_BUCKET_LOCK(r, iB)   (&VMM_CACHE_BUCKET_SHARD(r, iB)->LockSRW)
+#define VMM_CACHE_IS_EXPIRED(t, pOb)   ((DWORD)((t)->dwTick - (pOb)->dwTick) >= VMM_CACHE_REGIONS)
+
+/*
+* Acquire/Release all bucket locks of a cache region. The region entry table
+* lock must be held by caller to avoid lock order inversion.
+* -- r
+*/
+VOID VmmCache_BucketLockAll(_In_ PVMM_CACHE_REGION r)
+{
+    DWORD i;
+    for(i = 0; i < VMM_CACHE_BUCKET_LOCKS; i++) {
+        AcquireSRWLockExclusive(&r->L[i].LockSRW);
+    }
+}
+
+VOID VmmCache_BucketUnlockAll(_In_ PVMM_CACHE_REGION r)
+{
+    DWORD i;
+    for(i = 0; i < VMM_CACHE_BUCKET_LOCKS; i++) {
+        ReleaseSRWLockExclusive(&r->L[i].LockSRW);
+    }
+}
 
 /*
 * Retrieve cache table from ctxVmm given a specific tag.
@@ -57,34 +81,70 @@ PVMM_CACHE_TABLE VmmCacheTableGet(_In_ DWORD wTblTag)
 }
 
 /*
-* Clear the oldest region of all InUse entries and make it the new active region.
+* Unlink an entry from its region bucket chain. The caller must hold the bucket
+* lock and must remove the region refcount of the object after releasing it.
+* -- r
+* -- pOb
+*/
+VOID VmmCache_UnlinkEntry(_In_ PVMM_CACHE_REGION r, _In_ PVMMOB_CACHE_MEM pOb)
+{
+    if(pOb->FLink) {
+        pOb->FLink->BLink = pOb->BLink;
+    }
+    if(pOb->BLink) {
+        pOb->BLink->FLink = pOb->FLink;
+    } else {
+        r->B[pOb->iB] = pOb->FLink;
+    }
+    pOb->fInUse = FALSE;
+}
+
+/*
+* Clear a cache region of all InUse entries.
+* The table lock must be held by caller.
+* -- t
+* -- iR
+*/
+VOID VmmCache_ClearRegion(_In_ PVMM_CACHE_TABLE t, _In_ DWORD iR)
+{
+    DWORD iE;
+    PVMMOB_CACHE_MEM pOb;
+    AcquireSRWLockExclusive(&t->R[iR].LockSRW);
+    VmmCache_BucketLockAll(&t->R[iR]);
+    for(iE = 0; iE < t->R[iR].cE; iE++) {
+        pOb = t->R[iR].E[iE];
+        if(pOb->fInUse) {
+            pOb->fInUse = FALSE;
+            // remove region refcount of object - callback will take care of
+            // re-insertion into empty list when refcount becomes low enough.
+            Ob_DECREF(pOb);
+        }
+    }
+    ZeroMemory(t->R[iR].B, VMM_CACHE_BUCKETS * sizeof(PVMMOB_CACHE_MEM));
+    VmmCache_BucketUnlockAll(&t->R[iR]);
+    ReleaseSRWLockExclusive(&t->R[iR].LockSRW);
+}
+
+/*
+* Advance the cache one refresh tick and make the oldest region the new active
+* region. Entries are not wiped region-wise; each entry expires individually
+* once it is VMM_CACHE_REGIONS ticks old and is then reclaimed one at a time -
+* on lookup or by the CLOCK hand in VmmCacheReserve.
 * -- wTblTag
 */
 VOID VmmCacheClearPartial(_In_ DWORD dwTblTag)
 {
     PVMM_CACHE_TABLE t;
-    PVMMOB_CACHE_MEM pOb;
-    PSLIST_ENTRY e;
-    DWORD iR;
     PVMM_PROCESS pObProcess = NULL;
     t = VmmCacheTableGet(dwTblTag);
     if(!t || !t->fActive) { return; }
     EnterCriticalSection(&t->Lock);
-    iR = (t->iR + (VMM_CACHE_REGIONS - 1)) % VMM_CACHE_REGIONS;
-    // 1: clear all entries from region
-    AcquireSRWLockExclusive(&t->R[iR].LockSRW);
-    while((e = InterlockedPopEntrySList(&t->R[iR].ListHeadInUse))) {
-        pOb = CONTAINING_RECORD(e, VMMOB_CACHE_MEM, SListInUse);
-        // remove region refcount of object - callback will take care of
-        // re-insertion into empty list when refcount becomes low enough.
-        Ob_DECREF(pOb);
-    }
-    ZeroMemory(t->R[iR].B, VMM_CACHE_BUCKETS * sizeof(PVMMOB_CACHE_MEM));
-    ReleaseSRWLockExclusive(&t->R[iR].LockSRW);
-    t->iR = iR;
+    InterlockedIncrement(&t->dwTick);
+    InterlockedIncrement(&t->dwGeneration);
+    t->iR = (t->iR + (VMM_CACHE_REGIONS - 1)) % VMM_CACHE_REGIONS;
     t->fAllActiveRegions = t->fAllActiveRegions || (t->iR == 0);
     LeaveCriticalSection(&t->Lock);
-    // 2: if tlb cache clear -> update process 'is spider done' flag
+    // if tlb cache tick -> update process 'is spider done' flag
     if(t->fAllActiveRegions && (dwTblTag == VMM_CACHE_TAG_TLB)) {
         while((pObProcess = VmmProcessGetNext(pObProcess, 0))) {
             if(pObProcess->fTlbSpiderDone) {
@@ -103,11 +163,40 @@ VOID VmmCacheClearPartial(_In_ DWORD dwTblTag)
 VOID VmmCacheClear(_In_ DWORD dwTblTag)
 {
     DWORD i;
+    PVMM_CACHE_TABLE t;
+    t = VmmCacheTableGet(dwTblTag);
+    if(!t || !t->fActive) { return; }
+    EnterCriticalSection(&t->Lock);
+    for(i = 0; i < VMM_CACHE_REGIONS; i++) {
+        VmmCache_ClearRegion(t, i);
+    }
+    LeaveCriticalSection(&t->Lock);
     for(i = 0; i < VMM_CACHE_REGIONS; i++) {
         VmmCacheClearPartial(dwTblTag);
     }
 }
 
+/*
+* Unlink an entry found to be expired on lookup.
+* -- t
+* -- pOb
+*/
+VOID VmmCache_ExpireEntry(_In_ PVMM_CACHE_TABLE t, _In_ PVMMOB_CACHE_MEM pOb)
+{
+    BOOL fUnlink;
+    PSRWLOCK pLockSRW;
+    pLockSRW = VMM_CACHE_BUCKET_LOCK(&t->R[pOb->iR], pOb->iB);
+    AcquireSRWLockExclusive(pLockSRW);
+    if((fUnlink = pOb->fInUse && VMM_CACHE_IS_EXPIRED(t, pOb))) {
+        VmmCache_UnlinkEntry(&t->R[pOb->iR], pOb);
+    }
+    ReleaseSRWLockExclusive(pLockSRW);
+    if(fUnlink) {
+        InterlockedIncrement64(&t->cExpire);
+        Ob_DECREF(pOb);     // remove region refcount of object
+    }
+}
+
 /*
 * Retrieve an item from the cache.
 * CALLER DECREF: return
@@ -119,6 +208,7 @@ VOID VmmCacheClear(_In_ DWORD dwTblTag)
 PVMMOB_CACHE_MEM VmmCacheGetEx(_In_ DWORD dwTblTag, _In_ QWORD qwA, _In_ BOOL fCurrentRegionOnly)
 {
     PVMM_CACHE_TABLE t;
+    PSRWLOCK pLockSRW;
     DWORD iB, iR, iRB, iRC;
     PVMMOB_CACHE_MEM pOb;
     t = VmmCacheTableGet(dwTblTag);
@@ -127,22 +217,55 @@ PVMMOB_CACHE_MEM VmmCacheGetEx(_In_ DWORD dwTblTag, _In_ QWORD qwA, _In_ BOOL fC
     iRB = t->iR;
     for(iRC = 0; iRC < VMM_CACHE_REGIONS; iRC++) {
         iR = (iRB + iRC) % VMM_CACHE_REGIONS;
-        AcquireSRWLockShared(&t->R[iR].LockSRW);
+        pLockSRW = VMM_CACHE_BUCKET_LOCK(&t->R[iR], iB);
+        AcquireSRWLockShared(pLockSRW);
         pOb = t->R[iR].B[iB];
         while(pOb && (pOb->h.qwA != qwA)) {
             pOb = pOb->FLink;
         }
+        if(pOb && VMM_CACHE_IS_EXPIRED(t, pOb)) {
+            // expired entry -> reclaim it and treat as miss.
+            Ob_INCREF(pOb);
+            ReleaseSRWLockShared(pLockSRW);
+            VmmCache_ExpireEntry(t, pOb);
+            Ob_DECREF(pOb);
+            if(fCurrentRegionOnly) { break; }
+            continue;
+        }
         if(pOb) {
+            if(!pOb->fReferenced) {
+                pOb->fReferenced = TRUE;
+            }
+            if(pOb->fSpeculative && InterlockedExchange((volatile LONG*)&pOb->fSpeculative, FALSE)) {
+                InterlockedIncrement64(&ctxVmm->stat.cPhysReadAheadUsed);
+            }
             Ob_INCREF(pOb);
-            ReleaseSRWLockShared(&t->R[iR].LockSRW);
+            ReleaseSRWLockShared(pLockSRW);
+            InterlockedIncrement64(&VMM_CACHE_BUCKET_SHARD(&t->R[iR], iB)->cHit);
             return pOb;
         }
-        ReleaseSRWLockShared(&t->R[iR].LockSRW);
+        ReleaseSRWLockShared(pLockSRW);
         if(fCurrentRegionOnly) { break; }
     }
+    InterlockedIncrement64(&VMM_CACHE_BUCKET_SHARD(&t->R[iRB], iB)->cMiss);
     return NULL;
 }
 
+VOID VmmCacheStatistics(_In_ DWORD dwTblTag, _Out_ PQWORD pcHit, _Out_ PQWORD pcMiss)
+{
+    DWORD iR, iL;
+    PVMM_CACHE_TABLE t;
+    *pcHit = 0;
+    *pcMiss = 0;
+    if(!(t = VmmCacheTableGet(dwTblTag))) { return; }
+    for(iR = 0; iR < VMM_CACHE_REGIONS; iR++) {
+        for(iL = 0; iL < VMM_CACHE_BUCKET_LOCKS; iL++) {
+            *pcHit += t->R[iR].L[iL].cHit;
+            *pcMiss += t->R[iR].L[iL].cMiss;
+        }
+    }
+}
+
 /*
 * Retrieve an item from the cache.
 * CALLER DECREF: return
@@ -174,33 +297,108 @@ VOID VmmCache_CallbackRefCount1(PVMMOB_CACHE_MEM pOb)
         return;
     }
     if(!t->fActive) { return; }
+    if(pOb->fSpeculative) {
+        pOb->fSpeculative = FALSE;
+        InterlockedIncrement64(&ctxVmm->stat.cPhysReadAheadWasted);
+    }
     Ob_INCREF(pOb);
     InterlockedPushEntrySList(&t->R[pOb->iR].ListHeadEmpty, &pOb->SListEmpty);
 }
 
+/*
+* Allocate a new cache entry and attach it to the region entry table.
+* CALLER DECREF SPECIAL: return
+* -- t
+* -- iR
+* -- return = fresh object with refcount = 2, or NULL on fail / region full.
+*/
+PVMMOB_CACHE_MEM VmmCache_AllocEntry(_In_ PVMM_CACHE_TABLE t, _In_ DWORD iR)
+{
+    PVMMOB_CACHE_MEM pOb;
+    PVMM_CACHE_REGION r = &t->R[iR];
+    pOb = Ob_Alloc(t->tag, LMEM_ZEROINIT, sizeof(VMMOB_CACHE_MEM), NULL, (OB_CLEANUP_CB)VmmCache_CallbackRefCount1);
+    if(!pOb) { return NULL; }
+    pOb->iR = iR;
+    pOb->h.version = MEM_SCATTER_VERSION;
+    pOb->h.cb = 0x1000;
+    pOb->h.pb = pOb->pb;
+    pOb->h.qwA = MEM_SCATTER_ADDR_INVALID;
+    AcquireSRWLockExclusive(&r->LockSRW);
+    if(r->cE >= VMM_CACHE_REGION_MEMS) {
+        ReleaseSRWLockExclusive(&r->LockSRW);
+        Ob_DECREF(pOb);
+        return NULL;
+    }
+    r->E[r->cE++] = Ob_INCREF(pOb);     // "entry table" reference
+    ReleaseSRWLockExclusive(&r->LockSRW);
+    return pOb;
+}
+
+/*
+* Evict a single cold entry from a cache region using the CLOCK (second chance)
+* algorithm. Entries which have been hit since the hand last passed have their
+* reference bit cleared and are skipped. The evicted entry is returned to the
+* empty list by the refcount callback once no reader holds a reference to it.
+* -- t
+* -- iR
+* -- return = TRUE if an entry was evicted, FALSE if no entry is evictable.
+*/
+_Success_(return)
+BOOL VmmCache_EvictClock(_In_ PVMM_CACHE_TABLE t, _In_ DWORD iR)
+{
+    DWORD cSweep;
+    BOOL fEvict = FALSE;
+    PSRWLOCK pLockSRW;
+    PVMMOB_CACHE_MEM pOb = NULL;
+    PVMM_CACHE_REGION r = &t->R[iR];
+    AcquireSRWLockExclusive(&r->LockSRW);
+    for(cSweep = 2 * r->cE; cSweep && !fEvict; cSweep--) {
+        if(r->iClock >= r->cE) { r->iClock = 0; }
+        pOb = r->E[r->iClock++];
+        if(!pOb->fInUse) { continue; }
+        if(pOb->fReferenced && !VMM_CACHE_IS_EXPIRED(t, pOb)) {
+            pOb->fReferenced = FALSE;
+            continue;
+        }
+        pLockSRW = VMM_CACHE_BUCKET_LOCK(r, pOb->iB);
+        AcquireSRWLockExclusive(pLockSRW);
+        if(pOb->fInUse) {
+            VmmCache_UnlinkEntry(r, pOb);
+            fEvict = TRUE;
+        }
+        ReleaseSRWLockExclusive(pLockSRW);
+    }
+    ReleaseSRWLockExclusive(&r->LockSRW);
+    if(!fEvict) { return FALSE; }
+    InterlockedIncrement64(&t->cEvict);
+    Ob_DECREF(pOb);     // remove region refcount of object
+    return TRUE;
+}
+
 PVMMOB_CACHE_MEM VmmCacheReserve(_In_ DWORD dwTblTag)
 {
     PVMM_CACHE_TABLE t;
     PVMMOB_CACHE_MEM pOb;
     PSLIST_ENTRY e;
+    DWORD iR;
     WORD cLoopProtect = 0;
     t = VmmCacheTableGet(dwTblTag);
     if(!t || !t->fActive) { return NULL; }
-    while(!(e = InterlockedPopEntrySList(&t->R[t->iR].ListHeadEmpty))) {
-        if(QueryDepthSList(&t->R[t->iR].ListHeadTotal) < VMM_CACHE_REGION_MEMS) {
+    while(!(e = InterlockedPopEntrySList(&t->R[(iR = t->iR)].ListHeadEmpty))) {
+        if(t->R[iR].cE < VMM_CACHE_REGION_MEMS) {
             // below max threshold -> create new
-            pOb = Ob_Alloc(t->tag, LMEM_ZEROINIT, sizeof(VMMOB_CACHE_MEM), NULL, (OB_CLEANUP_CB)VmmCache_CallbackRefCount1);
-            if(!pOb) { return NULL; }
-            pOb->iR = t->iR;
-            pOb->h.version = MEM_SCATTER_VERSION;
-            pOb->h.cb = 0x1000;
-            pOb->h.pb = pOb->pb;
-            pOb->h.qwA = MEM_SCATTER_ADDR_INVALID;
-            Ob_INCREF(pOb);  // "total list" reference
-            InterlockedPushEntrySList(&t->R[pOb->iR].ListHeadTotal, &pOb->SListTotal);
-            return pOb;         // return fresh object - refcount = 2.
-        }
-        // reclaim existing entries by clearing the oldest cache region.
+            if((pOb = VmmCache_AllocEntry(t, iR))) {
+                return pOb;     // return fresh object - refcount = 2.
+            }
+            if(t->R[iR].cE < VMM_CACHE_REGION_MEMS) { return NULL; }
+            continue;
+        }
+        // reclaim a single cold entry from the active region.
+        if(VmmCache_EvictClock(t, iR)) { continue; }
+        // no evictable entries (all checked out) -> clear the oldest region.
+        EnterCriticalSection(&t->Lock);
+        VmmCache_ClearRegion(t, (t->iR + (VMM_CACHE_REGIONS - 1)) % VMM_CACHE_REGIONS);
+        LeaveCriticalSection(&t->Lock);
         VmmCacheClearPartial(dwTblTag);
         if(++cLoopProtect == VMM_CACHE_REGIONS) {
             VmmLog(MID_VMM, LOGLEVEL_WARNING, "SHOULD NOT HAPPEN - CACHE %04X DRAINED OF ENTRIES", dwTblTag);
@@ -222,6 +420,7 @@ PVMMOB_CACHE_MEM VmmCacheReserve(_In_ DWORD dwTblTag)
 VOID VmmCacheReserveReturn(_In_opt_ PVMMOB_CACHE_MEM pOb)
 {
     PVMM_CACHE_TABLE t;
+    PSRWLOCK pLockSRW;
     if(!pOb) { return; }
     t = VmmCacheTableGet(((POB)pOb)->_tag);
     if(!t) {
@@ -236,14 +435,17 @@ VOID VmmCacheReserveReturn(_In_opt_ PVMMOB_CACHE_MEM pOb)
     }
     // insert into map - refcount will be overtaken by "cache region".
     pOb->iB = VMM_CACHE_GET_BUCKET(pOb->h.qwA);
-    AcquireSRWLockExclusive(&t->R[pOb->iR].LockSRW);
-    InterlockedPushEntrySList(&t->R[pOb->iR].ListHeadInUse, &pOb->SListInUse);
+    pLockSRW = VMM_CACHE_BUCKET_LOCK(&t->R[pOb->iR], pOb->iB);
+    AcquireSRWLockExclusive(pLockSRW);
+    pOb->fInUse = TRUE;
+    pOb->fReferenced = FALSE;
+    pOb->dwTick = t->dwTick;
     // insert into "bucket"
     pOb->BLink = NULL;
     pOb->FLink = t->R[pOb->iR].B[pOb->iB];
     if(pOb->FLink) { pOb->FLink->BLink = pOb; }
     t->R[pOb->iR].B[pOb->iB] = pOb;
-    ReleaseSRWLockExclusive(&t->R[pOb->iR].LockSRW);
+    ReleaseSRWLockExclusive(pLockSRW);
 }
 
 VOID VmmCacheClose(_In_ DWORD dwTblTag)
@@ -251,43 +453,45 @@ VOID VmmCacheClose(_In_ DWORD dwTblTag)
     PVMM_CACHE_TABLE t;
     PVMMOB_CACHE_MEM pOb;
     PSLIST_ENTRY e;
-    DWORD iR;
+    DWORD iR, iE;
     t = VmmCacheTableGet(dwTblTag);
     if(!t || !t->fActive) { return; }
     t->fActive = FALSE;
     EnterCriticalSection(&t->Lock);
     for(iR = 0; iR < VMM_CACHE_REGIONS; iR++) {
         AcquireSRWLockExclusive(&t->R[iR].LockSRW);
+        VmmCache_BucketLockAll(&t->R[iR]);
         // remove from "empty list"
         while((e = InterlockedPopEntrySList(&t->R[iR].ListHeadEmpty))) {
             pOb = CONTAINING_RECORD(e, VMMOB_CACHE_MEM, SListEmpty);
             Ob_DECREF(pOb);
         }
-        // remove from "in use list"
-        while((e = InterlockedPopEntrySList(&t->R[iR].ListHeadInUse))) {
-            pOb = CONTAINING_RECORD(e, VMMOB_CACHE_MEM, SListInUse);
-            Ob_DECREF(pOb);
-        }
-        // remove from "total list"
-        while((e = InterlockedPopEntrySList(&t->R[iR].ListHeadTotal))) {
-            pOb = CONTAINING_RECORD(e, VMMOB_CACHE_MEM, SListTotal);
+        // remove "in use" and "entry table" references
+        for(iE = 0; iE < t->R[iR].cE; iE++) {
+            pOb = t->R[iR].E[iE];
+            if(pOb->fInUse) {
+                pOb->fInUse = FALSE;
+                Ob_DECREF(pOb);
+            }
             Ob_DECREF(pOb);
         }
+        t->R[iR].cE = 0;
     }
     DeleteCriticalSection(&t->Lock);
 }
 
 VOID VmmCacheInitialize(_In_ DWORD dwTblTag)
 {
-    DWORD iR;
+    DWORD iR, iL;
     PVMM_CACHE_TABLE t;
     t = VmmCacheTableGet(dwTblTag);
     if(!t || t->fActive) { return; }
     for(iR = 0; iR < VMM_CACHE_REGIONS; iR++) {
         InitializeSRWLock(&t->R[iR].LockSRW);
+        for(iL = 0; iL < VMM_CACHE_BUCKET_LOCKS; iL++) {
+            InitializeSRWLock(&t->R[iR].L[iL].LockSRW);
+        }
         InitializeSListHead(&t->R[iR].ListHeadEmpty);
-        InitializeSListHead(&t->R[iR].ListHeadInUse);
-        InitializeSListHead(&t->R[iR].ListHeadTotal);
     }
     InitializeCriticalSection(&t->Lock);
     t->tag = dwTblTag;
@@ -299,24 +503,24 @@ VOID VmmCacheInitialize(_In_ DWORD dwTblTag)
 */
 VOID VmmCacheInvalidate_2(_In_ DWORD dwTblTag, _In_ QWORD qwA)
 {
+    BOOL fUnlink;
+    PSRWLOCK pLockSRW;
     PVMM_CACHE_TABLE t;
     PVMMOB_CACHE_MEM pOb;
     t = VmmCacheTableGet(dwTblTag);
     if(!t || !t->fActive) { return; }
+    InterlockedIncrement(&t->dwGeneration);
     while((pOb = VmmCacheGet(dwTblTag, qwA))) {
-        AcquireSRWLockExclusive(&t->R[pOb->iR].LockSRW);
-        // remove from bucket list
-        if(pOb->FLink) {
-            pOb->FLink->BLink = pOb->BLink;
+        pLockSRW = VMM_CACHE_BUCKET_LOCK(&t->R[pOb->iR], pOb->iB);
+        AcquireSRWLockExclusive(pLockSRW);
+        // remove from bucket list (if not already removed by other thread)
+        if((fUnlink = pOb->fInUse)) {
+            VmmCache_UnlinkEntry(&t->R[pOb->iR], pOb);
         }
-        if(pOb->BLink) {
-            pOb->BLink->FLink = pOb->FLink;
-        } else {
-            t->R[pOb->iR].B[pOb->iB] = pOb->FLink;
+        ReleaseSRWLockExclusive(pLockSRW);
+        if(fUnlink) {
+            Ob_DECREF(pOb);     // remove region refcount of object
         }
-        // NB! "leak" object - i.e. keep it on InUse list until the cache
-        //     region itself gets cleared. somewhat ugly, but simple...
-        ReleaseSRWLockExclusive(&t->R[pOb->iR].LockSRW);
         Ob_DECREF(pOb);
     }
 }
@@ -401,7 +605,97 @@ BOOL VmmVirt2PhysEx(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ QWORD va, _Out_
 {
     *ppa = 0;
     if(ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_NA) { return FALSE; }
-    return ctxVmm->fnMemoryModel.pfnVirt2Phys(paDTB, fUserOnly, -1, va, ppa);
+    return ctxVmm->fnMemoryModel.pfnVirt2Phys(paDTB, fUserOnly, -1, va, ppa, NULL);
+}
+
+#define VMM_VIRT2PHYS_CACHE_SET(va, cPageShift)     ((((va) >> (cPageShift)) + (cPageShift)) & (VMM_VIRT2PHYS_CACHE_SETS - 1))
+
+/*
+* Retrieve a translation from the per-process virtual to physical translation
+* cache. Only entries matching the DTB, the user-only/supervisor view and the
+* current TLB cache generation are valid. Large page entries are probed for all
+* page sizes present in cache.
+* -- pc
+* -- paDTB
+* -- fUserOnly
+* -- va
+* -- ppa
+* -- return
+*/
+_Success_(return)
+BOOL VmmVirt2PhysCache_Get(_In_ PVMM_VIRT2PHYS_CACHE pc, _In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ QWORD va, _Out_ PQWORD ppa)
+{
+    BOOL fResult = FALSE;
+    DWORD dwGeneration, dwShiftMask, cShift, iSet, iWay;
+    QWORD qwMask;
+    PVMM_VIRT2PHYS_CACHE_ENTRY pe;
+    dwGeneration = ctxVmm->Cache.TLB.dwGeneration;
+    AcquireSRWLockShared(&pc->LockSRW);
+    if((pc->paDTB == paDTB) && (pc->fUserOnly == fUserOnly)) {
+        dwShiftMask = pc->dwPageShiftMask;
+        for(cShift = 12; !fResult && dwShiftMask && (cShift < 32); cShift++) {
+            if(!(dwShiftMask & (1 << cShift))) { continue; }
+            dwShiftMask &= ~(1 << cShift);
+            qwMask = (1ULL << cShift) - 1;
+            iSet = VMM_VIRT2PHYS_CACHE_SET(va, cShift);
+            for(iWay = 0; iWay < VMM_VIRT2PHYS_CACHE_WAYS; iWay++) {
+                pe = &pc->E[iSet][iWay];
+                if((pe->cPageShift == cShift) && (pe->dwGeneration == dwGeneration) && (pe->va == (va & ~qwMask))) {
+                    // x86 (non-PAE) memory model returns page aligned addresses.
+                    if(ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_X86) { qwMask &= ~0xfff; }
+                    *ppa = pe->pa | (va & qwMask);
+                    fResult = TRUE;
+                    break;
+                }
+            }
+        }
+    }
+    ReleaseSRWLockShared(&pc->LockSRW);
+    return fResult;
+}
+
+/*
+* Insert a successful translation into the per-process translation cache. If
+* the DTB or the user-only/supervisor view has changed all existing entries
+* are dropped.
+* -- pc
+* -- paDTB
+* -- fUserOnly
+* -- dwGeneration = TLB cache generation read before the page table walk.
+* -- va
+* -- pa
+* -- cPageShift
+*/
+VOID VmmVirt2PhysCache_Put(_In_ PVMM_VIRT2PHYS_CACHE pc, _In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ DWORD dwGeneration, _In_ QWORD va, _In_ QWORD pa, _In_ DWORD cPageShift)
+{
+    DWORD iSet, iWay;
+    QWORD qwMask;
+    PVMM_VIRT2PHYS_CACHE_ENTRY pe = NULL;
+    if((cPageShift < 12) || (cPageShift > 31)) { return; }
+    qwMask = (1ULL << cPageShift) - 1;
+    iSet = VMM_VIRT2PHYS_CACHE_SET(va, cPageShift);
+    AcquireSRWLockExclusive(&pc->LockSRW);
+    if((pc->paDTB != paDTB) || (pc->fUserOnly != fUserOnly)) {
+        ZeroMemory(pc->E, sizeof(pc->E));
+        pc->paDTB = paDTB;
+        pc->fUserOnly = fUserOnly;
+        pc->dwPageShiftMask = 0;
+    }
+    for(iWay = 0; iWay < VMM_VIRT2PHYS_CACHE_WAYS; iWay++) {
+        if(pc->E[iSet][iWay].dwGeneration != dwGeneration) {
+            pe = &pc->E[iSet][iWay];
+            break;
+        }
+    }
+    if(!pe) {
+        pe = &pc->E[iSet][pc->iReplace++ & (VMM_VIRT2PHYS_CACHE_WAYS - 1)];
+    }
+    pe->va = va & ~qwMask;
+    pe->pa = pa & ~qwMask;
+    pe->dwGeneration = dwGeneration;
+    pe->cPageShift = cPageShift;
+    pc->dwPageShiftMask |= 1 << cPageShift;
+    ReleaseSRWLockExclusive(&pc->LockSRW);
 }
 
 /*
@@ -417,9 +711,67 @@ BOOL VmmVirt2PhysEx(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ QWORD va, _Out_
 _Success_(return)
 BOOL VmmVirt2Phys(_In_opt_ PVMM_PROCESS pProcess, _In_ QWORD va, _Out_ PQWORD ppa)
 {
+    DWORD dwGeneration, cPageShift = 0;
+    PVMM_VIRT2PHYS_CACHE pc;
     *ppa = 0;
     if(!pProcess || (ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_NA)) { return FALSE; }
-    return ctxVmm->fnMemoryModel.pfnVirt2Phys(pProcess->paDTB, pProcess->fUserOnly, -1, va, ppa);
+    if(!(pc = pProcess->pVirt2PhysCache)) {
+        return ctxVmm->fnMemoryModel.pfnVirt2Phys(pProcess->paDTB, pProcess->fUserOnly, -1, va, ppa, NULL);
+    }
+    if(VmmVirt2PhysCache_Get(pc, pProcess->paDTB, pProcess->fUserOnly, va, ppa)) {
+        InterlockedIncrement64(&ctxVmm->stat.cTlbVirt2PhysCacheHit);
+        return TRUE;
+    }
+    dwGeneration = ctxVmm->Cache.TLB.dwGeneration;
+    if(!ctxVmm->fnMemoryModel.pfnVirt2Phys(pProcess->paDTB, pProcess->fUserOnly, -1, va, ppa, &cPageShift)) { return FALSE; }
+    VmmVirt2PhysCache_Put(pc, pProcess->paDTB, pProcess->fUserOnly, dwGeneration, va, *ppa, cPageShift);
+    return TRUE;
+}
+
+int VmmVirt2PhysScatter_CmpSort(PPVMM_VIRT2PHYS_SCATTER a, PPVMM_VIRT2PHYS_SCATTER b)
+{
+    return ((*a)->va < (*b)->va) ? -1 : (((*a)->va > (*b)->va) ? 1 : 0);
+}
+
+/*
+* Translate multiple virtual addresses to physical addresses. Translations are
+* retrieved from the process translation cache (if possible). The remaining
+* addresses are sorted and translated in one batched page table walk by the
+* memory model. Entries with fSkip set are not translated.
+* -- pProcess
+* -- cV2P
+* -- pV2Ps = entries with va and fSkip set on entry; f, pa and cPageShift set on exit.
+* -- ppV2Ps = scratch buffer of cV2P pointers.
+*/
+VOID VmmVirt2PhysScatter(_In_ PVMM_PROCESS pProcess, _In_ DWORD cV2P, _Inout_updates_(cV2P) PVMM_VIRT2PHYS_SCATTER pV2Ps, _Out_writes_(cV2P) PPVMM_VIRT2PHYS_SCATTER ppV2Ps)
+{
+    DWORD i, cMiss = 0, dwGeneration;
+    PVMM_VIRT2PHYS_SCATTER pe;
+    PVMM_VIRT2PHYS_CACHE pc = pProcess->pVirt2PhysCache;
+    dwGeneration = ctxVmm->Cache.TLB.dwGeneration;
+    for(i = 0; i < cV2P; i++) {
+        pe = pV2Ps + i;
+        pe->f = FALSE;
+        pe->pa = 0;
+        pe->cPageShift = 0;
+        if(pe->fSkip) { continue; }
+        if(pc && VmmVirt2PhysCache_Get(pc, pProcess->paDTB, pProcess->fUserOnly, pe->va, &pe->pa)) {
+            InterlockedIncrement64(&ctxVmm->stat.cTlbVirt2PhysCacheHit);
+            pe->f = TRUE;
+            continue;
+        }
+        ppV2Ps[cMiss++] = pe;
+    }
+    if(!cMiss) { return; }
+    qsort(ppV2Ps, cMiss, sizeof(PVMM_VIRT2PHYS_SCATTER), (_CoreCrtNonSecureSearchSortCompareFunction)VmmVirt2PhysScatter_CmpSort);
+    ctxVmm->fnMemoryModel.pfnVirt2PhysScatter(pProcess->paDTB, pProcess->fUserOnly, cMiss, ppV2Ps);
+    if(pc) {
+        for(i = 0; i < cMiss; i++) {
+            if(ppV2Ps[i]->f) {
+                VmmVirt2PhysCache_Put(pc, pProcess->paDTB, pProcess->fUserOnly, dwGeneration, ppV2Ps[i]->va, ppV2Ps[i]->pa, ppV2Ps[i]->cPageShift);
+            }
+        }
+    }
 }
 
 /*
@@ -905,6 +1257,7 @@ VOID VmmProcess_CloseObCallback(_In_ PVOID pVmmOb)
     Ob_DECREF(pProcess->Map.pObHandle);
     Ob_DECREF(pProcess->Map.pObEvil);
     Ob_DECREF(pProcess->pObPersistent);
+    LocalFree(pProcess->pVirt2PhysCache);
     LocalFree(pProcess->win.TOKEN.szSID);
     // plugin cleanup below
     Ob_DECREF(pProcess->Plugin.pObCLdrModulesDisplayCache);
@@ -969,6 +1322,9 @@ PVMM_PROCESS VmmProcessClone(_In_ PVMM_PROCESS pProcess)
     if(!pObProcessClone) { return NULL; }
     memcpy((PBYTE)pObProcessClone + sizeof(OB), (PBYTE)pProcess + sizeof(OB), pProcess->ObHdr.cbData);
     pObProcessClone->pObProcessCloneParent = Ob_INCREF(pProcess);
+    // the clone may run with another fUserOnly view than its parent - it must
+    // not share (or free) the parent translation cache.
+    pObProcessClone->pVirt2PhysCache = NULL;
     InitializeCriticalSection(&pObProcessClone->LockUpdate);
     InitializeCriticalSection(&pObProcessClone->LockPlugin);
     InitializeCriticalSection(&pObProcessClone->Map.LockUpdateThreadExtendedInfo);
@@ -1042,6 +1398,9 @@ PVMM_PROCESS VmmProcessCreateEntry(_In_ BOOL fTotalRefresh, _In_ DWORD dwPID, _I
         pProcess->paDTB_UserOpt = paDTB_UserOpt;
         pProcess->fUserOnly = fUserOnly;
         pProcess->fTlbSpiderDone = pProcess->fTlbSpiderDone;
+        if((pProcess->pVirt2PhysCache = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_VIRT2PHYS_CACHE)))) {
+            InitializeSRWLock(&pProcess->pVirt2PhysCache->LockSRW);
+        }
         pProcess->Plugin.pObCLdrModulesDisplayCache = ObContainer_New();
         pProcess->Plugin.pObCPeDumpDirCache = ObContainer_New();
         pProcess->Plugin.pObCPhys2Virt = ObContainer_New();
@@ -1198,115 +1557,595 @@ BOOL VmmProcessTableCreateInitial()
 
 // ----------------------------------------------------------------------------
 // WORK (THREAD POOL) API:
-// The 'Work' thread pool contain by default 32 threads which is waiting to
+// The 'Work' thread pool contain by default one thread per processor core
+// (but at least VMM_WORK_THREADPOOL_NUM_THREADS_MIN threads) waiting to
 // receive work scheduled by calling the VmmWork function.
+// Each worker thread own a work-stealing deque (Chase-Lev). Work scheduled
+// from a worker thread is pushed onto its own deque while work scheduled from
+// other threads is put on a shared injection queue. Idle worker threads steal
+// work from the deques of the other worker threads. Work units are pooled.
 // ----------------------------------------------------------------------------
 
+#define VMMWORK_DEQUE_SIZE              0x100
+#define VMMWORK_DEQUE_MASK              (VMMWORK_DEQUE_SIZE - 1)
+#define VMMWORK_UNIT_FREE_MAX           0x100
+
+typedef struct tdVMMWORK_COUNTER {
+    DWORD cRemaining;               // remaining work units, event is set when zero.
+    HANDLE hEvent;
+} VMMWORK_COUNTER, *PVMMWORK_COUNTER;
+
 typedef struct tdVMMWORK_UNIT {
+    struct tdVMMWORK_UNIT *FLink;   // injection queue / free list link
     LPTHREAD_START_ROUTINE pfn;     // function to call
     PVOID ctx;                      // optional function parameter
     HANDLE hEventFinish;            // optional event to set when upon work completion
+    PVMMWORK_COUNTER pCounter;      // optional completion counter to decrement upon work completion
 } VMMWORK_UNIT, *PVMMWORK_UNIT;
 
 typedef struct tdVMMWORK_THREAD_CONTEXT {
     HANDLE hEventWakeup;
     HANDLE hThread;
+    DWORD iThread;
+    DWORD iSteal;
+    DWORD cUnitFree;
+    PVMMWORK_UNIT pUnitFree;        // thread-local work unit free list
+    // Chase-Lev work-stealing deque: owner push/pop at bottom, steal at top.
+    volatile LONGLONG iTop;
+    volatile LONGLONG iBottom;
+    PVMMWORK_UNIT Deque[VMMWORK_DEQUE_SIZE];
 } VMMWORK_THREAD_CONTEXT, *PVMMWORK_THREAD_CONTEXT;
 
+#ifdef _WIN32
+static __declspec(thread) PVMMWORK_THREAD_CONTEXT g_pVmmWorkThreadCurrent = NULL;
+#endif /* _WIN32 */
+#ifdef LINUX
+static __thread PVMMWORK_THREAD_CONTEXT g_pVmmWorkThreadCurrent = NULL;
+#endif /* LINUX */
+
+/*
+* Push a work unit onto the bottom of the deque. Only called by the owner.
+* -- pt
+* -- pu
+* -- return = FALSE if the deque is full.
+*/
+_Success_(return)
+BOOL VmmWork_DequePush(_In_ PVMMWORK_THREAD_CONTEXT pt, _In_ PVMMWORK_UNIT pu)
+{
+    LONGLONG b = pt->iBottom;
+    if(b - pt->iTop >= VMMWORK_DEQUE_SIZE) { return FALSE; }
+    pt->Deque[b & VMMWORK_DEQUE_MASK] = pu;
+    MemoryBarrier();
+    pt->iBottom = b + 1;
+    return TRUE;
+}
+
+/*
+* Pop a work unit from the bottom of the deque. Only called by the owner.
+* -- pt
+* -- return
+*/
+PVMMWORK_UNIT VmmWork_DequePop(_In_ PVMMWORK_THREAD_CONTEXT pt)
+{
+    LONGLONG t, b;
+    PVMMWORK_UNIT pu = NULL;
+    b = pt->iBottom - 1;
+    pt->iBottom = b;
+    MemoryBarrier();
+    t = pt->iTop;
+    if(t <= b) {
+        pu = pt->Deque[b & VMMWORK_DEQUE_MASK];
+        if(t == b) {
+            // last unit - race against thieves.
+            if(InterlockedCompareExchange64(&pt->iTop, t + 1, t) != t) {
+                pu = NULL;
+            }
+            pt->iBottom = b + 1;
+        }
+    } else {
+        pt->iBottom = b + 1;
+    }
+    return pu;
+}
+
+/*
+* Steal a work unit from the top of the deque. May be called by any thread.
+* -- pt
+* -- return
+*/
+PVMMWORK_UNIT VmmWork_DequeSteal(_In_ PVMMWORK_THREAD_CONTEXT pt)
+{
+    LONGLONG t, b;
+    PVMMWORK_UNIT pu;
+    t = pt->iTop;
+    MemoryBarrier();
+    b = pt->iBottom;
+    if(t >= b) { return NULL; }
+    pu = pt->Deque[t & VMMWORK_DEQUE_MASK];
+    if(InterlockedCompareExchange64(&pt->iTop, t + 1, t) != t) { return NULL; }
+    return pu;
+}
+
+/*
+* Retrieve a pooled work unit (or allocate a new one).
+*/
+PVMMWORK_UNIT VmmWork_UnitAlloc(_In_opt_ PVMMWORK_THREAD_CONTEXT pt)
+{
+    PVMMWORK_UNIT pu = NULL;
+    if(pt && (pu = pt->pUnitFree)) {
+        pt->pUnitFree = pu->FLink;
+        pt->cUnitFree--;
+        return pu;
+    }
+    AcquireSRWLockExclusive(&ctxVmm->Work.LockSRW);
+    if((pu = ctxVmm->Work.pUnitFree)) {
+        ctxVmm->Work.pUnitFree = pu->FLink;
+        ctxVmm->Work.cUnitFree--;
+    }
+    ReleaseSRWLockExclusive(&ctxVmm->Work.LockSRW);
+    return pu ? pu : LocalAlloc(0, sizeof(VMMWORK_UNIT));
+}
+
+/*
+* Return a work unit to the pool.
+*/
+VOID VmmWork_UnitFree(_In_opt_ PVMMWORK_THREAD_CONTEXT pt, _In_ PVMMWORK_UNIT pu)
+{
+    if(pt && (pt->cUnitFree < VMMWORK_UNIT_FREE_MAX)) {
+        pu->FLink = pt->pUnitFree;
+        pt->pUnitFree = pu;
+        pt->cUnitFree++;
+        return;
+    }
+    AcquireSRWLockExclusive(&ctxVmm->Work.LockSRW);
+    if(ctxVmm->Work.cUnitFree < VMMWORK_UNIT_FREE_MAX) {
+        pu->FLink = ctxVmm->Work.pUnitFree;
+        ctxVmm->Work.pUnitFree = pu;
+        ctxVmm->Work.cUnitFree++;
+        pu = NULL;
+    }
+    ReleaseSRWLockExclusive(&ctxVmm->Work.LockSRW);
+    LocalFree(pu);
+}
+
+/*
+* Signal completion of a work unit and return it to the pool.
+*/
+VOID VmmWork_UnitComplete(_In_opt_ PVMMWORK_THREAD_CONTEXT pt, _In_ PVMMWORK_UNIT pu)
+{
+    if(pu->hEventFinish) {
+        SetEvent(pu->hEventFinish);
+    }
+    if(pu->pCounter && !InterlockedDecrement(&pu->pCounter->cRemaining)) {
+        SetEvent(pu->pCounter->hEvent);
+    }
+    VmmWork_UnitFree(pt, pu);
+}
+
+/*
+* Retrieve the next work unit for a worker thread: own deque first, then the
+* injection queue and finally steal from the other worker threads.
+* -- pt
+* -- return
+*/
+PVMMWORK_UNIT VmmWork_UnitGet(_In_ PVMMWORK_THREAD_CONTEXT pt)
+{
+    DWORD i, cThread = ctxVmm->Work.cThread;
+    PVMMWORK_UNIT pu;
+    PVMMWORK_THREAD_CONTEXT ptVictim;
+    if((pu = VmmWork_DequePop(pt))) { return pu; }
+    if(ctxVmm->Work.pInjectFirst) {
+        AcquireSRWLockExclusive(&ctxVmm->Work.LockSRW);
+        if((pu = ctxVmm->Work.pInjectFirst)) {
+            if(!(ctxVmm->Work.pInjectFirst = pu->FLink)) {
+                ctxVmm->Work.pInjectLast = NULL;
+            }
+        }
+        ReleaseSRWLockExclusive(&ctxVmm->Work.LockSRW);
+        if(pu) { return pu; }
+    }
+    for(i = 0; i < cThread; i++) {
+        ptVictim = ctxVmm->Work.ppThread[(pt->iThread + 1 + pt->iSteal++) % cThread];
+        if((ptVictim != pt) && (pu = VmmWork_DequeSteal(ptVictim))) { return pu; }
+    }
+    return NULL;
+}
+
+/*
+* Check whether any work is queued (without retrieving it).
+*/
+BOOL VmmWork_UnitExists()
+{
+    DWORD i;
+    PVMMWORK_THREAD_CONTEXT pt;
+    if(ctxVmm->Work.pInjectFirst) { return TRUE; }
+    for(i = 0; i < ctxVmm->Work.cThread; i++) {
+        pt = ctxVmm->Work.ppThread[i];
+        if(pt->iTop < pt->iBottom) { return TRUE; }
+    }
+    return FALSE;
+}
+
 DWORD VmmWork_MainWorkerLoop_ThreadProc(PVMMWORK_THREAD_CONTEXT ctx)
 {
     PVMMWORK_UNIT pu;
+    g_pVmmWorkThreadCurrent = ctx;
     while(ctxVmm->Work.fEnabled) {
-        if((pu = (PVMMWORK_UNIT)ObSet_Pop(ctxVmm->Work.psUnit))) {
+        if((pu = VmmWork_UnitGet(ctx))) {
             ((DWORD(*)(LPVOID))pu->pfn)(pu->ctx);
-            if(pu->hEventFinish) {
-                SetEvent(pu->hEventFinish);
-            }
-            LocalFree(pu);
+            VmmWork_UnitComplete(ctx, pu);
         } else {
             ResetEvent(ctx->hEventWakeup);
             ObSet_Push(ctxVmm->Work.psThreadAvail, (QWORD)ctx);
+            // re-check for work queued before this thread became available.
+            if(VmmWork_UnitExists()) {
+                ObSet_Remove(ctxVmm->Work.psThreadAvail, (QWORD)ctx);
+                continue;
+            }
             WaitForSingleObject(ctx->hEventWakeup, INFINITE);
         }
     }
-    ObSet_Remove(ctxVmm->Work.psThreadAll, (QWORD)ctx);
-    CloseHandle(ctx->hEventWakeup);
-    CloseHandle(ctx->hThread);
-    LocalFree(ctx);
+    g_pVmmWorkThreadCurrent = NULL;
+    InterlockedDecrement(&ctxVmm->Work.cThreadAlive);
     return 1;
 }
 
+/*
+* Retrieve the number of worker threads to use; either as configured or one
+* per processor core.
+*/
+DWORD VmmWork_ThreadCount()
+{
+    DWORD c = ctxMain->cfg.cWorkThreads;
+    if(!c) {
+#ifdef _WIN32
+        SYSTEM_INFO SystemInfo;
+        GetSystemInfo(&SystemInfo);
+        c = SystemInfo.dwNumberOfProcessors;
+#endif /* _WIN32 */
+#ifdef LINUX
+        c = (DWORD)sysconf(_SC_NPROCESSORS_ONLN);
+#endif /* LINUX */
+    }
+    c = max(c, VMM_WORK_THREADPOOL_NUM_THREADS_MIN);
+    return min(c, VMM_WORK_THREADPOOL_NUM_THREADS_MAX);
+}
+
 VOID VmmWork_Initialize()
 {
+    DWORD i, cThread;
     PVMMWORK_THREAD_CONTEXT p;
+    cThread = VmmWork_ThreadCount();
+    InitializeSRWLock(&ctxVmm->Work.LockSRW);
     ctxVmm->Work.fEnabled = TRUE;
-    ctxVmm->Work.psUnit = ObSet_New();
-    ctxVmm->Work.psThreadAll = ObSet_New();
     ctxVmm->Work.psThreadAvail = ObSet_New();
-    while(ObSet_Size(ctxVmm->Work.psThreadAll) < VMM_WORK_THREADPOOL_NUM_THREADS) {
-        if((p = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWORK_THREAD_CONTEXT)))) {
-            p->hEventWakeup = CreateEvent(NULL, TRUE, FALSE, NULL);
-            p->hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)VmmWork_MainWorkerLoop_ThreadProc, p, 0, NULL);
-            ObSet_Push(ctxVmm->Work.psThreadAll, (QWORD)p);
+    ctxVmm->Work.psEventFree = ObSet_New();
+    if(!(ctxVmm->Work.ppThread = LocalAlloc(LMEM_ZEROINIT, cThread * sizeof(PVMMWORK_THREAD_CONTEXT)))) { return; }
+    for(i = 0; i < cThread; i++) {
+        if(!(p = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWORK_THREAD_CONTEXT)))) { break; }
+        p->iThread = i;
+        p->hEventWakeup = CreateEvent(NULL, TRUE, FALSE, NULL);
+        ctxVmm->Work.ppThread[i] = p;
+    }
+    // threads are started once all thread contexts exists since idle threads
+    // steal from each other.
+    ctxVmm->Work.cThread = i;
+    ctxVmm->Work.cThreadAlive = i;
+    for(i = 0; i < ctxVmm->Work.cThread; i++) {
+        p = ctxVmm->Work.ppThread[i];
+        p->hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)VmmWork_MainWorkerLoop_ThreadProc, p, 0, NULL);
+        if(!p->hThread) {
+            InterlockedDecrement(&ctxVmm->Work.cThreadAlive);
         }
     }
+    VmmLog(MID_VMM, LOGLEVEL_DEBUG, "WORK: %i worker threads", ctxVmm->Work.cThread);
 }
 
 VOID VmmWork_Close()
 {
+    DWORD i;
+    HANDLE hEvent;
     PVMMWORK_UNIT pu;
-    PVMMWORK_THREAD_CONTEXT pt = NULL;
+    PVMMWORK_THREAD_CONTEXT pt;
     ctxVmm->Work.fEnabled = FALSE;
-    while(ObSet_Size(ctxVmm->Work.psThreadAll)) {
-        while((pt = (PVMMWORK_THREAD_CONTEXT)ObSet_GetNext(ctxVmm->Work.psThreadAll, (QWORD)pt))) {
-            SetEvent(pt->hEventWakeup);
+    while(ctxVmm->Work.cThreadAlive) {
+        for(i = 0; i < ctxVmm->Work.cThread; i++) {
+            SetEvent(ctxVmm->Work.ppThread[i]->hEventWakeup);
         }
         SwitchToThread();
     }
-    while((pu = (PVMMWORK_UNIT)ObSet_Pop(ctxVmm->Work.psUnit))) {
-        if(pu->hEventFinish) {
-            SetEvent(pu->hEventFinish);
+    // complete (without running) remaining queued work and free pooled units.
+    for(i = 0; i < ctxVmm->Work.cThread; i++) {
+        pt = ctxVmm->Work.ppThread[i];
+        while((pu = VmmWork_DequePop(pt))) {
+            VmmWork_UnitComplete(NULL, pu);
+        }
+        while((pu = pt->pUnitFree)) {
+            pt->pUnitFree = pu->FLink;
+            LocalFree(pu);
         }
+    }
+    while((pu = ctxVmm->Work.pInjectFirst)) {
+        ctxVmm->Work.pInjectFirst = pu->FLink;
+        VmmWork_UnitComplete(NULL, pu);
+    }
+    ctxVmm->Work.pInjectLast = NULL;
+    while((pu = ctxVmm->Work.pUnitFree)) {
+        ctxVmm->Work.pUnitFree = pu->FLink;
         LocalFree(pu);
     }
-    Ob_DECREF_NULL(&ctxVmm->Work.psUnit);
-    Ob_DECREF_NULL(&ctxVmm->Work.psThreadAll);
+    for(i = 0; i < ctxVmm->Work.cThread; i++) {
+        pt = ctxVmm->Work.ppThread[i];
+        if(pt->hThread) { CloseHandle(pt->hThread); }
+        if(pt->hEventWakeup) { CloseHandle(pt->hEventWakeup); }
+        LocalFree(pt);
+    }
+    while((hEvent = (HANDLE)ObSet_Pop(ctxVmm->Work.psEventFree))) {
+        CloseHandle(hEvent);
+    }
+    LocalFree(ctxVmm->Work.ppThread);
+    ctxVmm->Work.ppThread = NULL;
+    ctxVmm->Work.cThread = 0;
     Ob_DECREF_NULL(&ctxVmm->Work.psThreadAvail);
+    Ob_DECREF_NULL(&ctxVmm->Work.psEventFree);
 }
 
-VOID VmmWork(_In_ LPTHREAD_START_ROUTINE pfn, _In_opt_ PVOID ctx, _In_opt_ HANDLE hEventFinish)
+/*
+* Schedule a work unit onto the work-stealing thread pool.
+* -- pfn
+* -- ctx
+* -- hEventFinish
+* -- pCounter
+* -- return
+*/
+_Success_(return)
+BOOL VmmWork_Submit(_In_ LPTHREAD_START_ROUTINE pfn, _In_opt_ PVOID ctx, _In_opt_ HANDLE hEventFinish, _In_opt_ PVMMWORK_COUNTER pCounter)
 {
     PVMMWORK_UNIT pu;
-    PVMMWORK_THREAD_CONTEXT pt;
-    if((pu = LocalAlloc(0, sizeof(VMMWORK_UNIT)))) {
-        pu->pfn = pfn;
-        pu->ctx = ctx;
-        pu->hEventFinish = hEventFinish;
-        ObSet_Push(ctxVmm->Work.psUnit, (QWORD)pu);
-        if((pt = (PVMMWORK_THREAD_CONTEXT)ObSet_Pop(ctxVmm->Work.psThreadAvail))) {
-            SetEvent(pt->hEventWakeup);
+    PVMMWORK_THREAD_CONTEXT pt, ptCurrent = g_pVmmWorkThreadCurrent;
+    if(!ctxVmm->Work.cThread || !(pu = VmmWork_UnitAlloc(ptCurrent))) { return FALSE; }
+    pu->FLink = NULL;
+    pu->pfn = pfn;
+    pu->ctx = ctx;
+    pu->hEventFinish = hEventFinish;
+    pu->pCounter = pCounter;
+    if(!ptCurrent || !VmmWork_DequePush(ptCurrent, pu)) {
+        AcquireSRWLockExclusive(&ctxVmm->Work.LockSRW);
+        if(ctxVmm->Work.pInjectLast) {
+            ctxVmm->Work.pInjectLast->FLink = pu;
+        } else {
+            ctxVmm->Work.pInjectFirst = pu;
         }
+        ctxVmm->Work.pInjectLast = pu;
+        ReleaseSRWLockExclusive(&ctxVmm->Work.LockSRW);
+    }
+    if((pt = (PVMMWORK_THREAD_CONTEXT)ObSet_Pop(ctxVmm->Work.psThreadAvail))) {
+        SetEvent(pt->hEventWakeup);
     }
+    return TRUE;
+}
+
+VOID VmmWork(_In_ LPTHREAD_START_ROUTINE pfn, _In_opt_ PVOID ctx, _In_opt_ HANDLE hEventFinish)
+{
+    VmmWork_Submit(pfn, ctx, hEventFinish, NULL);
 }
 
 VOID VmmWorkWaitMultiple(_In_opt_ PVOID ctx, _In_ DWORD cWork, ...)
 {
     DWORD i;
+    BOOL fLast = FALSE;
     va_list arguments;
-    HANDLE hEventFinish[MAXIMUM_WAIT_OBJECTS] = { 0 };
-    if(cWork > MAXIMUM_WAIT_OBJECTS) { return; }
+    LPTHREAD_START_ROUTINE pfn;
+    VMMWORK_COUNTER Counter = { 0 };
+    if(!cWork || (cWork > MAXIMUM_WAIT_OBJECTS)) { return; }
+    // completion events are pooled - set only by the unit completing last.
+    if(!(Counter.hEvent = (HANDLE)ObSet_Pop(ctxVmm->Work.psEventFree))) {
+        if(!(Counter.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL))) { return; }
+    }
+    ResetEvent(Counter.hEvent);
+    Counter.cRemaining = cWork;
     va_start(arguments, cWork);
     for(i = 0; i < cWork; i++) {
-        hEventFinish[i] = CreateEvent(NULL, TRUE, FALSE, NULL);
-        VmmWork(va_arg(arguments, LPTHREAD_START_ROUTINE), ctx, hEventFinish[i]);
+        pfn = va_arg(arguments, LPTHREAD_START_ROUTINE);
+        // the last work unit (and any unit failing to schedule) is run on the
+        // calling thread.
+        if((i == cWork - 1) || !VmmWork_Submit(pfn, ctx, NULL, &Counter)) {
+            ((DWORD(*)(LPVOID))pfn)(ctx);
+            fLast = !InterlockedDecrement(&Counter.cRemaining);
+        }
     }
     va_end(arguments);
-    WaitForMultipleObjects(cWork, hEventFinish, TRUE, INFINITE);
-    for(i = 0; i < cWork; i++) {
-        if(hEventFinish[i]) {
-            CloseHandle(hEventFinish[i]);
+    // wait unless the calling thread completed the last unit - in which case
+    // no worker thread will access the counter or signal the event.
+    if(!fLast) {
+        WaitForSingleObject(Counter.hEvent, INFINITE);
+    }
+    if(!ObSet_Push(ctxVmm->Work.psEventFree, (QWORD)Counter.hEvent)) {
+        CloseHandle(Counter.hEvent);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// PARALLEL-FOR FUNCTIONALITY:
+// Items are sorted by weight (heaviest first) and handed out in chunks of
+// decreasing total weight (guided scheduling) to the calling thread and the
+// worker threads. Each participating thread has its own partial result.
+// ----------------------------------------------------------------------------
+
+typedef struct tdVMMWORK_PARALLELFOR_SORT {
+    QWORD qwWeight;
+    DWORD iItem;
+} VMMWORK_PARALLELFOR_SORT, *PVMMWORK_PARALLELFOR_SORT;
+
+typedef struct tdVMMOB_WORK_PARALLELFOR {
+    OB ObHdr;
+    HANDLE hEventFinish;
+    PVOID ctx;
+    VOID(*pfnAction)(_In_opt_ PVOID ctx, _In_opt_ PVOID pvPartial, _In_ DWORD iItem);
+    PBOOL pfAbort;
+    BOOL fAbort;
+    DWORD cItem;
+    DWORD cThread;              // max # participating threads (incl. calling thread)
+    DWORD iCursor;              // next unclaimed index into piItem (interlocked)
+    DWORD cItemFinish;          // # finished/skipped items (interlocked)
+    DWORD cPartial;             // # partial results in use (interlocked)
+    DWORD cbPartial;            // size of partial result (16-byte aligned)
+    PQWORD pqwWeightSum;        // cumulative weight in piItem order [cItem + 1]
+    PDWORD piItem;              // item indexes sorted by weight
+    PBYTE pbPartial;            // cThread partial results
+} VMMOB_WORK_PARALLELFOR, *PVMMOB_WORK_PARALLELFOR;
+
+int VmmWorkParallelFor_CmpSort(PVMMWORK_PARALLELFOR_SORT a, PVMMWORK_PARALLELFOR_SORT b)
+{
+    if(a->qwWeight != b->qwWeight) {
+        return (a->qwWeight < b->qwWeight) ? 1 : -1;
+    }
+    return (a->iItem > b->iItem) ? 1 : -1;
+}
+
+VOID VmmWorkParallelFor_CleanupCB(_In_ PVMMOB_WORK_PARALLELFOR pOb)
+{
+    if(pOb->hEventFinish) {
+        CloseHandle(pOb->hEventFinish);
+    }
+}
+
+/*
+* Claim the next chunk of items [*piBegin, *piEnd). The chunk weight is a
+* share of the remaining weight so that chunks shrink towards the end.
+* -- ctx
+* -- piBegin
+* -- piEnd
+* -- return
+*/
+_Success_(return)
+BOOL VmmWorkParallelFor_Claim(_In_ PVMMOB_WORK_PARALLELFOR ctx, _Out_ PDWORD piBegin, _Out_ PDWORD piEnd)
+{
+    DWORD i, iLo, iHi, iMid;
+    QWORD qwTarget;
+    while((i = ctx->iCursor) < ctx->cItem) {
+        qwTarget = ctx->pqwWeightSum[i] + max(1, (ctx->pqwWeightSum[ctx->cItem] - ctx->pqwWeightSum[i]) / (2ULL * ctx->cThread));
+        iLo = i + 1;
+        iHi = ctx->cItem;
+        while(iLo < iHi) {
+            iMid = (iLo + iHi) / 2;
+            if(ctx->pqwWeightSum[iMid] >= qwTarget) {
+                iHi = iMid;
+            } else {
+                iLo = iMid + 1;
+            }
+        }
+        if(InterlockedCompareExchange(&ctx->iCursor, iLo, i) == i) {
+            *piBegin = i;
+            *piEnd = iLo;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+VOID VmmWorkParallelFor_DoWork(_In_ PVMMOB_WORK_PARALLELFOR ctx)
+{
+    DWORD i, iBegin, iEnd;
+    PVOID pvPartial = NULL;
+    while(VmmWorkParallelFor_Claim(ctx, &iBegin, &iEnd)) {
+        if(!pvPartial && ctx->pbPartial) {
+            pvPartial = ctx->pbPartial + (SIZE_T)(InterlockedIncrement(&ctx->cPartial) - 1) * ctx->cbPartial;
+        }
+        for(i = iBegin; i < iEnd; i++) {
+            if(ctx->fAbort || (ctx->pfAbort && *ctx->pfAbort) || !ctxVmm->Work.fEnabled) {
+                ctx->fAbort = TRUE;
+                continue;
+            }
+            ctx->pfnAction(ctx->ctx, pvPartial, ctx->piItem[i]);
+        }
+        if(InterlockedAdd(&ctx->cItemFinish, iEnd - iBegin) == ctx->cItem) {
+            SetEvent(ctx->hEventFinish);
+        }
+    }
+}
+
+DWORD VmmWorkParallelFor_ThreadProc(_In_ PVMMOB_WORK_PARALLELFOR pObCtx)
+{
+    VmmWorkParallelFor_DoWork(pObCtx);
+    Ob_DECREF(pObCtx);
+    return 1;
+}
+
+_Success_(return)
+BOOL VmmWorkParallelFor(
+    _In_opt_ PVOID ctx,
+    _In_ DWORD cItem,
+    _In_reads_opt_(cItem) PQWORD pqwWeight,
+    _In_ DWORD cbPartial,
+    _In_ VOID(*pfnAction)(_In_opt_ PVOID ctx, _In_opt_ PVOID pvPartial, _In_ DWORD iItem),
+    _In_opt_ VOID(*pfnReduceOpt)(_In_opt_ PVOID ctx, _In_ PVOID pvPartial),
+    _In_opt_ PBOOL pfAbortOpt
+) {
+    BOOL fResult = FALSE;
+    DWORD i, cThread;
+    SIZE_T cbPartialAll;
+    PVMMOB_WORK_PARALLELFOR pObCtx = NULL;
+    PVMMWORK_PARALLELFOR_SORT pSort = NULL;
+    if(!cItem) { return TRUE; }
+    cThread = max(1, min(cItem, ctxVmm->Work.cThread));
+    cbPartial = (cbPartial + 15) & ~15;
+    cbPartialAll = (SIZE_T)cThread * cbPartial;
+    // 1: allocate context: [ctx | weight sum | partial results | item indexes]
+    pObCtx = Ob_Alloc(
+        OB_TAG_VMM_WORK_PARALLELFOR, LMEM_ZEROINIT,
+        sizeof(VMMOB_WORK_PARALLELFOR) + 16 + (cItem + 1ULL) * sizeof(QWORD) + cbPartialAll + cItem * sizeof(DWORD),
+        (OB_CLEANUP_CB)VmmWorkParallelFor_CleanupCB, NULL);
+    if(!pObCtx) { goto fail; }
+    if(!(pObCtx->hEventFinish = CreateEvent(NULL, TRUE, FALSE, NULL))) { goto fail; }
+    pObCtx->ctx = ctx;
+    pObCtx->pfnAction = pfnAction;
+    pObCtx->pfAbort = pfAbortOpt;
+    pObCtx->cItem = cItem;
+    pObCtx->cThread = cThread;
+    pObCtx->cbPartial = cbPartial;
+    pObCtx->pqwWeightSum = (PQWORD)(((SIZE_T)(pObCtx + 1) + 15) & ~(SIZE_T)15);
+    pObCtx->pbPartial = cbPartial ? (PBYTE)(pObCtx->pqwWeightSum + cItem + 1) : NULL;
+    pObCtx->piItem = (PDWORD)((PBYTE)(pObCtx->pqwWeightSum + cItem + 1) + cbPartialAll);
+    // 2: sort items by weight (heaviest first) and calculate cumulative weight.
+    if(pqwWeight) {
+        if(!(pSort = LocalAlloc(0, cItem * sizeof(VMMWORK_PARALLELFOR_SORT)))) { goto fail; }
+        for(i = 0; i < cItem; i++) {
+            pSort[i].qwWeight = max(1, pqwWeight[i]);
+            pSort[i].iItem = i;
+        }
+        qsort(pSort, cItem, sizeof(VMMWORK_PARALLELFOR_SORT), (_CoreCrtNonSecureSearchSortCompareFunction)VmmWorkParallelFor_CmpSort);
+        for(i = 0; i < cItem; i++) {
+            pObCtx->piItem[i] = pSort[i].iItem;
+            pObCtx->pqwWeightSum[i + 1] = pObCtx->pqwWeightSum[i] + pSort[i].qwWeight;
+        }
+    } else {
+        for(i = 0; i < cItem; i++) {
+            pObCtx->piItem[i] = i;
+            pObCtx->pqwWeightSum[i + 1] = i + 1;
+        }
+    }
+    // 3: parallelize onto worker threads, participate on the calling thread
+    //    and wait for completion. worker threads starting late (after all
+    //    items are claimed) exit immediately.
+    for(i = 1; i < cThread; i++) {
+        VmmWork((LPTHREAD_START_ROUTINE)VmmWorkParallelFor_ThreadProc, Ob_INCREF(pObCtx), NULL);
+    }
+    VmmWorkParallelFor_DoWork(pObCtx);
+    if(pObCtx->cItemFinish != cItem) {
+        WaitForSingleObject(pObCtx->hEventFinish, INFINITE);
+    }
+    // 4: reduce partial results on the calling thread.
+    if(pfnReduceOpt && pObCtx->pbPartial) {
+        for(i = 0; i < pObCtx->cPartial; i++) {
+            pfnReduceOpt(ctx, pObCtx->pbPartial + (SIZE_T)i * cbPartial);
         }
     }
+    fResult = !pObCtx->fAbort;
+fail:
+    LocalFree(pSort);
+    Ob_DECREF(pObCtx);
+    return fResult;
 }
 
 // ----------------------------------------------------------------------------
@@ -1314,25 +2153,47 @@ VOID VmmWorkWaitMultiple(_In_opt_ PVOID ctx, _In_ DWORD cWork, ...)
 // ----------------------------------------------------------------------------
 
 typedef struct tdVMM_PROCESS_ACTION_FOREACH {
-    HANDLE hEventFinish;
     VOID(*pfnAction)(_In_ PVMM_PROCESS pProcess, _In_ PVOID ctx);
     PVOID ctxAction;
-    DWORD cRemainingWork;       // set to dwPIDs count on entry and decremented as-goes - when zero FinishEvent is set.
-    DWORD iPID;                 // set to dwPIDs count on entry and decremented as-goes
     DWORD dwPIDs[];
 } VMM_PROCESS_ACTION_FOREACH, *PVMM_PROCESS_ACTION_FOREACH;
 
-DWORD VmmProcessActionForeachParallel_ThreadProc(PVMM_PROCESS_ACTION_FOREACH ctx)
+/*
+* Retrieve the estimated relative cost of processing a process - used as the
+* parallel-for weight when distributing per-process work. The estimate is the
+* number of entries in the core VAD map for user-mode processes and in the PTE
+* map for other processes. Only maps already cached on the process are used -
+* no map is created since the weights are retrieved serially before the
+* parallel work starts. A process without map gets the weight 1.
+* -- pProcess
+* -- return
+*/
+QWORD VmmProcessWeight(_In_ PVMM_PROCESS pProcess)
+{
+    QWORD qwWeight = 1;
+    PVMMOB_MAP_VAD pObVadMap = NULL;
+    PVMMOB_MAP_PTE pObPteMap = NULL;
+    EnterCriticalSection(&pProcess->LockUpdate);
+    if(pProcess->fUserOnly) {
+        pObVadMap = Ob_INCREF(pProcess->Map.pObVad);
+    } else {
+        pObPteMap = Ob_INCREF(pProcess->Map.pObPte);
+    }
+    LeaveCriticalSection(&pProcess->LockUpdate);
+    if(pObVadMap) { qwWeight += pObVadMap->cMap; }
+    if(pObPteMap) { qwWeight += pObPteMap->cMap; }
+    Ob_DECREF(pObVadMap);
+    Ob_DECREF(pObPteMap);
+    return qwWeight;
+}
+
+VOID VmmProcessActionForeachParallel_Action(_In_ PVMM_PROCESS_ACTION_FOREACH ctx, _In_opt_ PVOID pvPartial, _In_ DWORD iItem)
 {
-    PVMM_PROCESS pObProcess = VmmProcessGet(ctx->dwPIDs[InterlockedDecrement(&ctx->iPID)]);
+    PVMM_PROCESS pObProcess = VmmProcessGet(ctx->dwPIDs[iItem]);
     if(pObProcess) {
         ctx->pfnAction(pObProcess, ctx->ctxAction);
         Ob_DECREF(pObProcess);
     }
-    if(0 == InterlockedDecrement(&ctx->cRemainingWork)) {
-        SetEvent(ctx->hEventFinish);
-    }
-    return 1;
 }
 
 BOOL VmmProcessActionForeachParallel_CriteriaActiveOnly(_In_ PVMM_PROCESS pProcess, _In_opt_ PVOID ctx)
@@ -1348,40 +2209,317 @@ BOOL VmmProcessActionForeachParallel_CriteriaActiveUserOnly(_In_ PVMM_PROCESS pP
 VOID VmmProcessActionForeachParallel(_In_opt_ PVOID ctxAction, _In_opt_ BOOL(*pfnCriteria)(_In_ PVMM_PROCESS pProcess, _In_opt_ PVOID ctx), _In_ VOID(*pfnAction)(_In_ PVMM_PROCESS pProcess, _In_opt_ PVOID ctx))
 {
     DWORD i, cProcess;
+    PQWORD pqwWeight = NULL;
     PVMM_PROCESS pObProcess = NULL;
     POB_SET pObProcessSelectedSet = NULL;
     PVMM_PROCESS_ACTION_FOREACH ctx = NULL;
     // 1: select processes to queue using criteria function
     if(!(pObProcessSelectedSet = ObSet_New())) { goto fail; }
     while((pObProcess = VmmProcessGetNext(pObProcess, VMM_FLAG_PROCESS_SHOW_TERMINATED))) {
-        if(!pfnCriteria || pfnCriteria(pObProcess, ctx)) {
+        if(!pfnCriteria || pfnCriteria(pObProcess, ctxAction)) {
             ObSet_Push(pObProcessSelectedSet, pObProcess->dwPID);
         }
     }
     if(!(cProcess = ObSet_Size(pObProcessSelectedSet))) { goto fail; }
-    // 2: set up context for worker function
+    // 2: set up context and weights for worker function
     if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_PROCESS_ACTION_FOREACH) + cProcess * sizeof(DWORD)))) { goto fail; }
-    if(!(ctx->hEventFinish = CreateEvent(NULL, TRUE, FALSE, NULL))) { goto fail; }
+    if(!(pqwWeight = LocalAlloc(0, cProcess * sizeof(QWORD)))) { goto fail; }
     ctx->pfnAction = pfnAction;
     ctx->ctxAction = ctxAction;
-    ctx->cRemainingWork = cProcess;
-    ctx->iPID = cProcess;
     for(i = 0; i < cProcess; i++) {
         ctx->dwPIDs[i] = (DWORD)ObSet_Pop(pObProcessSelectedSet);
+        pqwWeight[i] = 1;
+        if((pObProcess = VmmProcessGet(ctx->dwPIDs[i]))) {
+            pqwWeight[i] = VmmProcessWeight(pObProcess);
+            Ob_DECREF_NULL(&pObProcess);
+        }
     }
     // 3: parallelize onto worker threads and wait for completion
-    for(i = 0; i < cProcess; i++) {
-        VmmWork((PTHREAD_START_ROUTINE)VmmProcessActionForeachParallel_ThreadProc, ctx, NULL);
-    }
-    WaitForSingleObject(ctx->hEventFinish, INFINITE);
+    VmmWorkParallelFor(ctx, cProcess, pqwWeight, 0, (VOID(*)(PVOID, PVOID, DWORD))VmmProcessActionForeachParallel_Action, NULL, NULL);
 fail:
     Ob_DECREF(pObProcessSelectedSet);
-    if(ctx) {
-        if(ctx->hEventFinish) {
-            CloseHandle(ctx->hEventFinish);
+    LocalFree(pqwWeight);
+    LocalFree(ctx);
+}
+
+// ----------------------------------------------------------------------------
+// SEQUENTIAL FILE STREAM READ-AHEAD FUNCTIONALITY:
+// Sequentially read file streams are read ahead in chunks by a work item into
+// a bounded per-stream buffer. The stream generation is incremented on seek or
+// invalidation which cancels the work item at the next chunk boundary.
+// ----------------------------------------------------------------------------
+
+/*
+* Discard buffered data of a stream and cancel any read-ahead in progress.
+* NB! must be called with ctxVmm->Cache.ReadStream.Lock held.
+* -- s
+* -- fSeek = reset the sequential access detection.
+*/
+VOID VmmReadStream_Reset(_In_ PVMM_READSTREAM_ENTRY s, _In_ BOOL fSeek)
+{
+    s->dwGeneration++;
+    s->fPending = FALSE;
+    s->cbBuffer = 0;
+    SetEvent(s->hEventChunk);
+    if(fSeek) {
+        s->cSequential = 0;
+        s->cbWindow = 0;
+    }
+}
+
+/*
+* Free a stream and its buffer. Any read-ahead in progress is cancelled.
+* NB! must be called with ctxVmm->Cache.ReadStream.Lock held.
+* -- s
+*/
+VOID VmmReadStream_Free(_In_ PVMM_READSTREAM_ENTRY s)
+{
+    VmmReadStream_Reset(s, TRUE);
+    Ob_DECREF_NULL(&s->pObCtx);
+    LocalFree(s->pbBuffer);
+    s->pbBuffer = NULL;
+    s->cbBufferAlloc = 0;
+    s->qwId = 0;
+    s->qwHandleId = 0;
+    s->qwAccess = 0;
+    s->pfnRead = NULL;
+    s->cbFile = 0;
+}
+
+/*
+* Worker thread read-ahead function. Chunks are read with the synchronous read
+* function of the stream and appended to the stream buffer as they complete.
+* -- pv = stream index (low dword) and stream generation (high dword).
+* -- return
+*/
+DWORD VmmReadStream_ThreadProc(_In_ PVOID pv)
+{
+    BOOL fChunk = FALSE;
+    DWORD cb = 0, cbDiscard;
+    QWORD cbOffset = 0, cbOffsetKeep;
+    POB pObCtx = NULL;
+    PVMM_READSTREAM_PFN pfnRead = NULL;
+    PVMM_READSTREAM prs = &ctxVmm->Cache.ReadStream;
+    PVMM_READSTREAM_ENTRY s = prs->S + ((DWORD)(QWORD)pv % VMM_READSTREAM_STREAMS);
+    DWORD dwGeneration = (DWORD)((QWORD)pv >> 32);
+    PBYTE pbChunk = LocalAlloc(0, VMM_READSTREAM_CHUNK);
+    while(TRUE) {
+        EnterCriticalSection(&prs->Lock);
+        if(s->dwGeneration != dwGeneration) {
+            // stream seek/invalidate/replace -> cancel
+            LeaveCriticalSection(&prs->Lock);
+            break;
+        }
+        // 1: append chunk to stream buffer (discard data behind stream position if required)
+        if(fChunk && (cbOffset == s->cbOffsetBuffer + s->cbBuffer)) {
+            if(s->cbBuffer + cb > s->cbBufferAlloc) {
+                cbOffsetKeep = (s->cbOffsetNext > VMM_READSTREAM_BACKLOG) ? (s->cbOffsetNext - VMM_READSTREAM_BACKLOG) : 0;
+                cbDiscard = (cbOffsetKeep > s->cbOffsetBuffer) ? (DWORD)min(s->cbBuffer, cbOffsetKeep - s->cbOffsetBuffer) : 0;
+                memmove(s->pbBuffer, s->pbBuffer + cbDiscard, s->cbBuffer - cbDiscard);
+                s->cbOffsetBuffer += cbDiscard;
+                s->cbBuffer -= cbDiscard;
+            }
+            if(s->cbBuffer + cb <= s->cbBufferAlloc) {
+                memcpy(s->pbBuffer + s->cbBuffer, pbChunk, cb);
+                s->cbBuffer += cb;
+            }
+            SetEvent(s->hEventChunk);
+        }
+        // 2: fetch next chunk - stop if done, buffer full, reader has overtaken
+        //    the read-ahead or on shutdown.
+        cbOffset = s->cbOffsetBuffer + s->cbBuffer;
+        fChunk = pbChunk && ctxVmm->Work.fEnabled &&
+            (cbOffset < s->cbOffsetPendingEnd) && (cbOffset + VMM_READSTREAM_BACKLOG >= s->cbOffsetNext) &&
+            (s->cbOffsetPendingEnd + VMM_READSTREAM_BACKLOG <= s->cbOffsetNext + s->cbBufferAlloc);
+        if(fChunk) {
+            cb = (DWORD)min(VMM_READSTREAM_CHUNK, s->cbOffsetPendingEnd - cbOffset);
+            s->cbOffsetInflightEnd = cbOffset + cb;
+            pfnRead = s->pfnRead;
+            pObCtx = Ob_INCREF(s->pObCtx);
+            ResetEvent(s->hEventChunk);
+        } else {
+            s->fPending = FALSE;
+            SetEvent(s->hEventChunk);
+        }
+        LeaveCriticalSection(&prs->Lock);
+        if(!fChunk) { break; }
+        pfnRead(pObCtx, pbChunk, cb, cbOffset);
+        Ob_DECREF_NULL(&pObCtx);
+    }
+    LocalFree(pbChunk);
+    return 0;
+}
+
+VOID VmmReadStream(
+    _In_ QWORD qwStreamId,
+    _In_ QWORD qwHandleId,
+    _In_ PVMM_READSTREAM_PFN pfnRead,
+    _In_opt_ POB pObCtx,
+    _In_ QWORD cbFile,
+    _Out_writes_(cb) PBYTE pb,
+    _In_ DWORD cb,
+    _Out_opt_ PDWORD pcbReadOpt,
+    _In_ QWORD cbOffset
+) {
+    HANDLE hEventChunk;
+    DWORD i, cbHit = 0, cbBuffered, cbAlloc, cWait = 0, dwGeneration;
+    QWORD qwWork = 0, cbOffsetBufferEnd, qwTickCount;
+    PVMM_READSTREAM_ENTRY s = NULL, sLRU = NULL, se;
+    PVMM_READSTREAM prs = &ctxVmm->Cache.ReadStream;
+    // 1: clamp read to file size
+    if(pcbReadOpt) { *pcbReadOpt = 0; }
+    if(!cb || (cbOffset >= cbFile)) { return; }
+    cb = (DWORD)min(cb, cbFile - cbOffset);
+    if(pcbReadOpt) { *pcbReadOpt = cb; }
+    if(!prs->cTrigger || !prs->cbReadAhead || !ctxVmm->Work.fEnabled) {
+        pfnRead(pObCtx, pb, cb, cbOffset);
+        return;
+    }
+    EnterCriticalSection(&prs->Lock);
+    // 2: locate stream (file + handle) - or replace least recently used stream.
+    //    other streams idle for too long are freed along the way.
+    qwTickCount = GetTickCount64();
+    for(i = 0; i < VMM_READSTREAM_STREAMS; i++) {
+        se = prs->S + i;
+        if((se->qwId == qwStreamId) && (se->qwHandleId == qwHandleId)) {
+            s = se;
+        } else if(se->qwId && !se->fPending && (qwTickCount - se->qwTickAccess > VMM_READSTREAM_IDLE_MS)) {
+            VmmReadStream_Free(se);
+        }
+        if(!sLRU || (se->qwAccess < sLRU->qwAccess)) {
+            sLRU = se;
+        }
+    }
+    if(!s) { s = sLRU; }
+    if((s->qwId != qwStreamId) || (s->qwHandleId != qwHandleId) || (s->pfnRead != pfnRead) || (s->pObCtx != pObCtx) || (s->cbFile != cbFile)) {
+        VmmReadStream_Reset(s, TRUE);
+        Ob_DECREF(s->pObCtx);
+        s->pObCtx = Ob_INCREF(pObCtx);
+        s->qwId = qwStreamId;
+        s->qwHandleId = qwHandleId;
+        s->pfnRead = pfnRead;
+        s->cbFile = cbFile;
+        s->cbOffsetNext = cbOffset;
+    }
+    s->qwAccess = ++prs->qwAccess;
+    s->qwTickAccess = qwTickCount;
+    // 3: sequential access detection - reads close to the expected offset are
+    //    sequential (tolerate out-of-order reads by multi-threaded readers),
+    //    other reads are seeks.
+    if((cbOffset + VMM_READSTREAM_BACKLOG >= s->cbOffsetNext) && (cbOffset <= s->cbOffsetNext + VMM_READSTREAM_BACKLOG)) {
+        s->cSequential++;
+        s->cbOffsetNext = max(s->cbOffsetNext, cbOffset + cb);
+    } else {
+        VmmReadStream_Reset(s, TRUE);
+        s->cbOffsetNext = cbOffset + cb;
+    }
+    // 4: read from buffered read-ahead data - wait for the in-flight chunk if
+    //    it contains the data rather than reading the same data twice.
+    while(TRUE) {
+        cbOffsetBufferEnd = s->cbOffsetBuffer + s->cbBuffer;
+        if(s->cbBuffer && (cbOffset + cbHit >= s->cbOffsetBuffer) && (cbOffset + cbHit < cbOffsetBufferEnd)) {
+            cbBuffered = (DWORD)min(cb - cbHit, cbOffsetBufferEnd - cbOffset - cbHit);
+            memcpy(pb + cbHit, s->pbBuffer + (cbOffset + cbHit - s->cbOffsetBuffer), cbBuffered);
+            cbHit += cbBuffered;
+        }
+        if((cbHit == cb) || !s->fPending || (cWait++ > 2) || (cbOffset + cbHit < cbOffsetBufferEnd) || (cbOffset + cbHit >= s->cbOffsetInflightEnd)) {
+            break;
+        }
+        hEventChunk = s->hEventChunk;
+        dwGeneration = s->dwGeneration;
+        LeaveCriticalSection(&prs->Lock);
+        WaitForSingleObject(hEventChunk, VMM_READSTREAM_WAIT_MS);
+        EnterCriticalSection(&prs->Lock);
+        if((s->qwId != qwStreamId) || (s->qwHandleId != qwHandleId) || (s->dwGeneration != dwGeneration)) {
+            LeaveCriticalSection(&prs->Lock);
+            goto finish;
+        }
+    }
+    // 5: schedule read-ahead if stream is sequential and less than half the
+    //    read-ahead window is buffered ahead of the stream position. The
+    //    window starts at one chunk and is doubled for each read-ahead.
+    if((s->cSequential >= prs->cTrigger) && !s->fPending) {
+        cbAlloc = min(VMM_READSTREAM_SIZE_MAX, max(VMM_READSTREAM_CHUNK, prs->cbReadAhead)) + VMM_READSTREAM_BACKLOG;
+        s->cbWindow = min(cbAlloc - VMM_READSTREAM_BACKLOG, max(VMM_READSTREAM_CHUNK, s->cbWindow));
+        if(s->cbBufferAlloc != cbAlloc) {
+            LocalFree(s->pbBuffer);
+            s->pbBuffer = LocalAlloc(0, cbAlloc);
+            s->cbBufferAlloc = s->pbBuffer ? cbAlloc : 0;
+            s->cbBuffer = 0;
+        }
+        cbOffsetBufferEnd = s->cbOffsetBuffer + s->cbBuffer;
+        if(!s->cbBuffer || (cbOffsetBufferEnd < s->cbOffsetNext)) {
+            s->cbBuffer = 0;
+            s->cbOffsetBuffer = cbOffsetBufferEnd = s->cbOffsetNext;
+        }
+        if(s->pbBuffer && (cbOffsetBufferEnd < cbFile) && (cbOffsetBufferEnd - s->cbOffsetNext < s->cbWindow / 2)) {
+            s->cbOffsetPendingEnd = min(cbFile, s->cbOffsetNext + s->cbWindow);
+            s->cbWindow = min(cbAlloc - VMM_READSTREAM_BACKLOG, s->cbWindow << 1);
+            s->fPending = TRUE;
+            qwWork = ((QWORD)s->dwGeneration << 32) | (QWORD)(s - prs->S);
+        }
+    }
+    LeaveCriticalSection(&prs->Lock);
+    if(qwWork) {
+        VmmWork((LPTHREAD_START_ROUTINE)VmmReadStream_ThreadProc, (PVOID)qwWork, NULL);
+    }
+finish:
+    // 6: read remaining data synchronously
+    if(cbHit < cb) {
+        pfnRead(pObCtx, pb + cbHit, cb - cbHit, cbOffset + cbHit);
+    }
+}
+
+VOID VmmReadStream_Invalidate()
+{
+    DWORD i;
+    QWORD qwTickCount = GetTickCount64();
+    PVMM_READSTREAM_ENTRY s;
+    PVMM_READSTREAM prs = &ctxVmm->Cache.ReadStream;
+    EnterCriticalSection(&prs->Lock);
+    for(i = 0; i < VMM_READSTREAM_STREAMS; i++) {
+        s = prs->S + i;
+        if(s->qwId && (qwTickCount - s->qwTickAccess > VMM_READSTREAM_IDLE_MS)) {
+            VmmReadStream_Free(s);
+        } else {
+            VmmReadStream_Reset(s, FALSE);
+        }
+    }
+    LeaveCriticalSection(&prs->Lock);
+}
+
+VOID VmmReadStream_CloseHandle(_In_ QWORD qwHandleId)
+{
+    DWORD i;
+    PVMM_READSTREAM prs = &ctxVmm->Cache.ReadStream;
+    if(!qwHandleId) { return; }
+    EnterCriticalSection(&prs->Lock);
+    for(i = 0; i < VMM_READSTREAM_STREAMS; i++) {
+        if(prs->S[i].qwId && (prs->S[i].qwHandleId == qwHandleId)) {
+            VmmReadStream_Free(prs->S + i);
+        }
+    }
+    LeaveCriticalSection(&prs->Lock);
+}
+
+/*
+* Free file stream read-ahead buffers. Worker threads must have been stopped.
+*/
+VOID VmmReadStream_Close()
+{
+    DWORD i;
+    PVMM_READSTREAM_ENTRY s;
+    for(i = 0; i < VMM_READSTREAM_STREAMS; i++) {
+        s = ctxVmm->Cache.ReadStream.S + i;
+        Ob_DECREF_NULL(&s->pObCtx);
+        LocalFree(s->pbBuffer);
+        s->pbBuffer = NULL;
+        if(s->hEventChunk) {
+            CloseHandle(s->hEventChunk);
+            s->hEventChunk = NULL;
         }
-        LocalFree(ctx);
     }
+    DeleteCriticalSection(&ctxVmm->Cache.ReadStream.Lock);
 }
 
 // ----------------------------------------------------------------------------
@@ -1435,17 +2573,83 @@ VOID VmmWriteScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_ PPMEM_SCATTER pp
     if(fProcessMagicHandle) { Ob_DECREF(pProcess); }
 }
 
+/*
+* Retrieve the number of read-ahead pages for a physical read given the first
+* and last cache miss of the read. The first miss is matched against tracked
+* access streams (sequential or strided). A stream continuing as predicted has
+* its read-ahead window grown while a stream skipping past its prediction has
+* its window shrunk. Misses not belonging to a stream are compared against the
+* recent miss history to detect new streams - random access won't read-ahead.
+* The access pattern state is sharded by thread id - a thread always uses the
+* same shard so concurrent readers rarely contend on the shard lock.
+* -- paFirst = address of first cache miss in read.
+* -- paLast = address of last cache miss in read.
+* -- cMax = max number of read-ahead pages.
+* -- pcbStride = stride between read-ahead pages (starting after paLast).
+* -- return = number of read-ahead pages (0 = no read-ahead).
+*/
+DWORD VmmReadAhead_Window(_In_ QWORD paFirst, _In_ QWORD paLast, _In_ DWORD cMax, _Out_ PQWORD pcbStride)
+{
+    DWORD i, c = 0;
+    QWORD pa, cbStride = 0;
+    PVMM_READAHEAD_STREAM s = NULL, se;
+    PVMM_READAHEAD ra = &ctxVmm->Cache.ReadAhead[((DWORD)(GetCurrentThreadId() * 0x9e3779b1) >> 16) & (VMM_READAHEAD_SHARDS - 1)];
+    paFirst &= ~0xfff;
+    paLast &= ~0xfff;
+    *pcbStride = 0;
+    AcquireSRWLockExclusive(&ra->LockSRW);
+    // 1: match existing stream
+    for(i = 0; i < VMM_READAHEAD_STREAMS; i++) {
+        se = &ra->S[i];
+        if(!se->cbStride) { continue; }
+        if(paFirst == se->paNext) {
+            se->cWindow = min(VMM_READAHEAD_WINDOW_MAX, se->cWindow << 1);
+            s = se;
+            break;
+        }
+        if((paFirst > se->paNext) && (paFirst <= se->paNext + se->cWindow * se->cbStride)) {
+            se->cWindow = max(VMM_READAHEAD_WINDOW_MIN, se->cWindow >> 1);
+            s = se;
+            break;
+        }
+    }
+    // 2: detect new stream from recent misses (smallest positive stride wins)
+    if(!s) {
+        for(i = 0; i < VMM_READAHEAD_HISTORY; i++) {
+            pa = ra->History[i];
+            if(pa && (paFirst > pa) && (paFirst - pa <= VMM_READAHEAD_STRIDE_MAX) && (!cbStride || (paFirst - pa < cbStride))) {
+                cbStride = paFirst - pa;
+            }
+        }
+        if(cbStride) {
+            s = &ra->S[ra->iStream++ % VMM_READAHEAD_STREAMS];
+            s->cbStride = cbStride;
+            s->cWindow = VMM_READAHEAD_WINDOW_MIN;
+        }
+    }
+    ra->History[ra->iHistory++ % VMM_READAHEAD_HISTORY] = paLast;
+    if(s) {
+        c = min(cMax, s->cWindow);
+        s->paNext = paLast + (c + 1ULL) * s->cbStride;
+        *pcbStride = s->cbStride;
+    }
+    ReleaseSRWLockExclusive(&ra->LockSRW);
+    return c;
+}
+
 VOID VmmReadScatterPhysical(_Inout_ PPMEM_SCATTER ppMEMsPhys, _In_ DWORD cpMEMsPhys, _In_ QWORD flags)
 {
     QWORD tp;   // 0 = normal, 1 = already read, 2 = cache hit, 3 = speculative read
-    BOOL fCache, fCacheRecent;
+    BOOL fCache, fCacheRecent, fReadAhead;
     PMEM_SCATTER pMEM;
-    DWORD i, c, cSpeculative;
+    QWORD qwA, cbStride;
+    DWORD i, c, cSpeculative, cReadAhead;
     PVMMOB_CACHE_MEM pObCacheEntry, pObReservedMEM;
-    PMEM_SCATTER ppMEMsSpeculative[0x18];
-    PVMMOB_CACHE_MEM ppObCacheSpeculative[0x18];
+    PMEM_SCATTER ppMEMsSpeculative[VMM_READAHEAD_WINDOW_MAX];
+    PVMMOB_CACHE_MEM ppObCacheSpeculative[VMM_READAHEAD_WINDOW_MAX];
     fCache = !(VMM_FLAG_NOCACHE & (flags | ctxVmm->flags));
     fCacheRecent = fCache && (VMM_FLAG_CACHE_RECENT_ONLY & flags);
+    fReadAhead = fCache && !(flags & (VMM_FLAG_NO_PREDICTIVE_READ | VMM_FLAG_PAGING_STRUCTURE | VMM_FLAG_NOCACHEPUT));
     // 1: cache read
     if(fCache) {
         c = 0, cSpeculative = 0;
@@ -1470,7 +2674,7 @@ VOID VmmReadScatterPhysical(_Inout_ PPMEM_SCATTER ppMEMsPhys, _In_ DWORD cpMEMsP
             }
             MEM_SCATTER_STACK_PUSH(pMEM, 1);        // 1: normal read
             // add to potential speculative read map if read is small enough...
-            if(cSpeculative < 0x18) {
+            if(cSpeculative < VMM_READAHEAD_WINDOW_MAX) {
                 ppMEMsSpeculative[cSpeculative++] = pMEM;
             }
         }
@@ -1482,25 +2686,31 @@ VOID VmmReadScatterPhysical(_Inout_ PPMEM_SCATTER ppMEMsPhys, _In_ DWORD cpMEMsP
             return;
         }
     }
-    // 2: speculative future read if negligible performance loss
-    if(fCache && cSpeculative && (cSpeculative < 0x18) && !(flags & VMMDLL_FLAG_NO_PREDICTIVE_READ)) {
-        for(i = 0; i < cpMEMsPhys; i++) {
-            pMEM = ppMEMsPhys[i];
-            if(1 != MEM_SCATTER_STACK_PEEK(pMEM, 1)) {
-                MEM_SCATTER_STACK_POP(pMEM);
+    // 2: adaptive read-ahead of pages predicted by the access pattern
+    if(fReadAhead && cSpeculative && (cSpeculative < VMM_READAHEAD_WINDOW_MAX)) {
+        cReadAhead = VmmReadAhead_Window(ppMEMsSpeculative[0]->qwA, ppMEMsSpeculative[cSpeculative - 1]->qwA, VMM_READAHEAD_WINDOW_MAX - cSpeculative, &cbStride);
+        if(cReadAhead) {
+            for(i = 0; i < cpMEMsPhys; i++) {
+                pMEM = ppMEMsPhys[i];
+                if(1 != MEM_SCATTER_STACK_PEEK(pMEM, 1)) {
+                    MEM_SCATTER_STACK_POP(pMEM);
+                }
             }
-        }
-        while(cSpeculative < 0x18) {
-            if((ppObCacheSpeculative[cSpeculative] = VmmCacheReserve(VMM_CACHE_TAG_PHYS))) {
-                pMEM = ppMEMsSpeculative[cSpeculative] = &ppObCacheSpeculative[cSpeculative]->h;
+            qwA = ppMEMsSpeculative[cSpeculative - 1]->qwA & ~0xfff;
+            for(i = cSpeculative; i < cSpeculative + cReadAhead; i++) {
+                qwA += cbStride;
+                if(qwA >= ctxMain->dev.paMax) { break; }
+                if(!(ppObCacheSpeculative[i] = VmmCacheReserve(VMM_CACHE_TAG_PHYS))) { break; }
+                ppObCacheSpeculative[i]->fSpeculative = TRUE;
+                pMEM = ppMEMsSpeculative[i] = &ppObCacheSpeculative[i]->h;
                 MEM_SCATTER_STACK_PUSH(pMEM, 4);
                 pMEM->f = FALSE;
-                pMEM->qwA = ((QWORD)ppMEMsSpeculative[cSpeculative - 1]->qwA & ~0xfff) + 0x1000;
-                cSpeculative++;
+                pMEM->qwA = qwA;
             }
+            InterlockedAdd64(&ctxVmm->stat.cPhysReadAheadRead, i - cSpeculative);
+            ppMEMsPhys = ppMEMsSpeculative;
+            cpMEMsPhys = i;
         }
-        ppMEMsPhys = ppMEMsSpeculative;
-        cpMEMsPhys = cSpeculative;
     }
     // 3: read!
     LcReadScatter(ctxMain->hLC, cpMEMsPhys, ppMEMsPhys);
@@ -1541,6 +2751,13 @@ VOID VmmReadScatterPhysical(_Inout_ PPMEM_SCATTER ppMEMsPhys, _In_ DWORD cpMEMsP
     }
 }
 
+#define VMM_READSCATTERVIRTUAL_CB_ENTRY     (sizeof(PMEM_SCATTER) + sizeof(MEM_SCATTER) + sizeof(VMM_VIRT2PHYS_SCATTER) + sizeof(PVMM_VIRT2PHYS_SCATTER))
+
+int VmmReadScatterVirtual_CmpPhys(_In_ PPMEM_SCATTER ppMEM1, _In_ PPMEM_SCATTER ppMEM2)
+{
+    return ((*ppMEM1)->qwA < (*ppMEM2)->qwA) ? -1 : (((*ppMEM1)->qwA > (*ppMEM2)->qwA) ? 1 : 0);
+}
+
 VOID VmmReadScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_updates_(cpMEMsVirt) PPMEM_SCATTER ppMEMsVirt, _In_ DWORD cpMEMsVirt, _In_ QWORD flags)
 {
     // NB! the buffers pIoPA / ppMEMsPhys are used for both:
@@ -1549,30 +2766,55 @@ VOID VmmReadScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_updates_(cpMEMsVir
     BOOL fVirt2Phys;
     DWORD i = 0, iVA, iPA;
     QWORD qwPA, qwPagedPA = 0;
-    BYTE pbBufferSmall[0x20 * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER))];
+    BYTE pbBufferSmall[0x20 * VMM_READSCATTERVIRTUAL_CB_ENTRY];
     PBYTE pbBufferMEMs, pbBufferLarge = NULL;
     PMEM_SCATTER pIoPA, pIoVA;
     PPMEM_SCATTER ppMEMsPhys = NULL;
+    PVMM_VIRT2PHYS_SCATTER pV2Ps;
+    PPVMM_VIRT2PHYS_SCATTER ppV2Ps;
     BOOL fPaging = !(VMM_FLAG_NOPAGING & (flags | ctxVmm->flags));
     BOOL fAltAddrPte = VMM_FLAG_ALTADDR_VA_PTE & flags;
     BOOL fZeropadOnFail = VMM_FLAG_ZEROPAD_ON_FAIL & (flags | ctxVmm->flags);
     BOOL fProcessMagicHandle = ((SIZE_T)pProcess >= PROCESS_MAGIC_HANDLE_THRESHOLD);
+    BOOL fVirt2PhysScatter = !fAltAddrPte && (cpMEMsVirt > 1) && ctxVmm->fnMemoryModel.pfnVirt2PhysScatter;
     // 0: 'magic' process handle
     if(fProcessMagicHandle && !(pProcess = VmmProcessGet((DWORD)(0-(SIZE_T)pProcess)))) { return; }
     // 1: allocate / set up buffers (if needed)
     if(cpMEMsVirt < 0x20) {
         ZeroMemory(pbBufferSmall, sizeof(pbBufferSmall));
         ppMEMsPhys = (PPMEM_SCATTER)pbBufferSmall;
-        pbBufferMEMs = pbBufferSmall + cpMEMsVirt * sizeof(PMEM_SCATTER);
     } else {
-        if(!(pbBufferLarge = LocalAlloc(LMEM_ZEROINIT, cpMEMsVirt * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER))))) {
+        if(!(pbBufferLarge = LocalAlloc(LMEM_ZEROINIT, cpMEMsVirt * VMM_READSCATTERVIRTUAL_CB_ENTRY))) {
             if(fProcessMagicHandle) { Ob_DECREF(pProcess); }
             return;
         }
         ppMEMsPhys = (PPMEM_SCATTER)pbBufferLarge;
-        pbBufferMEMs = pbBufferLarge + cpMEMsVirt * sizeof(PMEM_SCATTER);
     }
-    // 2: translate virt2phys
+    pbBufferMEMs = (PBYTE)ppMEMsPhys + cpMEMsVirt * sizeof(PMEM_SCATTER);
+    pV2Ps = (PVMM_VIRT2PHYS_SCATTER)(pbBufferMEMs + cpMEMsVirt * sizeof(MEM_SCATTER));
+    ppV2Ps = (PPVMM_VIRT2PHYS_SCATTER)(pV2Ps + cpMEMsVirt);
+    // 2: translate virt2phys (batched page table walk if supported by memory model)
+    if(fVirt2PhysScatter) {
+        for(iVA = 0; iVA < cpMEMsVirt; iVA++) {
+            pIoVA = ppMEMsVirt[iVA];
+            pV2Ps[iVA].va = pIoVA->qwA;
+            pV2Ps[iVA].fSkip = pIoVA->f || (pIoVA->qwA == 0) || (pIoVA->qwA == -1);
+        }
+        VmmVirt2PhysScatter(pProcess, cpMEMsVirt, pV2Ps, ppV2Ps);
+        // batch read paged out pages into the paging cache (if supported by memory model).
+        // NB! the not yet used MEM buffer is temporarily used to hold the PTEs.
+        if(fPaging && ctxVmm->fnMemoryModel.pfnPagedReadScatter) {
+            for(iVA = 0, i = 0; iVA < cpMEMsVirt; iVA++) {
+                if(!pV2Ps[iVA].fSkip && !pV2Ps[iVA].f && pV2Ps[iVA].pa && (ppMEMsVirt[iVA]->cb == 0x1000)) {
+                    ((PQWORD)pbBufferMEMs)[i++] = pV2Ps[iVA].pa;
+                }
+            }
+            if(i > 1) {
+                ctxVmm->fnMemoryModel.pfnPagedReadScatter(pProcess, i, (PQWORD)pbBufferMEMs, flags);
+            }
+            ZeroMemory(pbBufferMEMs, i * sizeof(QWORD));
+        }
+    }
     for(iVA = 0, iPA = 0; iVA < cpMEMsVirt; iVA++) {
         pIoVA = ppMEMsVirt[iVA];
         // MEMORY READ ALREADY COMPLETED
@@ -1584,7 +2826,12 @@ VOID VmmReadScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_updates_(cpMEMsVir
         }
         // PHYSICAL MEMORY
         qwPA = 0;
-        fVirt2Phys = !fAltAddrPte && VmmVirt2Phys(pProcess, pIoVA->qwA, &qwPA);
+        if(fVirt2PhysScatter) {
+            qwPA = pV2Ps[iVA].pa;
+            fVirt2Phys = pV2Ps[iVA].f;
+        } else {
+            fVirt2Phys = !fAltAddrPte && VmmVirt2Phys(pProcess, pIoVA->qwA, &qwPA);
+        }
         // PAGED MEMORY
         if(!fVirt2Phys && fPaging && (pIoVA->cb == 0x1000) && ctxVmm->fnMemoryModel.pfnPagedRead) {
             if(ctxVmm->fnMemoryModel.pfnPagedRead(pProcess, (fAltAddrPte ? 0 : pIoVA->qwA), (fAltAddrPte ? pIoVA->qwA : qwPA), pIoVA->pb, &qwPagedPA, NULL, flags)) {
@@ -1610,10 +2857,16 @@ VOID VmmReadScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_updates_(cpMEMsVir
         pIoPA->cb = pIoVA->cb;
         pIoPA->pb = pIoVA->pb;
         pIoPA->f = FALSE;
+        pIoPA->iStack = 0;
         MEM_SCATTER_STACK_PUSH(pIoPA, (QWORD)pIoVA);
     }
-    // 3: read and check result
+    // 3: read and check result - optionally sorted by physical address so that
+    //    physically adjacent pages reach the device as contiguous runs (and
+    //    any read-ahead continues after the highest physical page).
     if(iPA) {
+        if((flags & VMM_FLAG_SCATTER_COALESCE) && (iPA > 1)) {
+            qsort(ppMEMsPhys, iPA, sizeof(PMEM_SCATTER), (_CoreCrtNonSecureSearchSortCompareFunction)VmmReadScatterVirtual_CmpPhys);
+        }
         VmmReadScatterPhysical(ppMEMsPhys, iPA, flags);
         while(iPA > 0) {
             iPA--;
@@ -1697,6 +2950,7 @@ VOID VmmClose()
     if(!ctxVmm) { return; }
     if(ctxVmm->PluginManager.FLinkAll) { PluginManager_Close(); }
     VmmWork_Close();
+    VmmReadStream_Close();
     VmmWinObj_Close();
     VmmWinReg_Close();
     VmmNet_Close();
@@ -2017,6 +3271,7 @@ VOID VmmInitializeFunctions()
 
 BOOL VmmInitialize()
 {
+    DWORD i;
     // 1: allocate & initialize
     if(ctxVmm) { VmmClose(); }
     ctxVmm = (PVMM_CONTEXT)LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_CONTEXT));
@@ -2036,6 +3291,15 @@ BOOL VmmInitialize()
     if(!(ctxVmm->Cache.PAGING_FAILED = ObSet_New())) { goto fail; }
     // 6: CACHE INIT: Prototype PTE Cache Map
     if(!(ctxVmm->Cache.pmPrototypePte = ObMap_New(OB_MAP_FLAGS_OBJECT_OB))) { goto fail; }
+    for(i = 0; i < VMM_READAHEAD_SHARDS; i++) {
+        InitializeSRWLock(&ctxVmm->Cache.ReadAhead[i].LockSRW);
+    }
+    InitializeCriticalSection(&ctxVmm->Cache.ReadStream.Lock);
+    ctxVmm->Cache.ReadStream.cTrigger = VMM_READSTREAM_TRIGGER_DEFAULT;
+    ctxVmm->Cache.ReadStream.cbReadAhead = VMM_READSTREAM_SIZE_DEFAULT;
+    for(i = 0; i < VMM_READSTREAM_STREAMS; i++) {
+        if(!(ctxVmm->Cache.ReadStream.S[i].hEventChunk = CreateEvent(NULL, TRUE, TRUE, NULL))) { goto fail; }
+    }
     // 7: WORKER THREADS INIT:
     VmmWork_Initialize();
     // 8: OTHER INIT:
@@ -2068,90 +3332,388 @@ fail:
 // SEARCH MEMORY FUNCTIONALITY BELOW:
 // ----------------------------------------------------------------------------
 
+#define VMM_MEMORY_SEARCH_CHUNK_SIZE        0x00100000  // 1MB
+#define VMM_MEMORY_SEARCH_BATCH_CHUNKS      0x40
+#define VMM_MEMORY_SEARCH_THREADS           8
+
+typedef struct tdVMM_MEMORY_SEARCH_ANCHOR {
+    DWORD iS;                   // search entry index
+    DWORD o;                    // offset of anchor byte within search entry
+} VMM_MEMORY_SEARCH_ANCHOR, *PVMM_MEMORY_SEARCH_ANCHOR;
+
+typedef struct tdVMM_MEMORY_SEARCH_CHUNK {
+    QWORD va;
+    DWORD cb;
+    BOOL fAbort;
+    BOOL fFail;
+    POB_SET psHit;              // hits as: ((iS + 1) << 32) | offset
+} VMM_MEMORY_SEARCH_CHUNK, *PVMM_MEMORY_SEARCH_CHUNK;
+
+typedef struct tdVMMOB_MEMORY_SEARCH_BATCH {
+    OB ObHdr;
+    struct tdVMM_MEMORY_SEARCH_INTERNAL_CONTEXT *ctxi;
+    HANDLE hEventFinish;
+    DWORD cChunk;
+    DWORD iChunkNext;           // next chunk to claim (interlocked).
+    DWORD cChunkFinish;         // # finished chunks (interlocked).
+    VMM_MEMORY_SEARCH_CHUNK Chunk[VMM_MEMORY_SEARCH_BATCH_CHUNKS];
+} VMMOB_MEMORY_SEARCH_BATCH, *PVMMOB_MEMORY_SEARCH_BATCH;
+
 typedef struct tdVMM_MEMORY_SEARCH_INTERNAL_CONTEXT {
     PVMM_PROCESS pProcess;
+    PVMM_MEMORY_SEARCH_CONTEXT ctxs;
+    PVMM_MEMORY_SEARCH_CONTEXT_SEARCHENTRY pS;
     POB_SET psvaResult;
-    BOOL fMask[VMM_MEMORY_SEARCH_MAX];
-    DWORD cb;
-    BYTE pb[0x00100000];    // 1MB
+    PVMMOB_MEMORY_SEARCH_BATCH pObBatch;
+    BOOL fStreamEnd;            // result batch callback requested end of search.
+    // compiled search entries: search entries with at least one non-wildcard
+    // byte are dispatched by their anchor byte value - the anchor array is
+    // indexed by iAnchor[b]..iAnchor[b+1]. remaining entries are matched by
+    // trying each aligned offset.
+    DWORD cAnchorByte;          // # distinct anchor byte values
+    BYTE bAnchorSingle;         // anchor byte value if cAnchorByte == 1
+    DWORD iAnchor[0x101];
+    PVMM_MEMORY_SEARCH_ANCHOR pAnchor;
+    DWORD cNoAnchor;
+    PDWORD piNoAnchor;
+    BYTE pb[VMM_MEMORY_SEARCH_CHUNK_SIZE];
 } VMM_MEMORY_SEARCH_INTERNAL_CONTEXT, *PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT;
 
 /*
-* Search data inside region.
+* Compare a search entry against memory at the given offset.
+* -- pS
+* -- pb = memory to compare - at least pS->cb bytes.
+* -- return
 */
-_Success_(return)
-BOOL VmmSearch_SearchRegion(_In_ PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT ctxi, _In_ PVMM_MEMORY_SEARCH_CONTEXT ctxs)
+BOOL VmmSearch_SearchEntryMatch(_In_ PVMM_MEMORY_SEARCH_CONTEXT_SEARCHENTRY pS, _In_reads_(pS->cb) PBYTE pb)
 {
     BYTE v;
-    QWORD va, oMax;
-    DWORD o, i, iS, cbRead;
-    BOOL fMaskFail, f4;
+    DWORD i;
+    for(i = 0; i < pS->cb; i++) {
+        v = pS->pbSkipMask[i];
+        if((pS->pb[i] | v) != (pb[i] | v)) { return FALSE; }
+    }
+    return TRUE;
+}
+
+/*
+* Compile the search entries into the anchor byte dispatch table. The anchor
+* of a search entry is its first non-wildcard byte, preferring bytes not equal
+* to 0x00 or 0xff since those are very frequent in memory.
+* -- ctxi
+* -- return
+*/
+_Success_(return)
+BOOL VmmSearch_Compile(_In_ PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT ctxi)
+{
+    BYTE b;
+    DWORD iS, i, o, cSearch = ctxi->ctxs->cSearch;
+    DWORD cAnchor[0x100] = { 0 };
+    PDWORD poAnchor = NULL;
+    PVMM_MEMORY_SEARCH_CONTEXT_SEARCHENTRY pS;
+    if(!(poAnchor = LocalAlloc(0, cSearch * sizeof(DWORD)))) { return FALSE; }
+    if(!(ctxi->pAnchor = LocalAlloc(0, cSearch * sizeof(VMM_MEMORY_SEARCH_ANCHOR)))) { goto fail; }
+    if(!(ctxi->piNoAnchor = LocalAlloc(0, cSearch * sizeof(DWORD)))) { goto fail; }
+    // 1: select anchor byte for each search entry
+    for(iS = 0; iS < cSearch; iS++) {
+        pS = ctxi->pS + iS;
+        poAnchor[iS] = (DWORD)-1;
+        for(o = 0; o < pS->cb; o++) {
+            if(pS->pbSkipMask[o]) { continue; }
+            if((pS->pb[o] != 0x00) && (pS->pb[o] != 0xff)) {
+                poAnchor[iS] = o;
+                break;
+            }
+            if(poAnchor[iS] == (DWORD)-1) { poAnchor[iS] = o; }
+        }
+        if(poAnchor[iS] == (DWORD)-1) {
+            ctxi->piNoAnchor[ctxi->cNoAnchor++] = iS;
+            continue;
+        }
+        b = pS->pb[poAnchor[iS]];
+        if(!cAnchor[b]++) {
+            ctxi->cAnchorByte++;
+            ctxi->bAnchorSingle = b;
+        }
+    }
+    // 2: populate dispatch table (entries kept in search entry order per byte)
+    for(i = 0; i < 0x100; i++) {
+        ctxi->iAnchor[i + 1] = ctxi->iAnchor[i] + cAnchor[i];
+        cAnchor[i] = ctxi->iAnchor[i];
+    }
+    for(iS = 0; iS < cSearch; iS++) {
+        if(poAnchor[iS] == (DWORD)-1) { continue; }
+        b = ctxi->pS[iS].pb[poAnchor[iS]];
+        ctxi->pAnchor[cAnchor[b]].iS = iS;
+        ctxi->pAnchor[cAnchor[b]].o = poAnchor[iS];
+        cAnchor[b]++;
+    }
+    LocalFree(poAnchor);
+    return TRUE;
+fail:
+    LocalFree(poAnchor);
+    return FALSE;
+}
+
+/*
+* Record a search hit in a chunk.
+*/
+_Success_(return)
+BOOL VmmSearch_SearchChunk_AddHit(_In_ PVMM_MEMORY_SEARCH_CHUNK pc, _In_ DWORD iS, _In_ DWORD o)
+{
+    if(!pc->psHit && !(pc->psHit = ObSet_New())) { return FALSE; }
+    return ObSet_Push(pc->psHit, ((QWORD)(iS + 1) << 32) | o);
+}
+
+/*
+* Search data inside a chunk. Hits are recorded in the chunk and are merged
+* into the result in address order by the searching thread.
+* -- ctxi
+* -- pc
+* -- pb = 1MB buffer owned by the calling thread.
+*/
+VOID VmmSearch_SearchChunk(_In_ PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT ctxi, _In_ PVMM_MEMORY_SEARCH_CHUNK pc, _Out_writes_(VMM_MEMORY_SEARCH_CHUNK_SIZE) PBYTE pb)
+{
+    PBYTE pbHit;
+    DWORD o, p, i, iS, cbRead;
+    PVMM_MEMORY_SEARCH_ANCHOR pA;
     PVMM_MEMORY_SEARCH_CONTEXT_SEARCHENTRY pS;
+    PVMM_MEMORY_SEARCH_CONTEXT ctxs = ctxi->ctxs;
     if(ctxs->fAbortRequested || !ctxVmm->Work.fEnabled) {
-        ctxs->fAbortRequested = TRUE;
-        return FALSE;
+        pc->fAbort = TRUE;
+        return;
     }
-    ctxs->cbReadTotal += ctxi->cb;
-    VmmReadEx(ctxi->pProcess, ctxs->vaCurrent, ctxi->pb, ctxi->cb, &cbRead, ctxs->ReadFlags | VMM_FLAG_ZEROPAD_ON_FAIL);
-    if(!cbRead) { return TRUE; }
-    for(iS = 0; iS < ctxs->cSearch; iS++) {
-        pS = ctxs->search + iS;
-        f4 = (pS->cb >= 4);
-        if(ctxi->fMask[iS]) {
-            // mask search
-            f4 = f4 && (0 == *(PDWORD)pS->pbSkipMask);
-            oMax = ctxi->cb - pS->cb;
-            for(o = 0; o <= oMax; o += pS->cbAlign) {
-                if(f4) {
-                    if(*(PDWORD)pS->pb != *(PDWORD)(ctxi->pb + o)) { continue; }
-                } else {
-                    v = pS->pbSkipMask[0];
-                    if((pS->pb[0] | v) != (ctxi->pb[o] | v)) { continue; }
-                }
-                fMaskFail = FALSE;
-                for(i = 0; i < pS->cb; i++) {
-                    v = pS->pbSkipMask[i];
-                    if((pS->pb[i] | v) != (ctxi->pb[o + i] | v)) {
-                        fMaskFail = TRUE;
-                        break;
-                    }
-                }
-                if(fMaskFail) { continue; }
-                // match located!
-                va = ctxs->vaCurrent + o;
-                if(ctxs->pfnResultOptCB) {
-                    if(!ctxs->pfnResultOptCB(ctxs, va, iS)) { return FALSE; }
-                } else {
-                    ctxs->cResult++;
-                    if(ctxs->cResult < 0x00100000) {
-                        if(!ObSet_Push(ctxi->psvaResult, va)) { return FALSE; }
-                    }
+    VmmReadEx(ctxi->pProcess, pc->va, pb, pc->cb, &cbRead, ctxs->ReadFlags | VMM_FLAG_ZEROPAD_ON_FAIL);
+    if(!cbRead) { return; }
+    // 1: search entries with an anchor byte - single pass over the chunk.
+    if(ctxi->cAnchorByte) {
+        p = 0;
+        while(p < pc->cb) {
+            if(ctxi->cAnchorByte == 1) {
+                if(!(pbHit = memchr(pb + p, ctxi->bAnchorSingle, pc->cb - p))) { break; }
+                p = (DWORD)(pbHit - pb);
+            }
+            for(i = ctxi->iAnchor[pb[p]]; i < ctxi->iAnchor[pb[p] + 1]; i++) {
+                pA = ctxi->pAnchor + i;
+                if(p < pA->o) { continue; }
+                o = p - pA->o;
+                pS = ctxi->pS + pA->iS;
+                if((pS->cb > pc->cb) || (o > pc->cb - pS->cb)) { continue; }
+                if(o % pS->cbAlign) { continue; }
+                if(!VmmSearch_SearchEntryMatch(pS, pb + o)) { continue; }
+                if(!VmmSearch_SearchChunk_AddHit(pc, pA->iS, o)) {
+                    pc->fFail = TRUE;
+                    return;
                 }
             }
+            p++;
+        }
+    }
+    // 2: search entries without anchor byte (all bytes partially wildcard).
+    for(i = 0; i < ctxi->cNoAnchor; i++) {
+        iS = ctxi->piNoAnchor[i];
+        pS = ctxi->pS + iS;
+        if(pS->cb > pc->cb) { continue; }
+        for(o = 0; o <= pc->cb - pS->cb; o += pS->cbAlign) {
+            if(!VmmSearch_SearchEntryMatch(pS, pb + o)) { continue; }
+            if(!VmmSearch_SearchChunk_AddHit(pc, iS, o)) {
+                pc->fFail = TRUE;
+                return;
+            }
+        }
+    }
+}
+
+/*
+* Claim and search chunks from a batch until no unclaimed chunks remains.
+* -- pBatch
+* -- pbOpt = optional 1MB buffer, if not set a buffer is allocated on demand.
+*/
+VOID VmmSearch_Batch_DoWork(_In_ PVMMOB_MEMORY_SEARCH_BATCH pBatch, _In_opt_ PBYTE pbOpt)
+{
+    DWORD i;
+    PBYTE pbAlloc = NULL;
+    PVMM_MEMORY_SEARCH_CHUNK pc;
+    while((i = InterlockedIncrement(&pBatch->iChunkNext) - 1) < pBatch->cChunk) {
+        pc = pBatch->Chunk + i;
+        if(!pbOpt) {
+            pbOpt = pbAlloc = LocalAlloc(0, VMM_MEMORY_SEARCH_CHUNK_SIZE);
+        }
+        if(pbOpt) {
+            VmmSearch_SearchChunk(pBatch->ctxi, pc, pbOpt);
         } else {
-            // no-mask search
-            oMax = ctxi->cb - pS->cb;
-            for(o = 0; o <= oMax; o += pS->cbAlign) {
-                if(f4) {
-                    if(*(PDWORD)pS->pb != *(PDWORD)(ctxi->pb + o)) { continue; }
-                } else {
-                    if(pS->pb[0] != ctxi->pb[o]) { continue; }
-                }
-                if(memcmp(ctxi->pb + o, pS->pb, pS->cb)) { continue; }
-                // match located!
-                va = ctxs->vaCurrent + o;
-                if(ctxs->pfnResultOptCB) {
-                    if(!ctxs->pfnResultOptCB(ctxs, va, iS)) { return FALSE; }
-                } else {
-                    ctxs->cResult++;
-                    if(ctxs->cResult < 0x00100000) {
-                        if(!ObSet_Push(ctxi->psvaResult, va)) { return FALSE; }
-                    }
+            pc->fFail = TRUE;
+        }
+        if(InterlockedIncrement(&pBatch->cChunkFinish) == pBatch->cChunk) {
+            SetEvent(pBatch->hEventFinish);
+        }
+    }
+    LocalFree(pbAlloc);
+}
+
+DWORD VmmSearch_Batch_ThreadProc(_In_ PVMMOB_MEMORY_SEARCH_BATCH pObBatch)
+{
+    VmmSearch_Batch_DoWork(pObBatch, NULL);
+    Ob_DECREF(pObBatch);
+    return 1;
+}
+
+VOID VmmSearch_Batch_CleanupCB(_In_ PVMMOB_MEMORY_SEARCH_BATCH pOb)
+{
+    DWORD i;
+    for(i = 0; i < pOb->cChunk; i++) {
+        Ob_DECREF(pOb->Chunk[i].psHit);
+    }
+    if(pOb->hEventFinish) {
+        CloseHandle(pOb->hEventFinish);
+    }
+}
+
+/*
+* Sort chunk hits (search index + 1) << 32 | chunk offset in address order -
+* hits at the same address are ordered by search index. Used for the streaming
+* result callback.
+*/
+int VmmSearch_Batch_CmpHit(_In_ PQWORD pqw1, _In_ PQWORD pqw2)
+{
+    QWORD qw1 = ((*pqw1) << 32) | ((*pqw1) >> 32);
+    QWORD qw2 = ((*pqw2) << 32) | ((*pqw2) >> 32);
+    return (qw1 < qw2) ? -1 : ((qw1 > qw2) ? 1 : 0);
+}
+
+/*
+* Sort chunk hits (search index + 1) << 32 | chunk offset by search index and
+* then by address - the order in which a serial search of one chunk per search
+* entry finds them. Used for pfnResultOptCB and the ordinary result.
+*/
+int VmmSearch_Batch_CmpHitSerial(_In_ PQWORD pqw1, _In_ PQWORD pqw2)
+{
+    return (*pqw1 < *pqw2) ? -1 : ((*pqw1 > *pqw2) ? 1 : 0);
+}
+
+/*
+* Search the chunks of the current batch in parallel and merge the results in
+* chunk order. Results are identical, and in the same order, as if chunks were
+* searched one by one on the calling thread: within a chunk hits are ordered by
+* search index and then by address. The streaming result callback instead gets
+* the hits of a chunk in address order.
+* -- ctxi
+* -- return
+*/
+_Success_(return)
+BOOL VmmSearch_Batch_Finish(_In_ PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT ctxi)
+{
+    BOOL fResult = FALSE;
+    QWORD va, qwHit, vaCurrent;
+    DWORD i, iHit, iS, cHit, cThread;
+    POB_DATA pObHit = NULL;
+    PQWORD pvaStream = NULL;
+    PDWORD piStream;
+    PVMM_MEMORY_SEARCH_CHUNK pc;
+    PVMM_MEMORY_SEARCH_CONTEXT ctxs = ctxi->ctxs;
+    PVMMOB_MEMORY_SEARCH_BATCH pObBatch = ctxi->pObBatch;
+    ctxi->pObBatch = NULL;
+    if(!pObBatch) { return TRUE; }
+    // 1: search - queue worker threads and participate on the calling thread.
+    //    the calling thread always makes progress even if the worker threads
+    //    are busy; unstarted work items just find no unclaimed chunks.
+    cThread = min(VMM_MEMORY_SEARCH_THREADS, pObBatch->cChunk);
+    for(i = 1; i < cThread; i++) {
+        VmmWork((LPTHREAD_START_ROUTINE)VmmSearch_Batch_ThreadProc, Ob_INCREF(pObBatch), NULL);
+    }
+    VmmSearch_Batch_DoWork(pObBatch, ctxi->pb);
+    if(pObBatch->cChunkFinish != pObBatch->cChunk) {
+        WaitForSingleObject(pObBatch->hEventFinish, INFINITE);
+    }
+    // 2: merge results in chunk order.
+    vaCurrent = ctxs->vaCurrent;
+    for(i = 0; i < pObBatch->cChunk; i++) {
+        pc = pObBatch->Chunk + i;
+        if(pc->fAbort) {
+            ctxs->fAbortRequested = TRUE;
+            goto fail;
+        }
+        if(pc->fFail) { goto fail; }
+        ctxs->vaCurrent = pc->va;
+        ctxs->cbReadTotal += pc->cb;
+        if(!pc->psHit) { continue; }
+        if(!(pObHit = ObSet_GetAll(pc->psHit))) { goto fail; }
+        cHit = pObHit->ObHdr.cbData / sizeof(QWORD);
+        if(ctxs->pfnResultBatchOptCB) {
+            qsort(pObHit->pqw, cHit, sizeof(QWORD), (_CoreCrtNonSecureSearchSortCompareFunction)VmmSearch_Batch_CmpHit);
+            // streaming mode: deliver all hits in the chunk in one callback.
+            if(!(pvaStream = LocalAlloc(0, cHit * (sizeof(QWORD) + sizeof(DWORD))))) { goto fail; }
+            piStream = (PDWORD)(pvaStream + cHit);
+            for(iHit = 0; iHit < cHit; iHit++) {
+                qwHit = pObHit->pqw[iHit];
+                piStream[iHit] = (DWORD)(qwHit >> 32) - 1;
+                pvaStream[iHit] = pc->va + (DWORD)qwHit;
+            }
+            ctxs->cResult += cHit;
+            if(!ctxs->pfnResultBatchOptCB(ctxs, cHit, pvaStream, piStream)) {
+                ctxi->fStreamEnd = TRUE;
+                goto fail;
+            }
+            LocalFree(pvaStream);
+            pvaStream = NULL;
+            Ob_DECREF_NULL(&pObHit);
+            continue;
+        }
+        qsort(pObHit->pqw, cHit, sizeof(QWORD), (_CoreCrtNonSecureSearchSortCompareFunction)VmmSearch_Batch_CmpHitSerial);
+        for(iHit = 0; iHit < cHit; iHit++) {
+            qwHit = pObHit->pqw[iHit];
+            iS = (DWORD)(qwHit >> 32) - 1;
+            va = pc->va + (DWORD)qwHit;
+            if(ctxs->pfnResultOptCB) {
+                if(!ctxs->pfnResultOptCB(ctxs, va, iS)) { goto fail; }
+            } else {
+                ctxs->cResult++;
+                if(ctxs->cResult < 0x00100000) {
+                    if(!ObSet_Push(ctxi->psvaResult, va)) { goto fail; }
                 }
             }
         }
+        Ob_DECREF_NULL(&pObHit);
     }
-    return TRUE;
+    fResult = TRUE;
+fail:
+    ctxs->vaCurrent = vaCurrent;
+    LocalFree(pvaStream);
+    Ob_DECREF(pObHit);
+    Ob_DECREF(pObBatch);
+    return fResult;
+}
+
+/*
+* Add a chunk to the current batch; search the batch once it is full.
+* -- ctxi
+* -- va
+* -- cb
+* -- return
+*/
+_Success_(return)
+BOOL VmmSearch_Batch_Add(_In_ PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT ctxi, _In_ QWORD va, _In_ DWORD cb)
+{
+    PVMMOB_MEMORY_SEARCH_BATCH pB;
+    if(ctxi->ctxs->fAbortRequested || !ctxVmm->Work.fEnabled) {
+        ctxi->ctxs->fAbortRequested = TRUE;
+        return FALSE;
+    }
+    if(!ctxi->pObBatch) {
+        pB = Ob_Alloc(OB_TAG_VMM_SEARCH_BATCH, LMEM_ZEROINIT, sizeof(VMMOB_MEMORY_SEARCH_BATCH), (OB_CLEANUP_CB)VmmSearch_Batch_CleanupCB, NULL);
+        if(!pB) { return FALSE; }
+        if(!(pB->hEventFinish = CreateEvent(NULL, TRUE, FALSE, NULL))) {
+            Ob_DECREF(pB);
+            return FALSE;
+        }
+        pB->ctxi = ctxi;
+        ctxi->pObBatch = pB;
+    }
+    pB = ctxi->pObBatch;
+    pB->Chunk[pB->cChunk].va = va;
+    pB->Chunk[pB->cChunk].cb = cb;
+    pB->cChunk++;
+    return (pB->cChunk < VMM_MEMORY_SEARCH_BATCH_CHUNKS) || VmmSearch_Batch_Finish(ctxi);
 }
 
 /*
@@ -2160,10 +3722,11 @@ BOOL VmmSearch_SearchRegion(_In_ PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT ctxi, _In_
 _Success_(return)
 BOOL VmmSearch_SearchRange(_In_ PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT ctxi, _In_ PVMM_MEMORY_SEARCH_CONTEXT ctxs, _In_ QWORD vaMax)
 {
+    DWORD cb;
     while(ctxs->vaCurrent < vaMax) {
-        ctxi->cb = (DWORD)min(0x00100000, vaMax + 1 - ctxs->vaCurrent);
-        if(!VmmSearch_SearchRegion(ctxi, ctxs)) { return FALSE; }
-        ctxs->vaCurrent += ctxi->cb;
+        cb = (DWORD)min(VMM_MEMORY_SEARCH_CHUNK_SIZE, vaMax + 1 - ctxs->vaCurrent);
+        if(!VmmSearch_Batch_Add(ctxi, ctxs->vaCurrent, cb)) { return FALSE; }
+        ctxs->vaCurrent += cb;
         if(!ctxs->vaCurrent) {
             ctxs->vaCurrent = 0xfffffffffffff000;
             break;
@@ -2243,17 +3806,19 @@ BOOL VmmSearch(_In_opt_ PVMM_PROCESS pProcess, _Inout_ PVMM_MEMORY_SEARCH_CONTEX
     static BYTE pbZERO[sizeof(ctxs->search[0].pb)] = {0};
     DWORD iS;
     BOOL fResult = FALSE;
+    PVMM_MEMORY_SEARCH_CONTEXT_SEARCHENTRY pS;
     PVMM_MEMORY_SEARCH_INTERNAL_CONTEXT ctxi = NULL;
     // 1: sanity checks and fix-ups
     if(ppObAddressResult) { *ppObAddressResult = NULL; }
     ctxs->vaMin = ctxs->vaMin & ~0xfff;
     ctxs->vaMax = (ctxs->vaMax - 1) | 0xfff;
     if(ctxs->fAbortRequested || (ctxs->vaMax < ctxs->vaMin)) { goto fail; }
-    if(!ctxs->cSearch || ctxs->cSearch > VMM_MEMORY_SEARCH_MAX) { goto fail; }
+    if(!ctxs->cSearch || (!ctxs->pSearch && (ctxs->cSearch > VMM_MEMORY_SEARCH_MAX))) { goto fail; }
+    pS = ctxs->pSearch ? ctxs->pSearch : ctxs->search;
     for(iS = 0; iS < ctxs->cSearch; iS++) {
-        if(!ctxs->search[iS].cb || (ctxs->search[iS].cb > sizeof(ctxs->search[iS].pb))) { goto fail; }
-        if(!memcmp(ctxs->search[iS].pb, pbZERO, ctxs->search[iS].cb)) { goto fail; }
-        if(!ctxs->search[iS].cbAlign) { ctxs->search[iS].cbAlign = 1; }
+        if(!pS[iS].cb || (pS[iS].cb > sizeof(pS[iS].pb))) { goto fail; }
+        if(!memcmp(pS[iS].pb, pbZERO, pS[iS].cb)) { goto fail; }
+        if(!pS[iS].cbAlign) { pS[iS].cbAlign = 1; }
     }
     if(!ctxs->vaMax) {
         if(!pProcess) {
@@ -2265,12 +3830,12 @@ BOOL VmmSearch(_In_opt_ PVMM_PROCESS pProcess, _Inout_ PVMM_MEMORY_SEARCH_CONTEX
         }
     }
     // 2: allocate
-    if(!(ctxi = LocalAlloc(0, sizeof(VMM_MEMORY_SEARCH_INTERNAL_CONTEXT)))) { goto fail; }
+    if(!(ctxi = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_MEMORY_SEARCH_INTERNAL_CONTEXT)))) { goto fail; }
     if(!(ctxi->psvaResult = ObSet_New())) { goto fail; }
     ctxi->pProcess = pProcess;
-    for(iS = 0; iS < ctxs->cSearch; iS++) {
-        ctxi->fMask[iS] = (memcmp(ctxs->search[iS].pbSkipMask, pbZERO, ctxs->search[iS].cb) ? TRUE : FALSE);
-    }
+    ctxi->ctxs = ctxs;
+    ctxi->pS = pS;
+    if(!VmmSearch_Compile(ctxi)) { goto fail; }
     // 3: perform search
     if(pProcess && (ctxs->fForcePTE || ctxs->fForceVAD || (ctxVmm->tpMemoryModel == VMMDLL_MEMORYMODEL_X64))) {
         fResult = VmmSearch_VirtPteVad(ctxi, ctxs);
@@ -2278,6 +3843,8 @@ BOOL VmmSearch(_In_opt_ PVMM_PROCESS pProcess, _Inout_ PVMM_MEMORY_SEARCH_CONTEX
         ctxs->vaCurrent = ctxs->vaMin;
         fResult = VmmSearch_SearchRange(ctxi, ctxs, ctxs->vaMax);
     }
+    fResult = fResult && VmmSearch_Batch_Finish(ctxi);
+    fResult = fResult || ctxi->fStreamEnd;
     // 4: finish
     if(fResult && ppObAddressResult) {
         *ppObAddressResult = ObSet_GetAll(ctxi->psvaResult);
@@ -2286,6 +3853,9 @@ BOOL VmmSearch(_In_opt_ PVMM_PROCESS pProcess, _Inout_ PVMM_MEMORY_SEARCH_CONTEX
 fail:
     if(ctxi) {
         Ob_DECREF(ctxi->psvaResult);
+        Ob_DECREF(ctxi->pObBatch);
+        LocalFree(ctxi->pAnchor);
+        LocalFree(ctxi->piNoAnchor);
         LocalFree(ctxi);
     }
     return fResult;
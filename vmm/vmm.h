@@ -45,7 +45,8 @@
 #define VMM_CACHE_TLB_ENTRIES                   0x4000  // -> 64MB of cached data
 #define VMM_CACHE_PHYS_ENTRIES                  0x4000  // -> 64MB of cached data
 
-#define VMM_WORK_THREADPOOL_NUM_THREADS         0x20
+#define VMM_WORK_THREADPOOL_NUM_THREADS_MIN     0x20
+#define VMM_WORK_THREADPOOL_NUM_THREADS_MAX     0x100
 
 #define VMM_FLAG_NOCACHE                        0x00000001  // do not use the data cache (force reading from memory acquisition device).
 #define VMM_FLAG_ZEROPAD_ON_FAIL                0x00000002  // zero pad failed physical memory reads and report success if read within range of physical memory.
@@ -57,8 +58,11 @@
 #define VMM_FLAG_ALTADDR_VA_PTE                 0x00000080  // alternative address mode - MEM_IO_SCATTER_HEADER.qwA contains PTE instead of VA when calling VmmRead* functions.
 #define VMM_FLAG_NOCACHEPUT                     0x00000100  // do not write back to the data cache upon successful read from memory acquisition device.
 #define VMM_FLAG_CACHE_RECENT_ONLY              0x00000200  // only fetch from the most recent active cache region when reading.
+#define VMM_FLAG_NO_PREDICTIVE_READ             0x00000400  // do not perform additional predictive page reads (read-ahead).
+#define VMM_FLAG_SCATTER_COALESCE               0x00000800  // virtual scatter read: sort translated physical pages into ascending contiguous runs before the device read.
 #define VMM_FLAG_PAGING_LOOP_PROTECT_BITS       0x00ff0000  // placeholder bits for paging loop protect counter.
 #define VMM_FLAG_NOVAD                          0x01000000  // do not try to retrieve memory from backing VAD even if otherwise possible.
+#define VMM_FLAG_PAGING_STRUCTURE               0x02000000  // read of paging structures (page tables / prototype ptes) - never read-ahead.
 
 #define VMM_POOLTAG(v, tag)                     (v == _byteswap_ulong(tag))
 #define VMM_POOLTAG_SHORT(v, tag)               ((v & 0x00ffffff) == (_byteswap_ulong(tag) & 0x00ffffff))
@@ -807,6 +811,25 @@ typedef struct tdVMMOB_PROCESS_PERSISTENT {
     } Plugin;
 } VMMOB_PROCESS_PERSISTENT, *PVMMOB_PROCESS_PERSISTENT;
 
+#define VMM_VIRT2PHYS_CACHE_SETS    0x100   // # sets in per-process translation cache (must be power of 2)
+#define VMM_VIRT2PHYS_CACHE_WAYS    4       // # entries per set (must be power of 2)
+
+typedef struct tdVMM_VIRT2PHYS_CACHE_ENTRY {
+    QWORD va;                       // virtual page base address
+    QWORD pa;                       // physical page base address
+    DWORD dwGeneration;             // TLB cache generation at time of insert
+    DWORD cPageShift;               // page size: 12 = 4kB, 21 = 2MB, 22 = 4MB, 30 = 1GB
+} VMM_VIRT2PHYS_CACHE_ENTRY, *PVMM_VIRT2PHYS_CACHE_ENTRY;
+
+typedef struct tdVMM_VIRT2PHYS_CACHE {
+    SRWLOCK LockSRW;
+    QWORD paDTB;                    // DTB cached entries are valid for
+    BOOL fUserOnly;                 // user-only (no supervisor pages) view cached entries are valid for
+    DWORD dwPageShiftMask;          // bit mask of page sizes (shifts) present in cache
+    DWORD iReplace;
+    VMM_VIRT2PHYS_CACHE_ENTRY E[VMM_VIRT2PHYS_CACHE_SETS][VMM_VIRT2PHYS_CACHE_WAYS];
+} VMM_VIRT2PHYS_CACHE, *PVMM_VIRT2PHYS_CACHE;
+
 typedef struct tdVMM_PROCESS {
     OB ObHdr;
     CRITICAL_SECTION LockUpdate;
@@ -819,6 +842,7 @@ typedef struct tdVMM_PROCESS {
     CHAR szName[16];
     BOOL fUserOnly;
     BOOL fTlbSpiderDone;
+    PVMM_VIRT2PHYS_CACHE pVirt2PhysCache;   // owned by non-clone process, may be NULL
     struct {
         // NB! Map objects are _NEVER_ to be accessed directly from the
         //     process object itself! They may be deallocated on the fly!
@@ -884,6 +908,7 @@ typedef struct tdVMMOB_PROCESS_TABLE {
 #define VMM_CACHE_REGIONS       3
 #define VMM_CACHE_REGION_MEMS   0x5000
 #define VMM_CACHE_BUCKETS       0x5000
+#define VMM_CACHE_BUCKET_LOCKS  0x40    // # bucket lock shards per region (must be power of 2)
 
 #define VMM_CACHE_TAG_PHYS      'CaPh'
 #define VMM_CACHE_TAG_PAGING    'CaPg'
@@ -894,9 +919,11 @@ typedef struct tdVMMOB_CACHE_MEM {
     // internal cache table values below:
     DWORD iR;
     DWORD iB;
+    BOOL fInUse;                    // entry is linked into a region bucket (guarded by bucket lock)
+    BOOL fReferenced;               // CLOCK second-chance bit - set on cache hit
+    DWORD dwTick;                   // table refresh tick at time of insert - used for per-entry expiry
+    BOOL fSpeculative;              // read-ahead page not yet retrieved from cache
     SLIST_ENTRY SListEmpty;
-    SLIST_ENTRY SListInUse;
-    SLIST_ENTRY SListTotal;
     struct tdVMMOB_CACHE_MEM *FLink;
     struct tdVMMOB_CACHE_MEM *BLink;
     // "user" modifiable values below:
@@ -908,11 +935,20 @@ typedef struct tdVMMOB_CACHE_MEM {
     };
 } VMMOB_CACHE_MEM, *PVMMOB_CACHE_MEM, **PPVMMOB_CACHE_MEM;
 
-typedef struct tdVMM_CACHE_REGION {
+typedef struct tdVMM_CACHE_BUCKET_LOCK {
     SRWLOCK LockSRW;
+    QWORD cHit;                     // lookup statistics - counted per lock shard
+    QWORD cMiss;                    // to avoid a table-global contended counter.
+    BYTE _Filler[0x40 - sizeof(SRWLOCK) - 2 * sizeof(QWORD)];   // one lock per cache line
+} VMM_CACHE_BUCKET_LOCK, *PVMM_CACHE_BUCKET_LOCK;
+
+typedef struct tdVMM_CACHE_REGION {
+    SRWLOCK LockSRW;                // entry table lock (E, cE, iClock).
+    VMM_CACHE_BUCKET_LOCK L[VMM_CACHE_BUCKET_LOCKS];    // bucket chain locks (B, FLink/BLink, fInUse).
     SLIST_HEADER ListHeadEmpty;
-    SLIST_HEADER ListHeadInUse;
-    SLIST_HEADER ListHeadTotal;
+    DWORD cE;                       // # entries allocated to region (in E).
+    DWORD iClock;                   // CLOCK hand - index into E.
+    PVMMOB_CACHE_MEM E[VMM_CACHE_REGION_MEMS];
     PVMMOB_CACHE_MEM B[VMM_CACHE_BUCKETS];
 } VMM_CACHE_REGION, *PVMM_CACHE_REGION;
 
@@ -922,9 +958,76 @@ typedef struct tdVMM_CACHE_TABLE {
     DWORD iR;
     BOOL fAllActiveRegions;
     CRITICAL_SECTION Lock;
+    QWORD cEvict;
+    QWORD cExpire;
+    DWORD dwTick;                   // refresh tick - incremented by VmmCacheClearPartial
+    DWORD dwGeneration;             // incremented on refresh tick and entry invalidation
     VMM_CACHE_REGION R[VMM_CACHE_REGIONS];
 } VMM_CACHE_TABLE, *PVMM_CACHE_TABLE;
 
+#define VMM_READAHEAD_HISTORY       0x10        // # recent physical read miss addresses kept
+#define VMM_READAHEAD_STREAMS       0x08        // # concurrently tracked access streams
+#define VMM_READAHEAD_WINDOW_MIN    0x04        // initial read-ahead window (pages) of new stream
+#define VMM_READAHEAD_WINDOW_MAX    0x40        // max pages (misses + read-ahead) in single read
+#define VMM_READAHEAD_STRIDE_MAX    0x00010000  // max stride between misses to be considered a stream
+#define VMM_READAHEAD_SHARDS        0x10        // # independent access pattern states - selected by thread id (must be power of 2)
+
+typedef struct tdVMM_READAHEAD_STREAM {
+    QWORD paNext;                   // expected next miss address of stream
+    QWORD cbStride;                 // 0x1000 = sequential, larger = strided
+    DWORD cWindow;                  // current read-ahead window (pages)
+} VMM_READAHEAD_STREAM, *PVMM_READAHEAD_STREAM;
+
+typedef struct tdVMM_READAHEAD {
+    SRWLOCK LockSRW;
+    DWORD iHistory;
+    DWORD iStream;                  // next stream slot to replace (round-robin)
+    QWORD History[VMM_READAHEAD_HISTORY];
+    VMM_READAHEAD_STREAM S[VMM_READAHEAD_STREAMS];
+    BYTE _Filler[0x40];             // avoid false sharing between shards
+} VMM_READAHEAD, *PVMM_READAHEAD;
+
+#define VMM_READSTREAM_STREAMS          0x10        // # concurrently tracked sequential file streams
+#define VMM_READSTREAM_TRIGGER_DEFAULT  0x03        // # sequential reads before asynchronous read-ahead starts
+#define VMM_READSTREAM_SIZE_DEFAULT     0x00400000  // default read-ahead window (bytes)
+#define VMM_READSTREAM_SIZE_MAX         0x04000000  // max read-ahead window (bytes)
+#define VMM_READSTREAM_CHUNK            0x00100000  // read-ahead i/o size - also cancellation granularity
+#define VMM_READSTREAM_BACKLOG          0x00100000  // data kept behind stream position / out-of-order read tolerance
+#define VMM_READSTREAM_WAIT_MS          500         // max wait for in-flight read-ahead before reading synchronously
+#define VMM_READSTREAM_IDLE_MS          5000        // idle time after which a stream and its buffer is freed
+
+typedef VOID(*PVMM_READSTREAM_PFN)(_In_opt_ POB pObCtx, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _In_ QWORD cbOffset);
+
+typedef struct tdVMM_READSTREAM_ENTRY {
+    QWORD qwId;                     // stream id (0 = unused)
+    QWORD qwHandleId;               // file handle id (0 = file accessed by path)
+    QWORD qwAccess;                 // last access (access counter value)
+    QWORD qwTickAccess;             // last access (tick count)
+    DWORD cSequential;              // # sequential reads
+    DWORD cbWindow;                 // current read-ahead window - ramps up to cbReadAhead
+    DWORD dwGeneration;             // incremented on seek/invalidate - cancels in-flight read-ahead
+    BOOL fPending;                  // read-ahead work item is active
+    PVMM_READSTREAM_PFN pfnRead;
+    POB pObCtx;
+    QWORD cbFile;
+    QWORD cbOffsetNext;             // expected file offset of next sequential read
+    QWORD cbOffsetPendingEnd;       // read-ahead target end file offset
+    QWORD cbOffsetInflightEnd;      // end file offset of chunk currently being read
+    HANDLE hEventChunk;             // set when in-flight chunk completes or read-ahead stops
+    QWORD cbOffsetBuffer;           // file offset of pbBuffer
+    DWORD cbBuffer;                 // # valid bytes in pbBuffer
+    DWORD cbBufferAlloc;
+    PBYTE pbBuffer;
+} VMM_READSTREAM_ENTRY, *PVMM_READSTREAM_ENTRY;
+
+typedef struct tdVMM_READSTREAM {
+    CRITICAL_SECTION Lock;
+    DWORD cTrigger;                 // # sequential reads before read-ahead starts (0 = disabled)
+    DWORD cbReadAhead;              // read-ahead window (bytes)
+    QWORD qwAccess;                 // access counter
+    VMM_READSTREAM_ENTRY S[VMM_READSTREAM_STREAMS];
+} VMM_READSTREAM, *PVMM_READSTREAM;
+
 typedef struct tdVMM_VIRT2PHYS_INFORMATION {
     VMM_MEMORYMODEL_TP tpMemoryModel;
     QWORD va;
@@ -933,9 +1036,18 @@ typedef struct tdVMM_VIRT2PHYS_INFORMATION {
     WORD  iPTEs[5]; // Index of PTE in page table
 } VMM_VIRT2PHYS_INFORMATION, *PVMM_VIRT2PHYS_INFORMATION;
 
+typedef struct tdVMM_VIRT2PHYS_SCATTER {
+    QWORD va;                       // [in] virtual address to translate
+    BOOL fSkip;                     // [in] do not translate entry (already completed or invalid)
+    QWORD pa;                       // [out] physical address on success, pte (if possible) on fail
+    BOOL f;                         // [out] translation success
+    DWORD cPageShift;               // [out] page size of translation
+} VMM_VIRT2PHYS_SCATTER, *PVMM_VIRT2PHYS_SCATTER, **PPVMM_VIRT2PHYS_SCATTER;
+
 typedef struct tdVMM_MEMORYMODEL_FUNCTIONS {
     VOID(*pfnClose)();
-    BOOL(*pfnVirt2Phys)(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ QWORD va, _Out_ PQWORD ppa);
+    BOOL(*pfnVirt2Phys)(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ QWORD va, _Out_ PQWORD ppa, _Out_opt_ PDWORD pcPageShift);
+    VOID(*pfnVirt2PhysScatter)(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ DWORD cV2P, _Inout_updates_(cV2P) PPVMM_VIRT2PHYS_SCATTER ppV2Ps);     // ppV2Ps sorted by va
     VOID(*pfnVirt2PhysVadEx)(_In_ QWORD paPT, _Inout_ PVMMOB_MAP_VADEX pVadEx, _In_ BYTE iPML, _Inout_ PDWORD piVadEx);
     VOID(*pfnVirt2PhysGetInformation)(_Inout_ PVMM_PROCESS pProcess, _Inout_ PVMM_VIRT2PHYS_INFORMATION pVirt2PhysInfo);
     VOID(*pfnPhys2VirtGetInformation)(_In_ PVMM_PROCESS pProcess, _Inout_ PVMMOB_PHYS2VIRT_INFORMATION pP2V);
@@ -943,6 +1055,7 @@ typedef struct tdVMM_MEMORYMODEL_FUNCTIONS {
     VOID(*pfnTlbSpider)(_In_ PVMM_PROCESS pProcess);
     BOOL(*pfnTlbPageTableVerify)(_Inout_ PBYTE pb, _In_ QWORD pa, _In_ BOOL fSelfRefReq);
     BOOL(*pfnPagedRead)(_In_ PVMM_PROCESS pProcess, _In_opt_ QWORD va, _In_ QWORD pte, _Out_writes_opt_(4096) PBYTE pbPage, _Out_ PQWORD ppa, _Inout_opt_ PVMM_PTE_TP ptp, _In_ QWORD flags);
+    VOID(*pfnPagedReadScatter)(_In_ PVMM_PROCESS pProcess, _In_ DWORD cPTE, _In_reads_(cPTE) PQWORD pqwPTE, _In_ QWORD flags);         // batch read into paging cache
 } VMM_MEMORYMODEL_FUNCTIONS;
 
 #define VMM_EPROCESS_DWORD(pProcess, offset)    (*(PDWORD)(pProcess->win.EPROCESS.pb + offset))
@@ -958,6 +1071,8 @@ typedef struct tdVMM_MEMORYMODEL_FUNCTIONS {
 typedef struct tdVmmConfig {
     QWORD paCR3;
     DWORD tpForensicMode;                 // command line forensic mode
+    DWORD cWorkThreads;                   // command line worker thread count (0 = default)
+    DWORD cForensicScanDepth;             // command line forensic physmem scan pipeline depth (0 = default)
     // flags below
     BOOL fVerboseDll;
     BOOL fVerbose;
@@ -969,6 +1084,8 @@ typedef struct tdVmmConfig {
     BOOL fWaitInitialize;
     BOOL fUserInteract;
     BOOL fFileInfoHeader;
+    BOOL fForensicCacheRefresh;           // command line: invalidate/regenerate forensic database cache
+    BOOL fForensicIngestRelaxed;          // command line: relaxed database durability during forensic ingest
     // strings below
     CHAR szPythonPath[MAX_PATH];
     CHAR szPageFile[10][MAX_PATH];
@@ -976,6 +1093,7 @@ typedef struct tdVmmConfig {
     CHAR szMemMapStr[2048];
     CHAR szLogFile[MAX_PATH];
     CHAR szLogLevel[MAX_PATH];
+    CHAR szForensicCacheDir[MAX_PATH];    // command line: forensic database cache directory
 } VMMCONFIG, *PVMMCONFIG;
 
 typedef struct tdVMM_STATISTICS {
@@ -984,6 +1102,9 @@ typedef struct tdVMM_STATISTICS {
     QWORD cPhysReadFail;
     QWORD cPhysWrite;
     QWORD cPhysRefreshCache;
+    QWORD cPhysReadAheadRead;       // speculative pages read from device
+    QWORD cPhysReadAheadUsed;       // speculative pages later retrieved from cache
+    QWORD cPhysReadAheadWasted;     // speculative pages dropped from cache unused
     struct {
         QWORD cPrototype;
         QWORD cTransition;
@@ -1003,8 +1124,12 @@ typedef struct tdVMM_STATISTICS {
     QWORD cTlbReadSuccess;
     QWORD cTlbReadFail;
     QWORD cTlbRefreshCache;
+    QWORD cTlbVirt2PhysCacheHit;
     QWORD cProcessRefreshPartial;
     QWORD cProcessRefreshFull;
+    QWORD cInfoDbCacheHit;          // infodb lookups found in the in-memory symbol cache
+    QWORD cInfoDbCacheNotFound;     // infodb lookups answered as not found by the in-memory symbol cache
+    QWORD cInfoDbCacheMiss;         // infodb lookups requiring a sqlite query
 } VMM_STATISTICS, *PVMM_STATISTICS;
 
 typedef struct tdVMM_OFFSET_EPROCESS {
@@ -1234,6 +1359,7 @@ typedef struct tdVMM_CONTEXT {
         PVOID FLinkForensic;
         PVOID Root;
         PVOID Proc;
+        QWORD qwGeneration;     // unique per plugin manager initialization (0 = not initialized)
         struct {
             DWORD cEvent;
             HANDLE hEvent[MAXIMUM_WAIT_OBJECTS];
@@ -1267,13 +1393,22 @@ typedef struct tdVMM_CONTEXT {
         VMM_CACHE_TABLE PAGING;
         POB_SET PAGING_FAILED;
         POB_MAP pmPrototypePte;     // map with mm_vad.c managed data
+        VMM_READAHEAD ReadAhead[VMM_READAHEAD_SHARDS];  // physical read-ahead access pattern state (per thread shard)
+        VMM_READSTREAM ReadStream;  // sequential file stream read-ahead state
     } Cache;
     // worker threads
     struct {
         BOOL fEnabled;
-        POB_SET psThreadAll;
-        POB_SET psThreadAvail;
-        POB_SET psUnit;
+        DWORD cThread;
+        DWORD cThreadAlive;
+        struct tdVMMWORK_THREAD_CONTEXT **ppThread;
+        POB_SET psThreadAvail;      // idle worker threads
+        POB_SET psEventFree;        // pooled completion events
+        SRWLOCK LockSRW;            // injection queue and unit free list lock
+        struct tdVMMWORK_UNIT *pInjectFirst;
+        struct tdVMMWORK_UNIT *pInjectLast;
+        struct tdVMMWORK_UNIT *pUnitFree;
+        DWORD cUnitFree;
     } Work;
     WCHAR _EmptyWCHAR;
     VMMWIN_OBJECT_TYPE_TABLE ObjectTypeTable;
@@ -1337,6 +1472,14 @@ VOID VmmClose();
 */
 PVMMOB_CACHE_MEM VmmCacheGet(_In_ DWORD dwTblTag, _In_ QWORD qwA);
 
+/*
+* Retrieve the lookup hit/miss statistics of a cache table.
+* -- dwTblTag
+* -- pcHit
+* -- pcMiss
+*/
+VOID VmmCacheStatistics(_In_ DWORD dwTblTag, _Out_ PQWORD pcHit, _Out_ PQWORD pcMiss);
+
 /*
 * Retrieve a page table (0x1000 bytes) via the TLB cache.
 * CALLER DECREF: return
@@ -1489,6 +1632,48 @@ BOOL VmmReadWtoU(
 */
 VOID VmmReadEx(_In_opt_ PVMM_PROCESS pProcess, _In_ QWORD qwA, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _Out_opt_ PDWORD pcbReadOpt, _In_ QWORD flags);
 
+/*
+* Read from a zero-padded file stream - such as memory.pmem or a minidump.
+* Data is read by the synchronous read function pfnRead. Sequential access is
+* detected per stream, once detected the stream is read ahead asynchronously
+* by the worker threads into a bounded per-stream buffer. A seek cancels any
+* read-ahead in progress. Streams are tracked per file and file handle so that
+* concurrent readers of the same file don't cancel each other. Streams idle for
+* VMM_READSTREAM_IDLE_MS are freed. Thresholds: ctxVmm->Cache.ReadStream.
+* -- qwStreamId = non-zero id unique for the file.
+* -- qwHandleId = id of the file handle read through (0 if read by path).
+* -- pfnRead = synchronous read function (may be called on worker threads).
+* -- pObCtx = optional object forwarded to pfnRead.
+* -- cbFile = file size.
+* -- pb
+* -- cb
+* -- pcbReadOpt
+* -- cbOffset
+*/
+VOID VmmReadStream(
+    _In_ QWORD qwStreamId,
+    _In_ QWORD qwHandleId,
+    _In_ PVMM_READSTREAM_PFN pfnRead,
+    _In_opt_ POB pObCtx,
+    _In_ QWORD cbFile,
+    _Out_writes_(cb) PBYTE pb,
+    _In_ DWORD cb,
+    _Out_opt_ PDWORD pcbReadOpt,
+    _In_ QWORD cbOffset
+);
+
+/*
+* Discard all read-ahead data of file streams and free streams that have been
+* idle for VMM_READSTREAM_IDLE_MS - e.g. on memory cache refresh.
+*/
+VOID VmmReadStream_Invalidate();
+
+/*
+* Free the file streams of a file handle - e.g. when the handle is closed.
+* -- qwHandleId
+*/
+VOID VmmReadStream_CloseHandle(_In_ QWORD qwHandleId);
+
 /*
 * Read a single 4096-byte page of memory, virtual or physical.
 * Virtual memory is read if a process is specified in pProcess.
@@ -1657,6 +1842,16 @@ typedef struct tdVMM_MEMORY_SEARCH_CONTEXT {
     // for ranges inbetween vaMin:vaMax callback with pte or vad entry.
     // return: read from range(TRUE), do not read from range(FALSE).
     BOOL(*pfnFilterOptCB)(_In_ struct tdVMM_MEMORY_SEARCH_CONTEXT *ctxs, _In_opt_ PVMM_MAP_PTEENTRY pePte, _In_opt_ PVMM_MAP_VADENTRY peVad);
+    // optional search entries. if set cSearch entries are read from pSearch
+    // instead of search[] - allowing more than VMM_MEMORY_SEARCH_MAX entries.
+    PVMM_MEMORY_SEARCH_CONTEXT_SEARCHENTRY pSearch;
+    // optional streaming result callback function - called with the hits of
+    // each searched chunk in address order (hits at the same address ordered
+    // by search index). takes precedence over pfnResultOptCB and disables
+    // result in ppObAddressResult. the search does not proceed until the
+    // callback returns. hits are not capped.
+    // return = continue search(TRUE), end search early - not an error(FALSE).
+    BOOL(*pfnResultBatchOptCB)(_In_ struct tdVMM_MEMORY_SEARCH_CONTEXT *ctxs, _In_ DWORD cResult, _In_reads_(cResult) PQWORD pva, _In_reads_(cResult) PDWORD piSearch);
 } VMM_MEMORY_SEARCH_CONTEXT, *PVMM_MEMORY_SEARCH_CONTEXT;
 
 /*
@@ -1666,6 +1861,9 @@ typedef struct tdVMM_MEMORY_SEARCH_CONTEXT {
 * Search may take a long time. It's not recommended to run this interactively.
 * To cancel a search prematurely set the fAbortRequested flag in pctx and
 * wait a short while.
+* Memory is searched in parallel on the worker threads. Results, and calls to
+* the optional result callback, are delivered in address order on the calling
+* thread.
 * CALLER DECREF: ppObAddressResult
 * -- pProcess
 * -- ctxs
@@ -1808,6 +2006,37 @@ VOID VmmWork(_In_ LPTHREAD_START_ROUTINE pfn, _In_opt_ PVOID ctx, _In_opt_ HANDL
 */
 VOID VmmWorkWaitMultiple(_In_opt_ PVOID ctx, _In_ DWORD cWork, ...);
 
+/*
+* Parallel-for: call pfnAction once for each of cItem items on the worker
+* threads and on the calling thread. Items are processed heaviest first and
+* are handed out in chunks of decreasing total weight to balance the load.
+* Suitable weights are e.g. process VAD/PTE count (VmmProcessWeight), address
+* range size or page count.
+* Each participating thread has its own zero-initialized partial result of
+* cbPartial bytes forwarded to pfnAction. Once all items are processed each
+* partial result in use is forwarded to pfnReduceOpt on the calling thread.
+* NB! longer running functions must monitor ctxVmm->Work.fEnabled and exit
+*     immediately if required!
+* -- ctx = optional context forwarded to pfnAction / pfnReduceOpt.
+* -- cItem = number of items.
+* -- pqwWeight = optional item weights - if NULL all items are weighted equal.
+* -- cbPartial = size of per-thread partial result (0 = no partial result).
+* -- pfnAction = processing function to be called in multi-threaded context.
+* -- pfnReduceOpt = optional function combining partial results.
+* -- pfAbortOpt = optional cancellation flag - no more items are started once set.
+* -- return = TRUE if all items were processed, FALSE on failure/cancellation.
+*/
+_Success_(return)
+BOOL VmmWorkParallelFor(
+    _In_opt_ PVOID ctx,
+    _In_ DWORD cItem,
+    _In_reads_opt_(cItem) PQWORD pqwWeight,
+    _In_ DWORD cbPartial,
+    _In_ VOID(*pfnAction)(_In_opt_ PVOID ctx, _In_opt_ PVOID pvPartial, _In_ DWORD iItem),
+    _In_opt_ VOID(*pfnReduceOpt)(_In_opt_ PVOID ctx, _In_ PVOID pvPartial),
+    _In_opt_ PBOOL pfAbortOpt
+);
+
 /*
 * Perform multi-threaded parallel processing of processes in the process table.
 * This is useful when slow I/O should take place on multiple or all processes
@@ -1816,7 +2045,7 @@ VOID VmmWorkWaitMultiple(_In_opt_ PVOID ctx, _In_ DWORD cWork, ...);
 * check which of the processes that should be processed. The absence of the
 * critera function means all processes - including terminated processes.
 * The selected processes are forwarded to the callback function pfnAction in
-* parallel on multiple threads.
+* parallel on multiple threads - larger processes (by VmmProcessWeight) first.
 * NB! Manipulation of ctx in pfnAction callback function must be thread-safe!
 * NB! For fast actions VmmProcessGetNext in single-threaded mode is recommended
 *     over the use of this function!
@@ -1841,7 +2070,16 @@ BOOL VmmProcessActionForeachParallel_CriteriaActiveOnly(_In_ PVMM_PROCESS pProce
 BOOL VmmProcessActionForeachParallel_CriteriaActiveUserOnly(_In_ PVMM_PROCESS pProcess, _In_opt_ PVOID ctx);
 
 /*
-* Clear the oldest region of all InUse entries and make it the new active region.
+* Retrieve the estimated relative cost of processing a process - suitable as
+* item weight in VmmWorkParallelFor. Based on already existing maps only.
+* -- pProcess
+* -- return
+*/
+QWORD VmmProcessWeight(_In_ PVMM_PROCESS pProcess);
+
+/*
+* Advance the cache one refresh tick and make the oldest region the new active
+* region. Entries older than VMM_CACHE_REGIONS ticks expire one at a time.
 * -- wTblTag
 */
 VOID VmmCacheClearPartial(_In_ DWORD dwTblTag);
@@ -104,6 +104,18 @@ BOOL VmmDll_ConfigIntialize(_In_ DWORD argc, _In_ char* argv[])
             ctxMain->cfg.fWaitInitialize = TRUE;
             i++;
             continue;
+        } else if((0 == _stricmp(argv[i], "-fuse-fast")) || (0 == _stricmp(argv[i], "-fuse-direct-io"))) {
+            // FUSE option parsed by memprocfs - ignore here.
+            i++;
+            continue;
+        } else if(0 == _stricmp(argv[i], "-forensic-cache-refresh")) {
+            ctxMain->cfg.fForensicCacheRefresh = TRUE;
+            i++;
+            continue;
+        } else if(0 == _stricmp(argv[i], "-forensic-ingest-relaxed")) {
+            ctxMain->cfg.fForensicIngestRelaxed = TRUE;
+            i++;
+            continue;
         } else if(i + 1 >= argc) {
             return FALSE;
         } else if(0 == _stricmp(argv[i], "-cr3")) {
@@ -115,6 +127,18 @@ BOOL VmmDll_ConfigIntialize(_In_ DWORD argc, _In_ char* argv[])
             if(ctxMain->cfg.tpForensicMode > FC_DATABASE_TYPE_MAX) { return FALSE; }
             i += 2;
             continue;
+        } else if(0 == _stricmp(argv[i], "-forensic-cache")) {
+            strcpy_s(ctxMain->cfg.szForensicCacheDir, MAX_PATH, argv[i + 1]);
+            i += 2;
+            continue;
+        } else if(0 == _stricmp(argv[i], "-forensic-scan-depth")) {
+            ctxMain->cfg.cForensicScanDepth = (DWORD)Util_GetNumericA(argv[i + 1]);
+            i += 2;
+            continue;
+        } else if(0 == _stricmp(argv[i], "-threads")) {
+            ctxMain->cfg.cWorkThreads = (DWORD)Util_GetNumericA(argv[i + 1]);
+            i += 2;
+            continue;
         } else if(0 == _stricmp(argv[i], "-max")) {
             ctxMain->dev.paMax = Util_GetNumericA(argv[i + 1]);
             i += 2;
@@ -246,6 +270,14 @@ VOID VmmDll_PrintHelp()
         "          Example: -pythondisable                                              \n" \
         "   -mount : drive letter/path to mount The Memory Process File system at.      \n" \
         "          default: M   Example: -mount Q                                       \n" \
+        "   -fuse-fast : Linux only. Mount the FUSE file system in high-throughput mode \n" \
+        "          with 1MB read/write requests and splice. Example: -fuse-fast         \n" \
+        "   -fuse-direct-io : Linux only. Together with -fuse-fast: bypass the page     \n" \
+        "          cache (direct i/o) for volatile files. NB! files opened with direct  \n" \
+        "          i/o, such as memory.pmem, can't be memory mapped (mmap).             \n" \
+        "          Example: -fuse-fast -fuse-direct-io                                  \n" \
+        "   -threads : number of worker threads. Default: one per processor core, but   \n" \
+        "          at least 32 threads. Example: -threads 64                            \n" \
         "   -norefresh : disable automatic cache and processes refreshes even when      \n" \
         "          running against a live memory target - such as PCIe FPGA or live     \n" \
         "          driver acquired memory. This is not recommended. Example: -norefresh \n" \
@@ -266,6 +298,17 @@ VOID VmmDll_PrintHelp()
         "          3 = forensic mode with temp sqlite database remaining upon exit.     \n" \
         "          4 = forensic mode with static named sqlite database (vmm.sqlite3).   \n" \
         "          default: 0  Example -forensic 4                                      \n" \
+        "   -forensic-scan-depth : number of 16MB physical memory chunks read ahead in  \n" \
+        "          parallel during the forensic scan. Range: 2-16. Default: 4           \n" \
+        "          Example: -forensic-scan-depth 8                                      \n" \
+        "   -forensic-cache : directory in which the forensic database and outputs are  \n" \
+        "          persisted. A cache matching the memory image and MemProcFS build is  \n" \
+        "          reused read-only instead of re-running the forensic scan.            \n" \
+        "          Example: -forensic 1 -forensic-cache c:\\temp\\vmmcache               \n" \
+        "   -forensic-cache-refresh : invalidate and regenerate the forensic cache.     \n" \
+        "   -forensic-ingest-relaxed : faster forensic database ingest by turning off   \n" \
+        "          sqlite synchronous writes and the on-disk journal until the forensic \n" \
+        "          scan has completed. Default durability settings are restored after.  \n" \
         "                                                                               \n",
         VERSION_MAJOR, VERSION_MINOR, VERSION_REVISION
     );
@@ -518,6 +561,12 @@ BOOL VMMDLL_ConfigGet(_In_ ULONG64 fOption, _Out_ PULONG64 pqwValue)
         case VMMDLL_OPT_CONFIG_TICK_PERIOD:
             *pqwValue = ctxVmm->ThreadProcCache.cMs_TickPeriod;
             return TRUE;
+        case VMMDLL_OPT_CONFIG_READAHEAD_TRIGGER:
+            *pqwValue = ctxVmm->Cache.ReadStream.cTrigger;
+            return TRUE;
+        case VMMDLL_OPT_CONFIG_READAHEAD_SIZE:
+            *pqwValue = ctxVmm->Cache.ReadStream.cbReadAhead;
+            return TRUE;
         case VMMDLL_OPT_CONFIG_READCACHE_TICKS:
             *pqwValue = ctxVmm->ThreadProcCache.cTick_MEM;
             return TRUE;
@@ -641,6 +690,12 @@ BOOL VMMDLL_ConfigSet(_In_ ULONG64 fOption, _In_ ULONG64 qwValue)
         case VMMDLL_OPT_CONFIG_TICK_PERIOD:
             ctxVmm->ThreadProcCache.cMs_TickPeriod = (DWORD)qwValue;
             return TRUE;
+        case VMMDLL_OPT_CONFIG_READAHEAD_TRIGGER:
+            ctxVmm->Cache.ReadStream.cTrigger = (DWORD)qwValue;
+            return TRUE;
+        case VMMDLL_OPT_CONFIG_READAHEAD_SIZE:
+            ctxVmm->Cache.ReadStream.cbReadAhead = (DWORD)min(VMM_READSTREAM_SIZE_MAX, qwValue);
+            return TRUE;
         case VMMDLL_OPT_CONFIG_READCACHE_TICKS:
             ctxVmm->ThreadProcCache.cTick_MEM = (DWORD)qwValue;
             return TRUE;
@@ -872,6 +927,109 @@ NTSTATUS VMMDLL_VfsWriteU(_In_ LPSTR uszFileName, _In_reads_(cb) PBYTE pb, _In_
         VMMDLL_VfsWrite_Impl(uszFileName, pb, cb, pcbWrite, cbOffset))
 }
 
+#define VMMDLL_VFS_HANDLE_MAGIC     0x2f6a7b53c4d19e08
+
+typedef struct tdVMMDLL_VFS_HANDLE_CONTEXT {
+    QWORD qwMagic;
+    DWORD dwPID;                // (DWORD)-1 if not a per-process file
+    PLUGINMANAGER_FILE File;
+} VMMDLL_VFS_HANDLE_CONTEXT, *PVMMDLL_VFS_HANDLE_CONTEXT;
+
+VMMDLL_VFS_HANDLE VMMDLL_VfsOpen_Impl(_In_ LPSTR uszPath)
+{
+    DWORD dwPID = (DWORD)-1;
+    LPSTR uszSubPath;
+    PVMM_PROCESS pObProcess = NULL;
+    PVMMDLL_VFS_HANDLE_CONTEXT ctx = NULL;
+    if(!ctxVmm) { return NULL; }
+    if(uszPath[0] == '\\') { uszPath++; }
+    if(Util_VfsHelper_GetIdDir(uszPath, FALSE, &dwPID, &uszSubPath)) {
+        if(!(pObProcess = VmmProcessGet(dwPID))) { goto fail; }
+        uszPath = uszSubPath;
+    }
+    if(!(ctx = LocalAlloc(0, sizeof(VMMDLL_VFS_HANDLE_CONTEXT)))) { goto fail; }
+    if(!PluginManager_FileResolve(pObProcess ? TRUE : FALSE, uszPath, &ctx->File)) { goto fail; }
+    ctx->qwMagic = VMMDLL_VFS_HANDLE_MAGIC;
+    ctx->dwPID = pObProcess ? dwPID : (DWORD)-1;
+    Ob_DECREF(pObProcess);
+    return (VMMDLL_VFS_HANDLE)ctx;
+fail:
+    Ob_DECREF(pObProcess);
+    LocalFree(ctx);
+    return NULL;
+}
+
+_Success_(return != NULL)
+VMMDLL_VFS_HANDLE VMMDLL_VfsOpenU(_In_ LPSTR uszFileName)
+{
+    CALL_IMPLEMENTATION_VMM_RETURN(
+        STATISTICS_ID_VMMDLL_VfsOpen,
+        VMMDLL_VFS_HANDLE,
+        NULL,
+        VMMDLL_VfsOpen_Impl(uszFileName))
+}
+
+NTSTATUS VMMDLL_VfsReadWriteHandle_Impl(_In_ VMMDLL_VFS_HANDLE hVfs, _In_ BOOL fWrite, _Inout_updates_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcb, _In_ QWORD cbOffset)
+{
+    NTSTATUS nt;
+    PVMM_PROCESS pObProcess = NULL;
+    PVMMDLL_VFS_HANDLE_CONTEXT ctx = (PVMMDLL_VFS_HANDLE_CONTEXT)hVfs;
+    *pcb = 0;
+    if(!ctx || (ctx->qwMagic != VMMDLL_VFS_HANDLE_MAGIC)) { return VMM_STATUS_FILE_INVALID; }
+    // the process is looked up (cheap) on each call to follow process refreshes.
+    if((ctx->dwPID != (DWORD)-1) && !(pObProcess = VmmProcessGet(ctx->dwPID))) { return VMM_STATUS_FILE_INVALID; }
+    if(fWrite) {
+        nt = PluginManager_FileWrite(pObProcess, &ctx->File, pb, cb, pcb, cbOffset);
+    } else {
+        nt = PluginManager_FileRead(pObProcess, &ctx->File, pb, cb, pcb, cbOffset);
+    }
+    Ob_DECREF(pObProcess);
+    return nt;
+}
+
+NTSTATUS VMMDLL_VfsReadHandle(_In_ VMMDLL_VFS_HANDLE hVfs, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ ULONG64 cbOffset)
+{
+    CALL_IMPLEMENTATION_VMM_RETURN(
+        STATISTICS_ID_VMMDLL_VfsRead,
+        NTSTATUS,
+        VMMDLL_STATUS_UNSUCCESSFUL,
+        VMMDLL_VfsReadWriteHandle_Impl(hVfs, FALSE, pb, cb, pcbRead, cbOffset))
+}
+
+NTSTATUS VMMDLL_VfsWriteHandle(_In_ VMMDLL_VFS_HANDLE hVfs, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ ULONG64 cbOffset)
+{
+    CALL_IMPLEMENTATION_VMM_RETURN(
+        STATISTICS_ID_VMMDLL_VfsWrite,
+        NTSTATUS,
+        VMMDLL_STATUS_UNSUCCESSFUL,
+        VMMDLL_VfsReadWriteHandle_Impl(hVfs, TRUE, pb, cb, pcbWrite, cbOffset))
+}
+
+BOOL VMMDLL_VfsCloseHandle_Impl(_In_ PVMMDLL_VFS_HANDLE_CONTEXT ctx)
+{
+    VmmReadStream_CloseHandle(ctx->File.qwHandleId);
+    return TRUE;
+}
+
+_Success_(return)
+BOOL VMMDLL_VfsCloseHandle_Call(_In_ PVMMDLL_VFS_HANDLE_CONTEXT ctx)
+{
+    CALL_IMPLEMENTATION_VMM(
+        STATISTICS_ID_VMMDLL_VfsClose,
+        VMMDLL_VfsCloseHandle_Impl(ctx))
+}
+
+VOID VMMDLL_VfsCloseHandle(_In_opt_ _Post_ptr_invalid_ VMMDLL_VFS_HANDLE hVfs)
+{
+    PVMMDLL_VFS_HANDLE_CONTEXT ctx = (PVMMDLL_VFS_HANDLE_CONTEXT)hVfs;
+    if(!ctx || (ctx->qwMagic != VMMDLL_VFS_HANDLE_MAGIC)) { return; }
+    ctx->qwMagic = 0;
+    // read-ahead streams are released through the call wrapper (in sync with
+    // open/read/write) - the handle itself is free'd even if vmm is closed.
+    VMMDLL_VfsCloseHandle_Call(ctx);
+    LocalFree(ctx);
+}
+
 NTSTATUS VMMDLL_VfsWriteW(_In_ LPWSTR wszFileName, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ ULONG64 cbOffset)
 {
     LPSTR uszFileName;
@@ -1064,7 +1222,7 @@ BOOL VMMDLL_MemSearch_Impl(_In_ DWORD dwPID, _Inout_ PVMMDLL_MEM_SEARCH_CONTEXT
     if(pObData) {
         if(ppva) {
             if(!(*ppva = LocalAlloc(0, pObData->ObHdr.cbData))) { goto fail; }
-            memcpy(ppva, pObData->pqw, pObData->ObHdr.cbData);
+            memcpy(*ppva, pObData->pqw, pObData->ObHdr.cbData);
         }
         if(pcva) {
             *pcva = pObData->ObHdr.cbData / sizeof(QWORD);
@@ -88,6 +88,7 @@ typedef uint16_t                            WCHAR, *PWCHAR, *LPWSTR, *LPCWSTR;
 *              documentation for additional information.
 *    -norefresh = disable background refreshes (even if backing memory is
 *              volatile memory).
+*    -threads = number of worker threads (default: one per processor core, min 32).
 *    -memmap = specify a physical memory map given by file or specify 'auto'.
 *              example: -memmap c:\\temp\\my_custom_memory_map.txt
 *              example: -memmap auto
@@ -114,6 +115,14 @@ typedef uint16_t                            WCHAR, *PWCHAR, *LPWSTR, *LPCWSTR;
 *              3 = forensic mode with temp sqlite database remaining upon exit.
 *              4 = forensic mode with static named sqlite database (vmm.sqlite3).
 *              Example -forensic 4
+*    -forensic-scan-depth = number of 16MB physical memory chunks in flight in
+*              the forensic scan pipeline. Range: 2-16. Default: 4.
+*    -forensic-cache = directory in which to persist the forensic database and
+*              outputs. A cache matching the memory image and build is reused
+*              read-only instead of re-running the forensic scan.
+*    -forensic-cache-refresh = invalidate and regenerate the forensic cache.
+*    -forensic-ingest-relaxed = turn off sqlite synchronous writes and on-disk
+*              journal during forensic database ingest (restored afterwards).
 *
 * -- argc
 * -- argv
@@ -178,6 +187,8 @@ VOID VMMDLL_MemFree(_Frees_ptr_opt_ PVOID pvMem);
 #define VMMDLL_OPT_CONFIG_VMM_VERSION_REVISION          0x2000000B00000000  // R
 #define VMMDLL_OPT_CONFIG_STATISTICS_FUNCTIONCALL       0x2000000C00000000  // RW - enable function call statistics (.status/statistics_fncall file)
 #define VMMDLL_OPT_CONFIG_IS_PAGING_ENABLED             0x2000000D00000000  // RW - 1/0
+#define VMMDLL_OPT_CONFIG_READAHEAD_TRIGGER             0x2000000E00000000  // RW - # sequential file reads before async read-ahead starts (0 = disable)
+#define VMMDLL_OPT_CONFIG_READAHEAD_SIZE                0x2000000F00000000  // RW - async file read-ahead window in bytes
 
 #define VMMDLL_OPT_WIN_VERSION_MAJOR                    0x2000010100000000  // R
 #define VMMDLL_OPT_WIN_VERSION_MINOR                    0x2000010200000000  // R
@@ -413,6 +424,50 @@ EXPORTED_FUNCTION
 NTSTATUS VMMDLL_VfsWriteU(_In_ LPSTR  uszFileName, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ ULONG64 cbOffset);
 NTSTATUS VMMDLL_VfsWriteW(_In_ LPWSTR wszFileName, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ ULONG64 cbOffset);
 
+typedef HANDLE      VMMDLL_VFS_HANDLE;
+
+/*
+* Open a file in MemProcFS. The path is resolved once to the plugin handling
+* the file; subsequent reads/writes using the handle won't re-resolve it. This
+* is recommended for repeated reads/writes of the same (large) file.
+* CALLER CLOSE: VMMDLL_VfsCloseHandle(return)
+* -- [u]szFileName
+* -- return = handle to be used in VMMDLL_Vfs*Handle functions; NULL on fail.
+*/
+EXPORTED_FUNCTION _Success_(return != NULL)
+VMMDLL_VFS_HANDLE VMMDLL_VfsOpenU(_In_ LPSTR uszFileName);
+
+/*
+* Read select parts of a file opened with VMMDLL_VfsOpenU.
+* -- hVfs
+* -- pb
+* -- cb
+* -- pcbRead
+* -- cbOffset
+* -- return
+*/
+EXPORTED_FUNCTION
+NTSTATUS VMMDLL_VfsReadHandle(_In_ VMMDLL_VFS_HANDLE hVfs, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ ULONG64 cbOffset);
+
+/*
+* Write select parts to a file opened with VMMDLL_VfsOpenU.
+* -- hVfs
+* -- pb
+* -- cb
+* -- pcbWrite
+* -- cbOffset
+* -- return
+*/
+EXPORTED_FUNCTION
+NTSTATUS VMMDLL_VfsWriteHandle(_In_ VMMDLL_VFS_HANDLE hVfs, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ ULONG64 cbOffset);
+
+/*
+* Close a handle opened with VMMDLL_VfsOpenU.
+* -- hVfs
+*/
+EXPORTED_FUNCTION
+VOID VMMDLL_VfsCloseHandle(_In_opt_ _Post_ptr_invalid_ VMMDLL_VFS_HANDLE hVfs);
+
 /*
 * Utility functions for MemProcFS read/write towards different underlying data
 * representations.
@@ -651,6 +706,7 @@ VOID VMMDLL_LogEx(
 #define VMMDLL_FLAG_NOCACHEPUT                      0x0100  // do not write back to the data cache upon successful read from memory acquisition device.
 #define VMMDLL_FLAG_CACHE_RECENT_ONLY               0x0200  // only fetch from the most recent active cache region when reading.
 #define VMMDLL_FLAG_NO_PREDICTIVE_READ              0x0400  // do not perform additional predictive page reads (default on smaller requests).
+#define VMMDLL_FLAG_SCATTER_COALESCE                0x0800  // sort virtual reads by physical address after translation so that adjacent pages reach the device as contiguous runs; scatter handles also allow predictive reads.
 
 /*
 * Read memory in various non-contigious locations specified by the pointers to
@@ -760,7 +816,11 @@ BOOL VMMDLL_MemVirt2Phys(_In_ DWORD dwPID, _In_ ULONG64 qwVA, _Out_ PULONG64 pqw
 //     handle is closed since it may be used internally.
 // NB! VMMDLL_Scatter_ExecuteRead may be called at a later point in time to
 //     update (re-read) previously read data.
-// NB! larger reads (up to 1 GB max) are supported but not recommended.
+// NB! larger reads (up to 1 GB max of unique pages) are supported but not
+//     recommended.
+// NB! VMMDLL_Scatter_Clear keeps internal buffers for re-use (buffers much
+//     larger than last required are freed); re-using a handle is preferred
+//     over closing it and initializing a new handle.
 //-----------------------------------------------------------------------------
 typedef HANDLE      VMMDLL_SCATTER_HANDLE;
 
@@ -1520,7 +1580,7 @@ _Success_(return) BOOL VMMDLL_Map_GetServicesW(_Out_writes_bytes_opt_(*pcbServic
 // MEMORY SEARCH FUNCTIONALITY:
 //-----------------------------------------------------------------------------
 
-#define VMMDLL_MEM_SEARCH_VERSION           0xfe3e0002
+#define VMMDLL_MEM_SEARCH_VERSION           0xfe3e0004
 #define VMMDLL_MEM_SEARCH_MAX               16
 
 typedef struct tdVMMDLL_MEM_SEARCH_CONTEXT_SEARCHENTRY {
@@ -1559,6 +1619,16 @@ typedef struct tdVMMDLL_MEM_SEARCH_CONTEXT {
     // for ranges inbetween vaMin:vaMax callback with pte or vad entry.
     // return: read from range(TRUE), do not read from range(FALSE).
     BOOL(*pfnFilterOptCB)(_In_ struct tdVMMDLL_MEM_SEARCH_CONTEXT *ctx, _In_opt_ PVMMDLL_MAP_PTEENTRY pePte, _In_opt_ PVMMDLL_MAP_VADENTRY peVad);
+    // optional search entries. if set cSearch entries are read from pSearch
+    // instead of search[] - allowing more than VMMDLL_MEM_SEARCH_MAX entries.
+    PVMMDLL_MEM_SEARCH_CONTEXT_SEARCHENTRY pSearch;
+    // optional streaming result callback function - called with the hits of
+    // each searched memory chunk in address order (hits at the same address
+    // ordered by search index). takes precedence over pfnResultOptCB and
+    // disables ordinary result in ppva. the search does not proceed until the
+    // callback returns. hits are not capped.
+    // return = continue search(TRUE), end search early - not an error(FALSE).
+    BOOL(*pfnResultBatchOptCB)(_In_ struct tdVMMDLL_MEM_SEARCH_CONTEXT *ctx, _In_ DWORD cResult, _In_reads_(cResult) PQWORD pva, _In_reads_(cResult) PDWORD piSearch);
 } VMMDLL_MEM_SEARCH_CONTEXT, *PVMMDLL_MEM_SEARCH_CONTEXT;
 
 /*
@@ -1568,6 +1638,8 @@ typedef struct tdVMMDLL_MEM_SEARCH_CONTEXT {
 * Search may take a long time. It's not recommended to run this interactively.
 * To cancel a search prematurely set the fAbortRequested flag in the context
 * and wait a short while.
+* To receive results while the search is ongoing set pfnResultBatchOptCB in
+* the context; the callback may end the search early by returning FALSE.
 * CALLER FREE: VMMDLL_MemFree(*ppva)
 * -- dwPID
 * -- ctx
@@ -12,27 +12,49 @@
 #define SCATTER_MAX_SIZE            0x40000000
 #define SCATTER_CONTEXT_MAGIC       0x5a5d65c8465a32d5
 
+#define SCATTER_MAX_PAGES           (SCATTER_MAX_SIZE >> 12)
+#define SCATTER_SHRINK_THRESHOLD    0x00100000  // handle storage larger than this is freed on clear if mostly unused
+
+#define SCATTER_MEMBLOCK_COUNT      0x100
+#define SCATTER_RANGE_COUNT_MIN     0x40
+
 typedef struct tdSCATTER_RANGE {
-    struct tdSCATTER_RANGE *FLink;
     QWORD va;
     PDWORD pcbRead;
     PBYTE pb;
     DWORD cb;
-    DWORD cMEMs;
-    MEM_SCATTER MEMs[0];
 } SCATTER_RANGE, *PSCATTER_RANGE;
 
+// MEMs are allocated in fixed-size blocks which are kept and re-used across
+// calls to VMMDLL_Scatter_Clear() - this keeps MEM pointers stable while the
+// handle is being prepared and avoids allocator churn on re-use. Blocks well
+// above what the handle last required are freed by VMMDLL_Scatter_Clear().
+typedef struct tdSCATTER_MEMBLOCK {
+    struct tdSCATTER_MEMBLOCK *FLink;
+    MEM_SCATTER MEMs[SCATTER_MEMBLOCK_COUNT];
+} SCATTER_MEMBLOCK, *PSCATTER_MEMBLOCK;
+
 typedef struct tdSCATTER_CONTEXT {
     QWORD qwMagic;
     SRWLOCK LockSRW;
     DWORD dwReadFlags;
     BOOL fExecuteRead;
     DWORD dwPID;
-    DWORD cPageTotal;
-    DWORD cPageAlloc;
-    POB_MAP pmMEMs;
-    PBYTE pbBuffer;
+    DWORD cMEM;                         // # prepared MEMs (may contain duplicate pages until executed)
+    DWORD cMEMCompactNext;              // # prepared MEMs at which duplicate pages are next compacted
+    DWORD cPageTotal;                   // # unique pages in ppMEMs (valid after execute)
+    PSCATTER_MEMBLOCK pMemBlockFirst;
+    PSCATTER_MEMBLOCK pMemBlockCurrent;
+    DWORD iMemBlock;                    // next free MEM index in pMemBlockCurrent
+    DWORD cMemBlock;                    // # allocated MEM blocks
+    DWORD cRange;
+    DWORD cRangeAlloc;
     PSCATTER_RANGE pRanges;
+    DWORD cpMEMsAlloc;
+    PPMEM_SCATTER ppMEMs;               // MEMs sorted by page address, duplicates merged
+    DWORD cbBufferAlloc;
+    DWORD cbBuffer;                     // # bytes of pbBuffer used by last execute
+    PBYTE pbBuffer;                     // internal page buffer for MEMs without user buffer
 } SCATTER_CONTEXT, *PSCATTER_CONTEXT;
 
 #define SCATTER_CALL_SYNCHRONIZED_IMPLEMENTATION(hS, fn) {                                      \
@@ -44,13 +66,201 @@ typedef struct tdSCATTER_CONTEXT {
     return fResult;                                                                             \
 }
 
+/*
+* Retrieve a fresh MEM from the handle MEM blocks. Blocks are allocated on
+* demand and are kept for re-use when the handle is cleared.
+* -- ctx
+* -- return
+*/
+PMEM_SCATTER VMMDLL_Scatter_MemAlloc(_In_ PSCATTER_CONTEXT ctx)
+{
+    PMEM_SCATTER pMEM;
+    PSCATTER_MEMBLOCK pBlock;
+    if(!ctx->pMemBlockCurrent || (ctx->iMemBlock == SCATTER_MEMBLOCK_COUNT)) {
+        if(ctx->pMemBlockCurrent && ctx->pMemBlockCurrent->FLink) {
+            pBlock = ctx->pMemBlockCurrent->FLink;
+        } else if(!ctx->pMemBlockCurrent && ctx->pMemBlockFirst) {
+            pBlock = ctx->pMemBlockFirst;
+        } else {
+            if(!(pBlock = LocalAlloc(0, sizeof(SCATTER_MEMBLOCK)))) { return NULL; }
+            pBlock->FLink = NULL;
+            ctx->cMemBlock++;
+            if(ctx->pMemBlockCurrent) {
+                ctx->pMemBlockCurrent->FLink = pBlock;
+            } else {
+                ctx->pMemBlockFirst = pBlock;
+            }
+        }
+        ctx->pMemBlockCurrent = pBlock;
+        ctx->iMemBlock = 0;
+    }
+    pMEM = ctx->pMemBlockCurrent->MEMs + ctx->iMemBlock++;
+    ZeroMemory(pMEM, sizeof(MEM_SCATTER));
+    pMEM->version = MEM_SCATTER_VERSION;
+    pMEM->cb = 0x1000;
+    ctx->cMEM++;
+    return pMEM;
+}
+
+/*
+* Ensure a handle-owned array is able to hold at least cNeed entries. The array
+* is only ever grown - it's kept for re-use when the handle is cleared.
+* -- ppv = pointer to the array.
+* -- pcAlloc = pointer to the current allocated entry count.
+* -- cNeed = required entry count.
+* -- cbEntry = size of each entry.
+* -- return
+*/
+_Success_(return)
+BOOL VMMDLL_Scatter_Grow(_Inout_ PVOID *ppv, _Inout_ PDWORD pcAlloc, _In_ DWORD cNeed, _In_ DWORD cbEntry)
+{
+    PVOID pv;
+    DWORD cAlloc;
+    if(cNeed <= *pcAlloc) { return TRUE; }
+    cAlloc = max(max(cNeed, SCATTER_RANGE_COUNT_MIN), *pcAlloc * 2);
+    if(!(pv = LocalAlloc(0, (SIZE_T)cAlloc * cbEntry))) { return FALSE; }
+    if(*ppv) {
+        memcpy(pv, *ppv, (SIZE_T)*pcAlloc * cbEntry);
+        LocalFree(*ppv);
+    }
+    *ppv = pv;
+    *pcAlloc = cAlloc;
+    return TRUE;
+}
+
+/*
+* Free a handle-owned array if it's larger than SCATTER_SHRINK_THRESHOLD and
+* less than a quarter of it was used - it's re-grown on demand.
+* -- ppv = pointer to the array.
+* -- pcAlloc = pointer to the current allocated entry count.
+* -- cUsed = # entries used.
+* -- cbEntry = size of each entry.
+*/
+VOID VMMDLL_Scatter_Shrink(_Inout_ PVOID *ppv, _Inout_ PDWORD pcAlloc, _In_ DWORD cUsed, _In_ DWORD cbEntry)
+{
+    if(((QWORD)*pcAlloc * cbEntry > SCATTER_SHRINK_THRESHOLD) && (cUsed < *pcAlloc / 4)) {
+        LocalFree(*ppv);
+        *ppv = NULL;
+        *pcAlloc = 0;
+    }
+}
+
+/*
+* Free a chain of MEM blocks.
+* -- pBlock
+*/
+VOID VMMDLL_Scatter_FreeMemBlocks(_In_opt_ PSCATTER_MEMBLOCK pBlock)
+{
+    PSCATTER_MEMBLOCK pBlockNext;
+    while(pBlock) {
+        pBlockNext = pBlock->FLink;
+        LocalFree(pBlock);
+        pBlock = pBlockNext;
+    }
+}
+
+int VMMDLL_Scatter_CmpMEM(_In_ PPMEM_SCATTER ppMEM1, _In_ PPMEM_SCATTER ppMEM2)
+{
+    QWORD va1 = (*ppMEM1)->qwA & ~0xfff;
+    QWORD va2 = (*ppMEM2)->qwA & ~0xfff;
+    return (va1 < va2) ? -1 : ((va1 > va2) ? 1 : 0);
+}
+
+/*
+* Sort the prepared MEMs by page address into ppMEMs and merge MEMs of the same
+* page into one single MEM. The # unique pages is stored in cPageTotal.
+* -- ctx
+* -- return
+*/
+_Success_(return)
+BOOL VMMDLL_Scatter_SortMerge(_In_ PSCATTER_CONTEXT ctx)
+{
+    DWORD i, c, iMEM;
+    PMEM_SCATTER pMEM, pMEMPrimary;
+    PSCATTER_MEMBLOCK pBlock;
+    // 1: collect MEMs
+    if(!VMMDLL_Scatter_Grow((PVOID*)&ctx->ppMEMs, &ctx->cpMEMsAlloc, ctx->cMEM, sizeof(PMEM_SCATTER))) { return FALSE; }
+    for(i = 0, pBlock = ctx->pMemBlockFirst; pBlock && (i < ctx->cMEM); pBlock = pBlock->FLink) {
+        for(iMEM = 0; (iMEM < SCATTER_MEMBLOCK_COUNT) && (i < ctx->cMEM); iMEM++) {
+            ctx->ppMEMs[i++] = pBlock->MEMs + iMEM;
+        }
+    }
+    // 2: sort by page address and merge duplicate pages
+    qsort(ctx->ppMEMs, ctx->cMEM, sizeof(PMEM_SCATTER), (_CoreCrtNonSecureSearchSortCompareFunction)VMMDLL_Scatter_CmpMEM);
+    for(i = 0, c = 0; i < ctx->cMEM; i++) {
+        pMEM = ctx->ppMEMs[i];
+        if(c && ((ctx->ppMEMs[c - 1]->qwA & ~0xfff) == (pMEM->qwA & ~0xfff))) {
+            // duplicate page -> since we have two reads subscribing to this
+            // page we 'upgrade' the primary MEM to a full MEM.
+            pMEMPrimary = ctx->ppMEMs[c - 1];
+            pMEMPrimary->qwA = pMEMPrimary->qwA & ~0xfff;
+            pMEMPrimary->cb = 0x1000;
+            if(!pMEMPrimary->pb) {
+                pMEMPrimary->pb = pMEM->pb;
+            }
+            continue;
+        }
+        ctx->ppMEMs[c++] = pMEM;
+    }
+    ctx->cPageTotal = c;
+    return TRUE;
+}
+
+/*
+* Merge prepared MEMs of the same page and move the remaining unique MEMs to
+* the front of the MEM blocks (in place). Done each time the prepared MEMs have
+* doubled since the last compaction to bound memory use on duplicate prepares.
+* -- ctx
+* -- return
+*/
+_Success_(return)
+BOOL VMMDLL_Scatter_Compact(_In_ PSCATTER_CONTEXT ctx)
+{
+    DWORD i, j;
+    PMEM_SCATTER pMEM;
+    PSCATTER_MEMBLOCK pBlock, pBlockDst;
+    if(!VMMDLL_Scatter_SortMerge(ctx)) { return FALSE; }
+    // mark unique MEMs - f is unused until the handle is executed.
+    for(i = 0; i < ctx->cPageTotal; i++) {
+        ctx->ppMEMs[i]->f = TRUE;
+    }
+    // move unique MEMs to the front in MEM block order - a MEM is only ever
+    // moved to a lower slot so no unique MEM is overwritten before it's moved.
+    pBlock = pBlockDst = ctx->pMemBlockFirst;
+    for(i = 0, j = 0; i < ctx->cMEM; i++) {
+        pMEM = pBlock->MEMs + (i % SCATTER_MEMBLOCK_COUNT);
+        if(pMEM->f) {
+            pMEM->f = FALSE;
+            if(i != j) {
+                memcpy(pBlockDst->MEMs + (j % SCATTER_MEMBLOCK_COUNT), pMEM, sizeof(MEM_SCATTER));
+            }
+            j++;
+            if(!(j % SCATTER_MEMBLOCK_COUNT)) { pBlockDst = pBlockDst->FLink; }
+        }
+        if(!((i + 1) % SCATTER_MEMBLOCK_COUNT)) { pBlock = pBlock->FLink; }
+    }
+    // set MEM allocation cursor after the last unique MEM.
+    ctx->cMEM = j;
+    ctx->cPageTotal = 0;
+    ctx->pMemBlockCurrent = NULL;
+    ctx->iMemBlock = 0;
+    if(j) {
+        for(i = SCATTER_MEMBLOCK_COUNT, pBlock = ctx->pMemBlockFirst; i < j; i += SCATTER_MEMBLOCK_COUNT) {
+            pBlock = pBlock->FLink;
+        }
+        ctx->pMemBlockCurrent = pBlock;
+        ctx->iMemBlock = j + SCATTER_MEMBLOCK_COUNT - i;
+    }
+    return TRUE;
+}
+
 _Success_(return)
 BOOL VMMDLL_Scatter_PrepareInternal(_In_ PSCATTER_CONTEXT ctx, _In_ QWORD va, _In_ DWORD cb, _Out_writes_opt_(cb) PBYTE pb, _Out_opt_ PDWORD pcbRead)
 {
     QWORD vaMEM;
     PMEM_SCATTER pMEM;
-    PSCATTER_RANGE pr = NULL;
-    DWORD i, iNewMEM = 0, cMEMsRequired, cMEMsPre = 0;
+    PSCATTER_RANGE pr;
+    DWORD i, cMEMsRequired;
     // zero out any buffer received
     if(pb) { ZeroMemory(pb, cb); }
     if(pcbRead) { *pcbRead = 0; }
@@ -58,70 +268,40 @@ BOOL VMMDLL_Scatter_PrepareInternal(_In_ PSCATTER_CONTEXT ctx, _In_ QWORD va, _I
     if(va + cb < va) { return FALSE; }
     if(ctx->fExecuteRead) { return FALSE; }
     if(!cb) { return TRUE; }
-    if((cb >= SCATTER_MAX_SIZE) || ((ctx->cPageTotal << 12) + cb > SCATTER_MAX_SIZE)) { return FALSE; }
-    // count MEMs (required and pre-existing)
+    if(cb >= SCATTER_MAX_SIZE) { return FALSE; }
     cMEMsRequired = ((va & 0xfff) + cb + 0xfff) >> 12;
-    vaMEM = va & ~0xfff;
-    for(i = 0; i < cMEMsRequired; i++) {
-        if(ObMap_ExistsKey(ctx->pmMEMs, vaMEM | 1)) {
-            cMEMsPre++;
-        }
-        vaMEM += 0x1000;
+    // the 1GB limit applies to unique pages and is checked on execute. the
+    // prepared MEMs are compacted once they have doubled since the last
+    // compaction - fail if the unique pages already exceed the limit.
+    if(ctx->cMEM + cMEMsRequired > ctx->cMEMCompactNext) {
+        if(!VMMDLL_Scatter_Compact(ctx) || (ctx->cMEM > SCATTER_MAX_PAGES)) { return FALSE; }
+        ctx->cMEMCompactNext = max(SCATTER_MAX_PAGES, 2 * ctx->cMEM);
     }
-    // alloc scatter range (including any new MEMs required)
-    if(pb || pcbRead || (cMEMsRequired > cMEMsPre)) {
-        if(!(pr = LocalAlloc(LMEM_ZEROINIT, sizeof(SCATTER_RANGE) + (cMEMsRequired - cMEMsPre) * sizeof(MEM_SCATTER)))) { return FALSE; }
+    // record scatter range (if result is to be copied to caller on execute)
+    if(pb || pcbRead) {
+        if(!VMMDLL_Scatter_Grow((PVOID*)&ctx->pRanges, &ctx->cRangeAlloc, ctx->cRange + 1, sizeof(SCATTER_RANGE))) { return FALSE; }
+        pr = ctx->pRanges + ctx->cRange++;
         pr->va = va;
         pr->cb = cb;
         pr->pb = pb;
         pr->pcbRead = pcbRead;
-        pr->cMEMs = cMEMsRequired - cMEMsPre;
-        for(i = 0; i < pr->cMEMs; i++) {
-            pMEM = pr->MEMs + i;
-            pMEM->version = MEM_SCATTER_VERSION;
-            pMEM->cb = 0x1000;
-        }
-        pr->FLink = ctx->pRanges;
-        ctx->pRanges = pr;
     }
-    // assign addresses and/or buffers to MEMs
+    // append MEMs - duplicate pages are merged when the handle is executed.
     vaMEM = va & ~0xfff;
     for(i = 0; i < cMEMsRequired; i++) {
-        if((pMEM = ObMap_GetByKey(ctx->pmMEMs, vaMEM | 1))) {
-            // pre-existing MEM
-            if(pMEM->cb != 0x1000) {
-                // pre-existing MEM was a tiny MEM -> since we have two reads
-                // subscribing to this MEM we 'upgrade' it to a full MEM.
-                pMEM->qwA = pMEM->qwA & ~0xfff;
-                pMEM->cb = 0x1000;
+        if(!(pMEM = VMMDLL_Scatter_MemAlloc(ctx))) { return FALSE; }
+        pMEM->qwA = vaMEM;
+        if((cMEMsRequired == 1) && (cb <= 0x400)) {
+            // single-page small read -> optimize MEM for small read.
+            // NB! buffer allocation still remains 0x1000 even if not all is used for now.
+            pMEM->cb = (cb + 15) & ~0x7;
+            pMEM->qwA = va & ~0x7;
+            if((pMEM->qwA & 0xfff) + pMEM->cb > 0x1000) {
+                pMEM->qwA = (pMEM->qwA & ~0xfff) + 0x1000 - pMEM->cb;
             }
-        } else {
-            // new MEM
-            if(!pr || (pr->cMEMs <= iNewMEM)) {
-                // should never happen!
-                return FALSE;
-            }
-            pMEM = pr->MEMs + iNewMEM;
-            iNewMEM++;
-            pMEM->qwA = vaMEM;
-            if((cMEMsRequired == 1) && (cb <= 0x400)) {
-                // single-page small read -> optimize MEM for small read.
-                // NB! buffer allocation still remains 0x1000 even if not all is used for now.
-                pMEM->cb = (cb + 15) & ~0x7;
-                pMEM->qwA = va & ~0x7;
-                if((pMEM->qwA & 0xfff) + pMEM->cb > 0x1000) {
-                    pMEM->qwA = (pMEM->qwA & ~0xfff) + 0x1000 - pMEM->cb;
-                }
-            }
-            if(!ObMap_Push(ctx->pmMEMs, vaMEM | 1, pMEM)) {
-                // should never happen!
-                return FALSE;
-            }
-            ctx->cPageTotal++;
         }
-        if(pb && !pMEM->pb && (vaMEM >= va) && (vaMEM + 0xfff < va + cb)) {
+        if(pb && (vaMEM >= va) && (vaMEM + 0xfff < va + cb)) {
             pMEM->pb = pb + vaMEM - va;
-            ctx->cPageAlloc++;
         }
         vaMEM += 0x1000;
     }
@@ -163,21 +343,38 @@ BOOL VMMDLL_Scatter_Prepare(_In_ VMMDLL_SCATTER_HANDLE hS, _In_ QWORD va, _In_ D
 _Success_(return)
 BOOL VMMDLL_Scatter_ClearInternal(_In_ PSCATTER_CONTEXT ctx, _In_ DWORD dwPID, _In_ DWORD flags)
 {
-    PSCATTER_RANGE pRange, pRangeNext = ctx->pRanges;
+    DWORD i, cMemBlockUsed;
+    PSCATTER_MEMBLOCK pBlock;
+    // shrink - storage much larger than required by the last use is freed.
+    VMMDLL_Scatter_Shrink((PVOID*)&ctx->pRanges, &ctx->cRangeAlloc, ctx->cRange, sizeof(SCATTER_RANGE));
+    VMMDLL_Scatter_Shrink((PVOID*)&ctx->ppMEMs, &ctx->cpMEMsAlloc, ctx->cMEM, sizeof(PMEM_SCATTER));
+    VMMDLL_Scatter_Shrink((PVOID*)&ctx->pbBuffer, &ctx->cbBufferAlloc, ctx->cbBuffer, 1);
+    cMemBlockUsed = (ctx->cMEM + SCATTER_MEMBLOCK_COUNT - 1) / SCATTER_MEMBLOCK_COUNT;
+    if(((QWORD)ctx->cMemBlock * sizeof(SCATTER_MEMBLOCK) > SCATTER_SHRINK_THRESHOLD) && (cMemBlockUsed < ctx->cMemBlock / 4)) {
+        if(cMemBlockUsed) {
+            for(i = 1, pBlock = ctx->pMemBlockFirst; i < cMemBlockUsed; i++) {
+                pBlock = pBlock->FLink;
+            }
+            VMMDLL_Scatter_FreeMemBlocks(pBlock->FLink);
+            pBlock->FLink = NULL;
+        } else {
+            VMMDLL_Scatter_FreeMemBlocks(ctx->pMemBlockFirst);
+            ctx->pMemBlockFirst = NULL;
+        }
+        ctx->cMemBlock = cMemBlockUsed;
+    }
+    // reset cursors - remaining storage is kept for re-use until the handle
+    // is closed.
     ctx->fExecuteRead = FALSE;
     ctx->dwPID = dwPID;
     ctx->dwReadFlags = flags;
+    ctx->cMEM = 0;
+    ctx->cMEMCompactNext = SCATTER_MAX_PAGES;
     ctx->cPageTotal = 0;
-    ctx->cPageAlloc = 0;
-    ctx->pRanges = NULL;
-    ObMap_Clear(ctx->pmMEMs);
-    LocalFree(ctx->pbBuffer);
-    ctx->pbBuffer = NULL;
-    while(pRangeNext) {
-        pRange = pRangeNext;
-        pRangeNext = pRange->FLink;
-        LocalFree(pRange);
-    }
+    ctx->cRange = 0;
+    ctx->cbBuffer = 0;
+    ctx->pMemBlockCurrent = NULL;
+    ctx->iMemBlock = 0;
     return TRUE;
 }
 
@@ -201,23 +398,42 @@ BOOL VMMDLL_Scatter_Clear(_In_ VMMDLL_SCATTER_HANDLE hS, _In_ DWORD dwPID, _In_
 VOID VMMDLL_Scatter_CloseHandle(_In_opt_ _Post_ptr_invalid_ VMMDLL_SCATTER_HANDLE hS)
 {
     PSCATTER_CONTEXT ctx = (PSCATTER_CONTEXT)hS;
-    PSCATTER_RANGE pRange, pRangeNext;
     if(!ctx || (ctx->qwMagic != SCATTER_CONTEXT_MAGIC)) { return; }
     AcquireSRWLockExclusive(&ctx->LockSRW);
     ctx->qwMagic = 0;
     ReleaseSRWLockExclusive(&ctx->LockSRW);
     // dealloc / free
-    Ob_DECREF(ctx->pmMEMs);
     LocalFree(ctx->pbBuffer);
-    pRangeNext = ctx->pRanges;
-    while(pRangeNext) {
-        pRange = pRangeNext;
-        pRangeNext = pRange->FLink;
-        LocalFree(pRange);
-    }
+    LocalFree(ctx->ppMEMs);
+    LocalFree(ctx->pRanges);
+    VMMDLL_Scatter_FreeMemBlocks(ctx->pMemBlockFirst);
     LocalFree(ctx);
 }
 
+/*
+* Retrieve the MEM of a page by binary search in the sorted MEM array.
+* -- ctx
+* -- va = page address.
+* -- return
+*/
+PMEM_SCATTER VMMDLL_Scatter_GetMEM(_In_ PSCATTER_CONTEXT ctx, _In_ QWORD va)
+{
+    QWORD vaMEM;
+    DWORD iLo = 0, iHi = ctx->cPageTotal, i;
+    va = va & ~0xfff;
+    while(iLo < iHi) {
+        i = (iLo + iHi) >> 1;
+        vaMEM = ctx->ppMEMs[i]->qwA & ~0xfff;
+        if(vaMEM == va) { return ctx->ppMEMs[i]; }
+        if(vaMEM < va) {
+            iLo = i + 1;
+        } else {
+            iHi = i;
+        }
+    }
+    return NULL;
+}
+
 _Success_(return)
 BOOL VMMDLL_Scatter_ReadInternal(_In_ PSCATTER_CONTEXT ctx, _In_ QWORD va, _In_ DWORD cb, _Out_writes_opt_(cb) PBYTE pb, _Out_opt_ PDWORD pcbRead)
 {
@@ -229,7 +445,7 @@ BOOL VMMDLL_Scatter_ReadInternal(_In_ PSCATTER_CONTEXT ctx, _In_ QWORD va, _In_
     // 1st item may not be page aligned or may be 'tiny' sized MEM:
     {
         cbChunk = min(cb, 0x1000 - (va & 0xfff));
-        pMEM = ObMap_GetByKey(ctx->pmMEMs, (va & ~0xfff) | 1);
+        pMEM = VMMDLL_Scatter_GetMEM(ctx, va);
         if(pMEM && pMEM->f) {
             if(pMEM->cb == 0x1000) {
                 // normal page-sized MEM:
@@ -259,7 +475,7 @@ BOOL VMMDLL_Scatter_ReadInternal(_In_ PSCATTER_CONTEXT ctx, _In_ QWORD va, _In_
     // page aligned va onwards (read from normal page-sized MEMs):
     while(cb) {
         cbChunk = min(cb, 0x1000);
-        pMEM = ObMap_GetByKey(ctx->pmMEMs, va | 1);
+        pMEM = VMMDLL_Scatter_GetMEM(ctx, va);
         if(pMEM && pMEM->f && (pMEM->cb == 0x1000)) {
             cbReadTotal += cbChunk;
             if(pb) {
@@ -299,47 +515,78 @@ BOOL VMMDLL_Scatter_Read(_In_ VMMDLL_SCATTER_HANDLE hS, _In_ QWORD va, _In_ DWOR
     SCATTER_CALL_SYNCHRONIZED_IMPLEMENTATION(hS, VMMDLL_Scatter_ReadInternal((PSCATTER_CONTEXT)hS, va, cb, pb, pcbRead));
 }
 
+/*
+* Sort the prepared MEMs by page address and merge MEMs of the same page into
+* one single MEM. Also assign the internal page buffer to MEMs which are not
+* backed by a caller supplied buffer.
+* -- ctx
+* -- return
+*/
+_Success_(return)
+BOOL VMMDLL_Scatter_ExecuteReadInternal_Sort(_In_ PSCATTER_CONTEXT ctx)
+{
+    DWORD i, cPageBuffer = 0, cbBuffer;
+    PMEM_SCATTER pMEM;
+    if(!VMMDLL_Scatter_SortMerge(ctx)) { return FALSE; }
+    if(ctx->cPageTotal > SCATTER_MAX_PAGES) { return FALSE; }
+    // assign internal buffer to MEMs without caller supplied buffer
+    for(i = 0; i < ctx->cPageTotal; i++) {
+        if(!ctx->ppMEMs[i]->pb) { cPageBuffer++; }
+    }
+    cbBuffer = cPageBuffer * 0x1000;
+    if(cbBuffer > ctx->cbBufferAlloc) {
+        LocalFree(ctx->pbBuffer);
+        ctx->cbBufferAlloc = 0;
+        if(!(ctx->pbBuffer = LocalAlloc(0, cbBuffer))) { return FALSE; }
+        ctx->cbBufferAlloc = cbBuffer;
+    }
+    for(i = 0, cbBuffer = 0; i < ctx->cPageTotal; i++) {
+        pMEM = ctx->ppMEMs[i];
+        if(!pMEM->pb) {
+            pMEM->pb = ctx->pbBuffer + cbBuffer;
+            ZeroMemory(pMEM->pb, 0x1000);
+            cbBuffer += 0x1000;
+        }
+    }
+    ctx->cbBuffer = cbBuffer;
+    return TRUE;
+}
+
 /*
 * ExecuteRead - internal synchronized function.
 */
 _Success_(return)
 BOOL VMMDLL_Scatter_ExecuteReadInternal(_In_ PSCATTER_CONTEXT ctx)
 {
-    DWORD i, cbBuffer, cbBufferAlloc, oBufferAllocMEM = 0;
+    DWORD i, dwReadFlags;
     PMEM_SCATTER pMEM;
-    PPMEM_SCATTER ppMEMs;
     PSCATTER_RANGE pRange;
     // validate
-    if(!ctx->cPageTotal || (ctx->cPageTotal != ObMap_Size(ctx->pmMEMs))) { return FALSE; }
-    // alloc (if required)
-    cbBuffer = (ctx->cPageTotal - ctx->cPageAlloc) * 0x1000;
+    if(!ctx->cMEM) { return FALSE; }
+    // sort & merge MEMs (first execute) or reset MEMs (re-read)
     if(!ctx->fExecuteRead) {
-        cbBufferAlloc = cbBuffer + ctx->cPageTotal * sizeof(PMEM_SCATTER);
-        if(!(ctx->pbBuffer = LocalAlloc(LMEM_ZEROINIT, cbBufferAlloc))) { return FALSE; }
-    }
-    ppMEMs = (PPMEM_SCATTER)(ctx->pbBuffer + cbBuffer);
-    // fixup MEMs
-    for(i = 0; i < ctx->cPageTotal; i++) {
-        pMEM = ObMap_GetByIndex(ctx->pmMEMs, i);
-        ppMEMs[i] = pMEM;
-        if(!pMEM->pb) {
-            pMEM->pb = ctx->pbBuffer + oBufferAllocMEM;
-            oBufferAllocMEM += 0x1000;
-        } else if(ctx->fExecuteRead) {
+        if(!VMMDLL_Scatter_ExecuteReadInternal_Sort(ctx)) { return FALSE; }
+    } else {
+        for(i = 0; i < ctx->cPageTotal; i++) {
+            pMEM = ctx->ppMEMs[i];
             pMEM->f = FALSE;
             ZeroMemory(pMEM->pb, 0x1000);
         }
     }
-    // read scatter
-    VMMDLL_MemReadScatter(ctx->dwPID, ppMEMs, ctx->cPageTotal, ctx->dwReadFlags | VMMDLL_FLAG_NO_PREDICTIVE_READ);
+    // read scatter - pages are dispatched in ascending address order. With
+    // VMMDLL_FLAG_SCATTER_COALESCE virtual reads are also sorted by physical
+    // address after translation and predictive reads are allowed to extend
+    // the contiguous runs. Otherwise exactly the requested pages are read.
+    dwReadFlags = ctx->dwReadFlags;
+    if(!(ctx->dwReadFlags & VMMDLL_FLAG_SCATTER_COALESCE)) {
+        dwReadFlags |= VMMDLL_FLAG_NO_PREDICTIVE_READ;
+    }
+    VMMDLL_MemReadScatter(ctx->dwPID, ctx->ppMEMs, ctx->cPageTotal, dwReadFlags);
     ctx->fExecuteRead = TRUE;
-    // range fixup (if required)
-    pRange = ctx->pRanges;
-    while(pRange) {
-        if(pRange->pb || pRange->pcbRead) {
-            VMMDLL_Scatter_ReadInternal(ctx, pRange->va, pRange->cb, pRange->pb, pRange->pcbRead);
-        }
-        pRange = pRange->FLink;
+    // range fixup
+    for(i = 0; i < ctx->cRange; i++) {
+        pRange = ctx->pRanges + i;
+        VMMDLL_Scatter_ReadInternal(ctx, pRange->va, pRange->cb, pRange->pb, pRange->pcbRead);
     }
     return TRUE;
 }
@@ -371,7 +618,7 @@ VMMDLL_SCATTER_HANDLE VMMDLL_Scatter_Initialize(_In_ DWORD dwPID, _In_ DWORD fla
     ctx->qwMagic = SCATTER_CONTEXT_MAGIC;
     ctx->dwPID = dwPID;
     ctx->dwReadFlags = flags;
-    if(!(ctx->pmMEMs = ObMap_New(OB_MAP_FLAGS_OBJECT_VOID))) { goto fail; }
+    ctx->cMEMCompactNext = SCATTER_MAX_PAGES;
     return ctx;
 fail:
     VMMDLL_Scatter_CloseHandle((VMMDLL_SCATTER_HANDLE)ctx);
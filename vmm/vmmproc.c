@@ -108,6 +108,7 @@ BOOL VmmProcRefresh_MEM()
     VmmCacheClearPartial(VMM_CACHE_TAG_PAGING);
     InterlockedIncrement64(&ctxVmm->stat.cPageRefreshCache);
     ObSet_Clear(ctxVmm->Cache.PAGING_FAILED);
+    VmmReadStream_Invalidate();
     LeaveCriticalSection(&ctxVmm->LockMaster);
     return TRUE;
 }
@@ -0,0 +1,506 @@
+// vmmdll_benchmark.c - MemProcFS C/C++ VMM API micro benchmarks
+//
+// Minimal timing harness driving the public VMM API against a memory dump to
+// measure how core code paths scale. Since only the public API is used the
+// same benchmark binary may be run against different builds of vmm.dll/.so
+// to compare them (e.g. before/after a change).
+//
+// Usage:
+//   vmm_benchmark <benchmark> <vmm arguments>
+//   vmm_benchmark cache -device c:\dumps\memdump.raw
+//
+// Benchmarks:
+//   cache = multi-threaded cached physical page reads (VmmCacheGet) from
+//           1..N threads (N = number of cores).
+//   pool  = parallel per-process page table walk (phys2virt of all processes)
+//           scheduled on the VmmWork thread pool. Use the -threads vmm
+//           argument to compare pool sizes.
+//   vfs   = sequential reads of memory.pmem by path (VMMDLL_VfsReadU) vs.
+//           by handle (VMMDLL_VfsOpenU / VMMDLL_VfsReadHandle).
+//   scatter = scatter handle (VMMDLL_Scatter_*) self-check of overlapping and
+//           duplicate prepared ranges across clear/re-execute cycles against
+//           VMMDLL_MemRead, followed by a handle re-use timing.
+//
+// (c) Ulf Frisk, 2022
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#ifdef _WIN32
+
+#include <Windows.h>
+#include <stdio.h>
+#include <leechcore.h>
+#include <vmmdll.h>
+#pragma comment(lib, "leechcore")
+#pragma comment(lib, "vmm")
+
+typedef HANDLE                              BENCH_THREAD;
+
+#endif /* _WIN32 */
+#ifdef LINUX
+
+#include <leechcore.h>
+#include <vmmdll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define TRUE                                1
+#define FALSE                               0
+#define _stricmp(s1, s2)                    (strcasecmp(s1, s2))
+#define min(a, b)                           (((a) < (b)) ? (a) : (b))
+#define max(a, b)                           (((a) > (b)) ? (a) : (b))
+
+typedef pthread_t                           BENCH_THREAD;
+
+#endif /* LINUX */
+
+#define BENCH_CACHE_PAGES                   0x2000          // 32MB working set - fits in the PHYS cache.
+#define BENCH_CACHE_READS_PER_THREAD        0x00100000
+#define BENCH_THREADS_MAX                   0x40
+#define BENCH_POOL_ITERATIONS               8
+#define BENCH_VFS_FILE                      "\\memory.pmem"
+#define BENCH_VFS_SIZE                      0x04000000      // 64MB - read sequentially per run.
+#define BENCH_SCATTER_PA                    0x00100000
+#define BENCH_SCATTER_SIZE                  0x00040000      // 256kB reference range.
+#define BENCH_SCATTER_DUPLICATES            0x00050000      // > 1GB worth of duplicate page prepares.
+#define BENCH_SCATTER_ITERATIONS            0x1000
+
+// ----------------------------------------------------------------------------
+// Utility functions below:
+// ----------------------------------------------------------------------------
+
+/*
+* Retrieve a monotonic timestamp in microseconds.
+*/
+QWORD BenchTimeUs()
+{
+#ifdef _WIN32
+    LARGE_INTEGER qwFreq, qwNow;
+    QueryPerformanceFrequency(&qwFreq);
+    QueryPerformanceCounter(&qwNow);
+    return (QWORD)(qwNow.QuadPart * 1000000 / qwFreq.QuadPart);
+#endif /* _WIN32 */
+#ifdef LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (QWORD)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif /* LINUX */
+}
+
+DWORD BenchCoreCount()
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors;
+#endif /* _WIN32 */
+#ifdef LINUX
+    return (DWORD)max(1, sysconf(_SC_NPROCESSORS_ONLN));
+#endif /* LINUX */
+}
+
+/*
+* Run pfn in cThread threads and wait for all of them to complete.
+* -- cThread
+* -- pfn
+* -- pv = array of per-thread contexts.
+* -- cbv = size of each per-thread context.
+* -- return = wall clock time in microseconds.
+*/
+QWORD BenchRunThreads(_In_ DWORD cThread, _In_ VOID(*pfn)(PVOID), _In_ PBYTE pv, _In_ DWORD cbv)
+{
+    DWORD i;
+    QWORD tmStart;
+    BENCH_THREAD hThreads[BENCH_THREADS_MAX];
+    tmStart = BenchTimeUs();
+    for(i = 0; i < cThread; i++) {
+#ifdef _WIN32
+        hThreads[i] = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)pfn, pv + i * cbv, 0, NULL);
+#endif /* _WIN32 */
+#ifdef LINUX
+        pthread_create(&hThreads[i], NULL, (void*(*)(void*))pfn, pv + i * cbv);
+#endif /* LINUX */
+    }
+    for(i = 0; i < cThread; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(hThreads[i], INFINITE);
+        CloseHandle(hThreads[i]);
+#endif /* _WIN32 */
+#ifdef LINUX
+        pthread_join(hThreads[i], NULL);
+#endif /* LINUX */
+    }
+    return BenchTimeUs() - tmStart;
+}
+
+
+
+// ----------------------------------------------------------------------------
+// CACHE BENCHMARK:
+// Physical page reads which are all served from the PHYS cache. The reads are
+// driven from a rising number of threads to show how cache lookups scale with
+// the number of cores.
+// ----------------------------------------------------------------------------
+
+typedef struct tdBENCH_CACHE_THREAD {
+    QWORD *pqwPA;
+    DWORD cPA;
+    DWORD dwSeed;
+    DWORD cFail;
+} BENCH_CACHE_THREAD, *PBENCH_CACHE_THREAD;
+
+VOID BenchCache_ThreadProc(PBENCH_CACHE_THREAD ctx)
+{
+    DWORD i, dwSeed = ctx->dwSeed;
+    BYTE pb[8];
+    for(i = 0; i < BENCH_CACHE_READS_PER_THREAD; i++) {
+        dwSeed = dwSeed * 1103515245 + 12345;
+        if(!VMMDLL_MemReadEx((DWORD)-1, ctx->pqwPA[(dwSeed >> 8) % ctx->cPA] + (dwSeed & 0xff8), pb, sizeof(pb), NULL, VMMDLL_FLAG_FORCECACHE_READ)) {
+            ctx->cFail++;
+        }
+    }
+}
+
+BOOL BenchCache()
+{
+    double dRate, dRate1 = 0;
+    QWORD pa, tm, qwPA[BENCH_CACHE_PAGES];
+    DWORD i, cPA = 0, cThread, cThreadMax, cFail;
+    BYTE pbPage[0x1000];
+    BENCH_CACHE_THREAD ctxs[BENCH_THREADS_MAX];
+    // 1: locate readable pages and load them into the cache
+    for(pa = 0x100000; (cPA < BENCH_CACHE_PAGES) && (pa < 0x1000000000); pa += 0x1000) {
+        if(VMMDLL_MemReadEx((DWORD)-1, pa, pbPage, 0x1000, NULL, 0)) {
+            qwPA[cPA++] = pa;
+        }
+    }
+    if(!cPA) {
+        printf("BENCH CACHE: FAIL: no readable physical memory.\n");
+        return FALSE;
+    }
+    printf("BENCH CACHE: %i cached pages, %i 8-byte reads per thread.\n", cPA, BENCH_CACHE_READS_PER_THREAD);
+    printf("  THREADS      TIME(ms)   READS/s(M)   SPEEDUP   FAIL\n");
+    // 2: run benchmark with rising thread count
+    cThreadMax = min(BENCH_THREADS_MAX, BenchCoreCount());
+    for(cThread = 1; ; cThread = min(cThread * 2, cThreadMax)) {
+        for(i = 0; i < cThread; i++) {
+            ctxs[i].pqwPA = qwPA;
+            ctxs[i].cPA = cPA;
+            ctxs[i].dwSeed = 0x1337 + i;
+            ctxs[i].cFail = 0;
+        }
+        tm = BenchRunThreads(cThread, (VOID(*)(PVOID))BenchCache_ThreadProc, (PBYTE)ctxs, sizeof(BENCH_CACHE_THREAD));
+        for(i = 0, cFail = 0; i < cThread; i++) {
+            cFail += ctxs[i].cFail;
+        }
+        dRate = (double)cThread * BENCH_CACHE_READS_PER_THREAD / max(1, tm);
+        if(cThread == 1) { dRate1 = dRate; }
+        printf("  %7i  %12.1f  %11.2f  %8.2f  %5i\n", cThread, tm / 1000.0, dRate, dRate / dRate1, cFail);
+        if(cThread == cThreadMax) { break; }
+    }
+    return TRUE;
+}
+
+
+
+// ----------------------------------------------------------------------------
+// POOL BENCHMARK:
+// Reverse lookup (phys2virt) of a physical address in all processes. Each
+// lookup walks the page tables of all active processes in parallel on the
+// VmmWork thread pool (weighted parallel-for over the process list). A new
+// target address is used in each iteration to force a complete re-walk.
+// ----------------------------------------------------------------------------
+
+BOOL BenchPool()
+{
+    NTSTATUS nt;
+    CHAR szPA[0x20];
+    DWORD i, cbWrite, cbRead;
+    QWORD pa, tm, tmTotal = 0, tmMin = (QWORD)-1, tmMax = 0;
+    PBYTE pbResult;
+    BYTE pbPage[0x1000];
+    if(!(pbResult = malloc(0x01000000))) { return FALSE; }
+    printf("BENCH POOL: %i iterations of phys2virt over all processes.\n", BENCH_POOL_ITERATIONS);
+    printf("  ITERATION  TARGET PA            TIME(ms)   RESULT(bytes)\n");
+    for(i = 0, pa = 0x01000000; (i < BENCH_POOL_ITERATIONS) && (pa < 0x1000000000); pa += 0x00100000) {
+        if(!VMMDLL_MemReadEx((DWORD)-1, pa, pbPage, 0x1000, NULL, 0)) { continue; }
+        snprintf(szPA, sizeof(szPA), "%llx", pa);
+        VMMDLL_VfsWriteU("\\misc\\phys2virt\\phys.txt", (PBYTE)szPA, (DWORD)strlen(szPA), &cbWrite, 0);
+        tm = BenchTimeUs();
+        nt = VMMDLL_VfsReadU("\\misc\\phys2virt\\virt.txt", pbResult, 0x01000000, &cbRead, 0);
+        tm = BenchTimeUs() - tm;
+        if(nt && (nt != VMMDLL_STATUS_END_OF_FILE)) {
+            printf("BENCH POOL: FAIL: read phys2virt result (0x%08x).\n", nt);
+            free(pbResult);
+            return FALSE;
+        }
+        printf("  %9i  %016llx  %10.1f  %14i\n", i, pa, tm / 1000.0, cbRead);
+        tmTotal += tm;
+        tmMin = min(tmMin, tm);
+        tmMax = max(tmMax, tm);
+        i++;
+    }
+    free(pbResult);
+    if(!i) {
+        printf("BENCH POOL: FAIL: no readable physical memory.\n");
+        return FALSE;
+    }
+    printf("  AVG/MIN/MAX(ms): %.1f / %.1f / %.1f\n", tmTotal / 1000.0 / i, tmMin / 1000.0, tmMax / 1000.0);
+    return TRUE;
+}
+
+
+
+// ----------------------------------------------------------------------------
+// VFS BENCHMARK:
+// Sequential reads of a virtual file system file - once by path where each
+// read splits the path and walks the plugin tree, and once by a handle which
+// is resolved once on open. A warm-up pass loads the range into the cache to
+// have both variants read under the same conditions. Small reads show the
+// per-call overhead; large (FUSE sized) reads show the throughput.
+// ----------------------------------------------------------------------------
+
+/*
+* Read BENCH_VFS_SIZE bytes sequentially from the benchmark file.
+* -- hVfs = handle to read from, or NULL to read by path.
+* -- pb
+* -- cbChunk = size of each read.
+* -- pcbTotal = total number of bytes read.
+* -- return = time in microseconds.
+*/
+QWORD BenchVfs_Read(_In_opt_ VMMDLL_VFS_HANDLE hVfs, _In_ PBYTE pb, _In_ DWORD cbChunk, _Out_ PQWORD pcbTotal)
+{
+    NTSTATUS nt;
+    DWORD cbRead;
+    QWORD o, tm = BenchTimeUs();
+    *pcbTotal = 0;
+    for(o = 0; o < BENCH_VFS_SIZE; o += cbChunk) {
+        if(hVfs) {
+            nt = VMMDLL_VfsReadHandle(hVfs, pb, cbChunk, &cbRead, o);
+        } else {
+            nt = VMMDLL_VfsReadU(BENCH_VFS_FILE, pb, cbChunk, &cbRead, o);
+        }
+        if(nt || !cbRead) { break; }
+        *pcbTotal += cbRead;
+    }
+    return BenchTimeUs() - tm;
+}
+
+BOOL BenchVfs()
+{
+    DWORD i;
+    PBYTE pb;
+    QWORD tm, cbTotal;
+    VMMDLL_VFS_HANDLE hVfs;
+    DWORD cbChunk[] = { 0x1000, 0x00020000 };
+    if(!(hVfs = VMMDLL_VfsOpenU(BENCH_VFS_FILE))) {
+        printf("BENCH VFS: FAIL: VMMDLL_VfsOpenU(%s).\n", BENCH_VFS_FILE);
+        return FALSE;
+    }
+    if(!(pb = malloc(0x00020000))) {
+        VMMDLL_VfsCloseHandle(hVfs);
+        return FALSE;
+    }
+    BenchVfs_Read(hVfs, pb, 0x00020000, &cbTotal);
+    if(!cbTotal) {
+        printf("BENCH VFS: FAIL: no data read from %s.\n", BENCH_VFS_FILE);
+        VMMDLL_VfsCloseHandle(hVfs);
+        free(pb);
+        return FALSE;
+    }
+    printf("BENCH VFS: sequential read of %lli MB of %s.\n", cbTotal >> 20, BENCH_VFS_FILE);
+    printf("  CHUNK(bytes)  METHOD     TIME(ms)       MB/s\n");
+    for(i = 0; i < sizeof(cbChunk) / sizeof(DWORD); i++) {
+        tm = BenchVfs_Read(NULL, pb, cbChunk[i], &cbTotal);
+        printf("  %12i  path    %11.1f  %9.1f\n", cbChunk[i], tm / 1000.0, (double)cbTotal / max(1, tm));
+        tm = BenchVfs_Read(hVfs, pb, cbChunk[i], &cbTotal);
+        printf("  %12i  handle  %11.1f  %9.1f\n", cbChunk[i], tm / 1000.0, (double)cbTotal / max(1, tm));
+    }
+    VMMDLL_VfsCloseHandle(hVfs);
+    free(pb);
+    return TRUE;
+}
+
+
+// ----------------------------------------------------------------------------
+// SCATTER BENCHMARK:
+// Self-check of the scatter handle against plain reads of the same physical
+// memory: ranges overlapping each other, duplicate pages, tiny reads and page
+// crossing reads are prepared; results (buffers and read lengths) are checked
+// after execute, after re-execute and after clear of the handle. Duplicate
+// prepares beyond the 1GB limit must succeed. Last the time of a handle re-use
+// cycle (clear/prepare/execute) is measured.
+// ----------------------------------------------------------------------------
+
+typedef struct tdBENCH_SCATTER_RANGE {
+    DWORD o;
+    DWORD cb;
+    DWORD cbRead;
+    PBYTE pb;
+} BENCH_SCATTER_RANGE, *PBENCH_SCATTER_RANGE;
+
+/*
+* Prepare ranges (and a number of duplicate page prepares) in a scatter handle.
+* -- hS
+* -- pRanges
+* -- cRanges
+* -- cDuplicate = # additional prepares of already prepared pages.
+* -- return
+*/
+BOOL BenchScatter_Prepare(_In_ VMMDLL_SCATTER_HANDLE hS, _In_ PBENCH_SCATTER_RANGE pRanges, _In_ DWORD cRanges, _In_ DWORD cDuplicate)
+{
+    DWORD i;
+    for(i = 0; i < cRanges; i++) {
+        if(!VMMDLL_Scatter_PrepareEx(hS, BENCH_SCATTER_PA + pRanges[i].o, pRanges[i].cb, pRanges[i].pb, &pRanges[i].cbRead)) { return FALSE; }
+    }
+    for(i = 0; i < cDuplicate; i++) {
+        if(!VMMDLL_Scatter_Prepare(hS, BENCH_SCATTER_PA + ((i * 0x1000) % BENCH_SCATTER_SIZE), 0x1000)) { return FALSE; }
+    }
+    return TRUE;
+}
+
+/*
+* Verify prepared ranges (buffers and read lengths) and VMMDLL_Scatter_Read
+* against the reference data.
+* -- hS
+* -- pbRef
+* -- pRanges
+* -- cRanges
+* -- return = # failed checks.
+*/
+DWORD BenchScatter_Verify(_In_ VMMDLL_SCATTER_HANDLE hS, _In_ PBYTE pbRef, _In_ PBENCH_SCATTER_RANGE pRanges, _In_ DWORD cRanges)
+{
+    DWORD i, cbRead, cFail = 0;
+    BYTE pbPage[0x1000];
+    for(i = 0; i < cRanges; i++) {
+        if((pRanges[i].cbRead != pRanges[i].cb) || memcmp(pRanges[i].pb, pbRef + pRanges[i].o, pRanges[i].cb)) {
+            printf("BENCH SCATTER: FAIL: range %i (offset %x size %x read %x).\n", i, pRanges[i].o, pRanges[i].cb, pRanges[i].cbRead);
+            cFail++;
+        }
+    }
+    if(!VMMDLL_Scatter_Read(hS, BENCH_SCATTER_PA + 0x1800, 0x1000, pbPage, &cbRead) || (cbRead != 0x1000) || memcmp(pbPage, pbRef + 0x1800, 0x1000)) {
+        printf("BENCH SCATTER: FAIL: VMMDLL_Scatter_Read.\n");
+        cFail++;
+    }
+    return cFail;
+}
+
+BOOL BenchScatter()
+{
+    QWORD tm;
+    PBYTE pbRef, pbBuffer;
+    DWORD i, iRound, cFail = 0, cbBuffer = 0;
+    VMMDLL_SCATTER_HANDLE hS;
+    BENCH_SCATTER_RANGE Ranges[] = {
+        { 0x0000, 0x4000 },     // 4 pages
+        { 0x1800, 0x3000 },     // overlapping, unaligned
+        { 0x1000, 0x1000 },     // duplicate page
+        { 0x1000, 0x1000 },     // duplicate page
+        { 0x2010, 0x0008 },     // tiny read in prepared page
+        { 0x9ff8, 0x0010 },     // tiny page crossing read
+        { 0xc100, 0x0100 },     // tiny read
+        { 0xc100, 0x0100 },     // duplicate tiny read
+        { 0xc0f0, 0x0400 },     // overlapping tiny read
+        { 0x10000, 0x30000 },   // larger read
+    };
+    DWORD cRanges = sizeof(Ranges) / sizeof(BENCH_SCATTER_RANGE);
+    // 1: reference data
+    for(i = 0; i < cRanges; i++) {
+        cbBuffer += Ranges[i].cb;
+    }
+    pbRef = malloc(BENCH_SCATTER_SIZE);
+    pbBuffer = malloc(cbBuffer);
+    if(!pbRef || !pbBuffer || !VMMDLL_MemRead((DWORD)-1, BENCH_SCATTER_PA, pbRef, BENCH_SCATTER_SIZE)) {
+        printf("BENCH SCATTER: FAIL: reference read.\n");
+        free(pbRef);
+        free(pbBuffer);
+        return FALSE;
+    }
+    for(i = 0, cbBuffer = 0; i < cRanges; i++) {
+        Ranges[i].pb = pbBuffer + cbBuffer;
+        cbBuffer += Ranges[i].cb;
+    }
+    // 2: self-check - execute, re-execute and clear. the 2nd round prepares
+    //    duplicate pages beyond the 1GB limit, the 3rd round is small again.
+    hS = VMMDLL_Scatter_Initialize((DWORD)-1, 0);
+    for(iRound = 0; hS && (iRound < 3); iRound++) {
+        memset(pbBuffer, 0xcc, cbBuffer);
+        if(!BenchScatter_Prepare(hS, Ranges, cRanges, (iRound == 1) ? BENCH_SCATTER_DUPLICATES : 0x10)) {
+            printf("BENCH SCATTER: FAIL: prepare (round %i).\n", iRound);
+            cFail++;
+            break;
+        }
+        if(!VMMDLL_Scatter_ExecuteRead(hS)) {
+            printf("BENCH SCATTER: FAIL: execute (round %i).\n", iRound);
+            cFail++;
+            break;
+        }
+        cFail += BenchScatter_Verify(hS, pbRef, Ranges, cRanges);
+        memset(pbBuffer, 0xcc, cbBuffer);
+        if(!VMMDLL_Scatter_ExecuteRead(hS)) {
+            printf("BENCH SCATTER: FAIL: re-execute (round %i).\n", iRound);
+            cFail++;
+            break;
+        }
+        cFail += BenchScatter_Verify(hS, pbRef, Ranges, cRanges);
+        VMMDLL_Scatter_Clear(hS, (DWORD)-1, 0);
+    }
+    printf("BENCH SCATTER: self-check %s (%i failed checks).\n", (hS && !cFail) ? "OK" : "FAIL", cFail);
+    // 3: handle re-use timing
+    tm = BenchTimeUs();
+    for(i = 0; hS && !cFail && (i < BENCH_SCATTER_ITERATIONS); i++) {
+        VMMDLL_Scatter_Clear(hS, (DWORD)-1, 0);
+        BenchScatter_Prepare(hS, Ranges, cRanges, 0x40);
+        VMMDLL_Scatter_ExecuteRead(hS);
+    }
+    tm = BenchTimeUs() - tm;
+    if(hS && !cFail) {
+        printf("BENCH SCATTER: %i clear/prepare/execute cycles: %.1f ms (%.1f us/cycle).\n", BENCH_SCATTER_ITERATIONS, tm / 1000.0, (double)tm / BENCH_SCATTER_ITERATIONS);
+    }
+    VMMDLL_Scatter_CloseHandle(hS);
+    free(pbRef);
+    free(pbBuffer);
+    return hS && !cFail;
+}
+
+
+
+// ----------------------------------------------------------------------------
+// MAIN:
+// ----------------------------------------------------------------------------
+
+int main(_In_ int argc, _In_ char* argv[])
+{
+    BOOL fResult = FALSE;
+    LPSTR argvVmm[0x20];
+    DWORD i, argcVmm = 0;
+    if((argc < 3) || (argc > 0x20)) {
+        printf("Usage: vmm_benchmark <cache|pool|vfs|scatter> <vmm arguments>\n");
+        return 1;
+    }
+    argvVmm[argcVmm++] = "";
+    for(i = 2; i < (DWORD)argc; i++) {
+        argvVmm[argcVmm++] = argv[i];
+    }
+    if(!VMMDLL_Initialize(argcVmm, argvVmm)) {
+        printf("BENCH: FAIL: VMMDLL_Initialize\n");
+        return 1;
+    }
+    if(!_stricmp(argv[1], "cache")) {
+        fResult = BenchCache();
+    } else if(!_stricmp(argv[1], "pool")) {
+        fResult = BenchPool();
+    } else if(!_stricmp(argv[1], "vfs")) {
+        fResult = BenchVfs();
+    } else if(!_stricmp(argv[1], "scatter")) {
+        fResult = BenchScatter();
+    } else {
+        printf("BENCH: FAIL: unknown benchmark '%s'\n", argv[1]);
+    }
+    VMMDLL_Close();
+    return fResult ? 0 : 1;
+}